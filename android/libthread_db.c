@@ -11,6 +11,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <string.h>
 
 #define DEBUG 1
 #if DEBUG
@@ -194,6 +195,11 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
 
     agent->pid = ps_getpid(proc_handle);
     agent->ph = proc_handle;
+    agent->tids = NULL;
+    agent->num_tids = 0;
+    agent->max_tids = 0;
+    agent->tracking = 0;
+    agent->stale = 1;
     *agent_out = agent;
 
     return TD_OK;
@@ -203,6 +209,7 @@ td_ta_new(struct ps_prochandle * proc_handle, td_thragent_t ** agent_out)
 td_err_e
 td_ta_delete(td_thragent_t * ta)
 {
+    free(ta->tids);
     free(ta);
     // FIXME: anything else to do?
     return TD_OK;
@@ -330,35 +337,190 @@ td_ta_clear_event(const td_thragent_t * ta_arg, td_thr_events_t * event)
 }
 
 
-td_err_e
-td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
-               td_thr_state_e state, int32_t prio, sigset_t * sigmask, uint32_t user_flags)
+/* Find TID in the sorted thread table.  Return 1 if it is there,
+ * 0 if not; either way, set *POS to where it is or would go. */
+static int
+_find_tid(td_thragent_t const * ta, pid_t tid, int * pos)
+{
+    int lo = 0, hi = ta->num_tids;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (ta->tids[mid] < tid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *pos = lo;
+    return lo < ta->num_tids && ta->tids[lo] == tid;
+}
+
+/* Make room for one more thread in the thread table. */
+static int
+_reserve_tid(td_thragent_t * ta)
+{
+    if (ta->num_tids == ta->max_tids) {
+        int max_tids = ta->max_tids ? ta->max_tids * 2 : 64;
+        pid_t * tids = realloc(ta->tids, max_tids * sizeof(pid_t));
+
+        if (!tids)
+            return -1;
+        ta->tids = tids;
+        ta->max_tids = max_tids;
+    }
+    return 0;
+}
+
+/* Add TID to the thread table, unless it is there already. */
+static int
+_add_tid(td_thragent_t * ta, pid_t tid)
+{
+    int pos;
+
+    if (_find_tid(ta, tid, &pos))
+        return 0;
+
+    if (_reserve_tid(ta) < 0)
+        return -1;
+
+    memmove(&ta->tids[pos + 1], &ta->tids[pos],
+            (ta->num_tids - pos) * sizeof(pid_t));
+    ta->tids[pos] = tid;
+    ta->num_tids++;
+    return 0;
+}
+
+static int
+_compare_tids(const void * a, const void * b)
+{
+    pid_t ta = *(const pid_t *) a;
+    pid_t tb = *(const pid_t *) b;
+
+    return ta < tb ? -1 : ta > tb;
+}
+
+/* Read the thread table from /proc/<pid>/task */
+static td_err_e
+_rescan_tids(td_thragent_t * ta)
 {
-    td_err_e err = TD_OK;
     char path[32];
     DIR * dir;
     struct dirent * entry;
-    td_thrhandle_t handle;
 
-    snprintf(path, sizeof(path), "/proc/%d/task/", agent->pid);
+    snprintf(path, sizeof(path), "/proc/%d/task/", ta->pid);
     dir = opendir(path);
     if (!dir) {
         return TD_NOEVENT;
     }
 
-    handle.pid = agent->pid;
+    ta->num_tids = 0;
     while ((entry = readdir(dir)) != NULL) {
         if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
             continue;
         }
-        handle.tid = atoi(entry->d_name);
+        /* Each thread is listed once; sort the table when done. */
+        if (_reserve_tid(ta) < 0) {
+            closedir(dir);
+            ta->stale = 1;
+            return TD_MALLOC;
+        }
+        ta->tids[ta->num_tids++] = atoi(entry->d_name);
+    }
+
+    closedir(dir);
+    qsort(ta->tids, ta->num_tids, sizeof(pid_t), _compare_tids);
+
+    /* Without events, the table is out of date as soon as we're done */
+    ta->stale = !ta->tracking;
+    D("Read %d threads\n", ta->num_tids);
+    return TD_OK;
+}
+
+
+td_err_e
+td_ta_thr_track(td_thragent_t * ta)
+{
+    ta->tracking = 1;
+    ta->stale = 1;
+    return TD_OK;
+}
+
+
+td_err_e
+td_ta_thr_created(td_thragent_t * ta, lwpid_t lwpid)
+{
+    /* A rescan will find it */
+    if (ta->stale)
+        return TD_OK;
+
+    if (_add_tid(ta, lwpid) < 0) {
+        ta->stale = 1;
+        return TD_MALLOC;
+    }
+    return TD_OK;
+}
+
+
+td_err_e
+td_ta_thr_exited(td_thragent_t * ta, lwpid_t lwpid)
+{
+    int pos;
+
+    if (ta->stale)
+        return TD_OK;
+
+    if (_find_tid(ta, lwpid, &pos)) {
+        ta->num_tids--;
+        memmove(&ta->tids[pos], &ta->tids[pos + 1],
+                (ta->num_tids - pos) * sizeof(pid_t));
+    }
+    return TD_OK;
+}
+
+
+td_err_e
+td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func, void * cookie,
+               td_thr_state_e state, int32_t prio, sigset_t * sigmask, uint32_t user_flags)
+{
+    td_thragent_t * ta = (td_thragent_t *) agent;
+    td_err_e err = TD_OK;
+    td_thrhandle_t handle;
+    pid_t * tids;
+    int num_tids;
+    int i;
+
+    if (ta->stale) {
+        err = _rescan_tids(ta);
+        if (err != TD_OK) {
+            return err;
+        }
+    }
+
+    num_tids = ta->num_tids;
+    if (num_tids == 0) {
+        return TD_OK;
+    }
+
+    /* FUNC may make the debugger report thread events, which change
+     * the table; iterate over a copy. */
+    tids = malloc(num_tids * sizeof(pid_t));
+    if (!tids) {
+        return TD_MALLOC;
+    }
+    memcpy(tids, ta->tids, num_tids * sizeof(pid_t));
+
+    handle.pid = ta->pid;
+    for (i = 0; i < num_tids; i++) {
+        handle.tid = tids[i];
         if (func(&handle, cookie) != 0) {
 	    err = TD_DBERR;
             break;
         }
     }
 
-    closedir(dir);
+    free(tids);
 
     return err;
 }
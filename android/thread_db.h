@@ -73,6 +73,18 @@ typedef struct
 {
     pid_t pid;
     struct ps_prochandle *ph;
+
+    /* The threads of the process.  Once the debugger has called
+     * td_ta_thr_track, this is kept up to date from the clone and exit
+     * events the debugger reports, instead of being read from
+     * /proc/<pid>/task on every td_ta_thr_iter.  It is only read again
+     * when marked stale.  The table is kept sorted, so that a thread
+     * can be found without going through all of it. */
+    pid_t *tids;
+    int num_tids;
+    int max_tids;
+    int tracking;
+    int stale;
 } td_thragent_t;
 
 typedef struct
@@ -156,6 +168,16 @@ extern td_err_e td_ta_thr_iter(td_thragent_t const * agent, td_thr_iter_f * func
 
 extern char const ** td_symbol_list(void);
 
+/* Android extensions, for debuggers that see thread creation and exit
+ * (e.g. through PTRACE_O_TRACECLONE) and report them, so that
+ * td_ta_thr_iter doesn't need to rescan /proc. */
+
+extern td_err_e td_ta_thr_track(td_thragent_t * agent);
+
+extern td_err_e td_ta_thr_created(td_thragent_t * agent, lwpid_t lwpid);
+
+extern td_err_e td_ta_thr_exited(td_thragent_t * agent, lwpid_t lwpid);
+
 extern td_err_e td_thr_event_enable(td_thrhandle_t const * handle, td_event_e event);
 
 extern td_err_e td_thr_get_info(td_thrhandle_t const * handle, td_thrinfo_t * info);
@@ -31,7 +31,7 @@ SECTION
 	regard to the underlying operating system's file descriptor
 	limit (often as low as 20 open files).  The module in
 	<<cache.c>> maintains a least recently used list of
-	<<BFD_CACHE_MAX_OPEN>> files, and exports the name
+	<<bfd_cache_max_open>> files, and exports the name
 	<<bfd_cache_lookup>>, which runs around and makes sure that
 	the required BFD is open. If not, then it chooses a file to
 	close, closes it and opens the one wanted, returning its file
@@ -66,15 +66,52 @@ enum cache_flag {
   CACHE_NO_SEEK_ERROR = 4
 };
 
-/* The maximum number of files which the cache will keep open at
-   one time.  */
+/* The smallest number of files which the cache will keep open at
+   one time, whatever the system's limit on open files.  */
 
 #define BFD_CACHE_MAX_OPEN 10
 
+/* The maximum number of files which the cache will keep open at one
+   time, or zero if it has not been computed yet.  */
+
+static int max_open_files;
+
 /* The number of BFD files we have open.  */
 
 static int open_files;
 
+/* The number of cache lookups that found the file already open, and
+   the number that had to (re)open it.  */
+
+static unsigned long cache_hits;
+static unsigned long cache_misses;
+
+/* Return the maximum number of files the cache may keep open.  This
+   is a quarter of the process's limit on open files, so that programs
+   such as GDB, which can have hundreds of BFDs around, do not keep
+   closing and reopening them, while still leaving most descriptors to
+   the application.  */
+
+static int
+bfd_cache_max_open (void)
+{
+  if (max_open_files == 0)
+    {
+      long max = 0;
+
+#if defined (HAVE_SYSCONF) && defined (_SC_OPEN_MAX)
+      /* On POSIX systems this is RLIMIT_NOFILE.  */
+      max = sysconf (_SC_OPEN_MAX) / 4;
+#endif
+      if (max < BFD_CACHE_MAX_OPEN)
+	max = BFD_CACHE_MAX_OPEN;
+      else if (max > 0x10000)
+	max = 0x10000;
+      max_open_files = max;
+    }
+  return max_open_files;
+}
+
 /* Zero, or a pointer to the topmost BFD on the chain.  This is
    used by the <<bfd_cache_lookup>> macro in @file{libbfd.h} to
    determine when it can avoid a function call.  */
@@ -181,13 +218,13 @@ close_one (void)
 
 #define bfd_cache_lookup(x, flag) \
   ((x) == bfd_last_cache			\
-   ? (FILE *) (bfd_last_cache->iostream)	\
+   ? (cache_hits++, (FILE *) (bfd_last_cache->iostream))	\
    : bfd_cache_lookup_worker (x, flag))
 
 /* Called when the macro <<bfd_cache_lookup>> fails to find a
    quick answer.  Find a file descriptor for @var{abfd}.  If
    necessary, it open it.  If there are already more than
-   <<BFD_CACHE_MAX_OPEN>> files open, it tries to close one first, to
+   <<bfd_cache_max_open>> files open, it tries to close one first, to
    avoid running out of file descriptors.  It will return NULL
    if it is unable to (re)open the @var{abfd}.  */
 
@@ -203,6 +240,8 @@ bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
 
   if (abfd->iostream != NULL)
     {
+      cache_hits++;
+
       /* Move the file to the start of the cache.  */
       if (abfd != bfd_last_cache)
 	{
@@ -215,6 +254,7 @@ bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
   if (flag & CACHE_NO_OPEN)
     return NULL;
 
+  cache_misses++;
   if (bfd_open_file (abfd) == NULL)
     ;
   else if (!(flag & CACHE_NO_SEEK)
@@ -466,7 +506,7 @@ bfd_boolean
 bfd_cache_init (bfd *abfd)
 {
   BFD_ASSERT (abfd->iostream != NULL);
-  if (open_files >= BFD_CACHE_MAX_OPEN)
+  if (open_files >= bfd_cache_max_open ())
     {
       if (! close_one ())
 	return FALSE;
@@ -533,6 +573,32 @@ bfd_cache_close_all ()
   return ret;
 }
 
+/*
+FUNCTION
+	bfd_cache_stats
+
+SYNOPSIS
+	void bfd_cache_stats (int *open, int *max_open,
+			      unsigned long *hits, unsigned long *misses);
+
+DESCRIPTION
+	Store the number of files the cache currently has open in
+	*@var{open}, the most it will keep open at once in
+	*@var{max_open}, the number of cache lookups that found the
+	file already open in *@var{hits}, and the number that had to
+	reopen it in *@var{misses}.
+*/
+
+void
+bfd_cache_stats (int *open, int *max_open,
+		 unsigned long *hits, unsigned long *misses)
+{
+  *open = open_files;
+  *max_open = bfd_cache_max_open ();
+  *hits = cache_hits;
+  *misses = cache_misses;
+}
+
 /*
 INTERNAL_FUNCTION
 	bfd_open_file
@@ -553,7 +619,7 @@ bfd_open_file (bfd *abfd)
 {
   abfd->cacheable = TRUE;	/* Allow it to be closed later.  */
 
-  if (open_files >= BFD_CACHE_MAX_OPEN)
+  if (open_files >= bfd_cache_max_open ())
     {
       if (! close_one ())
 	return NULL;
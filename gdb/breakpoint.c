@@ -75,6 +75,7 @@
 #undef savestring
 
 #include "mi/mi-common.h"
+#include "ax-gdb.h"
 #include "python/python.h"
 
 /* Prototypes for local functions.  */
@@ -143,6 +144,11 @@ static int breakpoint_address_match (struct address_space *aspace1,
 static int watchpoint_locations_match (struct bp_location *loc1,
 				       struct bp_location *loc2);
 
+static int breakpoint_locations_match (struct bp_location *loc1,
+				       struct bp_location *loc2);
+
+static int breakpoint_address_is_meaningful (struct breakpoint *bpt);
+
 static int breakpoint_location_address_match (struct bp_location *bl,
 					      struct address_space *aspace,
 					      CORE_ADDR addr);
@@ -381,6 +387,63 @@ breakpoints_always_inserted_mode (void)
 	  && !RECORD_IS_USED);
 }
 
+/* Where breakpoint conditions are evaluated.  If host, GDB evaluates
+   them every time the breakpoint is hit.  If target, software
+   breakpoint conditions are compiled to agent expressions and given
+   to the target along with the breakpoint, so it only reports the
+   hits where a condition is true; GDB still checks the condition
+   then.  If the target can't evaluate conditions, GDB does.  Auto
+   (the default) is the same as target.  */
+
+static const char condition_evaluation_auto[] = "auto";
+static const char condition_evaluation_host[] = "host";
+static const char condition_evaluation_target[] = "target";
+static const char *condition_evaluation_enums[] = {
+  condition_evaluation_auto,
+  condition_evaluation_host,
+  condition_evaluation_target,
+  NULL
+};
+static const char *condition_evaluation_mode = condition_evaluation_auto;
+
+/* Return non-zero if breakpoint conditions are currently given to the
+   target to evaluate.  */
+
+static int
+target_evaluates_breakpoint_conditions (void)
+{
+  return (condition_evaluation_mode != condition_evaluation_host
+	  && target_supports_evaluation_of_breakpoint_conditions ());
+}
+
+static void
+show_condition_evaluation_mode (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c,
+				const char *value)
+{
+  if (condition_evaluation_mode == condition_evaluation_host)
+    fprintf_filtered (file,
+		      _("Breakpoint condition evaluation mode is %s.\n"),
+		      value);
+  else
+    fprintf_filtered (file,
+		      _("Breakpoint condition evaluation "
+			"mode is %s (currently %s).\n"),
+		      value,
+		      target_evaluates_breakpoint_conditions ()
+		      ? condition_evaluation_target
+		      : condition_evaluation_host);
+}
+
+static void update_inserted_breakpoint_conditions (void);
+
+static void
+set_condition_evaluation_mode (char *args, int from_tty,
+			       struct cmd_list_element *c)
+{
+  update_inserted_breakpoint_conditions ();
+}
+
 void _initialize_breakpoint (void);
 
 /* Are we executing breakpoint commands?  */
@@ -412,6 +475,20 @@ int target_exact_watchpoints = 0;
 	     BP_TMP < bp_location + bp_location_count && (B = *BP_TMP);	\
 	     BP_TMP++)
 
+/* Iterator for the breakpoint (not watchpoint) locations which may
+   match address ADDR according to breakpoint_location_address_match:
+   the ones at ADDR, and the ranged ones starting less than
+   bp_location_length_max bytes before it.  The subrange is found by
+   binary search, so this costs O(log N) plus the number of matches.
+   The same restriction as for ALL_BP_LOCATIONS applies.  */
+
+#define ALL_BP_LOCATIONS_AT_ADDR(B,BP_TMP,ADDR)				\
+	for (BP_TMP = bp_location_lower_bound				\
+		        (bp_location_range_start (ADDR));		\
+	     BP_TMP < bp_location + bp_location_count			\
+	     && (B = *BP_TMP)->address <= (ADDR);			\
+	     BP_TMP++)
+
 /* Iterator for tracepoints only.  */
 
 #define ALL_TRACEPOINTS(B)  \
@@ -446,6 +523,51 @@ static CORE_ADDR bp_location_placed_address_before_address_max;
 
 static CORE_ADDR bp_location_shadow_len_after_address_max;
 
+/* Maximum LENGTH of the ranged breakpoint locations in BP_LOCATION,
+   or zero if there are none.  Used by ALL_BP_LOCATIONS_AT_ADDR.  */
+
+static CORE_ADDR bp_location_length_max;
+
+/* The mark update_global_location_list last stored in the
+   GLOBAL_LIST_MARK field of all the locations it put in
+   BP_LOCATION.  */
+
+static unsigned int bp_location_list_mark;
+
+/* Return the first element of BP_LOCATION whose ADDRESS is ADDR or
+   greater, or BP_LOCATION + BP_LOCATION_COUNT if there is none.  */
+
+static struct bp_location **
+bp_location_lower_bound (CORE_ADDR addr)
+{
+  unsigned lo = 0, hi = bp_location_count;
+
+  while (lo < hi)
+    {
+      unsigned mid = lo + (hi - lo) / 2;
+
+      if (bp_location[mid]->address < addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return bp_location + lo;
+}
+
+/* Return the lowest ADDRESS a breakpoint location matching ADDR may
+   have.  */
+
+static CORE_ADDR
+bp_location_range_start (CORE_ADDR addr)
+{
+  if (bp_location_length_max == 0)
+    return addr;
+  if (addr < bp_location_length_max - 1)
+    return 0;
+  return addr - (bp_location_length_max - 1);
+}
+
 /* The locations that no longer correspond to any breakpoint, unlinked
    from bp_location array, but for which a hit may still be reported
    by a target.  */
@@ -617,6 +739,11 @@ set_breakpoint_condition (struct breakpoint *b, char *exp,
 	{
 	  xfree (loc->cond);
 	  loc->cond = NULL;
+	  if (loc->cond_bytecode != NULL)
+	    {
+	      free_agent_expr (loc->cond_bytecode);
+	      loc->cond_bytecode = NULL;
+	    }
 	}
     }
 
@@ -659,6 +786,7 @@ set_breakpoint_condition (struct breakpoint *b, char *exp,
 	    }
 	}
     }
+  update_inserted_breakpoint_conditions ();
   breakpoints_changed ();
   observer_notify_breakpoint_modified (b);
 }
@@ -1632,6 +1760,72 @@ unduplicated_should_be_inserted (struct bp_location *bl)
   return result;
 }
 
+/* Collect in *CONDITIONS the compiled conditions of BL and of the
+   locations that are duplicates of it, for the target to evaluate
+   when BL is inserted.  *CONDITIONS is left empty if the target must
+   report every hit: it doesn't evaluate conditions, or one of the
+   locations is unconditional or has a condition that can't be
+   compiled.  Returns a hash of the collected bytecode, or zero if
+   there is none.  */
+
+static hashval_t
+build_target_condition_list (struct bp_location *bl,
+			     VEC(agent_expr_p) **conditions)
+{
+  struct bp_location **locp, *loc;
+  hashval_t hash = 0;
+  int unconditional = 0;
+
+  gdb_assert (VEC_empty (agent_expr_p, *conditions));
+
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || !target_evaluates_breakpoint_conditions ())
+    return 0;
+
+  ALL_BP_LOCATIONS_AT_ADDR (loc, locp, bl->address)
+    {
+      if (!breakpoint_address_is_meaningful (loc->owner)
+	  || !unduplicated_should_be_inserted (loc)
+	  || !breakpoint_locations_match (loc, bl))
+	continue;
+
+      if (loc->cond == NULL)
+	{
+	  unconditional = 1;
+	  break;
+	}
+
+      if (loc->cond_bytecode == NULL)
+	{
+	  struct gdb_exception e;
+
+	  TRY_CATCH (e, RETURN_MASK_ERROR)
+	    {
+	      loc->cond_bytecode = gen_eval_for_expr (loc->address,
+						      loc->cond);
+	    }
+	  if (e.reason < 0)
+	    {
+	      unconditional = 1;
+	      break;
+	    }
+	}
+
+      VEC_safe_push (agent_expr_p, *conditions, loc->cond_bytecode);
+      hash = iterative_hash (loc->cond_bytecode->buf,
+			     loc->cond_bytecode->len, hash);
+    }
+
+  if (unconditional || VEC_empty (agent_expr_p, *conditions))
+    {
+      VEC_free (agent_expr_p, *conditions);
+      return 0;
+    }
+
+  /* Keep zero for "no conditions".  */
+  return hash != 0 ? hash : 1;
+}
+
 /* Insert a low-level "breakpoint" of some type.  BL is the breakpoint
    location.  Any error messages are printed to TMP_ERROR_STREAM; and
    DISABLED_BREAKS, and HW_BREAKPOINT_ERROR are used to report problems.
@@ -1660,6 +1854,15 @@ insert_bp_location (struct bp_location *bl,
   if (bl->loc_type == bp_loc_software_breakpoint
       || bl->loc_type == bp_loc_hardware_breakpoint)
     {
+      struct cleanup *old_chain;
+
+      /* The conditions only need to live until the target has
+	 them.  */
+      bl->target_conditions_hash
+	= build_target_condition_list (bl, &bl->target_info.conditions);
+      old_chain = make_cleanup (VEC_cleanup (agent_expr_p),
+				&bl->target_info.conditions);
+
       if (bl->owner->type != bp_hardware_breakpoint)
 	{
 	  /* If the explicitly specified breakpoint type
@@ -1745,6 +1948,7 @@ insert_bp_location (struct bp_location *bl,
 		  /* Set a software (trap) breakpoint at the LMA.  */
 		  bl->overlay_target_info = bl->target_info;
 		  bl->overlay_target_info.placed_address = addr;
+		  bl->overlay_target_info.conditions = NULL;
 		  val = target_insert_breakpoint (bl->gdbarch,
 						  &bl->overlay_target_info);
 		  if (val != 0)
@@ -1764,10 +1968,13 @@ insert_bp_location (struct bp_location *bl,
 	    {
 	      /* No.  This breakpoint will not be inserted.  
 		 No error, but do not mark the bp as 'inserted'.  */
+	      do_cleanups (old_chain);
 	      return 0;
 	    }
 	}
 
+      do_cleanups (old_chain);
+
       if (val)
 	{
 	  /* Can't set the breakpoint.  */
@@ -2895,7 +3102,7 @@ breakpoint_here_p (struct address_space *aspace, CORE_ADDR pc)
   struct bp_location *bl, **blp_tmp;
   int any_breakpoint_here = 0;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  ALL_BP_LOCATIONS_AT_ADDR (bl, blp_tmp, pc)
     {
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
@@ -2946,7 +3153,7 @@ regular_breakpoint_inserted_here_p (struct address_space *aspace,
 {
   struct bp_location *bl, **blp_tmp;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  ALL_BP_LOCATIONS_AT_ADDR (bl, blp_tmp, pc)
     {
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
@@ -2990,7 +3197,7 @@ software_breakpoint_inserted_here_p (struct address_space *aspace,
 {
   struct bp_location *bl, **blp_tmp;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  ALL_BP_LOCATIONS_AT_ADDR (bl, blp_tmp, pc)
     {
       if (bl->loc_type != bp_loc_software_breakpoint)
 	continue;
@@ -3059,7 +3266,7 @@ breakpoint_thread_match (struct address_space *aspace, CORE_ADDR pc,
   int thread = -1;
   int task = 0;
   
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  ALL_BP_LOCATIONS_AT_ADDR (bl, blp_tmp, pc)
     {
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
@@ -6137,6 +6344,7 @@ static void
 disable_breakpoints_in_unloaded_shlib (struct so_list *solib)
 {
   struct bp_location *loc, **locp_tmp;
+  struct target_section *p;
   int disabled_shlib_breaks = 0;
 
   /* SunOS a.out shared libraries are always mapped, so do not
@@ -6147,40 +6355,47 @@ disable_breakpoints_in_unloaded_shlib (struct so_list *solib)
       && bfd_get_flavour (exec_bfd) == bfd_target_aout_flavour)
     return;
 
-  ALL_BP_LOCATIONS (loc, locp_tmp)
-  {
-    /* ALL_BP_LOCATIONS bp_location has LOC->OWNER always non-NULL.  */
-    struct breakpoint *b = loc->owner;
-
-    if (solib->pspace == loc->pspace
-	&& !loc->shlib_disabled
-	&& (((b->type == bp_breakpoint
-	      || b->type == bp_jit_event
-	      || b->type == bp_hardware_breakpoint)
-	     && (loc->loc_type == bp_loc_hardware_breakpoint
-		 || loc->loc_type == bp_loc_software_breakpoint))
-	    || is_tracepoint (b))
-	&& solib_contains_address_p (solib, loc->address))
+  /* Only look at the locations within the sections of SOLIB; they
+     are contiguous in the sorted BP_LOCATION array.  */
+  for (p = solib->sections; p < solib->sections_end; p++)
+    for (locp_tmp = bp_location_lower_bound (p->addr);
+	 (locp_tmp < bp_location + bp_location_count
+	  && (loc = *locp_tmp)->address < p->endaddr);
+	 locp_tmp++)
       {
-	loc->shlib_disabled = 1;
-	/* At this point, we cannot rely on remove_breakpoint
-	   succeeding so we must mark the breakpoint as not inserted
-	   to prevent future errors occurring in remove_breakpoints.  */
-	loc->inserted = 0;
-
-	/* This may cause duplicate notifications for the same breakpoint.  */
-	observer_notify_breakpoint_modified (b);
-
-	if (!disabled_shlib_breaks)
+	/* BP_LOCATION has LOC->OWNER always non-NULL.  */
+	struct breakpoint *b = loc->owner;
+
+	if (solib->pspace == loc->pspace
+	    && !loc->shlib_disabled
+	    && (((b->type == bp_breakpoint
+		  || b->type == bp_jit_event
+		  || b->type == bp_hardware_breakpoint)
+		 && (loc->loc_type == bp_loc_hardware_breakpoint
+		     || loc->loc_type == bp_loc_software_breakpoint))
+		|| is_tracepoint (b)))
 	  {
-	    target_terminal_ours_for_output ();
-	    warning (_("Temporarily disabling breakpoints "
-		       "for unloaded shared library \"%s\""),
-		     solib->so_name);
+	    loc->shlib_disabled = 1;
+	    /* At this point, we cannot rely on remove_breakpoint
+	       succeeding so we must mark the breakpoint as not inserted
+	       to prevent future errors occurring in
+	       remove_breakpoints.  */
+	    loc->inserted = 0;
+
+	    /* This may cause duplicate notifications for the same
+	       breakpoint.  */
+	    observer_notify_breakpoint_modified (b);
+
+	    if (!disabled_shlib_breaks)
+	      {
+		target_terminal_ours_for_output ();
+		warning (_("Temporarily disabling breakpoints "
+			   "for unloaded shared library \"%s\""),
+			 solib->so_name);
+	      }
+	    disabled_shlib_breaks = 1;
 	  }
-	disabled_shlib_breaks = 1;
       }
-  }
 }
 
 /* FORK & VFORK catchpoints.  */
@@ -10292,9 +10507,92 @@ bp_location_compare (const void *ap, const void *bp)
   return (a > b) - (a < b);
 }
 
-/* Set bp_location_placed_address_before_address_max and
-   bp_location_shadow_len_after_address_max according to the current
-   content of the bp_location array.  */
+/* Fill the freshly allocated BP_LOCATION array, given the
+   OLD_LOCATION_COUNT elements of the former array OLD_LOCATION.
+   update_global_location_list has set the GLOBAL_LIST_MARK of the
+   current locations to bp_location_list_mark.  The locations kept from
+   OLD_LOCATION are still sorted, so only the new ones need sorting;
+   both runs are then merged.  This keeps adding or removing a few
+   breakpoints linear in the number of locations, instead of
+   re-sorting all of them.  */
+
+static void
+bp_location_merge (struct bp_location **old_location,
+		   unsigned old_location_count)
+{
+  struct bp_location **locp, **old_locp, **added, **mergep, **kept_end;
+  struct bp_location **added_end, **merged;
+  struct breakpoint *b;
+  struct bp_location *loc;
+  unsigned kept_count;
+
+  /* Copy the locations that survive, in their former order.  Clear
+     their mark so that the remaining marked locations are the new
+     ones.  */
+  locp = bp_location;
+  for (old_locp = old_location;
+       old_locp < old_location + old_location_count;
+       old_locp++)
+    if ((*old_locp)->global_list_mark == bp_location_list_mark)
+      {
+	(*old_locp)->global_list_mark = 0;
+	*locp++ = *old_locp;
+      }
+  kept_end = locp;
+  kept_count = kept_end - bp_location;
+
+  added = kept_end;
+  ALL_BREAKPOINTS (b)
+    for (loc = b->loc; loc; loc = loc->next)
+      if (loc->global_list_mark == bp_location_list_mark)
+	*locp++ = loc;
+      else
+	loc->global_list_mark = bp_location_list_mark;
+  added_end = locp;
+  gdb_assert (added_end == bp_location + bp_location_count);
+
+  /* The order of the kept locations may have changed if one of them
+     was moved or made permanent in place.  Sort everything again in
+     that case.  */
+  for (locp = bp_location; locp + 1 < kept_end; locp++)
+    if (bp_location_compare (locp, locp + 1) > 0)
+      break;
+  if (locp + 1 < kept_end)
+    {
+      qsort (bp_location, bp_location_count, sizeof (*bp_location),
+	     bp_location_compare);
+      return;
+    }
+
+  if (added == added_end)
+    return;
+  qsort (added, added_end - added, sizeof (*bp_location),
+	 bp_location_compare);
+  if (kept_count == 0)
+    return;
+
+  merged = xmalloc (sizeof (*bp_location) * bp_location_count);
+  mergep = merged;
+  locp = bp_location;
+  while (locp < kept_end && added < added_end)
+    {
+      if (bp_location_compare (locp, added) <= 0)
+	*mergep++ = *locp++;
+      else
+	*mergep++ = *added++;
+    }
+  while (locp < kept_end)
+    *mergep++ = *locp++;
+  while (added < added_end)
+    *mergep++ = *added++;
+
+  xfree (bp_location);
+  bp_location = merged;
+}
+
+/* Set bp_location_placed_address_before_address_max,
+   bp_location_shadow_len_after_address_max and bp_location_length_max
+   according to the current content of the bp_location array.  */
 
 static void
 bp_location_target_extensions_update (void)
@@ -10303,11 +10601,17 @@ bp_location_target_extensions_update (void)
 
   bp_location_placed_address_before_address_max = 0;
   bp_location_shadow_len_after_address_max = 0;
+  bp_location_length_max = 0;
 
   ALL_BP_LOCATIONS (bl, blp_tmp)
     {
       CORE_ADDR start, end, addr;
 
+      if ((bl->loc_type == bp_loc_software_breakpoint
+	   || bl->loc_type == bp_loc_hardware_breakpoint)
+	  && bl->length > bp_location_length_max)
+	bp_location_length_max = bl->length;
+
       if (!bp_location_has_shadow (bl))
 	continue;
 
@@ -10379,6 +10683,7 @@ swap_insertion (struct bp_location *left, struct bp_location *right)
   const int left_inserted = left->inserted;
   const int left_duplicate = left->duplicate;
   const struct bp_target_info left_target_info = left->target_info;
+  const unsigned int left_hash = left->target_conditions_hash;
 
   /* Locations of tracepoints can never be duplicated.  */
   if (is_tracepoint (left->owner))
@@ -10389,9 +10694,11 @@ swap_insertion (struct bp_location *left, struct bp_location *right)
   left->inserted = right->inserted;
   left->duplicate = right->duplicate;
   left->target_info = right->target_info;
+  left->target_conditions_hash = right->target_conditions_hash;
   right->inserted = left_inserted;
   right->duplicate = left_duplicate;
   right->target_info = left_target_info;
+  right->target_conditions_hash = left_hash;
 }
 
 /* If SHOULD_INSERT is false, do not insert any breakpoint locations
@@ -10438,17 +10745,19 @@ update_global_location_list (int should_insert)
   bp_location_count = 0;
   cleanups = make_cleanup (xfree, old_location);
 
+  /* Mark all the current locations.  Zero is not a valid mark;
+     bp_location_merge uses it for the locations it already placed.  */
+  if (++bp_location_list_mark == 0)
+    bp_location_list_mark = 1;
   ALL_BREAKPOINTS (b)
     for (loc = b->loc; loc; loc = loc->next)
-      bp_location_count++;
+      {
+	loc->global_list_mark = bp_location_list_mark;
+	bp_location_count++;
+      }
 
   bp_location = xmalloc (sizeof (*bp_location) * bp_location_count);
-  locp = bp_location;
-  ALL_BREAKPOINTS (b)
-    for (loc = b->loc; loc; loc = loc->next)
-      *locp++ = loc;
-  qsort (bp_location, bp_location_count, sizeof (*bp_location),
-	 bp_location_compare);
+  bp_location_merge (old_location, old_location_count);
 
   bp_location_target_extensions_update ();
 
@@ -10706,6 +11015,9 @@ update_global_location_list (int should_insert)
 			"a permanent breakpoint"));
     }
 
+  if (should_insert)
+    update_inserted_breakpoint_conditions ();
+
   if (breakpoints_always_inserted_mode () && should_insert
       && (have_live_inferiors ()
 	  || (gdbarch_has_global_breakpoints (target_gdbarch))))
@@ -10717,6 +11029,63 @@ update_global_location_list (int should_insert)
   do_cleanups (cleanups);
 }
 
+/* If the target evaluates breakpoint conditions, send again the
+   inserted locations whose set of conditions changed since they were
+   inserted, so that the target has the new set: conditions were
+   edited, or breakpoints at the same address were added, deleted,
+   enabled or disabled.  The target replaces the conditions of a
+   breakpoint inserted again without lifting it, so no hit is missed
+   in the meantime, as could happen in non-stop mode if we removed
+   it first.  */
+
+static void
+update_inserted_breakpoint_conditions (void)
+{
+  struct bp_location **locp, *bl;
+  int removed = 0;
+
+  if (!target_supports_evaluation_of_breakpoint_conditions ())
+    return;
+
+  ALL_BP_LOCATIONS (bl, locp)
+    {
+      VEC(agent_expr_p) *conditions = NULL;
+      struct cleanup *old_chain;
+      hashval_t hash;
+      int val;
+
+      if (!bl->inserted || bl->duplicate
+	  || bl->loc_type != bp_loc_software_breakpoint)
+	continue;
+
+      hash = build_target_condition_list (bl, &conditions);
+      old_chain = make_cleanup (VEC_cleanup (agent_expr_p), &conditions);
+      if (hash == bl->target_conditions_hash)
+	{
+	  do_cleanups (old_chain);
+	  continue;
+	}
+
+      /* The conditions only need to live until the target has them,
+	 like in insert_bp_location.  */
+      bl->target_info.conditions = conditions;
+      val = bl->owner->ops->insert_location (bl);
+      bl->target_info.conditions = NULL;
+      do_cleanups (old_chain);
+
+      if (val == 0)
+	bl->target_conditions_hash = hash;
+      else if (remove_breakpoint (bl, mark_uninserted) == 0)
+	{
+	  /* The target refused the update; start over.  */
+	  removed = 1;
+	}
+    }
+
+  if (removed)
+    insert_breakpoint_locations ();
+}
+
 void
 breakpoint_retire_moribund (void)
 {
@@ -10823,6 +11192,8 @@ static void
 bp_location_dtor (struct bp_location *self)
 {
   xfree (self->cond);
+  if (self->cond_bytecode != NULL)
+    free_agent_expr (self->cond_bytecode);
   xfree (self->function_name);
   xfree (self->source_file);
 }
@@ -14121,6 +14492,24 @@ inferior in all-stop mode, gdb behaves as if always-inserted mode is off."),
 			   &breakpoint_set_cmdlist,
 			   &breakpoint_show_cmdlist);
 
+  add_setshow_enum_cmd ("condition-evaluation", class_breakpoint,
+			condition_evaluation_enums,
+			&condition_evaluation_mode, _("\
+Set mode of breakpoint condition evaluation."), _("\
+Show mode of breakpoint condition evaluation."), _("\
+When this is set to \"host\", breakpoint conditions will be\n\
+evaluated on the host's side by GDB, every time a breakpoint is hit.\n\
+When it is set to \"target\", the conditions of software breakpoints\n\
+are also given to the target, which then only reports the hits where\n\
+a condition is true.  This is much faster, but only works if the\n\
+target supports it and the condition can be compiled to agent\n\
+expression bytecode; otherwise GDB evaluates the condition itself.\n\
+\"auto\" (the default) is the same as \"target\"."),
+			   &set_condition_evaluation_mode,
+			   &show_condition_evaluation_mode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+
   add_com ("break-range", class_breakpoint, break_range_command, _("\
 Set a breakpoint for an address range.\n\
 break-range START-LOCATION, END-LOCATION\n\
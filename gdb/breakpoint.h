@@ -22,6 +22,7 @@
 #include "frame.h"
 #include "value.h"
 #include "vec.h"
+#include "ax.h"
 
 struct value;
 struct block;
@@ -247,6 +248,13 @@ struct bp_target_info
      (e.g. if a remote stub handled the details).  We may still need
      the size to remove the breakpoint safely.  */
   int placed_size;
+
+  /* Conditions the target should evaluate before reporting a hit of
+     this breakpoint, as agent expressions.  The target reports the
+     hit if any of them is true.  Empty if the breakpoint must always
+     be reported.  Only set while the breakpoint is being inserted;
+     the expressions belong to the bp_locations.  */
+  VEC(agent_expr_p) *conditions;
 };
 
 /* GDB maintains two types of information about each breakpoint (or
@@ -313,6 +321,17 @@ struct bp_location
      the owner breakpoint object.  */
   struct expression *cond;
 
+  /* COND compiled to agent expression bytecode, for the target to
+     evaluate, or NULL if the target won't evaluate it: the target
+     can't, "breakpoint condition-evaluation" says not to, or COND
+     can't be compiled.  */
+  struct agent_expr *cond_bytecode;
+
+  /* A hash of the conditions the target was given when this location
+     was inserted, or zero if it was given none.  Used to tell when
+     they need to be given again.  */
+  unsigned int target_conditions_hash;
+
   /* This location's address is in an unloaded solib, and so this
      location should not be inserted.  It will be automatically
      enabled when that solib is loaded.  */
@@ -403,6 +422,11 @@ struct bp_location
   /* Source file name of this address.  */
 
   char *source_file;
+
+  /* Used by update_global_location_list to tell the locations that
+     are new to the global location array from the ones already in
+     it.  */
+  unsigned int global_list_mark;
 };
 
 /* This structure is a collection of function pointers that, if available,
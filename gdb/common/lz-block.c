@@ -0,0 +1,253 @@
+/* Block compression for the remote protocol.
+
+   Copyright (C) 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef GDBSERVER
+#include "server.h"
+#else
+#include "defs.h"
+#endif
+
+#include "lz-block.h"
+
+#include <string.h>
+
+/* Each sequence starts with a token byte.  Its high nibble is the
+   length of the literal run that follows, its low nibble the length
+   of the back-reference minus LZ_MIN_MATCH.  A nibble of 15 means
+   that the length continues in the following bytes, each added to
+   it, up to and including the first byte that is not 255.  The
+   literals come next, then the back-reference offset as two bytes,
+   least significant first.  The last sequence has literals only.  */
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 0xffff
+#define LZ_RUN_MASK 15
+
+/* Number of bits of the hash used to find earlier occurrences of
+   the next LZ_MIN_MATCH bytes.  */
+#define LZ_HASH_BITS 12
+
+static unsigned int
+lz_hash (const gdb_byte *p)
+{
+  unsigned int v = (p[0] | (p[1] << 8) | (p[2] << 16)
+		    | ((unsigned int) p[3] << 24));
+
+  return ((v * 2654435761U) & 0xffffffff) >> (32 - LZ_HASH_BITS);
+}
+
+/* Append the continuation bytes for a run length of LEN (already
+   reduced by LZ_RUN_MASK) at OP.  Returns the new output position, or
+   NULL if OEND would be exceeded.  */
+
+static gdb_byte *
+lz_put_length (gdb_byte *op, gdb_byte *oend, int len)
+{
+  for (; len >= 255; len -= 255)
+    {
+      if (op >= oend)
+	return NULL;
+      *op++ = 255;
+    }
+
+  if (op >= oend)
+    return NULL;
+  *op++ = len;
+  return op;
+}
+
+/* Append a sequence made of the LITLEN literal bytes at LIT followed
+   by a back-reference of MATCHLEN bytes at OFFSET at OP.  A MATCHLEN
+   of zero ends the block.  Returns the new output position, or NULL
+   if OEND would be exceeded.  */
+
+static gdb_byte *
+lz_put_sequence (gdb_byte *op, gdb_byte *oend, const gdb_byte *lit,
+		 int litlen, int offset, int matchlen)
+{
+  gdb_byte *token;
+
+  if (op >= oend)
+    return NULL;
+  token = op++;
+
+  if (litlen >= LZ_RUN_MASK)
+    {
+      *token = LZ_RUN_MASK << 4;
+      op = lz_put_length (op, oend, litlen - LZ_RUN_MASK);
+      if (op == NULL)
+	return NULL;
+    }
+  else
+    *token = litlen << 4;
+
+  if (oend - op < litlen)
+    return NULL;
+  memcpy (op, lit, litlen);
+  op += litlen;
+
+  if (matchlen == 0)
+    return op;
+
+  if (oend - op < 2)
+    return NULL;
+  *op++ = offset & 0xff;
+  *op++ = (offset >> 8) & 0xff;
+
+  matchlen -= LZ_MIN_MATCH;
+  if (matchlen >= LZ_RUN_MASK)
+    {
+      *token |= LZ_RUN_MASK;
+      op = lz_put_length (op, oend, matchlen - LZ_RUN_MASK);
+    }
+  else
+    *token |= matchlen;
+
+  return op;
+}
+
+/* See lz-block.h.  */
+
+int
+lz_block_compress (const gdb_byte *src, int len, gdb_byte *dst, int dst_len)
+{
+  /* Offset in SRC plus one of the last position with a given hash;
+     zero if none.  */
+  int table[1 << LZ_HASH_BITS];
+  const gdb_byte *ip = src;
+  const gdb_byte *anchor = src;
+  const gdb_byte *end = src + len;
+  gdb_byte *op = dst;
+  gdb_byte *oend = dst + dst_len;
+
+  memset (table, 0, sizeof (table));
+
+  while (end - ip >= LZ_MIN_MATCH)
+    {
+      unsigned int h = lz_hash (ip);
+      const gdb_byte *ref = table[h] ? src + table[h] - 1 : NULL;
+
+      table[h] = ip - src + 1;
+
+      if (ref != NULL && ip - ref <= LZ_MAX_OFFSET
+	  && memcmp (ref, ip, LZ_MIN_MATCH) == 0)
+	{
+	  int matchlen = LZ_MIN_MATCH;
+
+	  /* The match may overlap IP; the decoder copies forward one
+	     byte at a time, so that is how runs are encoded.  */
+	  while (ip + matchlen < end && ref[matchlen] == ip[matchlen])
+	    matchlen++;
+
+	  op = lz_put_sequence (op, oend, anchor, ip - anchor,
+				ip - ref, matchlen);
+	  if (op == NULL)
+	    return -1;
+
+	  ip += matchlen;
+	  anchor = ip;
+	}
+      else
+	ip++;
+    }
+
+  op = lz_put_sequence (op, oend, anchor, end - anchor, 0, 0);
+  if (op == NULL)
+    return -1;
+
+  return op - dst;
+}
+
+/* Read the continuation bytes of a run length at *IPP, adding them
+   to *LENP.  Returns 0 on success, -1 if the input ends early or the
+   length exceeds LIMIT.  */
+
+static int
+lz_get_length (const gdb_byte **ipp, const gdb_byte *iend, int *lenp,
+	       int limit)
+{
+  const gdb_byte *ip = *ipp;
+  int b;
+
+  do
+    {
+      if (ip >= iend)
+	return -1;
+      b = *ip++;
+      *lenp += b;
+      if (*lenp > limit)
+	return -1;
+    }
+  while (b == 255);
+
+  *ipp = ip;
+  return 0;
+}
+
+/* See lz-block.h.  */
+
+int
+lz_block_decompress (const gdb_byte *src, int len, gdb_byte *dst, int dst_len)
+{
+  const gdb_byte *ip = src;
+  const gdb_byte *iend = src + len;
+  gdb_byte *op = dst;
+  gdb_byte *oend = dst + dst_len;
+
+  while (ip < iend)
+    {
+      int token = *ip++;
+      int litlen = token >> 4;
+      int matchlen = token & LZ_RUN_MASK;
+      int offset;
+      const gdb_byte *ref;
+
+      if (litlen == LZ_RUN_MASK
+	  && lz_get_length (&ip, iend, &litlen, dst_len) != 0)
+	return -1;
+      if (iend - ip < litlen || oend - op < litlen)
+	return -1;
+      memcpy (op, ip, litlen);
+      ip += litlen;
+      op += litlen;
+
+      /* The last sequence has no back-reference.  */
+      if (ip == iend)
+	break;
+
+      if (iend - ip < 2)
+	return -1;
+      offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (offset == 0 || offset > op - dst)
+	return -1;
+
+      if (matchlen == LZ_RUN_MASK
+	  && lz_get_length (&ip, iend, &matchlen, dst_len) != 0)
+	return -1;
+      matchlen += LZ_MIN_MATCH;
+      if (oend - op < matchlen)
+	return -1;
+
+      for (ref = op - offset; matchlen > 0; matchlen--)
+	*op++ = *ref++;
+    }
+
+  return op - dst;
+}
@@ -0,0 +1,45 @@
+/* Block compression for the remote protocol.
+
+   Copyright (C) 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef LZ_BLOCK_H
+#define LZ_BLOCK_H
+
+/* The codec implemented here produces the LZ4 block format: a
+   sequence of (literal run, back-reference) pairs with 16-bit
+   offsets.  It needs no external library, compresses and
+   decompresses in a single linear pass, and does very well on zero
+   pages and pointer-heavy data.  Both GDB and gdbserver use it for
+   the vReadMemZ packet.  */
+
+/* Compress the LEN bytes at SRC into DST, which has room for DST_LEN
+   bytes.  Returns the size of the compressed data, or -1 if it does
+   not fit in DST.  */
+
+extern int lz_block_compress (const gdb_byte *src, int len,
+			      gdb_byte *dst, int dst_len);
+
+/* Decompress the LEN bytes of compressed data at SRC into DST, which
+   has room for DST_LEN bytes.  Returns the size of the decompressed
+   data, or -1 if SRC is malformed or the result does not fit in
+   DST.  */
+
+extern int lz_block_decompress (const gdb_byte *src, int len,
+				gdb_byte *dst, int dst_len);
+
+#endif /* LZ_BLOCK_H */
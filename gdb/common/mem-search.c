@@ -0,0 +1,268 @@
+/* Searching memory for several patterns at once.
+
+   Copyright (C) 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef GDBSERVER
+#include "server.h"
+#else
+#include "defs.h"
+#endif
+
+#include "mem-search.h"
+#include "gdb_assert.h"
+
+#include <string.h>
+
+/* Memory is read in chunks, the first MEM_SEARCH_MIN_CHUNK bytes
+   long so that a match near the start of the search space is found
+   with a small read, each following one twice as long as the one
+   before, up to MEM_SEARCH_MAX_CHUNK bytes, so that a long search
+   takes few reads.  MEM_SEARCH_MIN_CHUNK is also defined in the
+   gdb.base/find.c testcase.  */
+
+#define MEM_SEARCH_MIN_CHUNK (16 * 1024)
+#define MEM_SEARCH_MAX_CHUNK (1024 * 1024)
+
+void
+mem_search_prepare (struct mem_search *search)
+{
+  int i, j;
+
+  gdb_assert (search->num_patterns > 0);
+
+  if (search->align == 0)
+    search->align = 1;
+
+  search->max_len = 0;
+  for (i = 0; i < search->num_patterns; i++)
+    {
+      struct mem_search_pattern *pattern = &search->patterns[i];
+
+      gdb_assert (pattern->len > 0);
+      if (pattern->len > search->max_len)
+	search->max_len = pattern->len;
+
+      /* Scan for a byte that must match exactly, preferably one that
+	 is neither 0 nor 0xff, as those fill much of memory.  */
+      pattern->anchor = -1;
+      for (j = 0; j < pattern->len; j++)
+	if (pattern->mask == NULL || pattern->mask[j] == 0xff)
+	  {
+	    if (pattern->bytes[j] != 0 && pattern->bytes[j] != 0xff)
+	      {
+		pattern->anchor = j;
+		break;
+	      }
+	    if (pattern->anchor < 0)
+	      pattern->anchor = j;
+	  }
+    }
+}
+
+void
+mem_search_free (struct mem_search *search)
+{
+  int i;
+
+  for (i = 0; i < search->num_patterns; i++)
+    {
+      xfree (search->patterns[i].bytes);
+      xfree (search->patterns[i].mask);
+    }
+  xfree (search->patterns);
+  search->patterns = NULL;
+  search->num_patterns = 0;
+}
+
+int
+mem_search_simple_p (const struct mem_search *search)
+{
+  return (search->num_patterns == 1
+	  && search->patterns[0].mask == NULL
+	  && search->align <= 1);
+}
+
+/* Return non-zero if PATTERN matches the memory at P.  */
+
+static int
+mem_search_match_p (const struct mem_search_pattern *pattern,
+		    const gdb_byte *p)
+{
+  int i;
+
+  if (pattern->mask == NULL)
+    return memcmp (p, pattern->bytes, pattern->len) == 0;
+
+  for (i = 0; i < pattern->len; i++)
+    if (((p[i] ^ pattern->bytes[i]) & pattern->mask[i]) != 0)
+      return 0;
+  return 1;
+}
+
+/* Return the offset in BUF, which holds BUF_LEN bytes of memory read
+   from BUF_ADDR, of the first match of PATTERN that starts at an
+   offset from FROM to SCAN_END - 1 and lies entirely in BUF, or -1
+   if there is none.  */
+
+static long
+mem_search_next (const struct mem_search *search,
+		 const struct mem_search_pattern *pattern,
+		 const gdb_byte *buf, long buf_len, CORE_ADDR buf_addr,
+		 long from, long scan_end)
+{
+  long limit = buf_len - pattern->len + 1;
+  const gdb_byte *p;
+
+  if (limit > scan_end)
+    limit = scan_end;
+  if (from >= limit)
+    return -1;
+
+  if (search->align > 1)
+    {
+      ULONGEST misalign = (buf_addr + from) % search->align;
+
+      if (misalign != 0)
+	{
+	  if (search->align - misalign >= limit - from)
+	    return -1;
+	  from += search->align - misalign;
+	}
+
+      while (1)
+	{
+	  if ((pattern->anchor < 0
+	       || buf[from + pattern->anchor] == pattern->bytes[pattern->anchor])
+	      && mem_search_match_p (pattern, buf + from))
+	    return from;
+	  if (search->align >= limit - from)
+	    return -1;
+	  from += search->align;
+	}
+    }
+
+  if (pattern->anchor < 0)
+    {
+      for (; from < limit; from++)
+	if (mem_search_match_p (pattern, buf + from))
+	  return from;
+      return -1;
+    }
+
+  /* Let memchr, which C libraries implement with wide loads, skip
+     ahead to the next place the anchor byte matches.  */
+  while (from < limit)
+    {
+      p = memchr (buf + from + pattern->anchor,
+		  pattern->bytes[pattern->anchor], limit - from);
+      if (p == NULL)
+	return -1;
+      from = p - buf - pattern->anchor;
+      if (mem_search_match_p (pattern, buf + from))
+	return from;
+      from++;
+    }
+
+  return -1;
+}
+
+int
+mem_search_memory (const struct mem_search *search,
+		   CORE_ADDR start_addr, ULONGEST search_space_len,
+		   mem_search_read_ftype *read_memory,
+		   mem_search_found_ftype *found, void *data,
+		   CORE_ADDR *failed_addrp)
+{
+  gdb_byte *buf;
+  long *next;
+  long chunk = MEM_SEARCH_MIN_CHUNK;
+  long keep = 0;
+  CORE_ADDR read_addr = start_addr;
+  ULONGEST left = search_space_len;
+  ULONGEST count = 0;
+  int result = 0;
+  int i;
+
+  buf = xmalloc (MEM_SEARCH_MAX_CHUNK + search->max_len);
+  next = xmalloc (search->num_patterns * sizeof (long));
+
+  while (left > 0 && result == 0)
+    {
+      long len = left < chunk ? left : chunk;
+      CORE_ADDR buf_addr = read_addr - keep;
+      long buf_len, scan_end;
+
+      if (read_memory (read_addr, buf + keep, len, data) != 0)
+	{
+	  *failed_addrp = read_addr;
+	  result = -1;
+	  break;
+	}
+      read_addr += len;
+      left -= len;
+      buf_len = keep + len;
+
+      /* A match starting in the last MAX_LEN - 1 bytes of the buffer
+	 may not fit in it; those bytes are kept, and searched from
+	 again, with the next chunk.  */
+      keep = 0;
+      if (left > 0)
+	keep = search->max_len - 1 < buf_len ? search->max_len - 1 : buf_len;
+      scan_end = buf_len - keep;
+
+      for (i = 0; i < search->num_patterns; i++)
+	next[i] = mem_search_next (search, &search->patterns[i],
+				   buf, buf_len, buf_addr, 0, scan_end);
+
+      /* Report the matches of all the patterns in address order.  */
+      while (1)
+	{
+	  int best = -1;
+
+	  for (i = 0; i < search->num_patterns; i++)
+	    if (next[i] >= 0 && (best < 0 || next[i] < next[best]))
+	      best = i;
+	  if (best < 0)
+	    break;
+
+	  if (found (buf_addr + next[best], best, data))
+	    {
+	      result = 1;
+	      break;
+	    }
+	  count++;
+	  if (search->max_count != 0 && count >= search->max_count)
+	    {
+	      result = 1;
+	      break;
+	    }
+
+	  next[best] = mem_search_next (search, &search->patterns[best],
+					buf, buf_len, buf_addr,
+					next[best] + 1, scan_end);
+	}
+
+      memmove (buf, buf + scan_end, keep);
+      if (chunk < MEM_SEARCH_MAX_CHUNK)
+	chunk *= 2;
+    }
+
+  xfree (next);
+  xfree (buf);
+  return result;
+}
@@ -0,0 +1,104 @@
+/* Searching memory for several patterns at once.
+
+   Copyright (C) 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef MEM_SEARCH_H
+#define MEM_SEARCH_H
+
+/* A pattern to search memory for.  A byte of memory matches byte I
+   of the pattern if it is equal to BYTES[I] in the bits set in
+   MASK[I]; a zero MASK[I] makes byte I a wildcard.  */
+
+struct mem_search_pattern
+{
+  gdb_byte *bytes;
+
+  /* The mask, or NULL if all the bits of every byte must match.  */
+  gdb_byte *mask;
+
+  int len;
+
+  /* The offset of the byte scanned for first, which must match
+     exactly, or -1 if there is none.  Set by mem_search_prepare.  */
+  int anchor;
+};
+
+/* A search of memory for any of several patterns.  GDB and gdbserver
+   both use it, for the "find" command and the qSearch:memory
+   packets.  */
+
+struct mem_search
+{
+  struct mem_search_pattern *patterns;
+  int num_patterns;
+
+  /* Matches must start at an address that is a multiple of ALIGN.  */
+  ULONGEST align;
+
+  /* Stop after this many matches, if not zero.  */
+  ULONGEST max_count;
+
+  /* The length of the longest pattern.  Set by mem_search_prepare.  */
+  int max_len;
+};
+
+/* Read LEN bytes of memory at ADDR into BUF.  Return zero on success,
+   non-zero if the memory could not be read.  */
+
+typedef int (mem_search_read_ftype) (CORE_ADDR addr, gdb_byte *buf,
+				     ULONGEST len, void *data);
+
+/* Called for each match, of pattern number PATTERN at ADDR.  Return
+   non-zero to stop the search.  */
+
+typedef int (mem_search_found_ftype) (CORE_ADDR addr, int pattern,
+				      void *data);
+
+/* Choose the anchors of the patterns of SEARCH, and compute its
+   longest pattern length.  Call this before mem_search_memory, once
+   the patterns are filled in.  */
+
+extern void mem_search_prepare (struct mem_search *search);
+
+/* Free the patterns of SEARCH.  */
+
+extern void mem_search_free (struct mem_search *search);
+
+/* Return non-zero if SEARCH is for a single pattern without a mask or
+   alignment, as the qSearch:memory packet and the to_search_memory
+   target method are.  */
+
+extern int mem_search_simple_p (const struct mem_search *search);
+
+/* Search SEARCH_SPACE_LEN bytes of memory starting at START_ADDR,
+   read with READ_MEMORY, for the patterns of SEARCH.  Call FOUND for
+   each match, in address order; matches at the same address are
+   reported in pattern order.
+
+   Return 1 if FOUND stopped the search or SEARCH->max_count matches
+   were found, 0 if the search space was exhausted, and -1 if some
+   memory could not be read, setting *FAILED_ADDRP to its address.  */
+
+extern int mem_search_memory (const struct mem_search *search,
+			      CORE_ADDR start_addr,
+			      ULONGEST search_space_len,
+			      mem_search_read_ftype *read_memory,
+			      mem_search_found_ftype *found, void *data,
+			      CORE_ADDR *failed_addrp);
+
+#endif /* MEM_SEARCH_H */
@@ -48,6 +48,13 @@
 #include "objfiles.h"
 #include "wrapper.h"
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *) -1)
+#endif
+#endif
+
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -77,6 +84,30 @@ struct gdbarch *core_gdbarch = NULL;
    unix child targets.  */
 static struct target_section_table *core_data;
 
+/* The sections of CORE_DATA, sorted by address, so that memory reads
+   don't have to go through the whole section table.  Built when
+   first needed.  If some sections overlap, CORE_SECTIONS_OVERLAP is
+   set and the section table is searched in order instead, since the
+   first section of the table that holds an address has to win.
+   CORE_SORTED_SECTIONS_END is the end of the section table when the
+   sections were sorted.  */
+static struct target_section **core_sorted_sections;
+static int core_num_sorted_sections;
+static struct target_section *core_sorted_sections_end;
+static int core_sections_overlap;
+
+#ifdef HAVE_MMAP
+/* The core file, mapped in memory when its memory is first read, so
+   that the contents of its sections can be copied from there rather
+   than read through BFD.  CORE_MAP is NULL if the file could not be
+   mapped.  */
+static int core_map_tried;
+static gdb_byte *core_map;
+static file_ptr core_map_size;
+static void *core_map_addr;
+static bfd_size_type core_map_len;
+#endif
+
 /* True if we needed to fake the pid of the loaded core inferior.  */
 static int core_has_fake_pid = 0;
 
@@ -222,6 +253,16 @@ core_close (int quitting)
       xfree (core_data->sections);
       xfree (core_data);
       core_data = NULL;
+      xfree (core_sorted_sections);
+      core_sorted_sections = NULL;
+      core_num_sorted_sections = 0;
+      core_sorted_sections_end = NULL;
+#ifdef HAVE_MMAP
+      if (core_map != NULL)
+	munmap (core_map_addr, core_map_len);
+      core_map = NULL;
+      core_map_tried = 0;
+#endif
       core_has_fake_pid = 0;
 
       name = bfd_get_filename (core_bfd);
@@ -657,6 +698,175 @@ add_to_spuid_list (bfd *abfd, asection *asect, void *list_p)
   list->pos += 4;
 }
 
+/* qsort comparison function for core_sorted_sections: by address,
+   then by position in the section table.  */
+
+static int
+compare_core_sections (const void *ap, const void *bp)
+{
+  const struct target_section *a = *(const struct target_section **) ap;
+  const struct target_section *b = *(const struct target_section **) bp;
+
+  if (a->addr != b->addr)
+    return a->addr < b->addr ? -1 : 1;
+  if (a != b)
+    return a < b ? -1 : 1;
+  return 0;
+}
+
+/* Sort the sections of CORE_DATA into core_sorted_sections.  */
+
+static void
+sort_core_sections (void)
+{
+  struct target_section *p;
+  int count, i;
+
+  xfree (core_sorted_sections);
+  core_sorted_sections
+    = XNEWVEC (struct target_section *,
+	       core_data->sections_end - core_data->sections);
+
+  /* Empty sections hold no address, and would only get in the way of
+     a section that starts at the same address.  */
+  count = 0;
+  for (p = core_data->sections; p < core_data->sections_end; p++)
+    if (p->addr < p->endaddr)
+      core_sorted_sections[count++] = p;
+  qsort (core_sorted_sections, count, sizeof (*core_sorted_sections),
+	 compare_core_sections);
+  core_num_sorted_sections = count;
+  core_sorted_sections_end = core_data->sections_end;
+
+  core_sections_overlap = 0;
+  for (i = 1; i < count; i++)
+    if (core_sorted_sections[i]->addr < core_sorted_sections[i - 1]->endaddr)
+      core_sections_overlap = 1;
+}
+
+/* Return the section of CORE_DATA that holds ADDR, or NULL if ADDR is
+   in none of them.  */
+
+static struct target_section *
+core_section_containing (CORE_ADDR addr)
+{
+  int lo = 0, hi = core_num_sorted_sections;
+
+  /* Find the last section that starts at or before ADDR.  */
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (core_sorted_sections[mid]->addr <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo > 0 && addr < core_sorted_sections[lo - 1]->endaddr)
+    return core_sorted_sections[lo - 1];
+  return NULL;
+}
+
+/* Return a pointer to the contents of section P of the core file in
+   memory, or NULL if they have to be read through BFD.  */
+
+static const gdb_byte *
+core_section_contents (struct target_section *p)
+{
+#ifdef HAVE_MMAP
+  asection *sect = p->the_bfd_section;
+
+  if (!core_map_tried)
+    {
+      core_map_tried = 1;
+
+      /* A core file opened for writing is written through BFD, which
+	 the mapping would not see.  */
+      if (core_bfd->direction == read_direction)
+	{
+	  file_ptr size = bfd_get_size (core_bfd);
+	  void *map_addr;
+	  bfd_size_type map_len;
+	  void *map;
+
+	  if (size > 0 && (size_t) size == size)
+	    {
+	      map = bfd_mmap (core_bfd, 0, size, PROT_READ, MAP_PRIVATE, 0,
+			      &map_addr, &map_len);
+	      if (map != MAP_FAILED)
+		{
+		  core_map = map;
+		  core_map_size = size;
+		  core_map_addr = map_addr;
+		  core_map_len = map_len;
+		}
+	    }
+	}
+    }
+
+  /* Sections without contents read as zeroes, and the contents of a
+     truncated core file may not all be there; leave those to BFD.  */
+  if (core_map != NULL
+      && (sect->flags & SEC_HAS_CONTENTS) != 0
+      && (sect->flags & SEC_IN_MEMORY) == 0
+      && sect->filepos >= 0
+      && sect->filepos + bfd_section_size (core_bfd, sect) <= core_map_size)
+    return core_map + sect->filepos;
+#endif
+
+  return NULL;
+}
+
+/* Transfer LEN bytes of memory at OFFSET between the core file and
+   READBUF or WRITEBUF, like section_table_xfer_memory_partial.  */
+
+static LONGEST
+core_xfer_memory_partial (gdb_byte *readbuf, const gdb_byte *writebuf,
+			  ULONGEST offset, LONGEST len)
+{
+  struct target_section *p;
+  const gdb_byte *contents;
+  int res;
+
+  if (core_sorted_sections == NULL
+      || core_sorted_sections_end != core_data->sections_end)
+    sort_core_sections ();
+
+  if (core_sections_overlap)
+    return section_table_xfer_memory_partial (readbuf, writebuf,
+					      offset, len,
+					      core_data->sections,
+					      core_data->sections_end,
+					      NULL);
+
+  p = core_section_containing (offset);
+  if (p == NULL)
+    return 0;
+
+  /* Transfer up to the end of the section only.  */
+  if (offset + len > p->endaddr)
+    len = p->endaddr - offset;
+
+  if (writebuf)
+    res = bfd_set_section_contents (p->bfd, p->the_bfd_section,
+				    writebuf, offset - p->addr, len);
+  else
+    {
+      contents = core_section_contents (p);
+      if (contents != NULL)
+	{
+	  memcpy (readbuf, contents + (offset - p->addr), len);
+	  return len;
+	}
+
+      res = bfd_get_section_contents (p->bfd, p->the_bfd_section,
+				      readbuf, offset - p->addr, len);
+    }
+
+  return (res != 0) ? len : 0;
+}
+
 static LONGEST
 core_xfer_partial (struct target_ops *ops, enum target_object object,
 		   const char *annex, gdb_byte *readbuf,
@@ -666,11 +876,7 @@ core_xfer_partial (struct target_ops *ops, enum target_object object,
   switch (object)
     {
     case TARGET_OBJECT_MEMORY:
-      return section_table_xfer_memory_partial (readbuf, writebuf,
-						offset, len,
-						core_data->sections,
-						core_data->sections_end,
-						NULL);
+      return core_xfer_memory_partial (readbuf, writebuf, offset, len);
 
     case TARGET_OBJECT_AUXV:
       if (readbuf)
@@ -26,6 +26,7 @@
 #include "target.h"
 #include "inferior.h"
 #include "splay-tree.h"
+#include "breakpoint.h"
 
 /* Commands with a prefix of `{set,show} dcache'.  */
 static struct cmd_list_element *dcache_set_list = NULL;
@@ -84,6 +85,22 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The code cache holds the contents of read-only code sections, with
+   the shadows of inserted breakpoints in place of their instructions.
+   Code is mostly read a few bytes at a time, in ascending order, by
+   prologue analyzers and disassemblers, so its lines are larger than
+   those of the data cache, and on a miss, up to CODE_CACHE_READ_AHEAD
+   lines are read at once.  As code doesn't change while the program
+   runs, the code cache is kept across resumptions.  */
+#define CODE_CACHE_DEFAULT_SIZE 1024
+static unsigned code_cache_size = CODE_CACHE_DEFAULT_SIZE;
+
+#define CODE_CACHE_DEFAULT_LINE_SIZE 512
+static unsigned code_cache_line_size = CODE_CACHE_DEFAULT_LINE_SIZE;
+
+#define CODE_CACHE_DEFAULT_READ_AHEAD 8
+static unsigned code_cache_read_ahead = CODE_CACHE_DEFAULT_READ_AHEAD;
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -115,8 +132,20 @@ struct dcache_struct
   int size;
   CORE_ADDR line_size;  /* current line_size.  */
 
-  /* The ptid of last inferior to use cache or null_ptid.  */
+  /* The ptid of last inferior to use cache or null_ptid.  For a code
+     cache, only the process matters.  */
   ptid_t ptid;
+
+  /* Non-zero if this is a code cache.  */
+  int code;
+
+  /* Statistics of a code cache: the number of reads, how many of them
+     missed, and the target reads done to fill lines, of BYTES_READ
+     bytes in all.  */
+  unsigned long reads;
+  unsigned long misses;
+  unsigned long target_reads;
+  ULONGEST bytes_read;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
@@ -129,6 +158,8 @@ static struct dcache_block *dcache_alloc (DCACHE *dcache, CORE_ADDR addr);
 
 static void dcache_info (char *exp, int tty);
 
+static void code_cache_info (char *exp, int tty);
+
 void _initialize_dcache (void);
 
 static int dcache_enabled_p = 0; /* OBSOLETE */
@@ -141,6 +172,7 @@ show_dcache_enabled_p (struct ui_file *file, int from_tty,
 }
 
 static DCACHE *last_cache; /* Used by info dcache.  */
+static DCACHE *last_code_cache; /* Used by info code-cache.  */
 
 /* Add BLOCK to circular block list BLIST, behind the block at *BLIST.
    *BLIST is not updated (unless it was previously NULL of course).
@@ -228,6 +260,8 @@ dcache_free (DCACHE *dcache)
 {
   if (last_cache == dcache)
     last_cache = NULL;
+  if (last_code_cache == dcache)
+    last_code_cache = NULL;
 
   splay_tree_delete (dcache->tree);
   for_each_block (&dcache->oldest, free_block, NULL);
@@ -254,20 +288,44 @@ invalidate_block (struct dcache_block *block, void *param)
 void
 dcache_invalidate (DCACHE *dcache)
 {
+  unsigned line_size = dcache->code ? code_cache_line_size : dcache_line_size;
+
   for_each_block (&dcache->oldest, invalidate_block, dcache);
 
   dcache->oldest = NULL;
   dcache->size = 0;
   dcache->ptid = null_ptid;
 
-  if (dcache->line_size != dcache_line_size)
+  if (dcache->line_size != line_size)
     {
       /* We've been asked to use a different line size.
 	 All of our freelist blocks are now the wrong size, so free them.  */
 
       for_each_block (&dcache->freelist, free_block, dcache);
       dcache->freelist = NULL;
-      dcache->line_size = dcache_line_size;
+      dcache->line_size = line_size;
+    }
+}
+
+/* If DCACHE holds the memory of another inferior than the current
+   one, flush it.  */
+
+static void
+dcache_check_ptid (DCACHE *dcache)
+{
+  if (dcache->code)
+    {
+      /* All the threads of a process share its code.  */
+      if (ptid_get_pid (inferior_ptid) != ptid_get_pid (dcache->ptid))
+	{
+	  dcache_invalidate (dcache);
+	  dcache->ptid = pid_to_ptid (ptid_get_pid (inferior_ptid));
+	}
+    }
+  else if (! ptid_equal (inferior_ptid, dcache->ptid))
+    {
+      dcache_invalidate (dcache);
+      dcache->ptid = inferior_ptid;
     }
 }
 
@@ -306,24 +364,17 @@ dcache_hit (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
-/* Fill a cache line from target memory.
-   The result is 1 for success, 0 if the (entire) cache line
-   wasn't readable.  */
+/* Read LEN bytes of target memory at MEMADDR into MYADDR, for
+   filling cache lines.  The result is 1 for success, 0 if the
+   (entire) memory wasn't readable.  */
 
 static int
-dcache_read_line (DCACHE *dcache, struct dcache_block *db)
+dcache_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
 {
-  CORE_ADDR memaddr;
-  gdb_byte *myaddr;
-  int len;
   int res;
   int reg_len;
   struct mem_region *region;
 
-  len = dcache->line_size;
-  memaddr = db->addr;
-  myaddr  = db->data;
-
   while (len > 0)
     {
       /* Don't overrun if this block is right at the end of the region.  */
@@ -356,6 +407,16 @@ dcache_read_line (DCACHE *dcache, struct dcache_block *db)
   return 1;
 }
 
+/* Fill a cache line from target memory.
+   The result is 1 for success, 0 if the (entire) cache line
+   wasn't readable.  */
+
+static int
+dcache_read_line (DCACHE *dcache, struct dcache_block *db)
+{
+  return dcache_read_memory (db->addr, db->data, dcache->line_size);
+}
+
 /* Get a free cache block, put or keep it on the valid list,
    and return its address.  */
 
@@ -363,8 +424,9 @@ static struct dcache_block *
 dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 {
   struct dcache_block *db;
+  unsigned max_size = dcache->code ? code_cache_size : dcache_size;
 
-  if (dcache->size >= dcache_size)
+  if (dcache->size >= max_size)
     {
       /* Evict the least recently allocated line.  */
       db = dcache->oldest;
@@ -451,10 +513,10 @@ dcache_splay_tree_compare (splay_tree_key a, splay_tree_key b)
     return -1;
 }
 
-/* Allocate and initialize a data cache.  */
+/* Allocate and initialize a cache, a code cache if CODE is non-zero.  */
 
-DCACHE *
-dcache_init (void)
+static DCACHE *
+dcache_init_1 (int code)
 {
   DCACHE *dcache;
 
@@ -467,13 +529,35 @@ dcache_init (void)
   dcache->oldest = NULL;
   dcache->freelist = NULL;
   dcache->size = 0;
-  dcache->line_size = dcache_line_size;
+  dcache->line_size = code ? code_cache_line_size : dcache_line_size;
   dcache->ptid = null_ptid;
-  last_cache = dcache;
+  dcache->code = code;
+  dcache->reads = 0;
+  dcache->misses = 0;
+  dcache->target_reads = 0;
+  dcache->bytes_read = 0;
 
   return dcache;
 }
 
+/* Allocate and initialize a data cache.  */
+
+DCACHE *
+dcache_init (void)
+{
+  last_cache = dcache_init_1 (0);
+  return last_cache;
+}
+
+/* Allocate and initialize a code cache.  */
+
+DCACHE *
+dcache_init_code (void)
+{
+  last_code_cache = dcache_init_1 (1);
+  return last_code_cache;
+}
+
 
 /* Read or write LEN bytes from inferior memory at MEMADDR, transferring
    to or from debugger address MYADDR.  Write to inferior if SHOULD_WRITE is
@@ -499,11 +583,7 @@ dcache_xfer_memory (struct target_ops *ops, DCACHE *dcache,
   /* If this is a different inferior from what we've recorded,
      flush the cache.  */
 
-  if (! ptid_equal (inferior_ptid, dcache->ptid))
-    {
-      dcache_invalidate (dcache);
-      dcache->ptid = inferior_ptid;
-    }
+  dcache_check_ptid (dcache);
 
   /* Do write-through first, so that if it fails, we don't write to
      the cache at all.  */
@@ -554,30 +634,135 @@ dcache_update (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr, int len)
 {
   int i;
 
+  /* A write to another process doesn't change the code cached.  */
+  if (dcache->code
+      && ptid_get_pid (inferior_ptid) != ptid_get_pid (dcache->ptid))
+    return;
+
   for (i = 0; i < len; i++)
     dcache_poke_byte (dcache, memaddr + i, myaddr + i);
 }
 
+/* Fill the line of code cache DCACHE at ADDR, which isn't in the
+   cache, reading ahead the following lines that aren't in the cache
+   either and start below LIMIT, with a single target read.  Return the
+   line at ADDR, or NULL if it couldn't be read.  */
+
+static struct dcache_block *
+dcache_read_ahead (DCACHE *dcache, CORE_ADDR addr, CORE_ADDR limit)
+{
+  CORE_ADDR start = MASK (dcache, addr);
+  CORE_ADDR next;
+  struct dcache_block *db = NULL;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  int count = 1;
+  int i;
+
+  for (next = start + dcache->line_size;
+       (count < code_cache_read_ahead
+	&& count < code_cache_size
+	&& next > start && next < limit
+	&& splay_tree_lookup (dcache->tree, (splay_tree_key) next) == NULL);
+       next += dcache->line_size)
+    count++;
+
+  buf = xmalloc (count * dcache->line_size);
+  old_chain = make_cleanup (xfree, buf);
+
+  dcache->target_reads++;
+  if (!dcache_read_memory (start, buf, count * dcache->line_size))
+    {
+      /* The lines read ahead may not all be readable; try again with
+	 just the one needed.  */
+      if (count == 1)
+	{
+	  do_cleanups (old_chain);
+	  return NULL;
+	}
+      count = 1;
+      dcache->target_reads++;
+      if (!dcache_read_memory (start, buf, dcache->line_size))
+	{
+	  do_cleanups (old_chain);
+	  return NULL;
+	}
+    }
+  dcache->bytes_read += count * dcache->line_size;
+
+  /* Keep breakpoint instructions out of the cache: it holds the code
+     as it is without them, so that it needn't change when they are
+     inserted or removed.  */
+  breakpoint_xfer_memory (buf, NULL, NULL, start, count * dcache->line_size);
+
+  /* Allocate the line at ADDR last, so that it is evicted last.  */
+  for (i = count - 1; i >= 0; i--)
+    {
+      db = dcache_alloc (dcache, start + i * dcache->line_size);
+      memcpy (db->data, buf + i * dcache->line_size, dcache->line_size);
+    }
+
+  do_cleanups (old_chain);
+  return db;
+}
+
+/* Read LEN bytes of code at MEMADDR through code cache DCACHE into
+   MYADDR.  Lines are read ahead up to LIMIT, the end of the code
+   section holding MEMADDR.  Return the number of bytes read, which is
+   less than LEN if some memory couldn't be read.  */
+
+int
+dcache_read_code (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
+		  int len, CORE_ADDR limit)
+{
+  int done = 0;
+  int missed = 0;
+
+  dcache_check_ptid (dcache);
+  dcache->reads++;
+
+  while (done < len)
+    {
+      CORE_ADDR addr = memaddr + done;
+      struct dcache_block *db = dcache_hit (dcache, addr);
+      int n;
+
+      if (db == NULL)
+	{
+	  missed = 1;
+	  db = dcache_read_ahead (dcache, addr, limit);
+	  if (db == NULL)
+	    break;
+	}
+
+      n = dcache->line_size - XFORM (dcache, addr);
+      if (n > len - done)
+	n = len - done;
+      memcpy (myaddr + done, db->data + XFORM (dcache, addr), n);
+      done += n;
+    }
+
+  if (missed)
+    dcache->misses++;
+  return done;
+}
+
+/* Print line number INDEX of DCACHE, with its contents.  */
+
 static void
-dcache_print_line (int index)
+dcache_print_line (DCACHE *dcache, int index)
 {
   splay_tree_node n;
   struct dcache_block *db;
   int i, j;
 
-  if (!last_cache)
-    {
-      printf_filtered (_("No data cache available.\n"));
-      return;
-    }
-
-  n = splay_tree_min (last_cache->tree);
+  n = splay_tree_min (dcache->tree);
 
   for (i = index; i > 0; --i)
     {
       if (!n)
 	break;
-      n = splay_tree_successor (last_cache->tree, n->key);
+      n = splay_tree_successor (dcache->tree, n->key);
     }
 
   if (!n)
@@ -591,35 +776,79 @@ dcache_print_line (int index)
   printf_filtered (_("Line %d: address %s [%d hits]\n"),
 		   index, paddress (target_gdbarch, db->addr), db->refs);
 
-  for (j = 0; j < last_cache->line_size; j++)
+  for (j = 0; j < dcache->line_size; j++)
     {
       printf_filtered ("%02x ", db->data[j]);
 
       /* Print a newline every 16 bytes (48 characters).  */
-      if ((j % 16 == 15) && (j != last_cache->line_size - 1))
+      if ((j % 16 == 15) && (j != dcache->line_size - 1))
 	printf_filtered ("\n");
     }
   printf_filtered ("\n");
 }
 
+/* Print a summary of each line of DCACHE.  */
+
 static void
-dcache_info (char *exp, int tty)
+dcache_print_lines (DCACHE *dcache)
 {
   splay_tree_node n;
   int i, refcount;
 
+  refcount = 0;
+
+  n = splay_tree_min (dcache->tree);
+  i = 0;
+
+  while (n)
+    {
+      struct dcache_block *db = (struct dcache_block *) n->value;
+
+      printf_filtered (_("Line %d: address %s [%d hits]\n"),
+		       i, paddress (target_gdbarch, db->addr), db->refs);
+      i++;
+      refcount += db->refs;
+
+      n = splay_tree_successor (dcache->tree, n->key);
+    }
+
+  printf_filtered (_("Cache state: %d active lines, %d hits\n"), i, refcount);
+}
+
+/* Parse the line number argument EXP of "info dcache" or "info
+   code-cache", COMMAND.  Return the line number, or -1 after printing
+   a usage message if EXP is invalid.  */
+
+static int
+dcache_parse_line_number (char *exp, const char *command)
+{
+  char *linestart;
+  int i;
+
+  i = strtol (exp, &linestart, 10);
+  if (linestart == exp || i < 0)
+    {
+      printf_filtered (_("Usage: info %s [linenumber]\n"), command);
+      return -1;
+    }
+
+  return i;
+}
+
+static void
+dcache_info (char *exp, int tty)
+{
   if (exp)
     {
-      char *linestart;
+      int i = dcache_parse_line_number (exp, "dcache");
 
-      i = strtol (exp, &linestart, 10);
-      if (linestart == exp || i < 0)
-	{
-	  printf_filtered (_("Usage: info dcache [linenumber]\n"));
-          return;
-	}
+      if (i < 0)
+	return;
 
-      dcache_print_line (i);
+      if (!last_cache)
+	printf_filtered (_("No data cache available.\n"));
+      else
+	dcache_print_line (last_cache, i);
       return;
     }
 
@@ -637,24 +866,55 @@ dcache_info (char *exp, int tty)
   printf_filtered (_("Contains data for %s\n"),
 		   target_pid_to_str (last_cache->ptid));
 
-  refcount = 0;
+  dcache_print_lines (last_cache);
+}
 
-  n = splay_tree_min (last_cache->tree);
-  i = 0;
+static void
+code_cache_info (char *exp, int tty)
+{
+  if (exp)
+    {
+      int i = dcache_parse_line_number (exp, "code-cache");
 
-  while (n)
+      if (i < 0)
+	return;
+
+      if (!last_code_cache)
+	printf_filtered (_("No code cache available.\n"));
+      else
+	dcache_print_line (last_code_cache, i);
+      return;
+    }
+
+  printf_filtered (_("Code cache %u lines of %u bytes each, "
+		     "reading ahead %u lines.\n"),
+		   code_cache_size,
+		   last_code_cache ? (unsigned) last_code_cache->line_size
+		   : code_cache_line_size,
+		   code_cache_read_ahead);
+
+  if (!last_code_cache)
     {
-      struct dcache_block *db = (struct dcache_block *) n->value;
+      printf_filtered (_("No code cache available.\n"));
+      return;
+    }
 
-      printf_filtered (_("Line %d: address %s [%d hits]\n"),
-		       i, paddress (target_gdbarch, db->addr), db->refs);
-      i++;
-      refcount += db->refs;
+  printf_filtered (_("%lu reads, %lu missed; "
+		     "%lu target reads of %s bytes\n"),
+		   last_code_cache->reads, last_code_cache->misses,
+		   last_code_cache->target_reads,
+		   pulongest (last_code_cache->bytes_read));
 
-      n = splay_tree_successor (last_cache->tree, n->key);
+  if (ptid_equal (last_code_cache->ptid, null_ptid))
+    {
+      printf_filtered (_("The code cache is empty.\n"));
+      return;
     }
 
-  printf_filtered (_("Cache state: %d active lines, %d hits\n"), i, refcount);
+  printf_filtered (_("Contains code of %s\n"),
+		   target_pid_to_str (last_code_cache->ptid));
+
+  dcache_print_lines (last_code_cache);
 }
 
 static void
@@ -685,6 +945,45 @@ set_dcache_line_size (char *args, int from_tty,
     dcache_invalidate (last_cache);
 }
 
+static void
+set_code_cache_size (char *args, int from_tty,
+		     struct cmd_list_element *c)
+{
+  if (code_cache_size == 0)
+    {
+      code_cache_size = CODE_CACHE_DEFAULT_SIZE;
+      error (_("Code cache size must be greater than 0."));
+    }
+  if (last_code_cache)
+    dcache_invalidate (last_code_cache);
+}
+
+static void
+set_code_cache_line_size (char *args, int from_tty,
+			  struct cmd_list_element *c)
+{
+  if (code_cache_line_size < 2
+      || (code_cache_line_size & (code_cache_line_size - 1)) != 0)
+    {
+      unsigned d = code_cache_line_size;
+      code_cache_line_size = CODE_CACHE_DEFAULT_LINE_SIZE;
+      error (_("Invalid code cache line size: %u (must be power of 2)."), d);
+    }
+  if (last_code_cache)
+    dcache_invalidate (last_code_cache);
+}
+
+static void
+set_code_cache_read_ahead (char *args, int from_tty,
+			   struct cmd_list_element *c)
+{
+  if (code_cache_read_ahead == 0)
+    {
+      code_cache_read_ahead = CODE_CACHE_DEFAULT_READ_AHEAD;
+      error (_("Code cache read-ahead must be greater than 0."));
+    }
+}
+
 static void
 set_dcache_command (char *arg, int from_tty)
 {
@@ -744,4 +1043,38 @@ Show number of dcache lines."),
 			    set_dcache_size,
 			    NULL,
 			    &dcache_set_list, &dcache_show_list);
+
+  add_info ("code-cache", code_cache_info,
+	    _("\
+Print information on the code cache performance.\n\
+With no arguments, this command prints the cache configuration and\n\
+statistics, and a summary of each line in the cache.  Use\n\
+\"info code-cache <lineno>\" to dump the contents of a given line."));
+
+  add_setshow_uinteger_cmd ("code-line-size", class_obscure,
+			    &code_cache_line_size, _("\
+Set code cache line size in bytes (must be power of 2)."), _("\
+Show code cache line size."),
+			    NULL,
+			    set_code_cache_line_size,
+			    NULL,
+			    &dcache_set_list, &dcache_show_list);
+  add_setshow_uinteger_cmd ("code-size", class_obscure,
+			    &code_cache_size, _("\
+Set number of code cache lines."), _("\
+Show number of code cache lines."),
+			    NULL,
+			    set_code_cache_size,
+			    NULL,
+			    &dcache_set_list, &dcache_show_list);
+  add_setshow_uinteger_cmd ("code-read-ahead", class_obscure,
+			    &code_cache_read_ahead, _("\
+Set number of code cache lines read at once."), _("\
+Show number of code cache lines read at once."),
+			    _("\
+When code is read that isn't in the code cache, the following lines\n\
+of the same section are read with it, up to this many lines in all."),
+			    set_code_cache_read_ahead,
+			    NULL,
+			    &dcache_set_list, &dcache_show_list);
 }
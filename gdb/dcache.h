@@ -30,6 +30,9 @@ void dcache_invalidate (DCACHE *dcache);
 /* Initialize DCACHE.  */
 DCACHE *dcache_init (void);
 
+/* Initialize a code cache.  */
+DCACHE *dcache_init_code (void);
+
 /* Free a DCACHE.  */
 void dcache_free (DCACHE *);
 
@@ -41,4 +44,7 @@ int dcache_xfer_memory (struct target_ops *ops, DCACHE *cache, CORE_ADDR mem,
 void dcache_update (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
 		    int len);
 
+int dcache_read_code (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
+		      int len, CORE_ADDR limit);
+
 #endif /* DCACHE_H */
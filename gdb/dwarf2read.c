@@ -56,15 +56,22 @@
 #include "vec.h"
 #include "c-lang.h"
 #include "valprint.h"
+#include "elf-bfd.h"
+#include "gdb_dirent.h"
 #include <ctype.h>
 
 #include <fcntl.h>
 #include "gdb_string.h"
 #include "gdb_assert.h"
 #include <sys/types.h>
+#include <utime.h>
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_PTHREAD_CREATE)
+#include <pthread.h>
+#define DWARF2_WORKER_THREADS 1
+#endif
 #ifdef HAVE_MMAP
 #include <sys/mman.h>
 #ifndef MAP_FAILED
@@ -240,6 +247,19 @@ struct dwarf2_per_objfile
      symbols.  */
   int reading_partial_symbols;
 
+  /* The name of the file in the index cache that the index of this
+     objfile should be written to once its partial symbols have been
+     read, or NULL.  See index_cache_lookup.  */
+  char *index_cache_file;
+
+  /* The names listed in the objfile's pubnames and pubtypes sections,
+     by their last component, or NULL if it has no such pair of
+     sections.  See dwarf2_may_define_name.  */
+  htab_t pub_names;
+
+  /* Non-zero once PUB_NAMES has been computed.  */
+  unsigned char pub_names_read;
+
   /* Table mapping type .debug_info DIE offsets to types.
      This is NULL if not allocated yet.
      It (currently) makes sense to allocate debug_types_type_hash lazily.
@@ -824,6 +844,18 @@ show_dwarf2_max_cache_age (struct ui_file *file, int from_tty,
 		    value);
 }
 
+/* The number of threads used to decompress compressed sections.
+   Zero means that everything is done by the main thread.  */
+static unsigned int dwarf2_worker_threads = 0;
+static void
+show_dwarf2_worker_threads (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The number of DWARF 2 worker threads "
+			    "is %s.\n"),
+		    value);
+}
+
 
 /* Various complaints about symbol reading that don't abort the process.  */
 
@@ -933,6 +965,21 @@ static void psymtab_to_symtab_1 (struct partial_symtab *);
 
 static void dwarf2_read_abbrevs (bfd *abfd, struct dwarf2_cu *cu);
 
+static int index_cache_lookup (struct objfile *objfile);
+
+static char *index_cache_section_file_name (struct objfile *objfile,
+					    asection *sectp);
+
+static int index_cache_lookup_section (struct objfile *objfile,
+				       struct dwarf2_section_info *info,
+				       bfd_size_type size);
+
+static void index_cache_store_section (const char *filename,
+				       const gdb_byte *buf,
+				       bfd_size_type size);
+
+static void index_cache_store_objfile (struct objfile *objfile);
+
 static void dwarf2_free_abbrev_table (void *);
 
 static unsigned int peek_abbrev_code (bfd *, gdb_byte *);
@@ -1399,6 +1446,147 @@ dwarf2_has_info (struct objfile *objfile,
 	  && dwarf2_per_objfile->abbrev.asection != NULL);
 }
 
+/* Return the last component of the C++ qualified name NAME: the part
+   after its last "::" that is not within template arguments or a
+   parameter list.  */
+
+static const char *
+pub_name_last_component (const char *name)
+{
+  const char *p, *last = name;
+  int depth = 0;
+
+  for (p = name; *p != '\0'; p++)
+    {
+      if (*p == '<' || *p == '(')
+	depth++;
+      else if ((*p == '>' || *p == ')') && depth > 0)
+	depth--;
+      else if (depth == 0 && p[0] == ':' && p[1] == ':')
+	{
+	  last = p + 2;
+	  p++;
+	}
+    }
+
+  return last;
+}
+
+/* Add the names in the pubnames-style section SECTNAME of OBJFILE to
+   NAMES, by their last component.  GNU_STYLE is non-zero for the
+   .debug_gnu_pub* sections, whose entries have an extra flag byte.
+   Return zero if the section is missing or malformed.  */
+
+static int
+dwarf2_read_pub_names (struct objfile *objfile, htab_t names,
+		       const char *sectname, int gnu_style)
+{
+  bfd *abfd = objfile->obfd;
+  asection *sectp = bfd_get_section_by_name (abfd, sectname);
+  bfd_size_type size;
+  gdb_byte *buf, *p, *end;
+
+  if (sectp == NULL)
+    return 0;
+
+  /* NAMES points into the section contents, so keep them.  */
+  size = bfd_get_section_size (sectp);
+  buf = obstack_alloc (&objfile->objfile_obstack, size);
+  if (!bfd_get_section_contents (abfd, sectp, buf, 0, size))
+    return 0;
+
+  p = buf;
+  end = buf + size;
+  while (p < end)
+    {
+      unsigned int bytes_read, offset_size;
+      LONGEST length;
+      gdb_byte *set_end;
+
+      if (end - p < 4 || (read_4_bytes (abfd, p) == 0xffffffff
+			  && end - p < 12))
+	return 0;
+      length = read_initial_length (abfd, p, &bytes_read);
+      offset_size = bytes_read == 4 ? 4 : 8;
+      p += bytes_read;
+      if (length < 2 + 2 * offset_size || length > end - p)
+	return 0;
+      set_end = p + length;
+
+      /* Skip the version and the .debug_info offset and length.  */
+      p += 2 + 2 * offset_size;
+
+      while (set_end - p >= offset_size
+	     && read_offset_1 (abfd, p, offset_size) != 0)
+	{
+	  const char *name;
+
+	  p += offset_size + (gnu_style ? 1 : 0);
+	  if (p >= set_end)
+	    return 0;
+	  name = (const char *) p;
+	  p = memchr (p, '\0', set_end - p);
+	  if (p == NULL)
+	    return 0;
+	  p++;
+
+	  name = pub_name_last_component (name);
+	  *htab_find_slot (names, name, INSERT) = (char *) name;
+	}
+
+      p = set_end;
+    }
+
+  return 1;
+}
+
+/* See symfile.h.  */
+
+int
+dwarf2_may_define_name (struct objfile *objfile, const char *name)
+{
+  struct dwarf2_per_objfile *saved_per_objfile = dwarf2_per_objfile;
+  struct dwarf2_per_objfile *data;
+  int has_info;
+
+  /* This may be called while another objfile is being read, so leave
+     the global alone.  */
+  has_info = dwarf2_has_info (objfile, NULL);
+  data = dwarf2_per_objfile;
+  dwarf2_per_objfile = saved_per_objfile;
+  if (!has_info)
+    return 1;
+
+  if (!data->pub_names_read)
+    {
+      htab_t names;
+
+      data->pub_names_read = 1;
+      names = htab_create_alloc_ex (100, htab_hash_string, (htab_eq) streq,
+				    NULL, &objfile->objfile_obstack,
+				    hashtab_obstack_allocate,
+				    dummy_obstack_deallocate);
+
+      /* Either pair is complete enough: producers list enumerators
+	 in pubnames and typedefs and tags in pubtypes.  */
+      if ((dwarf2_read_pub_names (objfile, names, ".debug_gnu_pubnames", 1)
+	   && dwarf2_read_pub_names (objfile, names,
+				     ".debug_gnu_pubtypes", 1))
+	  || (dwarf2_read_pub_names (objfile, names, ".debug_pubnames", 0)
+	      && dwarf2_read_pub_names (objfile, names,
+					".debug_pubtypes", 0)))
+	data->pub_names = names;
+    }
+
+  /* Names with template arguments or parameters may be spelled
+     differently in the index; don't rule them out.  */
+  if (data->pub_names == NULL || strpbrk (name, "<(") != NULL)
+    return 1;
+
+  return htab_find (data->pub_names,
+		    pub_name_last_component (name)) != NULL;
+}
+
 /* When loading sections, we look either for uncompressed section or for
    compressed section names.  */
 
@@ -1506,91 +1694,320 @@ dwarf2_locate_sections (bfd *abfd, asection *sectp, void *vnames)
     dwarf2_per_objfile->has_section_at_zero = 1;
 }
 
-/* Decompress a section that was compressed using zlib.  Store the
-   decompressed buffer, and its size, in OUTBUF and OUTSIZE.  */
+/* A helper function that decides whether a section is empty.  */
 
-static void
-zlib_decompress_section (struct objfile *objfile, asection *sectp,
-                         gdb_byte **outbuf, bfd_size_type *outsize)
+static int
+dwarf2_section_empty_p (struct dwarf2_section_info *info)
 {
-  bfd *abfd = objfile->obfd;
-#ifndef HAVE_ZLIB_H
-  error (_("Support for zlib-compressed DWARF data (from '%s') "
-           "is disabled in this copy of GDB"),
-         bfd_get_filename (abfd));
-#else
-  bfd_size_type compressed_size = bfd_get_section_size (sectp);
-  gdb_byte *compressed_buffer = xmalloc (compressed_size);
-  struct cleanup *cleanup = make_cleanup (xfree, compressed_buffer);
+  return info->asection == NULL || info->size == 0;
+}
+
+#ifdef HAVE_ZLIB_H
+/* A compressed section being decompressed, possibly on a DWARF worker
+   thread.  */
+
+struct zlib_section_job
+{
+  struct dwarf2_section_info *info;
+
+  /* The zlib data of the section, past its header; xmalloc'd.  */
+  gdb_byte *compressed;
+  bfd_size_type compressed_size;
+
+  /* Where the section is decompressed to, on the objfile obstack.  */
+  gdb_byte *uncompressed;
   bfd_size_type uncompressed_size;
-  gdb_byte *uncompressed_buffer;
-  z_stream strm;
+
+  /* The file in the index cache the section should be written to, or
+     NULL; xmalloc'd.  */
+  char *cache_file;
+
+  /* The result of zlib_inflate_section.  */
   int rc;
-  int header_size = 12;
 
-  if (bfd_seek (abfd, sectp->filepos, SEEK_SET) != 0
-      || bfd_bread (compressed_buffer,
-		    compressed_size, abfd) != compressed_size)
-    error (_("Dwarf Error: Can't read DWARF data from '%s'"),
-           bfd_get_filename (abfd));
+  /* Non-zero if this job runs in its own thread.  */
+  int started;
+#ifdef DWARF2_WORKER_THREADS
+  pthread_t thread;
+#endif
+};
 
-  /* Read the zlib header.  In this case, it should be "ZLIB" followed
-     by the uncompressed section size, 8 bytes in big-endian order.  */
-  if (compressed_size < header_size
-      || strncmp (compressed_buffer, "ZLIB", 4) != 0)
-    error (_("Dwarf Error: Corrupt DWARF ZLIB header from '%s'"),
-           bfd_get_filename (abfd));
-  uncompressed_size = compressed_buffer[4]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[5]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[6]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[7]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[8]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[9]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[10]; uncompressed_size <<= 8;
-  uncompressed_size += compressed_buffer[11];
+/* Inflate the IN_SIZE bytes of zlib data at IN into the OUT_SIZE bytes
+   at OUT, which they must fill exactly.  Return Z_OK on success, or
+   the zlib error code.  This never calls into the rest of GDB, so it
+   can run on a DWARF worker thread.  */
+
+static int
+zlib_inflate_section (gdb_byte *in, bfd_size_type in_size,
+		      gdb_byte *out, bfd_size_type out_size)
+{
+  z_stream strm;
+  int rc;
 
   /* It is possible the section consists of several compressed
      buffers concatenated together, so we uncompress in a loop.  */
   strm.zalloc = NULL;
   strm.zfree = NULL;
   strm.opaque = NULL;
-  strm.avail_in = compressed_size - header_size;
-  strm.next_in = (Bytef*) compressed_buffer + header_size;
-  strm.avail_out = uncompressed_size;
-  uncompressed_buffer = obstack_alloc (&objfile->objfile_obstack,
-                                       uncompressed_size);
+  strm.avail_in = in_size;
+  strm.next_in = (Bytef*) in;
+  strm.avail_out = out_size;
   rc = inflateInit (&strm);
+  if (rc != Z_OK)
+    return rc;
   while (strm.avail_in > 0)
     {
-      if (rc != Z_OK)
-        error (_("Dwarf Error: setting up DWARF uncompression in '%s': %d"),
-               bfd_get_filename (abfd), rc);
-      strm.next_out = ((Bytef*) uncompressed_buffer
-                       + (uncompressed_size - strm.avail_out));
+      strm.next_out = (Bytef*) out + (out_size - strm.avail_out);
       rc = inflate (&strm, Z_FINISH);
       if (rc != Z_STREAM_END)
-        error (_("Dwarf Error: zlib error uncompressing from '%s': %d"),
-               bfd_get_filename (abfd), rc);
+	{
+	  inflateEnd (&strm);
+	  return rc == Z_OK ? Z_BUF_ERROR : rc;
+	}
       rc = inflateReset (&strm);
+      if (rc != Z_OK)
+	{
+	  inflateEnd (&strm);
+	  return rc;
+	}
     }
   rc = inflateEnd (&strm);
-  if (rc != Z_OK
-      || strm.avail_out != 0)
-    error (_("Dwarf Error: concluding DWARF uncompression in '%s': %d"),
-           bfd_get_filename (abfd), rc);
+  if (rc == Z_OK && strm.avail_out != 0)
+    rc = Z_DATA_ERROR;
+  return rc;
+}
 
-  do_cleanups (cleanup);
-  *outbuf = uncompressed_buffer;
-  *outsize = uncompressed_size;
-#endif
+/* Body of a DWARF worker thread; ARG is its zlib_section_job.  */
+
+static void *
+zlib_section_job_run (void *arg)
+{
+  struct zlib_section_job *job = arg;
+
+  job->rc = zlib_inflate_section (job->compressed, job->compressed_size,
+				  job->uncompressed, job->uncompressed_size);
+  return NULL;
 }
 
-/* A helper function that decides whether a section is empty.  */
+/* Start decompressing the section INFO of OBJFILE, which has a zlib
+   header, into JOB.  If the section is in the index cache, use that
+   instead, leave JOB alone and return 1.  Otherwise read the
+   compressed data, allocate room for the decompressed one, and return
+   0; the caller must then inflate it and call
+   zlib_finish_section.  */
 
 static int
-dwarf2_section_empty_p (struct dwarf2_section_info *info)
+zlib_prepare_section (struct objfile *objfile,
+		      struct dwarf2_section_info *info,
+		      struct zlib_section_job *job)
 {
-  return info->asection == NULL || info->size == 0;
+  bfd *abfd = objfile->obfd;
+  asection *sectp = info->asection;
+  bfd_size_type compressed_size = bfd_get_section_size (sectp);
+  gdb_byte header[12];
+  bfd_size_type uncompressed_size;
+  const int header_size = sizeof (header);
+
+  /* Read the zlib header.  In this case, it should be "ZLIB" followed
+     by the uncompressed section size, 8 bytes in big-endian order.  */
+  if (compressed_size < header_size
+      || bfd_seek (abfd, sectp->filepos, SEEK_SET) != 0
+      || bfd_bread (header, header_size, abfd) != header_size)
+    error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+           bfd_get_filename (abfd));
+  if (strncmp (header, "ZLIB", 4) != 0)
+    error (_("Dwarf Error: Corrupt DWARF ZLIB header from '%s'"),
+           bfd_get_filename (abfd));
+  uncompressed_size = header[4]; uncompressed_size <<= 8;
+  uncompressed_size += header[5]; uncompressed_size <<= 8;
+  uncompressed_size += header[6]; uncompressed_size <<= 8;
+  uncompressed_size += header[7]; uncompressed_size <<= 8;
+  uncompressed_size += header[8]; uncompressed_size <<= 8;
+  uncompressed_size += header[9]; uncompressed_size <<= 8;
+  uncompressed_size += header[10]; uncompressed_size <<= 8;
+  uncompressed_size += header[11];
+
+  if (index_cache_lookup_section (objfile, info, uncompressed_size))
+    return 1;
+
+  memset (job, 0, sizeof (*job));
+  job->info = info;
+  job->compressed_size = compressed_size - header_size;
+  job->compressed = xmalloc (job->compressed_size);
+  if (bfd_bread (job->compressed, job->compressed_size,
+		 abfd) != job->compressed_size)
+    {
+      xfree (job->compressed);
+      error (_("Dwarf Error: Can't read DWARF data from '%s'"),
+	     bfd_get_filename (abfd));
+    }
+  job->uncompressed_size = uncompressed_size;
+  job->uncompressed = obstack_alloc (&objfile->objfile_obstack,
+				     uncompressed_size);
+  job->cache_file = index_cache_section_file_name (objfile, sectp);
+  return 0;
+}
+
+/* A cleanup that frees the buffers of the zlib_section_job ARG.  */
+
+static void
+zlib_free_section_job (void *arg)
+{
+  struct zlib_section_job *job = arg;
+
+  xfree (job->compressed);
+  job->compressed = NULL;
+  xfree (job->cache_file);
+  job->cache_file = NULL;
+}
+
+/* Finish decompressing the section of JOB, once it has been inflated:
+   check the result, make the section's buffer the decompressed data,
+   and write that to the index cache if it should be.  */
+
+static void
+zlib_finish_section (struct objfile *objfile, struct zlib_section_job *job)
+{
+  struct dwarf2_section_info *info = job->info;
+
+  if (job->rc != Z_OK)
+    error (_("Dwarf Error: zlib error uncompressing from '%s': %d"),
+	   bfd_get_filename (objfile->obfd), job->rc);
+
+  info->buffer = job->uncompressed;
+  info->size = job->uncompressed_size;
+  info->readin = 1;
+
+  if (job->cache_file != NULL)
+    index_cache_store_section (job->cache_file, info->buffer, info->size);
+}
+
+/* Decompress the compressed sections of OBJFILE that have not been
+   read yet, starting with INFO, on the DWARF worker threads.  Errors
+   in sections other than INFO are not reported here; those sections
+   are left unread, so that the error is reported if they are ever
+   needed.  */
+
+static void
+zlib_decompress_sections (struct objfile *objfile,
+			  struct dwarf2_section_info *info)
+{
+  struct dwarf2_per_objfile *data
+    = objfile_data (objfile, dwarf2_objfile_data_key);
+  struct dwarf2_section_info *candidates[12];
+  struct zlib_section_job *jobs;
+  struct cleanup *cleanup;
+  int n_candidates = 0, n_jobs = 0, i;
+
+  candidates[n_candidates++] = info;
+  if (data != NULL)
+    {
+      struct dwarf2_section_info *others[] =
+	{
+	  &data->info, &data->abbrev, &data->line, &data->loc,
+	  &data->macinfo, &data->macro, &data->str, &data->ranges,
+	  &data->frame, &data->eh_frame, &data->gdb_index
+	};
+
+      for (i = 0; i < ARRAY_SIZE (others); i++)
+	if (others[i] != info
+	    && !others[i]->readin
+	    && !dwarf2_section_empty_p (others[i])
+	    && strncmp (others[i]->asection->name, ".zdebug", 7) == 0)
+	  candidates[n_candidates++] = others[i];
+    }
+
+  jobs = XCALLOC (n_candidates, struct zlib_section_job);
+  cleanup = make_cleanup (xfree, jobs);
+
+  for (i = 0; i < n_candidates; i++)
+    {
+      struct dwarf2_section_info *section = candidates[i];
+      volatile struct gdb_exception except;
+      int done = 0;
+
+      if (section == info)
+	done = zlib_prepare_section (objfile, section, &jobs[n_jobs]);
+      else
+	{
+	  TRY_CATCH (except, RETURN_MASK_ERROR)
+	    {
+	      done = zlib_prepare_section (objfile, section, &jobs[n_jobs]);
+	    }
+	  if (except.reason < 0)
+	    continue;
+	}
+
+      if (!done)
+	make_cleanup (zlib_free_section_job, &jobs[n_jobs++]);
+    }
+
+#ifdef DWARF2_WORKER_THREADS
+  /* Keep one job for this thread.  */
+  for (i = 1; i < n_jobs && i <= dwarf2_worker_threads; i++)
+    jobs[i].started = (pthread_create (&jobs[i].thread, NULL,
+				       zlib_section_job_run, &jobs[i]) == 0);
+#endif
+
+  /* Once the workers are busy, run the jobs that did not get a thread
+     here, then wait for the others.  */
+  for (i = 0; i < n_jobs; i++)
+    if (!jobs[i].started)
+      zlib_section_job_run (&jobs[i]);
+#ifdef DWARF2_WORKER_THREADS
+  for (i = 0; i < n_jobs; i++)
+    if (jobs[i].started)
+      pthread_join (jobs[i].thread, NULL);
+#endif
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      volatile struct gdb_exception except;
+
+      if (jobs[i].info == info)
+	zlib_finish_section (objfile, &jobs[i]);
+      else
+	{
+	  TRY_CATCH (except, RETURN_MASK_ERROR)
+	    {
+	      zlib_finish_section (objfile, &jobs[i]);
+	    }
+	}
+    }
+
+  do_cleanups (cleanup);
+}
+#endif
+
+/* Decompress the section INFO of OBJFILE, which was compressed using
+   zlib, and make INFO's buffer and size those of the decompressed
+   data.  */
+
+static void
+zlib_decompress_section (struct objfile *objfile,
+			 struct dwarf2_section_info *info)
+{
+#ifndef HAVE_ZLIB_H
+  error (_("Support for zlib-compressed DWARF data (from '%s') "
+           "is disabled in this copy of GDB"),
+         bfd_get_filename (objfile->obfd));
+#else
+  struct zlib_section_job job;
+  struct cleanup *cleanup;
+
+  if (dwarf2_worker_threads > 0)
+    {
+      zlib_decompress_sections (objfile, info);
+      return;
+    }
+
+  if (zlib_prepare_section (objfile, info, &job))
+    return;
+  cleanup = make_cleanup (zlib_free_section_job, &job);
+  zlib_section_job_run (&job);
+  zlib_finish_section (objfile, &job);
+  do_cleanups (cleanup);
+#endif
 }
 
 /* Read the contents of the section SECTP from object file specified by
@@ -1622,8 +2039,7 @@ dwarf2_read_section (struct objfile *objfile, struct dwarf2_section_info *info)
       /* Upon decompression, update the buffer and its size.  */
       if (strncmp (header, "ZLIB", sizeof (header)) == 0)
         {
-          zlib_decompress_section (objfile, sectp, &info->buffer,
-				   &info->size);
+          zlib_decompress_section (objfile, info);
           return;
         }
     }
@@ -2152,21 +2568,16 @@ find_slot_in_mapped_hash (struct mapped_index *index, const char *name,
     }
 }
 
-/* Read the index file.  If everything went ok, initialize the "quick"
-   elements of all the CUs and return 1.  Otherwise, return 0.  */
+static int dwarf2_read_index_contents (struct objfile *, gdb_byte *,
+				       offset_type);
+
+/* Read the index section.  If everything went ok, initialize the
+   "quick" elements of all the CUs and return 1.  Otherwise, return
+   0.  */
 
 static int
 dwarf2_read_index (struct objfile *objfile)
 {
-  char *addr;
-  struct mapped_index *map;
-  offset_type *metadata;
-  const gdb_byte *cu_list;
-  const gdb_byte *types_list = NULL;
-  offset_type version, cu_list_elements;
-  offset_type types_list_elements = 0;
-  int i;
-
   if (dwarf2_section_empty_p (&dwarf2_per_objfile->gdb_index))
     return 0;
 
@@ -2178,7 +2589,27 @@ dwarf2_read_index (struct objfile *objfile)
 
   dwarf2_read_section (objfile, &dwarf2_per_objfile->gdb_index);
 
-  addr = dwarf2_per_objfile->gdb_index.buffer;
+  return dwarf2_read_index_contents (objfile,
+				     dwarf2_per_objfile->gdb_index.buffer,
+				     dwarf2_per_objfile->gdb_index.size);
+}
+
+/* Use the index at ADDR, of SIZE bytes, for OBJFILE.  ADDR must live
+   as long as OBJFILE.  If everything went ok, initialize the "quick"
+   elements of all the CUs and return 1.  Otherwise, return 0.  */
+
+static int
+dwarf2_read_index_contents (struct objfile *objfile, gdb_byte *addr,
+			    offset_type size)
+{
+  struct mapped_index *map;
+  offset_type *metadata;
+  const gdb_byte *cu_list;
+  const gdb_byte *types_list = NULL;
+  offset_type version, cu_list_elements;
+  offset_type types_list_elements = 0;
+  int i;
+
   /* Version check.  */
   version = MAYBE_SWAP (*(offset_type *) addr);
   /* Versions earlier than 3 emitted every copy of a psymbol.  This
@@ -2195,7 +2626,7 @@ dwarf2_read_index (struct objfile *objfile)
 
   map = OBSTACK_ZALLOC (&objfile->objfile_obstack, struct mapped_index);
   map->version = version;
-  map->total_size = dwarf2_per_objfile->gdb_index.size;
+  map->total_size = size;
 
   metadata = (offset_type *) (addr + sizeof (offset_type));
 
@@ -2957,6 +3388,9 @@ dwarf2_initialize_objfile (struct objfile *objfile)
   if (dwarf2_read_index (objfile))
     return 1;
 
+  if (index_cache_lookup (objfile))
+    return 1;
+
   return 0;
 }
 
@@ -2973,6 +3407,12 @@ dwarf2_build_psymtabs (struct objfile *objfile)
     }
 
   dwarf2_build_psymtabs_hard (objfile);
+
+  /* Write the index to the cache right away.  Waiting until GDB is
+     idle would miss objfiles loaded by a -batch run, which exits
+     before it gets there.  */
+  if (dwarf2_per_objfile->index_cache_file != NULL)
+    index_cache_store_objfile (objfile);
 }
 
 /* Return TRUE if OFFSET is within CU_HEADER.  */
@@ -16432,6 +16872,8 @@ dwarf2_per_objfile_free (struct objfile *objfile, void *d)
     munmap_section_buffer (section);
 
   VEC_free (dwarf2_section_info_def, data->types);
+
+  xfree (data->index_cache_file);
 }
 
 
@@ -16934,7 +17376,7 @@ write_obstack (FILE *file, struct obstack *obstack)
 static void
 unlink_if_set (void *p)
 {
-  char **filename = p;
+  const char **filename = p;
   if (*filename)
     unlink (*filename);
 }
@@ -16986,13 +17428,14 @@ write_one_signatured_type (void **slot, void *d)
   return 1;
 }
 
-/* Create an index file for OBJFILE in the directory DIR.  */
+/* Write an index of OBJFILE to the file FILENAME.  Return zero if
+   OBJFILE has no partial symbols to index.  */
 
-static void
-write_psymtabs_to_index (struct objfile *objfile, const char *dir)
+static int
+write_psymtabs_to_index (struct objfile *objfile, const char *filename)
 {
   struct cleanup *cleanup;
-  char *filename, *cleanup_filename;
+  const char *cleanup_filename;
   struct obstack contents, addr_obstack, constant_pool, symtab_obstack;
   struct obstack cu_list, types_cu_list;
   int i;
@@ -17006,7 +17449,7 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   struct psymtab_cu_index_map *psymtab_cu_index_map;
 
   if (!objfile->psymtabs || !objfile->psymtabs_addrmap)
-    return;
+    return 0;
 
   if (dwarf2_per_objfile->using_index)
     error (_("Cannot use an index to create the index"));
@@ -17017,9 +17460,7 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   if (stat (objfile->name, &st) < 0)
     perror_with_name (objfile->name);
 
-  filename = concat (dir, SLASH_STRING, lbasename (objfile->name),
-		     INDEX_SUFFIX, (char *) NULL);
-  cleanup = make_cleanup (xfree, filename);
+  cleanup = make_cleanup (null_cleanup, NULL);
 
   out_file = fopen (filename, "wb");
   if (!out_file)
@@ -17168,6 +17609,8 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   cleanup_filename = NULL;
 
   do_cleanups (cleanup);
+
+  return 1;
 }
 
 /* Implementation of the `save gdb-index' command.
@@ -17196,29 +17639,690 @@ save_gdb_index_command (char *arg, int from_tty)
       {
 	volatile struct gdb_exception except;
 
+	char *filename;
+	struct cleanup *cleanup;
+
+	filename = concat (arg, SLASH_STRING, lbasename (objfile->name),
+			   INDEX_SUFFIX, (char *) NULL);
+	cleanup = make_cleanup (xfree, filename);
+
 	TRY_CATCH (except, RETURN_MASK_ERROR)
 	  {
-	    write_psymtabs_to_index (objfile, arg);
+	    write_psymtabs_to_index (objfile, filename);
 	  }
 	if (except.reason < 0)
 	  exception_fprintf (gdb_stderr, except,
 			     _("Error while writing index for `%s': "),
 			     objfile->name);
+
+	do_cleanups (cleanup);
       }
   }
 }
 
 
 
-int dwarf2_always_disassemble;
+/* The index cache.  When it is enabled, the index of each objfile
+   that has a build ID but no .gdb_index section is written to a file
+   named after the build ID in INDEX_CACHE_DIRECTORY, and is used
+   instead of building partial symbols the next time the objfile is
+   loaded.  */
 
-static void
-show_dwarf2_always_disassemble (struct ui_file *file, int from_tty,
-				struct cmd_list_element *c, const char *value)
-{
-  fprintf_filtered (file,
-		    _("Whether to always disassemble "
-		      "DWARF expressions is %s.\n"),
+/* Non-zero if the index cache is used.  */
+static int index_cache_enabled = 0;
+
+/* The directory holding the index cache.  */
+static char *index_cache_directory;
+
+/* The total size the files in the index cache may grow to, in
+   megabytes, before the least recently used ones are deleted.  Zero
+   means no limit.  */
+static unsigned int index_cache_size_limit = 1024;
+
+/* Non-zero if the decompressed contents of compressed DWARF sections
+   are kept in the index cache too.  */
+static int index_cache_sections = 0;
+
+/* Statistics about the index cache, shown by "show index-cache
+   stats".  */
+static unsigned int index_cache_hits;
+static unsigned int index_cache_misses;
+static unsigned int index_cache_stores;
+static unsigned int index_cache_evictions;
+static unsigned int index_cache_section_hits;
+static unsigned int index_cache_section_misses;
+static unsigned int index_cache_section_stores;
+
+static struct cmd_list_element *set_index_cache_cmdlist;
+static struct cmd_list_element *show_index_cache_cmdlist;
+
+/* Return the name of the file in the index cache for OBJFILE, with
+   SUFFIX appended to its build ID, or NULL if OBJFILE has no build ID.
+   The result is xmalloc'd.  */
+
+static char *
+index_cache_file_name (struct objfile *objfile, const char *suffix)
+{
+  bfd *abfd = objfile->obfd;
+  char *build_id, *filename;
+  size_t i;
+
+  if (index_cache_directory == NULL || *index_cache_directory == '\0')
+    return NULL;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || elf_tdata (abfd)->build_id == NULL
+      || elf_tdata (abfd)->build_id_size == 0)
+    return NULL;
+
+  build_id = xmalloc (2 * elf_tdata (abfd)->build_id_size + 1);
+  for (i = 0; i < elf_tdata (abfd)->build_id_size; i++)
+    xsnprintf (&build_id[2 * i], 3, "%02x",
+	       (unsigned) elf_tdata (abfd)->build_id[i]);
+
+  filename = concat (index_cache_directory, SLASH_STRING, build_id,
+		     suffix, (char *) NULL);
+  xfree (build_id);
+  return filename;
+}
+
+/* Return the name of the file in the index cache holding the
+   decompressed contents of the compressed section SECTP of OBJFILE, or
+   NULL if it should not be cached.  The result is xmalloc'd.  */
+
+static char *
+index_cache_section_file_name (struct objfile *objfile, asection *sectp)
+{
+  if (!index_cache_sections
+      || strncmp (bfd_get_section_name (objfile->obfd, sectp),
+		  ".zdebug_", 8) != 0)
+    return NULL;
+
+  return index_cache_file_name (objfile,
+				bfd_get_section_name (objfile->obfd, sectp));
+}
+
+/* Return non-zero if NAME is the name of a file in the index cache:
+   an index, or the decompressed contents of a section.  */
+
+static int
+index_cache_file_p (const char *name)
+{
+  size_t len = strlen (name);
+  const char *section;
+
+  if (len > strlen (INDEX_SUFFIX)
+      && strcmp (name + len - strlen (INDEX_SUFFIX), INDEX_SUFFIX) == 0)
+    return 1;
+
+  /* Temporary files have the process ID appended.  */
+  section = strstr (name, ".zdebug_");
+  return (section != NULL && section != name
+	  && strchr (section + 1, '.') == NULL);
+}
+
+/* Return non-zero if the index at ADDR, of SIZE bytes, is well formed
+   and describes the .debug_info section of OBJFILE.  The file comes
+   from outside GDB and may be truncated or corrupt, so every offset
+   and count that the index reader follows is checked against SIZE.
+   Two objfiles with the same build ID can also have different DWARF,
+   for instance if one of them went through a DWARF rewriting tool;
+   their indexes must not be mixed up.  */
+
+static int
+index_cache_index_matches (struct objfile *objfile, gdb_byte *addr,
+			   offset_type size)
+{
+  offset_type *metadata, *symbol_table;
+  offset_type offsets[6];
+  offset_type n_cus, n_types, slots, pool_size, i, j;
+  gdb_byte *pool;
+  ULONGEST next_offset = 0;
+
+  /* The version, and the offsets of the five tables.  */
+  if (size < 6 * sizeof (offset_type))
+    return 0;
+
+  metadata = (offset_type *) (addr + sizeof (offset_type));
+  for (i = 0; i < 5; i++)
+    offsets[i] = MAYBE_SWAP (metadata[i]);
+  offsets[5] = size;
+
+  /* The tables follow the header, in order.  */
+  if (offsets[0] < 6 * sizeof (offset_type))
+    return 0;
+  for (i = 0; i < 5; i++)
+    if (offsets[i] > offsets[i + 1])
+      return 0;
+
+  /* Each table holds a whole number of entries.  */
+  if ((offsets[1] - offsets[0]) % 16 != 0
+      || (offsets[2] - offsets[1]) % 24 != 0
+      || (offsets[3] - offsets[2]) % 20 != 0
+      || (offsets[4] - offsets[3]) % (2 * sizeof (offset_type)) != 0)
+    return 0;
+  n_cus = (offsets[1] - offsets[0]) / 16;
+  n_types = (offsets[2] - offsets[1]) / 24;
+
+  /* The compilation units must cover all of .debug_info.  */
+  for (i = offsets[0]; i < offsets[1]; i += 16)
+    {
+      ULONGEST offset, length;
+
+      offset = extract_unsigned_integer (addr + i, 8, BFD_ENDIAN_LITTLE);
+      length = extract_unsigned_integer (addr + i + 8, 8, BFD_ENDIAN_LITTLE);
+      if (offset != next_offset)
+	return 0;
+      next_offset = offset + length;
+    }
+  if (next_offset != dwarf2_per_objfile->info.size)
+    return 0;
+
+  /* The type units must be in the one .debug_types section.  */
+  if (n_types > 0)
+    {
+      struct dwarf2_section_info *section;
+
+      if (VEC_length (dwarf2_section_info_def, dwarf2_per_objfile->types)
+	  != 1)
+	return 0;
+      section = VEC_index (dwarf2_section_info_def,
+			   dwarf2_per_objfile->types, 0);
+      dwarf2_read_section (objfile, section);
+
+      for (i = offsets[1]; i < offsets[2]; i += 24)
+	{
+	  ULONGEST offset, type_offset;
+
+	  offset = extract_unsigned_integer (addr + i, 8, BFD_ENDIAN_LITTLE);
+	  type_offset = extract_unsigned_integer (addr + i + 8, 8,
+						  BFD_ENDIAN_LITTLE);
+	  if (offset >= section->size
+	      || type_offset >= section->size - offset)
+	    return 0;
+	}
+    }
+
+  /* Address ranges must belong to a unit.  */
+  for (i = offsets[2]; i < offsets[3]; i += 20)
+    if (extract_unsigned_integer (addr + i + 16, 4, BFD_ENDIAN_LITTLE)
+	>= n_cus + n_types)
+      return 0;
+
+  /* The symbol table is probed by masking the hash, so its size must
+     be a power of two.  */
+  slots = (offsets[4] - offsets[3]) / (2 * sizeof (offset_type));
+  if (slots == 0 || (slots & (slots - 1)) != 0)
+    return 0;
+
+  /* Every name and unit vector must be in the constant pool, and the
+     vectors must refer to units.  */
+  symbol_table = (offset_type *) (addr + offsets[3]);
+  pool = addr + offsets[4];
+  pool_size = size - offsets[4];
+  for (i = 0; i < 2 * slots; i += 2)
+    {
+      offset_type name_offset = MAYBE_SWAP (symbol_table[i]);
+      offset_type vec_offset = MAYBE_SWAP (symbol_table[i + 1]);
+      offset_type *vec;
+      offset_type count;
+
+      if (name_offset == 0 && vec_offset == 0)
+	continue;
+
+      if (name_offset >= pool_size
+	  || memchr (pool + name_offset, '\0',
+		     pool_size - name_offset) == NULL)
+	return 0;
+
+      if (pool_size < sizeof (offset_type)
+	  || vec_offset > pool_size - sizeof (offset_type))
+	return 0;
+      vec = (offset_type *) (pool + vec_offset);
+      count = MAYBE_SWAP (vec[0]);
+      if (count > ((pool_size - vec_offset) / sizeof (offset_type)) - 1)
+	return 0;
+      for (j = 1; j <= count; j++)
+	if (MAYBE_SWAP (vec[j]) >= n_cus + n_types)
+	  return 0;
+    }
+
+  return 1;
+}
+
+/* Read all of the SIZE bytes of file descriptor FD into BUF.  Return
+   non-zero on success.  */
+
+static int
+index_cache_read_file (int fd, gdb_byte *buf, size_t size)
+{
+  while (size > 0)
+    {
+      ssize_t n = read (fd, buf, size);
+
+      if (n <= 0)
+	return 0;
+      buf += n;
+      size -= n;
+    }
+
+  return 1;
+}
+
+/* Try to use the index of OBJFILE from the index cache.  Return 1 if
+   it was found and is now in use.  Otherwise, arrange for the index
+   to be written to the cache once the partial symbols of OBJFILE have
+   been read, and return 0.  */
+
+static int
+index_cache_lookup (struct objfile *objfile)
+{
+  char *filename;
+  struct stat st;
+  int fd;
+
+  if (!index_cache_enabled)
+    return 0;
+
+  filename = index_cache_file_name (objfile, INDEX_SUFFIX);
+  if (filename == NULL)
+    return 0;
+
+  fd = open (filename, O_RDONLY | O_BINARY);
+  if (fd >= 0)
+    {
+      if (fstat (fd, &st) == 0
+	  && st.st_size > 0
+	  && st.st_size == (offset_type) st.st_size)
+	{
+	  gdb_byte *buf;
+
+	  /* The index must live as long as OBJFILE.  If it turns out to
+	     be unusable, this memory is wasted, but that should be
+	     rare.  */
+	  buf = obstack_alloc (&objfile->objfile_obstack, st.st_size);
+	  dwarf2_read_section (objfile, &dwarf2_per_objfile->info);
+
+	  if (index_cache_read_file (fd, buf, st.st_size)
+	      && index_cache_index_matches (objfile, buf, st.st_size)
+	      && dwarf2_read_index_contents (objfile, buf, st.st_size))
+	    {
+	      close (fd);
+
+	      /* Mark the file as recently used.  */
+	      utime (filename, NULL);
+	      xfree (filename);
+	      index_cache_hits++;
+	      return 1;
+	    }
+	}
+      close (fd);
+    }
+
+  index_cache_misses++;
+  dwarf2_per_objfile->index_cache_file = filename;
+  return 0;
+}
+
+/* Create the index cache directory and its parents, if needed.  */
+
+static void
+index_cache_make_directory (void)
+{
+  char *dir, *p;
+  struct cleanup *cleanup;
+
+  dir = xstrdup (index_cache_directory);
+  cleanup = make_cleanup (xfree, dir);
+
+  for (p = dir + 1; ; p++)
+    if (*p == '\0' || IS_DIR_SEPARATOR (*p))
+      {
+	char c = *p;
+
+	*p = '\0';
+#ifdef _WIN32
+	if (mkdir (dir) != 0 && errno != EEXIST)
+#else
+	if (mkdir (dir, 0700) != 0 && errno != EEXIST)
+#endif
+	  perror_with_name (dir);
+	if (c == '\0')
+	  break;
+	*p = c;
+      }
+
+  do_cleanups (cleanup);
+}
+
+/* A file in the index cache, as seen by index_cache_evict.  */
+
+struct index_cache_entry
+{
+  char *filename;
+  ULONGEST size;
+  time_t mtime;
+};
+
+/* qsort comparison function that sorts index_cache_entry objects from
+   the least to the most recently used.  */
+
+static int
+compare_index_cache_entries (const void *ap, const void *bp)
+{
+  const struct index_cache_entry *a = ap;
+  const struct index_cache_entry *b = bp;
+
+  if (a->mtime != b->mtime)
+    return a->mtime < b->mtime ? -1 : 1;
+  return strcmp (a->filename, b->filename);
+}
+
+/* Delete the least recently used files from the index cache until it
+   fits in INDEX_CACHE_SIZE_LIMIT again.  KEEP is the file that was
+   just written; it is never deleted.  */
+
+static void
+index_cache_evict (const char *keep)
+{
+  struct index_cache_entry *entries = NULL;
+  int n_entries = 0, n_allocated = 0, i;
+  ULONGEST total = 0, limit;
+  DIR *dir;
+  struct dirent *ent;
+
+  if (index_cache_size_limit == 0)
+    return;
+  limit = (ULONGEST) index_cache_size_limit * 1024 * 1024;
+
+  dir = opendir (index_cache_directory);
+  if (dir == NULL)
+    return;
+
+  while ((ent = readdir (dir)) != NULL)
+    {
+      char *filename;
+      struct stat st;
+
+      if (!index_cache_file_p (ent->d_name))
+	continue;
+
+      filename = concat (index_cache_directory, SLASH_STRING, ent->d_name,
+			 (char *) NULL);
+      if (stat (filename, &st) != 0)
+	{
+	  xfree (filename);
+	  continue;
+	}
+
+      if (n_entries == n_allocated)
+	{
+	  n_allocated = n_allocated ? 2 * n_allocated : 16;
+	  entries = xrealloc (entries, n_allocated * sizeof (*entries));
+	}
+      entries[n_entries].filename = filename;
+      entries[n_entries].size = st.st_size;
+      entries[n_entries].mtime = st.st_mtime;
+      n_entries++;
+      total += st.st_size;
+    }
+  closedir (dir);
+
+  if (total > limit)
+    {
+      qsort (entries, n_entries, sizeof (*entries),
+	     compare_index_cache_entries);
+      for (i = 0; i < n_entries && total > limit; i++)
+	if (strcmp (entries[i].filename, keep) != 0
+	    && unlink (entries[i].filename) == 0)
+	  {
+	    total -= entries[i].size;
+	    index_cache_evictions++;
+	  }
+    }
+
+  for (i = 0; i < n_entries; i++)
+    xfree (entries[i].filename);
+  xfree (entries);
+}
+
+/* Write the index of OBJFILE to FILENAME in the index cache.  The
+   index is written to a temporary file first, so that other GDB
+   processes sharing the cache never see a partial index.  */
+
+static void
+index_cache_store (struct objfile *objfile, const char *filename)
+{
+  char *tmp_filename;
+  struct cleanup *cleanup;
+
+  index_cache_make_directory ();
+
+  tmp_filename = xstrprintf ("%s.%ld", filename, (long) getpid ());
+  cleanup = make_cleanup (xfree, tmp_filename);
+
+  if (write_psymtabs_to_index (objfile, tmp_filename))
+    {
+      if (rename (tmp_filename, filename) != 0)
+	{
+	  unlink (tmp_filename);
+	  perror_with_name (filename);
+	}
+      index_cache_stores++;
+      index_cache_evict (filename);
+    }
+
+  do_cleanups (cleanup);
+}
+
+/* Try to use the decompressed contents of the compressed section INFO
+   of OBJFILE, SIZE bytes long, from the index cache.  Return 1, with
+   INFO read in, if they were found; they are mapped rather than read
+   if possible.  */
+
+static int
+index_cache_lookup_section (struct objfile *objfile,
+			    struct dwarf2_section_info *info,
+			    bfd_size_type size)
+{
+  char *filename;
+  struct stat st;
+  int fd, found = 0;
+
+  filename = index_cache_section_file_name (objfile, info->asection);
+  if (filename == NULL)
+    return 0;
+
+  fd = open (filename, O_RDONLY | O_BINARY);
+  if (fd >= 0)
+    {
+      /* A file of another size was made from different DWARF.  */
+      if (fstat (fd, &st) == 0
+	  && st.st_size == size
+	  && size == (size_t) size)
+	{
+#ifdef HAVE_MMAP
+	  void *addr = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	  if (size > 0 && addr != MAP_FAILED)
+	    {
+	      info->buffer = addr;
+	      info->map_addr = addr;
+	      info->map_len = size;
+	      found = 1;
+	    }
+#endif
+	  if (!found)
+	    {
+	      gdb_byte *buf = obstack_alloc (&objfile->objfile_obstack, size);
+
+	      if (index_cache_read_file (fd, buf, size))
+		{
+		  info->buffer = buf;
+		  found = 1;
+		}
+	    }
+	}
+      close (fd);
+    }
+
+  if (found)
+    {
+      info->size = size;
+      info->readin = 1;
+
+      /* Mark the file as recently used.  */
+      utime (filename, NULL);
+      index_cache_section_hits++;
+    }
+  else
+    index_cache_section_misses++;
+
+  xfree (filename);
+  return found;
+}
+
+/* Write the SIZE bytes at BUF, the decompressed contents of a section,
+   to FILENAME in the index cache, through a temporary file as for
+   indexes.  Failing to do so is not an error, the section itself was
+   read fine.  */
+
+static void
+index_cache_store_section (const char *filename, const gdb_byte *buf,
+			   bfd_size_type size)
+{
+  volatile struct gdb_exception except;
+
+  TRY_CATCH (except, RETURN_MASK_ERROR)
+    {
+      char *tmp_filename;
+      struct cleanup *cleanup;
+      FILE *out_file;
+      int ok;
+
+      index_cache_make_directory ();
+
+      tmp_filename = xstrprintf ("%s.%ld", filename, (long) getpid ());
+      cleanup = make_cleanup (xfree, tmp_filename);
+
+      out_file = fopen (tmp_filename, "wb");
+      if (out_file == NULL)
+	perror_with_name (tmp_filename);
+      ok = fwrite (buf, 1, size, out_file) == size;
+      if (fclose (out_file) != 0)
+	ok = 0;
+      if (!ok || rename (tmp_filename, filename) != 0)
+	{
+	  unlink (tmp_filename);
+	  perror_with_name (filename);
+	}
+
+      index_cache_section_stores++;
+      index_cache_evict (filename);
+      do_cleanups (cleanup);
+    }
+  if (except.reason < 0)
+    exception_fprintf (gdb_stderr, except,
+		       _("Error while writing index cache for `%s': "),
+		       filename);
+}
+
+/* Write the index of OBJFILE that index_cache_lookup asked for.  An
+   error here does not affect the symbols that were just read, so it is
+   only reported.  */
+
+static void
+index_cache_store_objfile (struct objfile *objfile)
+{
+  volatile struct gdb_exception except;
+
+  TRY_CATCH (except, RETURN_MASK_ERROR)
+    {
+      index_cache_store (objfile, dwarf2_per_objfile->index_cache_file);
+    }
+  if (except.reason < 0)
+    exception_fprintf (gdb_stderr, except,
+		       _("Error while writing index cache for `%s': "),
+		       objfile->name);
+
+  xfree (dwarf2_per_objfile->index_cache_file);
+  dwarf2_per_objfile->index_cache_file = NULL;
+}
+
+static void
+set_index_cache_cmd (char *args, int from_tty)
+{
+  help_list (set_index_cache_cmdlist, "set index-cache ", -1, gdb_stdout);
+}
+
+static void
+show_index_cache_cmd (char *args, int from_tty)
+{
+  cmd_show_list (show_index_cache_cmdlist, from_tty, "");
+}
+
+static void
+show_index_cache_enabled (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The index cache is %s.\n"),
+		    index_cache_enabled ? _("enabled") : _("disabled"));
+}
+
+static void
+show_index_cache_directory (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The directory of the index cache is \"%s\".\n"),
+		    value);
+}
+
+static void
+show_index_cache_size_limit (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The size limit of the index cache is %s "
+			    "megabytes.\n"),
+		    value);
+}
+
+/* Implement the "show index-cache stats" command.  */
+
+static void
+show_index_cache_stats (char *args, int from_tty)
+{
+  printf_filtered (_("Index cache hits: %u\n"), index_cache_hits);
+  printf_filtered (_("Index cache misses: %u\n"), index_cache_misses);
+  printf_filtered (_("Index cache stores: %u\n"), index_cache_stores);
+  printf_filtered (_("Index cache evictions: %u\n"),
+		   index_cache_evictions);
+  printf_filtered (_("Decompressed section hits: %u\n"),
+		   index_cache_section_hits);
+  printf_filtered (_("Decompressed section misses: %u\n"),
+		   index_cache_section_misses);
+  printf_filtered (_("Decompressed section stores: %u\n"),
+		   index_cache_section_stores);
+}
+
+static void
+show_index_cache_sections (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Keeping decompressed DWARF sections in the "
+			    "index cache is %s.\n"),
+		    value);
+}
+
+
+int dwarf2_always_disassemble;
+
+static void
+show_dwarf2_always_disassemble (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("Whether to always disassemble "
+		      "DWARF expressions is %s.\n"),
 		    value);
 }
 
@@ -17265,6 +18369,18 @@ caching, which can slow down startup."),
 			    &set_dwarf2_cmdlist,
 			    &show_dwarf2_cmdlist);
 
+  add_setshow_zuinteger_cmd ("worker-threads", class_obscure,
+			     &dwarf2_worker_threads, _("\
+Set the number of threads used to decompress DWARF 2 sections."), _("\
+Show the number of threads used to decompress DWARF 2 sections."), _("\
+When non-zero, this many threads decompress the compressed DWARF\n\
+sections of an objfile all at once, the first time GDB needs one of\n\
+them.  Zero does all the work in GDB's main thread."),
+			     NULL,
+			     show_dwarf2_worker_threads,
+			     &set_dwarf2_cmdlist,
+			     &show_dwarf2_cmdlist);
+
   add_setshow_boolean_cmd ("always-disassemble", class_obscure,
 			   &dwarf2_always_disassemble, _("\
 Set whether `info address' always disassembles DWARF expressions."), _("\
@@ -17300,4 +18416,69 @@ Save a gdb-index file.\n\
 Usage: save gdb-index DIRECTORY"),
 	       &save_cmdlist);
   set_cmd_completer (c, filename_completer);
+
+  if (getenv ("XDG_CACHE_HOME") != NULL && *getenv ("XDG_CACHE_HOME") != '\0')
+    index_cache_directory = concat (getenv ("XDG_CACHE_HOME"), SLASH_STRING,
+				    "gdb", (char *) NULL);
+  else if (getenv ("HOME") != NULL)
+    index_cache_directory = concat (getenv ("HOME"), SLASH_STRING, ".cache",
+				    SLASH_STRING, "gdb", (char *) NULL);
+  else
+    index_cache_directory = xstrdup ("");
+
+  add_prefix_cmd ("index-cache", class_files, set_index_cache_cmd, _("\
+Set index cache options.\n\
+The index cache keeps the indexes of objfiles without a .gdb_index\n\
+section on disk, so that their partial symbols are read quickly the\n\
+next time they are loaded."),
+		  &set_index_cache_cmdlist, "set index-cache ",
+		  0/*allow-unknown*/, &setlist);
+  add_prefix_cmd ("index-cache", class_files, show_index_cache_cmd, _("\
+Show index cache options."),
+		  &show_index_cache_cmdlist, "show index-cache ",
+		  0/*allow-unknown*/, &showlist);
+
+  add_setshow_boolean_cmd ("enabled", class_files, &index_cache_enabled, _("\
+Set whether the index cache is used."), _("\
+Show whether the index cache is used."), _("\
+When on, GDB looks up the index of objfiles that have a build ID but\n\
+no .gdb_index section in the index cache, and adds the indexes it\n\
+does not find there."),
+			   NULL, show_index_cache_enabled,
+			   &set_index_cache_cmdlist,
+			   &show_index_cache_cmdlist);
+
+  add_setshow_boolean_cmd ("decompressed-sections", class_files,
+			   &index_cache_sections, _("\
+Set whether decompressed DWARF sections are kept in the index cache."), _("\
+Show whether decompressed DWARF sections are kept in the index cache."), _("\
+When on, GDB keeps the decompressed contents of the compressed\n\
+.zdebug sections of objfiles that have a build ID in the index cache,\n\
+and maps them from there the next time the objfiles are loaded,\n\
+instead of decompressing them again."),
+			   NULL, show_index_cache_sections,
+			   &set_index_cache_cmdlist,
+			   &show_index_cache_cmdlist);
+
+  add_setshow_filename_cmd ("directory", class_files,
+			    &index_cache_directory, _("\
+Set the directory of the index cache."), _("\
+Show the directory of the index cache."), NULL,
+			    NULL, show_index_cache_directory,
+			    &set_index_cache_cmdlist,
+			    &show_index_cache_cmdlist);
+
+  add_setshow_zuinteger_cmd ("size-limit", class_files,
+			     &index_cache_size_limit, _("\
+Set the size limit of the index cache, in megabytes."), _("\
+Show the size limit of the index cache, in megabytes."), _("\
+When the files in the index cache take more space than this, the\n\
+least recently used ones are deleted.  Zero means no limit."),
+			     NULL, show_index_cache_size_limit,
+			     &set_index_cache_cmdlist,
+			     &show_index_cache_cmdlist);
+
+  add_cmd ("stats", class_files, show_index_cache_stats, _("\
+Show statistics about the index cache."),
+	   &show_index_cache_cmdlist);
 }
@@ -220,6 +220,26 @@ record_minimal_symbol (const char *name, int name_len, int copy_name,
 #define ST_DYNAMIC 1
 #define ST_SYNTHETIC 2
 
+/* Remember the base name of NAME, the name of an ELF file symbol of
+   OBJFILE, so that source file lookups can find out whether the
+   deferred debug information of OBJFILE may describe that file.  */
+
+static void
+elf_record_file_symbol (struct objfile *objfile, char *name)
+{
+  char *base_name = (char *) lbasename (name);
+  void **slot;
+
+  if (objfile->file_symbol_names == NULL)
+    objfile->file_symbol_names = htab_create_alloc (10, htab_hash_string,
+						    (htab_eq) streq, NULL,
+						    xcalloc, xfree);
+
+  slot = htab_find_slot (objfile->file_symbol_names, base_name, INSERT);
+  if (*slot == NULL)
+    *slot = base_name;
+}
+
 static void
 elf_symtab_read (struct objfile *objfile, int type,
 		 long number_of_symbols, asymbol **symbol_table,
@@ -330,6 +350,8 @@ elf_symtab_read (struct objfile *objfile, int type,
 	  filesymname =
 	    obsavestring ((char *) filesym->name, strlen (filesym->name),
 			  &objfile->objfile_obstack);
+	  if ((objfile->flags & OBJF_LAZY_DEBUG) != 0 && *filesymname != '\0')
+	    elf_record_file_symbol (objfile, filesymname);
 	}
       else if (sym->flags & BSF_SECTION_SYM)
 	continue;
@@ -24,6 +24,7 @@
 #include "gdbcmd.h"
 #include "value.h"
 #include "target.h"
+#include "cli/cli-utils.h"
 
 /* Copied from bfd_put_bits.  */
 
@@ -45,42 +46,209 @@ put_bits (bfd_uint64_t data, char *buf, int bits, bfd_boolean big_p)
     }
 }
 
+/* Return the end of the search pattern that starts at S: the first
+   semicolon that is not quoted, or the end of S.  */
+
+static char *
+find_pattern_end (char *s)
+{
+  char quote = '\0';
+
+  for (; *s != '\0'; s++)
+    {
+      if (quote != '\0')
+	{
+	  if (*s == '\\' && s[1] != '\0')
+	    s++;
+	  else if (*s == quote)
+	    quote = '\0';
+	}
+      else if (*s == '"' || *s == '\'')
+	quote = *s;
+      else if (*s == ';')
+	break;
+    }
+
+  return s;
+}
+
+/* Subroutine of parse_find_args.  Parse the search pattern in S, the
+   values to search for separated by commas, into PATTERN.  A "?"
+   instead of a value matches any SIZE bytes, or any byte if SIZE is
+   not specified.  Set *VAL_BYTESP to the size of the first value, if
+   it is not set yet.  */
+
+static void
+parse_find_pattern (char *s, char size, bfd_boolean big_p,
+		    struct mem_search_pattern *pattern, int *val_bytesp)
+{
+  /* Buffers to hold the search pattern and its mask.
+     We realloc space as needed.  */
+#define INITIAL_PATTERN_BUF_SIZE 100
+  ULONGEST pattern_buf_size = INITIAL_PATTERN_BUF_SIZE;
+  gdb_byte *pattern_buf;
+  gdb_byte *mask_buf;
+  /* Length of the in-use part of the buffers.  */
+  ULONGEST pattern_len = 0;
+  int wildcards = 0;
+  struct cleanup *old_cleanups;
+
+  pattern_buf = xmalloc (pattern_buf_size);
+  old_cleanups = make_cleanup (free_current_contents, &pattern_buf);
+  mask_buf = xmalloc (pattern_buf_size);
+  make_cleanup (free_current_contents, &mask_buf);
+
+  while (isspace (*s))
+    ++s;
+
+  while (*s != '\0')
+    {
+      LONGEST x;
+      int val_bytes;
+      char *p;
+      struct value *v = NULL;
+
+      /* Look for a wildcard.  */
+      p = skip_spaces (s + 1);
+      if (*s == '?' && (*p == ',' || *p == '\0'))
+	{
+	  s = p;
+	  switch (size)
+	    {
+	    case 'h':
+	      val_bytes = sizeof (int16_t);
+	      break;
+	    case 'w':
+	      val_bytes = sizeof (int32_t);
+	      break;
+	    case 'g':
+	      val_bytes = sizeof (int64_t);
+	      break;
+	    default:
+	      val_bytes = 1;
+	      break;
+	    }
+	}
+      else
+	{
+	  v = parse_to_comma_and_eval (&s);
+	  val_bytes = TYPE_LENGTH (value_type (v));
+	  if (*val_bytesp == 0)
+	    *val_bytesp = val_bytes;
+	}
+
+      /* Keep it simple and assume size == 'g' when watching for when we
+	 need to grow the pattern buf.  */
+      while ((pattern_len + max (val_bytes, sizeof (int64_t)))
+	     > pattern_buf_size)
+	{
+	  pattern_buf_size *= 2;
+	  pattern_buf = xrealloc (pattern_buf, pattern_buf_size);
+	  mask_buf = xrealloc (mask_buf, pattern_buf_size);
+	}
+
+      if (v == NULL)
+	{
+	  memset (pattern_buf + pattern_len, 0, val_bytes);
+	  memset (mask_buf + pattern_len, 0, val_bytes);
+	  wildcards = 1;
+	}
+      else if (size != '\0')
+	{
+	  x = value_as_long (v);
+	  switch (size)
+	    {
+	    case 'b':
+	      val_bytes = 1;
+	      pattern_buf[pattern_len] = x;
+	      break;
+	    case 'h':
+	      val_bytes = sizeof (int16_t);
+	      put_bits (x, (char *) pattern_buf + pattern_len, 16, big_p);
+	      break;
+	    case 'w':
+	      val_bytes = sizeof (int32_t);
+	      put_bits (x, (char *) pattern_buf + pattern_len, 32, big_p);
+	      break;
+	    case 'g':
+	      val_bytes = sizeof (int64_t);
+	      put_bits (x, (char *) pattern_buf + pattern_len, 64, big_p);
+	      break;
+	    }
+	  memset (mask_buf + pattern_len, 0xff, val_bytes);
+	}
+      else
+	{
+	  memcpy (pattern_buf + pattern_len, value_contents (v), val_bytes);
+	  memset (mask_buf + pattern_len, 0xff, val_bytes);
+	}
+      pattern_len += val_bytes;
+
+      if (*s == ',')
+	++s;
+      while (isspace (*s))
+	++s;
+    }
+
+  if (pattern_len == 0)
+    error (_("Missing search pattern."));
+
+  pattern->bytes = pattern_buf;
+  pattern->len = pattern_len;
+  if (wildcards)
+    pattern->mask = mask_buf;
+  else
+    {
+      pattern->mask = NULL;
+      xfree (mask_buf);
+    }
+
+  /* The pattern was parsed successfully, leave the freeing of its
+     buffers to the caller now.  */
+  discard_cleanups (old_cleanups);
+}
+
+/* Cleanup function to free the patterns of a search.  */
+
+static void
+do_mem_search_free (void *arg)
+{
+  mem_search_free (arg);
+}
+
 /* Subroutine of find_command to simplify it.
-   Parse the arguments of the "find" command.  */
+   Parse the arguments of the "find" command into SEARCH.
+   The patterns of SEARCH are freed by a cleanup that is left
+   for the caller.  SEARCH is left without patterns if the search
+   range is empty.  */
 
 static void
-parse_find_args (char *args, ULONGEST *max_countp,
-		 char **pattern_bufp, ULONGEST *pattern_lenp,
+parse_find_args (char *args, struct mem_search *search,
 		 CORE_ADDR *start_addrp, ULONGEST *search_space_lenp,
 		 bfd_boolean big_p)
 {
   /* Default to using the specified type.  */
   char size = '\0';
   ULONGEST max_count = ~(ULONGEST) 0;
-  /* Buffer to hold the search pattern.  */
-  char *pattern_buf;
-  /* Current size of search pattern buffer.
-     We realloc space as needed.  */
-#define INITIAL_PATTERN_BUF_SIZE 100
-  ULONGEST pattern_buf_size = INITIAL_PATTERN_BUF_SIZE;
-  /* Pointer to one past the last in-use part of pattern_buf.  */
-  char *pattern_buf_end;
-  ULONGEST pattern_len;
+  int align_p = 0;
+  /* The size of the first value of the patterns.  */
+  int val_bytes = 0;
+  int patterns_alloc = 0;
+  int min_len;
   CORE_ADDR start_addr;
   ULONGEST search_space_len;
   char *s = args;
-  struct cleanup *old_cleanups;
   struct value *v;
+  int i;
 
   if (args == NULL)
     error (_("Missing search parameters."));
 
-  pattern_buf = xmalloc (pattern_buf_size);
-  pattern_buf_end = pattern_buf;
-  old_cleanups = make_cleanup (free_current_contents, &pattern_buf);
+  memset (search, 0, sizeof (*search));
+  make_cleanup (do_mem_search_free, search);
 
-  /* Get search granularity and/or max count if specified.
-     They may be specified in either order, together or separately.  */
+  /* Get search granularity, alignment and/or max count if specified.
+     They may be specified in any order, together or separately.  */
 
   while (*s == '/')
     {
@@ -104,6 +272,10 @@ parse_find_args (char *args, ULONGEST *max_countp,
 	    case 'g':
 	      size = *s++;
 	      break;
+	    case 'a':
+	      align_p = 1;
+	      s++;
+	      break;
 	    default:
 	      error (_("Invalid size granularity."));
 	    }
@@ -132,7 +304,6 @@ parse_find_args (char *args, ULONGEST *max_countp,
       len = value_as_long (v);
       if (len == 0)
 	{
-	  do_cleanups (old_cleanups);
 	  printf_filtered (_("Empty search range.\n"));
 	  return;
 	}
@@ -164,82 +335,94 @@ parse_find_args (char *args, ULONGEST *max_countp,
   if (*s == ',')
     ++s;
 
-  /* Fetch the search string.  */
+  /* Fetch the search patterns, separated by semicolons.  */
 
-  while (*s != '\0')
+  do
     {
-      LONGEST x;
-      int val_bytes;
-
-      while (isspace (*s))
-	++s;
-
-      v = parse_to_comma_and_eval (&s);
-      val_bytes = TYPE_LENGTH (value_type (v));
+      char *end = find_pattern_end (s);
+      char saved = *end;
 
-      /* Keep it simple and assume size == 'g' when watching for when we
-	 need to grow the pattern buf.  */
-      if ((pattern_buf_end - pattern_buf + max (val_bytes, sizeof (int64_t)))
-	  > pattern_buf_size)
+      if (search->num_patterns == patterns_alloc)
 	{
-	  size_t current_offset = pattern_buf_end - pattern_buf;
-
-	  pattern_buf_size *= 2;
-	  pattern_buf = xrealloc (pattern_buf, pattern_buf_size);
-	  pattern_buf_end = pattern_buf + current_offset;
+	  patterns_alloc = patterns_alloc ? patterns_alloc * 2 : 4;
+	  search->patterns = xrealloc (search->patterns,
+				       (patterns_alloc
+					* sizeof (struct mem_search_pattern)));
 	}
 
-      if (size != '\0')
-	{
-	  x = value_as_long (v);
-	  switch (size)
-	    {
-	    case 'b':
-	      *pattern_buf_end++ = x;
-	      break;
-	    case 'h':
-	      put_bits (x, pattern_buf_end, 16, big_p);
-	      pattern_buf_end += sizeof (int16_t);
-	      break;
-	    case 'w':
-	      put_bits (x, pattern_buf_end, 32, big_p);
-	      pattern_buf_end += sizeof (int32_t);
-	      break;
-	    case 'g':
-	      put_bits (x, pattern_buf_end, 64, big_p);
-	      pattern_buf_end += sizeof (int64_t);
-	      break;
-	    }
-	}
-      else
-	{
-	  memcpy (pattern_buf_end, value_contents (v), val_bytes);
-	  pattern_buf_end += val_bytes;
-	}
+      *end = '\0';
+      parse_find_pattern (s, size, big_p,
+			  &search->patterns[search->num_patterns],
+			  &val_bytes);
+      *end = saved;
+      search->num_patterns++;
 
-      if (*s == ',')
-	++s;
-      while (isspace (*s))
+      s = end;
+      if (*s == ';')
 	++s;
     }
+  while (*s != '\0');
 
-  if (pattern_buf_end == pattern_buf)
-    error (_("Missing search pattern."));
-
-  pattern_len = pattern_buf_end - pattern_buf;
-
-  if (search_space_len < pattern_len)
+  min_len = search->patterns[0].len;
+  for (i = 1; i < search->num_patterns; i++)
+    if (search->patterns[i].len < min_len)
+      min_len = search->patterns[i].len;
+  if (search_space_len < min_len)
     error (_("Search space too small to contain pattern."));
 
-  *max_countp = max_count;
-  *pattern_bufp = pattern_buf;
-  *pattern_lenp = pattern_len;
+  if (align_p)
+    {
+      switch (size)
+	{
+	case 'b':
+	  search->align = 1;
+	  break;
+	case 'h':
+	  search->align = sizeof (int16_t);
+	  break;
+	case 'w':
+	  search->align = sizeof (int32_t);
+	  break;
+	case 'g':
+	  search->align = sizeof (int64_t);
+	  break;
+	default:
+	  search->align = val_bytes;
+	  break;
+	}
+    }
+
+  search->max_count = max_count;
   *start_addrp = start_addr;
   *search_space_lenp = search_space_len;
+}
 
-  /* We successfully parsed the arguments, leave the freeing of PATTERN_BUF
-     to the caller now.  */
-  discard_cleanups (old_cleanups);
+/* State of the "find" command's search, for find_command_found.  */
+
+struct find_command_state
+{
+  struct gdbarch *gdbarch;
+  const struct mem_search *search;
+  unsigned int found_count;
+  CORE_ADDR last_found_addr;
+};
+
+/* Print the match of pattern PATTERN at ADDR.  DATA is the
+   find_command_state.  */
+
+static int
+find_command_found (CORE_ADDR addr, int pattern, void *data)
+{
+  struct find_command_state *state = data;
+
+  print_address (state->gdbarch, addr, gdb_stdout);
+  if (state->search->num_patterns > 1)
+    printf_filtered (_(" (pattern %d)"), pattern + 1);
+  printf_filtered ("\n");
+  ++state->found_count;
+  state->last_found_addr = addr;
+
+  return 0;
 }
 
 static void
@@ -249,70 +432,52 @@ find_command (char *args, int from_tty)
   bfd_boolean big_p = gdbarch_byte_order (gdbarch) == BFD_ENDIAN_BIG;
   /* Command line parameters.
      These are initialized to avoid uninitialized warnings from -Wall.  */
-  ULONGEST max_count = 0;
-  char *pattern_buf = 0;
-  ULONGEST pattern_len = 0;
+  struct mem_search search;
   CORE_ADDR start_addr = 0;
   ULONGEST search_space_len = 0;
   /* End of command line parameters.  */
-  unsigned int found_count;
-  CORE_ADDR last_found_addr;
+  struct find_command_state state;
   struct cleanup *old_cleanups;
 
-  parse_find_args (args, &max_count, &pattern_buf, &pattern_len, 
-		   &start_addr, &search_space_len, big_p);
-
-  old_cleanups = make_cleanup (free_current_contents, &pattern_buf);
+  old_cleanups = make_cleanup (null_cleanup, NULL);
+  parse_find_args (args, &search, &start_addr, &search_space_len, big_p);
+  if (search.num_patterns == 0)
+    {
+      do_cleanups (old_cleanups);
+      return;
+    }
 
   /* Perform the search.  */
 
-  found_count = 0;
-  last_found_addr = 0;
+  state.gdbarch = gdbarch;
+  state.search = &search;
+  state.found_count = 0;
+  state.last_found_addr = 0;
 
-  while (search_space_len >= pattern_len
-	 && found_count < max_count)
+  if (search.max_count > 0)
     {
-      /* Offset from start of this iteration to the next iteration.  */
-      ULONGEST next_iter_incr;
-      CORE_ADDR found_addr;
-      int found = target_search_memory (start_addr, search_space_len,
-					pattern_buf, pattern_len, &found_addr);
-
-      if (found <= 0)
-	break;
-
-      print_address (gdbarch, found_addr, gdb_stdout);
-      printf_filtered ("\n");
-      ++found_count;
-      last_found_addr = found_addr;
-
-      /* Begin next iteration at one byte past this match.  */
-      next_iter_incr = (found_addr - start_addr) + 1;
-
-      /* For robustness, we don't let search_space_len go -ve here.  */
-      if (search_space_len >= next_iter_incr)
-	search_space_len -= next_iter_incr;
-      else
-	search_space_len = 0;
-      start_addr += next_iter_incr;
+      mem_search_prepare (&search);
+      target_search_memory_multi (&search, start_addr, search_space_len,
+				  find_command_found, &state);
     }
 
   /* Record and print the results.  */
 
-  set_internalvar_integer (lookup_internalvar ("numfound"), found_count);
-  if (found_count > 0)
+  set_internalvar_integer (lookup_internalvar ("numfound"),
+			   state.found_count);
+  if (state.found_count > 0)
     {
       struct type *ptr_type = builtin_type (gdbarch)->builtin_data_ptr;
 
       set_internalvar (lookup_internalvar ("_"),
-		       value_from_pointer (ptr_type, last_found_addr));
+		       value_from_pointer (ptr_type, state.last_found_addr));
     }
 
-  if (found_count == 0)
+  if (state.found_count == 0)
     printf_filtered ("Pattern not found.\n");
   else
-    printf_filtered ("%d pattern%s found.\n", found_count,
-		     found_count > 1 ? "s" : "");
+    printf_filtered ("%d pattern%s found.\n", state.found_count,
+		     state.found_count > 1 ? "s" : "");
 
   do_cleanups (old_cleanups);
 }
@@ -326,14 +491,19 @@ _initialize_mem_search (void)
   add_cmd ("find", class_vars, find_command, _("\
 Search memory for a sequence of bytes.\n\
 Usage:\nfind \
-[/size-char] [/max-count] start-address, end-address, expr1 [, expr2 ...]\n\
-find [/size-char] [/max-count] start-address, +length, expr1 [, expr2 ...]\n\
+[/size-char] [/max-count] [/a] start-address, end-address, expr1 [, expr2 ...]\n\
+find [/size-char] [/max-count] [/a] start-address, +length, expr1 [, expr2 ...]\n\
 size-char is one of b,h,w,g for 8,16,32,64 bit values respectively,\n\
 and if not specified the size is taken from the type of the expression\n\
 in the current language.\n\
 Note that this means for example that in the case of C-like languages\n\
 a search for an untyped 0x42 will search for \"(int) 0x42\"\n\
 which is typically four bytes.\n\
+An expression of \"?\" matches any value, of size size-char or a byte.\n\
+Several patterns, separated by \";\", are searched for in a single pass;\n\
+each match is then printed with the number of its pattern.\n\
+With /a, only matches at addresses that are a multiple of the size are\n\
+found, which is size-char or the size of the first expression.\n\
 \n\
 The address of the last match is stored as the value of \"$_\".\n\
 Convenience variable \"$numfound\" is set to the number of matches."),
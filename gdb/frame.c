@@ -44,6 +44,7 @@
 #include "block.h"
 #include "inline-frame.h"
 #include  "tracepoint.h"
+#include "hashtab.h"
 
 static struct frame_info *get_prev_frame_1 (struct frame_info *this_frame);
 static struct frame_info *get_prev_frame_raw (struct frame_info *this_frame);
@@ -131,16 +132,73 @@ struct frame_info
 
 /* A frame stash used to speed up frame lookups.  */
 
-/* We currently only stash one frame at a time, as this seems to be
-   sufficient for now.  */
-static struct frame_info *frame_stash = NULL;
+/* The stash holds every frame whose ID has been computed since the
+   frame cache was last flushed, hashed by frame ID.  Entries point
+   into FRAME_CACHE_OBSTACK, so the stash is emptied whenever that
+   obstack is.  */
+static htab_t frame_stash;
 
-/* Add the following FRAME to the frame stash.  */
+/* Statistics about the use of the frame stash, shown by "maint info
+   frame-stash".  */
+static unsigned int frame_stash_hits;
+static unsigned int frame_stash_misses;
+
+/* Hash frame ID.  Only the fields that are present take part, as
+   frame_id_eq treats missing ones as wildcards.  A lookup with a
+   wildcard ID may therefore miss a frame it would match; such
+   lookups fall back to walking the frame chain.  */
+
+static hashval_t
+frame_id_hash (struct frame_id id)
+{
+  hashval_t hash = 0;
+
+  if (id.stack_addr_p)
+    hash = iterative_hash (&id.stack_addr, sizeof (id.stack_addr), hash);
+  if (id.code_addr_p)
+    hash = iterative_hash (&id.code_addr, sizeof (id.code_addr), hash);
+  if (id.special_addr_p)
+    hash = iterative_hash (&id.special_addr, sizeof (id.special_addr),
+			   hash);
+  return iterative_hash (&id.inline_depth, sizeof (id.inline_depth), hash);
+}
+
+/* Hash function for the frame stash.  */
+
+static hashval_t
+frame_stash_hash (const void *p)
+{
+  const struct frame_info *frame = p;
+
+  return frame_id_hash (frame->this_id.value);
+}
+
+/* Equality function for the frame stash.  KEY is a pointer to a frame
+   ID.  */
+
+static int
+frame_stash_eq (const void *p, const void *key)
+{
+  const struct frame_info *frame = p;
+
+  return frame_id_eq (frame->this_id.value, *(const struct frame_id *) key);
+}
+
+/* Add the following FRAME to the frame stash.  FRAME's ID must have
+   been computed.  If a frame with an equal ID is already stashed, it
+   is kept: it is the one closer to the current frame, which is what
+   a walk of the frame chain would find first.  */
 
 static void
 frame_stash_add (struct frame_info *frame)
 {
-  frame_stash = frame;
+  void **slot;
+
+  slot = htab_find_slot_with_hash (frame_stash, &frame->this_id.value,
+				   frame_id_hash (frame->this_id.value),
+				   INSERT);
+  if (*slot == NULL)
+    *slot = frame;
 }
 
 /* Search the frame stash for an entry with the given frame ID.
@@ -149,10 +207,15 @@ frame_stash_add (struct frame_info *frame)
 static struct frame_info *
 frame_stash_find (struct frame_id id)
 {
-  if (frame_stash && frame_id_eq (frame_stash->this_id.value, id))
-    return frame_stash;
+  struct frame_info *frame;
 
-  return NULL;
+  frame = htab_find_with_hash (frame_stash, &id, frame_id_hash (id));
+  if (frame)
+    frame_stash_hits++;
+  else
+    frame_stash_misses++;
+
+  return frame;
 }
 
 /* Invalidate the frame stash by removing all entries in it.  */
@@ -160,7 +223,22 @@ frame_stash_find (struct frame_id id)
 static void
 frame_stash_invalidate (void)
 {
-  frame_stash = NULL;
+  htab_empty (frame_stash);
+}
+
+/* Implement the "maint info frame-stash" command.  */
+
+static void
+maintenance_info_frame_stash (char *args, int from_tty)
+{
+  printf_filtered (_("Frame stash entries: %lu\n"),
+		   (unsigned long) htab_elements (frame_stash));
+  printf_filtered (_("Frame stash size: %lu\n"),
+		   (unsigned long) htab_size (frame_stash));
+  printf_filtered (_("Frame stash lookups: %u\n"),
+		   frame_stash_hits + frame_stash_misses);
+  printf_filtered (_("Frame stash hits: %u\n"), frame_stash_hits);
+  printf_filtered (_("Frame stash misses: %u\n"), frame_stash_misses);
 }
 
 /* Flag to control debugging.  */
@@ -344,10 +422,9 @@ get_frame_id (struct frame_info *fi)
 	  fprint_frame_id (gdb_stdlog, fi->this_id.value);
 	  fprintf_unfiltered (gdb_stdlog, " }\n");
 	}
+      frame_stash_add (fi);
     }
 
-  frame_stash_add (fi);
-
   return fi->this_id.value;
 }
 
@@ -2427,6 +2504,9 @@ _initialize_frame (void)
 {
   obstack_init (&frame_cache_obstack);
 
+  frame_stash = htab_create_alloc (256, frame_stash_hash, frame_stash_eq,
+				   NULL, xcalloc, xfree);
+
   observer_attach_target_changed (frame_observer_target_changed);
 
   add_prefix_cmd ("backtrace", class_maintenance, set_backtrace_cmd, _("\
@@ -2485,4 +2565,8 @@ When non-zero, frame specific internal debugging is enabled."),
 			    NULL,
 			    show_frame_debug,
 			    &setdebuglist, &showdebuglist);
+
+  add_cmd ("frame-stash", class_maintenance, maintenance_info_frame_stash,
+	   _("Show statistics about the frame stash."),
+	   &maintenanceinfolist);
 }
@@ -33,6 +33,7 @@
 #include <fcntl.h>
 #include "regcache.h"
 #include "regset.h"
+#include "gdbthread.h"
 
 /* The largest amount of memory to read from the target at once.  We
    must throttle it to limit the amount of memory used by GDB during
@@ -43,6 +44,7 @@ static const char *default_gcore_target (void);
 static enum bfd_architecture default_gcore_arch (void);
 static unsigned long default_gcore_mach (void);
 static int gcore_memory_sections (bfd *);
+static void gcore_copy_callback (bfd *, asection *, void *);
 
 /* create_gcore_bfd -- helper for gcore_command (exported).
    Open a new bfd core file for output, and return the handle.  */
@@ -59,12 +61,12 @@ create_gcore_bfd (char *filename)
   return obfd;
 }
 
-/* write_gcore_file -- helper for gcore_command (exported).
-   Compose and write the corefile data to the core file.  */
-
+/* write_gcore_file_headers -- helper for write_gcore_file (exported).
+   Compose the corefile data and write the notes to the core file, but
+   leave the contents of the memory sections to the caller.  */
 
 void
-write_gcore_file (bfd *obfd)
+write_gcore_file_headers (bfd *obfd)
 {
   void *note_data = NULL;
   int note_size = 0;
@@ -102,6 +104,211 @@ write_gcore_file (bfd *obfd)
     }
 }
 
+/* write_gcore_file -- helper for gcore_command (exported).
+   Compose and write the corefile data to the core file.  */
+
+void
+write_gcore_file (bfd *obfd)
+{
+  write_gcore_file_headers (obfd);
+
+  /* Copy memory region contents.  */
+  bfd_map_over_sections (obfd, gcore_copy_callback, NULL);
+}
+
+/* The size of a long on the target, which the layouts of the notes
+   below depend on.  */
+
+static int
+gcore_long_size (void)
+{
+  return gdbarch_long_bit (target_gdbarch) / TARGET_CHAR_BIT;
+}
+
+/* Append an NT_PRSTATUS note for the thread LWP, stopped by the host
+   signal CURSIG, with the general registers GREGS of SIZE bytes.  BFD
+   can only write the host's prstatus_t, which a cross debugger may
+   not have; lay it out as the Linux kernel does instead.  */
+
+static char *
+gcore_write_prstatus (bfd *obfd, char *note_data, int *note_size,
+		      long lwp, int cursig, const gdb_byte *gregs, int size)
+{
+  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch);
+  int long_size = gcore_long_size ();
+  /* pr_info, pr_cursig, pr_sigpend, pr_sighold, pr_pid, pr_ppid,
+     pr_pgrp, pr_sid and four struct timevals precede pr_reg.  */
+  int pid_offset = 16 + 2 * long_size;
+  int reg_offset = pid_offset + 16 + 8 * long_size;
+  /* pr_fpvalid follows it.  */
+  int prstatus_size = ((reg_offset + size + 4 + long_size - 1)
+		       & -long_size);
+  gdb_byte *prstatus = xzalloc (prstatus_size);
+
+  store_signed_integer (prstatus, 4, byte_order, cursig);
+  store_signed_integer (prstatus + 12, 2, byte_order, cursig);
+  store_signed_integer (prstatus + pid_offset, 4, byte_order, lwp);
+  memcpy (prstatus + reg_offset, gregs, size);
+
+  note_data = elfcore_write_note (obfd, note_data, note_size, "CORE",
+				  NT_PRSTATUS, prstatus, prstatus_size);
+  xfree (prstatus);
+  return note_data;
+}
+
+/* Append an NT_PRPSINFO note for the program FNAME, run as PSARGS,
+   laid out as the Linux kernel does, for the same reason as above.
+   The user and group IDs are 16 bits wide on the 32-bit targets
+   GDBserver is commonly used with, 32 bits wide on 64-bit ones.  */
+
+static char *
+gcore_write_prpsinfo (bfd *obfd, char *note_data, int *note_size,
+		      const char *fname, const char *psargs)
+{
+  int long_size = gcore_long_size ();
+  /* pr_state, pr_sname, pr_zomb, pr_nice, pr_flag, pr_uid, pr_gid,
+     pr_pid, pr_ppid, pr_pgrp and pr_sid precede pr_fname.  */
+  int fname_offset = 2 * long_size + (long_size == 8 ? 8 : 4) + 16;
+  int prpsinfo_size = (fname_offset + 16 + 80 + long_size - 1) & -long_size;
+  gdb_byte *prpsinfo = xzalloc (prpsinfo_size);
+
+  strncpy ((char *) prpsinfo + fname_offset, fname, 16);
+  strncpy ((char *) prpsinfo + fname_offset + 16, psargs, 80);
+
+  note_data = elfcore_write_note (obfd, note_data, note_size, "CORE",
+				  NT_PRPSINFO, prpsinfo, prpsinfo_size);
+  xfree (prpsinfo);
+  return note_data;
+}
+
+/* Data for gcore_thread_notes_callback.  */
+
+struct gcore_thread_notes_data
+{
+  bfd *obfd;
+  char *note_data;
+  int *note_size;
+  enum target_signal stop_signal;
+};
+
+/* Append the notes of the registers of the thread PTID to the notes
+   in ARGS, using the register sets of the current architecture.  */
+
+static void
+gcore_thread_notes (ptid_t ptid, struct gcore_thread_notes_data *args)
+{
+  struct gdbarch *gdbarch = target_gdbarch;
+  struct regcache *regcache = get_thread_arch_regcache (ptid, gdbarch);
+  struct core_regset_section *sect_list;
+  struct cleanup *old_chain;
+  long lwp = ptid_get_lwp (ptid);
+
+  if (lwp == 0)
+    lwp = ptid_get_tid (ptid);
+  if (lwp == 0)
+    lwp = ptid_get_pid (ptid);
+
+  old_chain = save_inferior_ptid ();
+  inferior_ptid = ptid;
+  target_fetch_registers (regcache, -1);
+  do_cleanups (old_chain);
+
+  for (sect_list = gdbarch_core_regset_sections (gdbarch);
+       sect_list->sect_name != NULL;
+       sect_list++)
+    {
+      const struct regset *regset;
+      char *gdb_regset;
+
+      regset = gdbarch_regset_from_core_section (gdbarch,
+						 sect_list->sect_name,
+						 sect_list->size);
+      gdb_assert (regset && regset->collect_regset);
+      gdb_regset = xzalloc (sect_list->size);
+      regset->collect_regset (regset, regcache, -1,
+			      gdb_regset, sect_list->size);
+
+      if (strcmp (sect_list->sect_name, ".reg") == 0)
+	args->note_data = gcore_write_prstatus
+	  (args->obfd, args->note_data, args->note_size,
+	   lwp, target_signal_to_host (args->stop_signal),
+	   (gdb_byte *) gdb_regset, sect_list->size);
+      else
+	args->note_data = (char *) elfcore_write_register_note
+	  (args->obfd, args->note_data, args->note_size,
+	   sect_list->sect_name, gdb_regset, sect_list->size);
+      xfree (gdb_regset);
+    }
+}
+
+static int
+gcore_thread_notes_callback (struct thread_info *info, void *data)
+{
+  /* The current thread comes first; see gcore_make_regset_notes.  */
+  if (ptid_get_pid (info->ptid) == ptid_get_pid (inferior_ptid)
+      && !ptid_equal (info->ptid, inferior_ptid))
+    gcore_thread_notes (info->ptid, data);
+
+  return 0;
+}
+
+static int
+gcore_find_signalled_thread (struct thread_info *info, void *data)
+{
+  return (info->suspend.stop_signal != TARGET_SIGNAL_0
+	  && ptid_get_pid (info->ptid) == ptid_get_pid (inferior_ptid));
+}
+
+/* gcore_make_regset_notes -- implements to_make_corefile_notes for
+   targets that know no more about the inferior than its threads,
+   registers and memory, such as the remote target (exported).  Build
+   the notes for the process, its threads and auxiliary vector, writing
+   the registers with the register sets of the current architecture,
+   and return them in a malloc buffer.  */
+
+char *
+gcore_make_regset_notes (bfd *obfd, int *note_size)
+{
+  struct gcore_thread_notes_data args;
+  struct thread_info *info;
+  char *exec_file = get_exec_file (0);
+  gdb_byte *auxv;
+  int auxv_len;
+
+  if (!gdbarch_regset_from_core_section_p (target_gdbarch)
+      || gdbarch_core_regset_sections (target_gdbarch) == NULL)
+    error (_("Can't create a corefile"));
+
+  args.obfd = obfd;
+  args.note_data = NULL;
+  args.note_size = note_size;
+
+  if (exec_file != NULL)
+    args.note_data = gcore_write_prpsinfo (obfd, args.note_data, note_size,
+					   lbasename (exec_file), exec_file);
+
+  info = iterate_over_threads (gcore_find_signalled_thread, NULL);
+  args.stop_signal = info != NULL ? info->suspend.stop_signal
+				  : TARGET_SIGNAL_0;
+
+  /* Readers of the core file take the first thread for the current
+     one.  */
+  gcore_thread_notes (inferior_ptid, &args);
+  iterate_over_threads (gcore_thread_notes_callback, &args);
+
+  auxv_len = target_read_alloc (&current_target, TARGET_OBJECT_AUXV,
+				NULL, &auxv);
+  if (auxv_len > 0)
+    {
+      args.note_data = elfcore_write_note (obfd, args.note_data, note_size,
+					   "CORE", NT_AUXV, auxv, auxv_len);
+      xfree (auxv);
+    }
+
+  make_cleanup (xfree, args.note_data);
+  return args.note_data;
+}
+
 static void
 do_bfd_delete_cleanup (void *arg)
 {
@@ -508,6 +715,20 @@ objfile_find_memory_regions (find_memory_region_ftype func, void *obfd)
   return 0;
 }
 
+/* Return non-zero if the contents of OSEC, a section of the core file
+   OBFD, are to be copied from target memory.  */
+
+int
+gcore_memory_section_p (bfd *obfd, asection *osec)
+{
+  /* Read-only sections are marked; we don't have to copy their contents.  */
+  if ((bfd_get_section_flags (obfd, osec) & SEC_LOAD) == 0)
+    return 0;
+
+  /* Only interested in "load" sections.  */
+  return strncmp ("load", bfd_section_name (obfd, osec), 4) == 0;
+}
+
 static void
 gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
 {
@@ -516,12 +737,7 @@ gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
   struct cleanup *old_chain = NULL;
   void *memhunk;
 
-  /* Read-only sections are marked; we don't have to copy their contents.  */
-  if ((bfd_get_section_flags (obfd, osec) & SEC_LOAD) == 0)
-    return;
-
-  /* Only interested in "load" sections.  */
-  if (strncmp ("load", bfd_section_name (obfd, osec), 4) != 0)
+  if (!gcore_memory_section_p (obfd, osec))
     return;
 
   size = min (total_size, MAX_COPY_BYTES);
@@ -565,9 +781,6 @@ gcore_memory_sections (bfd *obfd)
   /* Record phdrs for section-to-segment mapping.  */
   bfd_map_over_sections (obfd, make_output_phdrs, NULL);
 
-  /* Copy memory region contents.  */
-  bfd_map_over_sections (obfd, gcore_copy_callback, NULL);
-
   return 1;
 }
 
@@ -22,6 +22,9 @@
 
 extern bfd *create_gcore_bfd (char *filename);
 extern void write_gcore_file (bfd *obfd);
+extern void write_gcore_file_headers (bfd *obfd);
+extern int gcore_memory_section_p (bfd *obfd, asection *osec);
+extern char *gcore_make_regset_notes (bfd *obfd, int *note_size);
 extern bfd *load_corefile (char *filename, int from_tty);
 
 #endif /* GCORE_H */
@@ -24,6 +24,7 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 extern int remote_debug;
 
@@ -109,6 +110,38 @@ require_int (char **pp, int *value)
   return 0;
 }
 
+/* Like require_int, but for file offsets, which may exceed the range
+   of an int.  */
+
+static int
+require_offset (char **pp, LONGEST *value)
+{
+  char *p;
+  int count;
+
+  p = *pp;
+  *value = 0;
+  count = 0;
+
+  while (*p && *p != ',')
+    {
+      int nib;
+
+      /* Don't allow overflow.  */
+      if (count >= 15)
+	return -1;
+
+      if (safe_fromhex (p[0], &nib))
+	return -1;
+      *value = *value * 16 + nib;
+      p++;
+      count++;
+    }
+
+  *pp = p;
+  return 0;
+}
+
 static int
 require_data (char *p, int p_len, char **data, int *data_len)
 {
@@ -304,10 +337,26 @@ handle_open (char *own_buf)
   hostio_reply (own_buf, fd);
 }
 
+/* Write up to LEN bytes of DATA to FD at OFFSET.  Return the number of
+   bytes written, or -1 if an error occurs.  */
+
+static int
+hostio_pwrite (int fd, const void *data, int len, LONGEST offset)
+{
+#ifdef HAVE_PWRITE
+  return pwrite (fd, data, len, offset);
+#else
+  if (lseek (fd, offset, SEEK_SET) == -1)
+    return -1;
+  return write (fd, data, len);
+#endif
+}
+
 static void
 handle_pread (char *own_buf, int *new_packet_len)
 {
-  int fd, ret, len, offset, bytes_sent;
+  int fd, ret, len, bytes_sent;
+  LONGEST offset;
   char *p, *data;
 
   p = own_buf + strlen ("vFile:pread:");
@@ -317,7 +366,7 @@ handle_pread (char *own_buf, int *new_packet_len)
       || require_valid_fd (fd)
       || require_int (&p, &len)
       || require_comma (&p)
-      || require_int (&p, &offset)
+      || require_offset (&p, &offset)
       || require_end (p))
     {
       hostio_packet_error (own_buf);
@@ -357,7 +406,8 @@ handle_pread (char *own_buf, int *new_packet_len)
 static void
 handle_pwrite (char *own_buf, int packet_len)
 {
-  int fd, ret, len, offset;
+  int fd, ret, len;
+  LONGEST offset;
   char *p, *data;
 
   p = own_buf + strlen ("vFile:pwrite:");
@@ -365,7 +415,7 @@ handle_pwrite (char *own_buf, int packet_len)
   if (require_int (&p, &fd)
       || require_comma (&p)
       || require_valid_fd (fd)
-      || require_int (&p, &offset)
+      || require_offset (&p, &offset)
       || require_comma (&p)
       || require_data (p, packet_len - (p - own_buf), &data, &len))
     {
@@ -373,14 +423,7 @@ handle_pwrite (char *own_buf, int packet_len)
       return;
     }
 
-#ifdef HAVE_PWRITE
-  ret = pwrite (fd, data, len, offset);
-#else
-  ret = lseek (fd, offset, SEEK_SET);
-  if (ret != -1)
-    ret = write (fd, data, len);
-#endif
-
+  ret = hostio_pwrite (fd, data, len, offset);
   if (ret == -1)
     {
       hostio_error (own_buf);
@@ -392,6 +435,149 @@ handle_pwrite (char *own_buf, int packet_len)
   free (data);
 }
 
+/* The amount of memory handle_pwritemem reads at once, and the size of
+   the blocks of zeros it leaves as holes in the file.  */
+#define PWRITEMEM_BUFSIZ (64 * 1024)
+#define PWRITEMEM_BLOCK_SIZE 4096
+
+static int
+zero_block_p (const unsigned char *buf, int len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+    if (buf[i] != 0)
+      return 0;
+
+  return 1;
+}
+
+/* Write all LEN bytes of BUF to FD at OFFSET.  Return 0, or -1 if an
+   error occurs.  */
+
+static int
+hostio_pwrite_all (int fd, const unsigned char *buf, int len,
+		   LONGEST offset)
+{
+  while (len > 0)
+    {
+      int ret = hostio_pwrite (fd, buf, len, offset);
+
+      if (ret == -1)
+	return -1;
+
+      buf += ret;
+      len -= ret;
+      offset += ret;
+    }
+
+  return 0;
+}
+
+/* Handle vFile:pwritemem, which writes inferior memory to an open file,
+   so that GDB can have a core file written on the target without the
+   memory crossing the link.  Blocks of zeros are skipped, leaving
+   holes in the file; GDB creates the file empty, so they read back as
+   zeros.  The reply is the number of bytes written, which is short if
+   some of the memory could not be read.  */
+
+static void
+handle_pwritemem (char *own_buf)
+{
+  int fd, len, done;
+  LONGEST offset;
+  ULONGEST addr;
+  unsigned char *buf;
+  char *p;
+
+  p = own_buf + strlen ("vFile:pwritemem:");
+
+  if (require_int (&p, &fd)
+      || require_comma (&p)
+      || require_valid_fd (fd)
+      || require_offset (&p, &offset)
+      || require_comma (&p))
+    {
+      hostio_packet_error (own_buf);
+      return;
+    }
+  p = unpack_varlen_hex (p, &addr);
+  if (require_comma (&p)
+      || require_int (&p, &len)
+      || require_end (p))
+    {
+      hostio_packet_error (own_buf);
+      return;
+    }
+
+  buf = xmalloc (PWRITEMEM_BUFSIZ);
+
+  done = 0;
+  while (done < len)
+    {
+      int size = len - done;
+      int start, end;
+
+      if (size > PWRITEMEM_BUFSIZ)
+	size = PWRITEMEM_BUFSIZ;
+      if (gdb_read_memory (addr + done, buf, size) != size)
+	break;
+
+      /* Write out each run of blocks that are not all zeros.  */
+      for (start = 0; start < size; start = end)
+	{
+	  int block = PWRITEMEM_BLOCK_SIZE;
+
+	  if (block > size - start)
+	    block = size - start;
+	  if (zero_block_p (buf + start, block))
+	    {
+	      end = start + block;
+	      continue;
+	    }
+
+	  for (end = start + block; end < size; end += block)
+	    {
+	      block = PWRITEMEM_BLOCK_SIZE;
+	      if (block > size - end)
+		block = size - end;
+	      if (zero_block_p (buf + end, block))
+		break;
+	    }
+
+	  if (hostio_pwrite_all (fd, buf + start, end - start,
+				 offset + done + start) != 0)
+	    {
+	      hostio_error (own_buf);
+	      free (buf);
+	      return;
+	    }
+	}
+
+      done += size;
+    }
+
+  free (buf);
+
+  /* If the memory ended with zeros, the file may still be short of
+     them; write the last byte to extend it.  */
+  if (done > 0)
+    {
+      unsigned char zero = 0;
+      struct stat st;
+
+      if (fstat (fd, &st) != 0
+	  || (st.st_size < offset + done
+	      && hostio_pwrite_all (fd, &zero, 1, offset + done - 1) != 0))
+	{
+	  hostio_error (own_buf);
+	  return;
+	}
+    }
+
+  hostio_reply (own_buf, done);
+}
+
 static void
 handle_close (char *own_buf)
 {
@@ -465,6 +651,8 @@ handle_vFile (char *own_buf, int packet_len, int *new_packet_len)
     handle_open (own_buf);
   else if (strncmp (own_buf, "vFile:pread:", 11) == 0)
     handle_pread (own_buf, new_packet_len);
+  else if (strncmp (own_buf, "vFile:pwritemem:", 16) == 0)
+    handle_pwritemem (own_buf);
   else if (strncmp (own_buf, "vFile:pwrite:", 12) == 0)
     handle_pwrite (own_buf, packet_len);
   else if (strncmp (own_buf, "vFile:close:", 12) == 0)
@@ -32,16 +32,71 @@ struct thread_info *current_inferior;
 #define get_thread(inf) ((struct thread_info *)(inf))
 #define get_dll(inf) ((struct dll_info *)(inf))
 
+/* Initial number of hash buckets of an inferior_list.  */
+#define INFERIOR_LIST_INITIAL_BUCKETS 64
+
+/* Return the hash bucket of ID in LIST.  */
+
+static struct inferior_list_entry **
+inferior_list_bucket (struct inferior_list *list, ptid_t id)
+{
+  unsigned int hash;
+
+  hash = ptid_get_pid (id);
+  hash = hash * 31 + ptid_get_lwp (id);
+  hash = hash * 31 + ptid_get_tid (id);
+
+  return &list->buckets[hash % list->num_buckets];
+}
+
+/* (Re)build the hash table of LIST with NUM_BUCKETS buckets.  */
+
+static void
+rehash_inferior_list (struct inferior_list *list, int num_buckets)
+{
+  struct inferior_list_entry *inf;
+
+  free (list->buckets);
+  list->buckets = xcalloc (num_buckets, sizeof (list->buckets[0]));
+  list->num_buckets = num_buckets;
+
+  /* Walk the list in order, so that each bucket ends up with the most
+     recently added entries first, like add_inferior_to_list leaves
+     it.  */
+  for (inf = list->head; inf != NULL; inf = inf->next)
+    {
+      struct inferior_list_entry **bucket
+	= inferior_list_bucket (list, inf->id);
+
+      inf->hash_next = *bucket;
+      *bucket = inf;
+    }
+}
+
 void
 add_inferior_to_list (struct inferior_list *list,
 		      struct inferior_list_entry *new_inferior)
 {
+  struct inferior_list_entry **bucket;
+
   new_inferior->next = NULL;
   if (list->tail != NULL)
     list->tail->next = new_inferior;
   else
     list->head = new_inferior;
   list->tail = new_inferior;
+
+  list->count++;
+  if (list->buckets == NULL)
+    rehash_inferior_list (list, INFERIOR_LIST_INITIAL_BUCKETS);
+  else if (list->count > 2 * list->num_buckets)
+    rehash_inferior_list (list, 2 * list->num_buckets);
+  else
+    {
+      bucket = inferior_list_bucket (list, new_inferior->id);
+      new_inferior->hash_next = *bucket;
+      *bucket = new_inferior;
+    }
 }
 
 /* Invoke ACTION for each inferior in LIST.  */
@@ -60,12 +115,40 @@ for_each_inferior (struct inferior_list *list,
     }
 }
 
+/* Remove ENTRY from the hash table of LIST.  Returns non-zero if it
+   was found.  */
+
+static int
+unhash_inferior (struct inferior_list *list,
+		 struct inferior_list_entry *entry)
+{
+  struct inferior_list_entry **cur;
+
+  if (list->buckets == NULL)
+    return 0;
+
+  for (cur = inferior_list_bucket (list, entry->id);
+       *cur != NULL;
+       cur = &(*cur)->hash_next)
+    if (*cur == entry)
+      {
+	*cur = entry->hash_next;
+	list->count--;
+	return 1;
+      }
+
+  return 0;
+}
+
 void
 remove_inferior (struct inferior_list *list,
 		 struct inferior_list_entry *entry)
 {
   struct inferior_list_entry **cur;
 
+  if (!unhash_inferior (list, entry))
+    return;
+
   if (list->head == entry)
     {
       list->head = entry->next;
@@ -87,6 +170,18 @@ remove_inferior (struct inferior_list *list,
     list->tail = *cur;
 }
 
+/* Forget all entries of LIST, without freeing them.  */
+
+static void
+clear_list (struct inferior_list *list)
+{
+  list->head = list->tail = NULL;
+  free (list->buckets);
+  list->buckets = NULL;
+  list->num_buckets = 0;
+  list->count = 0;
+}
+
 void
 add_thread (ptid_t thread_id, void *target_data)
 {
@@ -110,14 +205,8 @@ add_thread (ptid_t thread_id, void *target_data)
 ptid_t
 thread_id_to_gdb_id (ptid_t thread_id)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, thread_id))
-	return thread_id;
-      inf = inf->next;
-    }
+  if (find_inferior_id (&all_threads, thread_id) != NULL)
+    return thread_id;
 
   return null_ptid;
 }
@@ -131,17 +220,7 @@ thread_to_gdb_id (struct thread_info *thread)
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      struct thread_info *thread = get_thread (inf);
-      if (ptid_equal (thread->entry.id, ptid))
-	return thread;
-      inf = inf->next;
-    }
-
-  return NULL;
+  return get_thread (find_inferior_id (&all_threads, ptid));
 }
 
 ptid_t
@@ -189,19 +268,26 @@ find_inferior (struct inferior_list *list,
   return NULL;
 }
 
+/* Find the first entry of LIST whose id is ID, or NULL.  */
+
 struct inferior_list_entry *
 find_inferior_id (struct inferior_list *list, ptid_t id)
 {
-  struct inferior_list_entry *inf = list->head;
+  struct inferior_list_entry *inf, *found = NULL;
 
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, id))
-	return inf;
-      inf = inf->next;
-    }
+  if (list->buckets == NULL)
+    return NULL;
 
-  return NULL;
+  /* Buckets hold the most recently added entries first; keep the
+     last match, to return the same entry a walk of the list
+     would.  */
+  for (inf = *inferior_list_bucket (list, id);
+       inf != NULL;
+       inf = inf->hash_next)
+    if (ptid_equal (inf->id, id))
+      found = inf;
+
+  return found;
 }
 
 void *
@@ -308,9 +394,6 @@ unloaded_dll (const char *name, CORE_ADDR base_addr)
     }
 }
 
-#define clear_list(LIST) \
-  do { (LIST)->head = (LIST)->tail = NULL; } while (0)
-
 void
 clear_inferiors (void)
 {
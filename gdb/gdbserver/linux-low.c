@@ -126,8 +126,22 @@ struct inferior_list all_lwps;
 
 struct inferior_list stopped_pids;
 
+/* Whether stop_all_lwps is in progress, and whether it also
+   suspends the LWPs it stops.  */
+enum stopping_threads_kind
+  {
+    /* Not stopping threads presently.  */
+    NOT_STOPPING_THREADS,
+
+    /* Stopping threads.  */
+    STOPPING_THREADS,
+
+    /* Stopping and suspending threads.  */
+    STOPPING_AND_SUSPENDING_THREADS
+  };
+
 /* FIXME this is a bit of a hack, and could be removed.  */
-int stopping_threads;
+enum stopping_threads_kind stopping_threads = NOT_STOPPING_THREADS;
 
 /* FIXME make into a target method?  */
 int using_threads = 1;
@@ -159,6 +173,7 @@ static int finish_step_over (struct lwp_info *lwp);
 static CORE_ADDR get_stop_pc (struct lwp_info *lwp);
 static int kill_lwp (unsigned long lwpid, int signo);
 static void linux_enable_event_reporting (int pid);
+static void free_svr4_lm_entries (struct svr4_lm_entry *entries, int count);
 
 /* True if the low target can hardware single-step.  Such targets
    don't need a BREAKPOINT_REINSERT_ADDR callback.  */
@@ -202,6 +217,12 @@ struct pending_signals
 #ifdef HAVE_LINUX_REGSETS
 static char *disabled_regsets;
 static int num_regsets;
+
+/* For each register of the current register cache layout and each
+   regset, non-zero if the regset holds the register, indexed by the
+   register number times NUM_REGSETS plus the regset's index in
+   target_regsets.  Computed when first needed.  */
+static char *regset_registers;
 #endif
 
 /* The read/write ends of the pipe registered as waitable file in the
@@ -299,6 +320,7 @@ linux_add_process (int pid, int attached)
 
   proc = add_process (pid, attached);
   proc->private = xcalloc (1, sizeof (*proc->private));
+  proc->private->mem_fd = -1;
 
   if (the_low_target.new_process != NULL)
     proc->private->arch_private = the_low_target.new_process ();
@@ -426,18 +448,28 @@ handle_extended_wait (struct lwp_info *event_child, int wstat)
       new_lwp = (struct lwp_info *) add_lwp (ptid);
       add_thread (ptid, new_lwp);
 
+#ifdef USE_THREAD_DB
+      thread_db_notice_clone (ptid);
+#endif
+
       /* Either we're going to immediately resume the new thread
 	 or leave it stopped.  linux_resume_one_lwp is a nop if it
 	 thinks the thread is currently running, so set this first
 	 before calling linux_resume_one_lwp.  */
       new_lwp->stopped = 1;
 
+      /* If we're suspending all threads, leave this one suspended
+	 too.  The matching unstop_all_lwps call unsuspends every LWP,
+	 including the ones created meanwhile.  */
+      if (stopping_threads == STOPPING_AND_SUSPENDING_THREADS)
+	new_lwp->suspended = 1;
+
       /* Normally we will get the pending SIGSTOP.  But in some cases
 	 we might get another signal delivered to the group first.
 	 If we do get another signal, be sure not to lose it.  */
       if (WSTOPSIG (status) == SIGSTOP)
 	{
-	  if (stopping_threads)
+	  if (stopping_threads != NOT_STOPPING_THREADS)
 	    new_lwp->stop_pc = get_stop_pc (new_lwp);
 	  else
 	    linux_resume_one_lwp (new_lwp, 0, 0, NULL);
@@ -446,7 +478,7 @@ handle_extended_wait (struct lwp_info *event_child, int wstat)
 	{
 	  new_lwp->stop_expected = 1;
 
-	  if (stopping_threads)
+	  if (stopping_threads != NOT_STOPPING_THREADS)
 	    {
 	      new_lwp->stop_pc = get_stop_pc (new_lwp);
 	      new_lwp->status_pending_p = 1;
@@ -1043,6 +1075,10 @@ linux_mourn (struct process_info *process)
 
   /* Freeing all private data.  */
   priv = process->private;
+  if (priv->mem_fd != -1)
+    close (priv->mem_fd);
+  free_svr4_lm_entries (priv->lm_entries, priv->lm_entries_count);
+  free (priv->libraries_svr4_doc);
   free (priv->arch_private);
   free (priv);
   process->private = NULL;
@@ -1183,6 +1219,8 @@ retry:
       the_low_target.arch_setup ();
 #ifdef HAVE_LINUX_REGSETS
       memset (disabled_regsets, 0, num_regsets);
+      /* The register cache layout may have changed.  */
+      linux_regsets_changed ();
 #endif
       new_inferior = 0;
     }
@@ -1397,6 +1435,7 @@ Checking whether LWP %ld needs to move out of the jump pad...it does\n",
 	    {
 	      siginfo_t info;
 	      struct regcache *regcache;
+	      CORE_ADDR thread_area;
 
 	      /* The si_addr on a few signals references the address
 		 of the faulting instruction.  Adjust that as
@@ -1420,7 +1459,9 @@ Checking whether LWP %ld needs to move out of the jump pad...it does\n",
 
 	      /* Cancel any fast tracepoint lock this thread was
 		 holding.  */
-	      force_unlock_trace_buffer ();
+	      if ((*the_low_target.get_thread_area) (lwpid_of (lwp),
+						    &thread_area) == 0)
+		force_unlock_trace_buffer (thread_area);
 	    }
 
 	  if (lwp->exit_jump_pad_bkpt != NULL)
@@ -1636,7 +1677,7 @@ linux_wait_for_event_1 (ptid_t ptid, int *wstat, int options)
     {
       requested_child = find_lwp_pid (ptid);
 
-      if (!stopping_threads
+      if (stopping_threads == NOT_STOPPING_THREADS
 	  && requested_child->status_pending_p
 	  && requested_child->collecting_fast_tracepoint)
 	{
@@ -1702,6 +1743,10 @@ linux_wait_for_event_1 (ptid_t ptid, int *wstat, int options)
 	      return lwpid_of (event_child);
 	    }
 
+#ifdef USE_THREAD_DB
+	  thread_db_notice_exit (event_child->head.id);
+#endif
+
 	  if (!non_stop)
 	    {
 	      current_inferior = (struct thread_info *) all_threads.head;
@@ -1760,7 +1805,7 @@ linux_wait_for_event_1 (ptid_t ptid, int *wstat, int options)
 	  event_child->stop_expected = 0;
 
 	  should_stop = (current_inferior->last_resume_kind == resume_stop
-			 || stopping_threads);
+			 || stopping_threads != NOT_STOPPING_THREADS);
 
 	  if (!should_stop)
 	    {
@@ -2431,13 +2476,17 @@ Check if we're already there.\n",
      not support Z0 breakpoints.  If we do, we're be able to handle
      GDB breakpoints on top of internal breakpoints, by handling the
      internal breakpoint and still reporting the event to GDB.  If we
-     don't, we're out of luck, GDB won't see the breakpoint hit.  */
+     don't, we're out of luck, GDB won't see the breakpoint hit.  A
+     GDB breakpoint whose conditions we evaluate and find false is
+     handled like one of our own: GDB never hears about it.  */
   report_to_gdb = (!maybe_internal_trap
 		   || current_inferior->last_resume_kind == resume_step
 		   || event_child->stopped_by_watchpoint
 		   || (!step_over_finished
 		       && !bp_explains_trap && !trace_event)
-		   || gdb_breakpoint_here (event_child->stop_pc));
+		   || (gdb_breakpoint_here (event_child->stop_pc)
+		       && gdb_condition_true_at_breakpoint
+			    (event_child->stop_pc)));
 
   /* We found no reason GDB would want us to stop.  We either hit one
      of our own breakpoints, or finished an internal step GDB
@@ -2446,7 +2495,9 @@ Check if we're already there.\n",
     {
       if (debug_threads)
 	{
-	  if (bp_explains_trap)
+	  if (gdb_breakpoint_here (event_child->stop_pc))
+	    fprintf (stderr, "Hit a GDB breakpoint whose condition is false.\n");
+	  else if (bp_explains_trap)
 	    fprintf (stderr, "Hit a gdbserver breakpoint.\n");
 	  if (step_over_finished)
 	    fprintf (stderr, "Step-over finished.\n");
@@ -2901,14 +2952,16 @@ lwp_running (struct inferior_list_entry *entry, void *data)
 static void
 stop_all_lwps (int suspend, struct lwp_info *except)
 {
-  stopping_threads = 1;
+  stopping_threads = (suspend
+		      ? STOPPING_AND_SUSPENDING_THREADS
+		      : STOPPING_THREADS);
 
   if (suspend)
     find_inferior (&all_lwps, suspend_and_send_sigstop_callback, except);
   else
     find_inferior (&all_lwps, send_sigstop_callback, except);
   for_each_inferior (&all_lwps, wait_for_sigstop);
-  stopping_threads = 0;
+  stopping_threads = NOT_STOPPING_THREADS;
 }
 
 /* Resume execution of the inferior process.
@@ -3300,8 +3353,10 @@ need_step_over_p (struct inferior_list_entry *entry, void *dummy)
   if (breakpoint_here (pc) || fast_tracepoint_jump_here (pc))
     {
       /* Don't step over a breakpoint that GDB expects to hit
-	 though.  */
-      if (gdb_breakpoint_here (pc))
+	 though, unless its condition says GDB wouldn't be told
+	 about the hit.  */
+      if (gdb_breakpoint_here (pc)
+	  && gdb_condition_true_at_breakpoint (pc))
 	{
 	  if (debug_threads)
 	    fprintf (stderr,
@@ -3903,14 +3958,17 @@ usr_fetch_inferior_registers (struct regcache *regcache, int regno)
 }
 
 /* Store our register values back into the inferior.
-   If REGNO is -1, do this for all registers.
+   If REGNO is -1, do this for all registers that were fetched.
    Otherwise, REGNO specifies which register (so we can save time).  */
 static void
 usr_store_inferior_registers (struct regcache *regcache, int regno)
 {
   if (regno == -1)
-    for (regno = 0; regno < the_low_target.num_regs; regno++)
-      store_register (regcache, regno);
+    {
+      for (regno = 0; regno < the_low_target.num_regs; regno++)
+	if (regcache->register_status[regno] != REG_UNKNOWN)
+	  store_register (regcache, regno);
+    }
   else
     store_register (regcache, regno);
 }
@@ -3920,14 +3978,107 @@ usr_store_inferior_registers (struct regcache *regcache, int regno)
 
 #ifdef HAVE_LINUX_REGSETS
 
+/* Compute regset_registers for the current register cache layout:
+   see which registers each regset supplies to a cache none of whose
+   registers are valid.  */
+
+static void
+compute_regset_registers (void)
+{
+  struct regcache *regcache = new_register_cache ();
+  int num_regs = register_count ();
+  int i, regno;
+
+  regset_registers = xcalloc (num_regs, num_regsets);
+  for (i = 0; i < num_regsets; i++)
+    {
+      struct regset_info *regset = &target_regsets[i];
+      void *buf;
+
+      if (regset->size == 0)
+	continue;
+
+      buf = xcalloc (1, regset->size);
+      supply_regblock (regcache, NULL);
+      regset->store_function (regcache, buf);
+      free (buf);
+
+      for (regno = 0; regno < num_regs; regno++)
+	if (regcache->register_status[regno] == REG_VALID)
+	  regset_registers[regno * num_regsets + i] = 1;
+    }
+  free_register_cache (regcache);
+}
+
+void
+linux_regsets_changed (void)
+{
+  free (regset_registers);
+  regset_registers = NULL;
+}
+
+/* Return non-zero if the regset at index SET of target_regsets
+   holds register REGNO.  */
+
 static int
-regsets_fetch_inferior_registers (struct regcache *regcache)
+regset_has_register (int set, int regno)
+{
+  if (regset_registers == NULL)
+    compute_regset_registers ();
+
+  return regset_registers[regno * num_regsets + set];
+}
+
+/* Return non-zero if register REGNO is in none of the regsets,
+   which then all need to be read to fetch it.  */
+
+static int
+register_in_no_regset (int regno)
+{
+  int i;
+
+  for (i = 0; i < num_regsets; i++)
+    if (regset_has_register (i, regno))
+      return 0;
+  return 1;
+}
+
+/* Return non-zero if no register of the regset at index SET has been
+   fetched into REGCACHE or written to it.  A regset that seems to
+   hold no register at all doesn't count as unknown.  */
+
+static int
+regset_unknown_p (struct regcache *regcache, int set)
+{
+  int num_regs = register_count ();
+  int regno;
+  int seen = 0;
+
+  for (regno = 0; regno < num_regs; regno++)
+    if (regset_has_register (set, regno))
+      {
+	if (regcache->register_status[regno] != REG_UNKNOWN)
+	  return 0;
+	seen = 1;
+      }
+  return seen;
+}
+
+/* Fetch the regsets that hold register REGNO, or all regsets if
+   REGNO is -1.  Return 0 if the general registers were fetched or
+   weren't needed, 1 if they should be fetched some other way.  */
+
+static int
+regsets_fetch_inferior_registers (struct regcache *regcache, int regno)
 {
   struct regset_info *regset;
   int saw_general_regs = 0;
   int pid;
   struct iovec iov;
 
+  if (regno != -1 && register_in_no_regset (regno))
+    regno = -1;
+
   regset = target_regsets;
 
   pid = lwpid_of (get_thread_lwp (current_inferior));
@@ -3942,6 +4093,15 @@ regsets_fetch_inferior_registers (struct regcache *regcache)
 	  continue;
 	}
 
+      if (regno != -1
+	  && !regset_has_register (regset - target_regsets, regno))
+	{
+	  if (regset->type == GENERAL_REGS)
+	    saw_general_regs = 1;
+	  regset ++;
+	  continue;
+	}
+
       buf = xmalloc (regset->size);
 
       nt_type = regset->nt_type;
@@ -3991,6 +4151,11 @@ regsets_fetch_inferior_registers (struct regcache *regcache)
     return 1;
 }
 
+/* Store the regsets some of whose registers have been fetched into
+   REGCACHE or written to it.  Return 0 if the general registers were
+   stored or didn't need to be, 1 if they should be stored some other
+   way.  */
+
 static int
 regsets_store_inferior_registers (struct regcache *regcache)
 {
@@ -4013,6 +4178,15 @@ regsets_store_inferior_registers (struct regcache *regcache)
 	  continue;
 	}
 
+      /* There's nothing to write back if the regset was never read.  */
+      if (regset_unknown_p (regcache, regset - target_regsets))
+	{
+	  if (regset->type == GENERAL_REGS)
+	    saw_general_regs = 1;
+	  regset ++;
+	  continue;
+	}
+
       buf = xmalloc (regset->size);
 
       /* First fill the buffer with the current register set contents,
@@ -4095,7 +4269,7 @@ void
 linux_fetch_registers (struct regcache *regcache, int regno)
 {
 #ifdef HAVE_LINUX_REGSETS
-  if (regsets_fetch_inferior_registers (regcache) == 0)
+  if (regsets_fetch_inferior_registers (regcache, regno) == 0)
     return;
 #endif
 #ifdef HAVE_LINUX_USRREGS
@@ -4116,6 +4290,116 @@ linux_store_registers (struct regcache *regcache, int regno)
 }
 
 
+#ifdef __NR_process_vm_readv
+
+/* Non-zero if the process_vm_readv/process_vm_writev syscalls are
+   known to be unimplemented by the running kernel.  */
+static int process_vm_unsupported;
+
+/* Transfer LEN bytes between debugger memory at MYADDR and the
+   address space of LWP PID at MEMADDR using process_vm_readv (if
+   WRITE is zero) or process_vm_writev.  Returns 0 if the whole range
+   was transferred, -1 otherwise.  Neither call can write to
+   read-only mappings or read PROT_NONE ones, so the caller must be
+   prepared to fall back to /proc or ptrace.  */
+
+static int
+linux_process_vm_xfer (int pid, CORE_ADDR memaddr, unsigned char *myaddr,
+		       int len, int write)
+{
+  struct iovec local, remote;
+  long ret;
+
+  if (process_vm_unsupported)
+    return -1;
+
+  local.iov_base = myaddr;
+  local.iov_len = len;
+  /* Coerce to a uintptr_t first to avoid potential gcc warning about
+     coercing an 8 byte integer to a 4 byte pointer.  */
+  remote.iov_base = (void *) (uintptr_t) memaddr;
+  remote.iov_len = len;
+
+  errno = 0;
+  ret = syscall (write ? __NR_process_vm_writev : __NR_process_vm_readv,
+		 pid, &local, 1UL, &remote, 1UL, 0UL);
+  if (ret == len)
+    return 0;
+
+  if (ret == -1 && errno == ENOSYS)
+    {
+      if (debug_threads)
+	fprintf (stderr, "process_vm_readv/writev not supported\n");
+      process_vm_unsupported = 1;
+    }
+
+  return -1;
+}
+
+#endif
+
+/* Return the cached /proc/PID/mem file descriptor of the current
+   process, opening it through LWP PID if necessary.  Returns -1 if
+   the file can not be opened.  */
+
+static int
+linux_proc_mem_fd (int pid)
+{
+  struct process_info_private *priv = current_process ()->private;
+
+  if (priv->mem_fd == -1)
+    {
+      char filename[64];
+
+      sprintf (filename, "/proc/%d/mem", pid);
+      priv->mem_fd = open (filename, O_RDONLY | O_LARGEFILE);
+    }
+
+  return priv->mem_fd;
+}
+
+/* Forget the cached /proc/PID/mem file descriptor of the current
+   process, if any.  */
+
+static void
+linux_close_proc_mem_fd (void)
+{
+  struct process_info_private *priv = current_process ()->private;
+
+  if (priv->mem_fd != -1)
+    {
+      close (priv->mem_fd);
+      priv->mem_fd = -1;
+    }
+}
+
+/* Read LEN bytes at MEMADDR into MYADDR through the cached
+   /proc/PID/mem descriptor.  Returns the number of bytes read, which
+   is 0 if the descriptor refers to an address space that no longer
+   exists, or -1 on error.  */
+
+static int
+linux_proc_mem_read (int pid, CORE_ADDR memaddr, unsigned char *myaddr,
+		     int len)
+{
+  int fd = linux_proc_mem_fd (pid);
+
+  if (fd == -1)
+    return -1;
+
+  /* If pread64 is available, use it.  It's faster if the kernel
+     supports it (only one syscall), and it's 64-bit safe even on
+     32-bit platforms (for instance, SPARC debugging a SPARC64
+     application).  */
+#ifdef HAVE_PREAD64
+  return pread64 (fd, myaddr, len, memaddr);
+#else
+  if (lseek (fd, memaddr, SEEK_SET) == -1)
+    return -1;
+  return read (fd, myaddr, len);
+#endif
+}
+
 /* Copy LEN bytes from inferior's memory starting at MEMADDR
    to debugger memory starting at MYADDR.  */
 
@@ -4132,39 +4416,33 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
   /* Allocate buffer of that many longwords.  */
   register PTRACE_XFER_TYPE *buffer
     = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
-  int fd;
-  char filename[64];
   int pid = lwpid_of (get_thread_lwp (current_inferior));
 
+#ifdef __NR_process_vm_readv
+  /* A single syscall, whatever the length, and no file descriptor
+     to manage.  */
+  if (linux_process_vm_xfer (pid, memaddr, myaddr, len, 0) == 0)
+    return 0;
+#endif
+
   /* Try using /proc.  Don't bother for one word.  */
   if (len >= 3 * sizeof (long))
     {
-      /* We could keep this file open and cache it - possibly one per
-	 thread.  That requires some juggling, but is even faster.  */
-      sprintf (filename, "/proc/%d/mem", pid);
-      fd = open (filename, O_RDONLY | O_LARGEFILE);
-      if (fd == -1)
-	goto no_proc;
-
-      /* If pread64 is available, use it.  It's faster if the kernel
-	 supports it (only one syscall), and it's 64-bit safe even on
-	 32-bit platforms (for instance, SPARC debugging a SPARC64
-	 application).  */
-#ifdef HAVE_PREAD64
-      if (pread64 (fd, myaddr, len, memaddr) != len)
-#else
-      if (lseek (fd, memaddr, SEEK_SET) == -1 || read (fd, myaddr, len) != len)
-#endif
+      int n = linux_proc_mem_read (pid, memaddr, myaddr, len);
+
+      if (n == 0)
 	{
-	  close (fd);
-	  goto no_proc;
+	  /* The cached descriptor refers to an address space that no
+	     longer exists, e.g., because the process exec'd.  Reopen
+	     it and retry once.  */
+	  linux_close_proc_mem_fd ();
+	  n = linux_proc_mem_read (pid, memaddr, myaddr, len);
 	}
 
-      close (fd);
-      return 0;
+      if (n == len)
+	return 0;
     }
 
- no_proc:
   /* Read all the longwords */
   for (i = 0; i < count; i++, addr += sizeof (PTRACE_XFER_TYPE))
     {
@@ -4220,6 +4498,17 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 	       val, (long)memaddr);
     }
 
+#ifdef __NR_process_vm_writev
+  /* Bulk writes usually target writable data, where a single
+     process_vm_writev does the whole job.  Small writes are most
+     often breakpoint insertions into read-only text, which
+     process_vm_writev refuses, so go straight to ptrace for those.  */
+  if (len >= 3 * sizeof (long)
+      && linux_process_vm_xfer (pid, memaddr, (unsigned char *) myaddr,
+				len, 1) == 0)
+    return 0;
+#endif
+
   /* Fill start and end extra bytes of buffer with existing memory data.  */
 
   errno = 0;
@@ -4761,6 +5050,23 @@ linux_supports_disable_randomization (void)
 #endif
 }
 
+static int
+linux_supports_conditional_breakpoints (void)
+{
+  /* The conditions are attached to the breakpoints GDB inserts with
+     Z0 packets, and checked by linux_wait_1.  */
+  return the_low_target.insert_point != NULL;
+}
+
+static int
+linux_supports_lazy_registers (void)
+{
+  /* linux_fetch_registers only reads the regsets that hold the
+     register asked for, and linux_store_registers only writes back
+     those that were read.  */
+  return 1;
+}
+
 /* Enumerate spufs IDs for process PID.  */
 static int
 spu_enumerate_spu_ids (long pid, unsigned char *buf, CORE_ADDR offset, int len)
@@ -5251,7 +5557,58 @@ struct link_map_offsets
     int l_prev_offset;
   };
 
-/* Construct qXfer:libraries:read reply.  */
+/* Free the NAMEs of the COUNT link map entries in ENTRIES, and
+   ENTRIES itself.  */
+
+static void
+free_svr4_lm_entries (struct svr4_lm_entry *entries, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    free (entries[i].name);
+  free (entries);
+}
+
+/* Return non-zero if link map entries A and B describe the same
+   library.  */
+
+static int
+svr4_lm_entry_eq (const struct svr4_lm_entry *a,
+		  const struct svr4_lm_entry *b)
+{
+  return (a->lm == b->lm && a->l_name == b->l_name
+	  && a->l_addr == b->l_addr && a->l_ld == b->l_ld);
+}
+
+/* Append the <library> element describing ENTRY to BUFFER.  */
+
+static void
+svr4_library_xml (struct buffer *buffer, const struct svr4_lm_entry *entry)
+{
+  char *name = xml_escape_text (entry->name);
+  char buf[128];
+
+  buffer_grow_str (buffer, "<library name=\"");
+  buffer_grow_str (buffer, name);
+  sprintf (buf, "\" lm=\"0x%lx\" l_addr=\"0x%lx\" l_ld=\"0x%lx\"/>",
+	   (unsigned long) entry->lm, (unsigned long) entry->l_addr,
+	   (unsigned long) entry->l_ld);
+  buffer_grow_str (buffer, buf);
+  free (name);
+}
+
+/* Construct qXfer:libraries-svr4:read reply.
+
+   An empty ANNEX requests the full list.  An ANNEX of the form
+   "prev=ADDR,gen=GEN" names the link map entry at the tail of the
+   list GDB last received, and the generation number of the document
+   it came in.  If that is the list reported last time, the reply has
+   the "incremental" attribute set and carries only the entries
+   removed since then, as <removed> elements, and the entries added
+   since then.  Otherwise, or if the link map cannot be read in full,
+   the full list is returned.  Every document carries a new generation
+   number.  */
 
 static int
 linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
@@ -5263,6 +5620,13 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
   struct process_info_private *const priv = current_process ()->private;
   char filename[PATH_MAX];
   int pid, is_elf64;
+  int incremental = 0;
+  struct buffer buffer;
+  char buf[128];
+  struct svr4_lm_entry *entries = NULL;
+  char *added = NULL;
+  char *removed = NULL;
+  int count = 0, allocated = 0;
 
   static const struct link_map_offsets lmo_32bit_offsets =
     {
@@ -5292,6 +5656,40 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
   if (readbuf == NULL)
     return -1;
 
+  if (offset != 0 && priv->libraries_svr4_doc != NULL)
+    {
+      /* A continuation of the document built for the read at offset
+	 zero.  */
+      document = priv->libraries_svr4_doc;
+      goto reply;
+    }
+
+  if (annex[0] != '\0')
+    {
+      ULONGEST prev_lm, gen;
+      char *end;
+
+      if (strncmp (annex, "prev=", 5) != 0)
+	return -1;
+      end = unpack_varlen_hex ((char *) annex + 5, &prev_lm);
+      if (strncmp (end, ",gen=", 5) != 0)
+	return -1;
+      end = unpack_varlen_hex (end + 5, &gen);
+      if (*end != '\0')
+	return -1;
+
+      incremental = (gen == priv->libraries_svr4_generation
+		     && priv->lm_entries_count > 0
+		     && (priv->lm_entries[priv->lm_entries_count - 1].lm
+			 == prev_lm));
+    }
+
+  priv->libraries_svr4_generation++;
+  buffer_init (&buffer);
+  sprintf (buf, "<library-list-svr4 version=\"1.0\" generation=\"0x%x\"",
+	   priv->libraries_svr4_generation);
+  buffer_grow_str (&buffer, buf);
+
   pid = lwpid_of (get_thread_lwp (current_inferior));
   xsnprintf (filename, sizeof filename, "/proc/%d/exe", pid);
   is_elf64 = elf_64_file_p (filename);
@@ -5302,21 +5700,16 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 
   if (priv->r_debug == (CORE_ADDR) -1 || priv->r_debug == 0)
     {
-      document = xstrdup ("<library-list-svr4 version=\"1.0\"/>\n");
+      buffer_grow_str0 (&buffer, "/>\n");
+      document = buffer_finish (&buffer);
     }
   else
     {
-      int allocated = 1024;
-      char *p;
       const int ptr_size = is_elf64 ? 8 : 4;
       CORE_ADDR lm_addr, lm_prev, l_name, l_addr, l_ld, l_next, l_prev;
-      int r_version, header_done = 0;
+      int r_version, i, next_old = 0, body = 0, complete = 0;
 
-      document = xmalloc (allocated);
-      sprintf (document,
-        "<library-list-svr4 version=\"1.0\" debug-base=\"0x%lx\"",
-        (unsigned long) priv->r_debug);
-      p = document + strlen (document);
+      removed = xcalloc (priv->lm_entries_count + 1, 1);
 
       r_version = 0;
       if (linux_read_memory (priv->r_debug + lmo->r_version_offset,
@@ -5348,7 +5741,8 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	     && read_one_ptr (lm_addr + lmo->l_next_offset,
 			      &l_next, ptr_size) == 0)
 	{
-	  unsigned char libname[PATH_MAX];
+	  struct svr4_lm_entry entry;
+	  int old;
 
 	  if (lm_prev != l_prev)
 	    {
@@ -5357,59 +5751,123 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
 	      break;
 	    }
 
-	  /* Not checking for error because reading may stop before
-	     we've got PATH_MAX worth of characters.  */
-	  libname[0] = '\0';
-	  linux_read_memory (l_name, libname, sizeof (libname) - 1);
-	  libname[sizeof (libname) - 1] = '\0';
-	  /* Always include the first entry, i.e. the main executable */
-	  if (libname[0] != '\0' || lm_prev == 0)
-	    {
-	      /* 6x the size for xml_escape_text below.  */
-	      size_t len = 6 * strlen ((char *) libname);
-	      char *name;
+	  entry.lm = lm_addr;
+	  entry.l_name = l_name;
+	  entry.l_addr = l_addr;
+	  entry.l_ld = l_ld;
+	  entry.name = NULL;
+
+	  /* Entries reported last time keep their order; look for this
+	     one past the last entry found so far.  Entries skipped over
+	     have been removed.  */
+	  for (old = next_old; old < priv->lm_entries_count; old++)
+	    if (svr4_lm_entry_eq (&priv->lm_entries[old], &entry))
+	      break;
 
-	      if (!header_done)
-		{
-		  /* Terminate `<library-list-svr4'.  */
-		  *p++ = '>';
-		  header_done = 1;
-		}
+	  if (old < priv->lm_entries_count)
+	    {
+	      /* An entry both sides already know about, after a new one.
+		 The new entry cannot be expressed as an append.  */
+	      if (count > 0 && added[count - 1])
+		incremental = 0;
+
+	      for (i = next_old; i < old; i++)
+		removed[i] = 1;
+	      next_old = old + 1;
+	      entry.name = xstrdup (priv->lm_entries[old].name);
+	    }
+	  else
+	    {
+	      unsigned char libname[PATH_MAX];
+
+	      /* Not checking for error because reading may stop before
+		 we've got PATH_MAX worth of characters.  */
+	      libname[0] = '\0';
+	      linux_read_memory (l_name, libname, sizeof (libname) - 1);
+	      libname[sizeof (libname) - 1] = '\0';
+
+	      /* Always include the first entry, i.e. the main
+		 executable.  */
+	      if (libname[0] != '\0' || lm_prev == 0)
+		entry.name = xstrdup ((char *) libname);
+	    }
 
-	      while (allocated < p - document + len + 200)
+	  if (entry.name != NULL)
+	    {
+	      if (count == allocated)
 		{
-		  /* Expand to guarantee sufficient storage.  */
-		  uintptr_t document_len = p - document;
-
-		  document = xrealloc (document, 2 * allocated);
-		  allocated *= 2;
-		  p = document + document_len;
+		  allocated = allocated ? 2 * allocated : 16;
+		  entries = xrealloc (entries, allocated * sizeof (*entries));
+		  added = xrealloc (added, allocated);
 		}
-
-	      name = xml_escape_text ((char *) libname);
-	      p += sprintf (p, "<library name=\"%s\" lm=\"0x%lx\" "
-			       "l_addr=\"0x%lx\" l_ld=\"0x%lx\"/>",
-			    name, (unsigned long) lm_addr,
-			    (unsigned long) l_addr, (unsigned long) l_ld);
-	      free (name);
+	      added[count] = old >= priv->lm_entries_count;
+	      entries[count++] = entry;
 	    }
 
 	  if (l_next == 0)
-	    break;
+	    {
+	      complete = 1;
+	      break;
+	    }
 
 	  lm_prev = lm_addr;
 	  lm_addr = l_next;
 	}
+
+      for (i = next_old; i < priv->lm_entries_count; i++)
+	removed[i] = 1;
+
     done:
-       if (!header_done)
+      /* Entries missing from a list we could not read in full are not
+	 necessarily gone; report what we have as the full list.  */
+      if (!complete)
+	incremental = 0;
+
+      sprintf (buf, " debug-base=\"0x%lx\"", (unsigned long) priv->r_debug);
+      buffer_grow_str (&buffer, buf);
+      if (incremental)
+	buffer_grow_str (&buffer, " incremental=\"yes\"");
+
+      for (i = 0; incremental && i < priv->lm_entries_count; i++)
+	if (removed[i])
+	  {
+	    if (!body++)
+	      buffer_grow_str (&buffer, ">");
+	    sprintf (buf, "<removed lm=\"0x%lx\"/>",
+		     (unsigned long) priv->lm_entries[i].lm);
+	    buffer_grow_str (&buffer, buf);
+	  }
+
+      for (i = 0; i < count; i++)
+	if (!incremental || added[i])
 	  {
-	    /* Empty list; terminate `<library-list-svr4'.  */
-	    strcpy (p, "/>");
+	    if (!body++)
+	      buffer_grow_str (&buffer, ">");
+	    svr4_library_xml (&buffer, &entries[i]);
 	  }
-	else
-	  strcpy (p, "</library-list-svr4>");
+
+      if (body)
+	buffer_grow_str0 (&buffer, "</library-list-svr4>");
+      else
+	{
+	  /* Empty list; terminate `<library-list-svr4'.  */
+	  buffer_grow_str0 (&buffer, "/>");
+	}
+      document = buffer_finish (&buffer);
     }
 
+  /* What we report now is what the next incremental request is
+     relative to.  */
+  free_svr4_lm_entries (priv->lm_entries, priv->lm_entries_count);
+  priv->lm_entries = entries;
+  priv->lm_entries_count = count;
+  free (added);
+  free (removed);
+
+  free (priv->libraries_svr4_doc);
+  priv->libraries_svr4_doc = document;
+
+ reply:
   document_len = strlen (document);
   if (offset < document_len)
     document_len -= offset;
@@ -5419,7 +5877,6 @@ linux_qxfer_libraries_svr4 (const char *annex, unsigned char *readbuf,
     len = document_len;
 
   memcpy (readbuf, document + offset, len);
-  xfree (document);
 
   return len;
 }
@@ -5487,6 +5944,8 @@ static struct target_ops linux_target_ops = {
   linux_supports_disable_randomization,
   linux_get_min_fast_tracepoint_insn_len,
   linux_qxfer_libraries_svr4,
+  linux_supports_conditional_breakpoints,
+  linux_supports_lazy_registers,
 };
 
 static void
@@ -44,10 +44,29 @@ struct regset_info
   regset_store_func store_function;
 };
 extern struct regset_info target_regsets[];
+
+/* Called by the low target after it changed the sizes of
+   target_regsets or the register cache layout.  */
+void linux_regsets_changed (void);
 #endif
 
 struct siginfo;
 
+/* A link map entry reported by qXfer:libraries-svr4:read.  */
+
+struct svr4_lm_entry
+{
+  /* Address of the struct link_map, and the values of its l_name,
+     l_addr and l_ld fields.  */
+  CORE_ADDR lm;
+  CORE_ADDR l_name;
+  CORE_ADDR l_addr;
+  CORE_ADDR l_ld;
+
+  /* The library name read from L_NAME.  */
+  char *name;
+};
+
 struct process_info_private
 {
   /* Arch-specific additions.  */
@@ -59,6 +78,27 @@ struct process_info_private
 
   /* &_r_debug.  0 if not yet determined.  -1 if no PT_DYNAMIC in Phdrs.  */
   CORE_ADDR r_debug;
+
+  /* Cached file descriptor for /proc/PID/mem, or -1 if not open.
+     Closed when the process is mourned, and reopened after a failed
+     access (e.g., after the process execs and gets a new address
+     space).  */
+  int mem_fd;
+
+  /* The link map entries reported by the last qXfer:libraries-svr4:read
+     document, in link map order.  Incremental requests are answered
+     relative to this list.  */
+  struct svr4_lm_entry *lm_entries;
+  int lm_entries_count;
+
+  /* Generation number of that document.  GDB echoes it back in
+     incremental requests, so that changes are only ever reported
+     relative to the list GDB actually has.  */
+  unsigned int libraries_svr4_generation;
+
+  /* The last qXfer:libraries-svr4:read document.  Reads at nonzero
+     offsets are served from it rather than rebuilding it.  */
+  char *libraries_svr4_doc;
 };
 
 struct lwp_info;
@@ -277,6 +317,8 @@ int thread_db_init (int use_events);
 void thread_db_detach (struct process_info *);
 void thread_db_mourn (struct process_info *);
 int thread_db_handle_monitor_command (char *);
+void thread_db_notice_clone (ptid_t ptid);
+void thread_db_notice_exit (ptid_t ptid);
 int thread_db_get_tls_address (struct thread_info *thread, CORE_ADDR offset,
 			       CORE_ADDR load_module, CORE_ADDR *address);
 int thread_db_look_up_one_symbol (const char *name, CORE_ADDR *addrp);
@@ -949,6 +949,7 @@ x86_linux_update_xmltarget (void)
      regsets, flush the contents of the current valid caches back to
      the threads.  */
   regcache_invalidate ();
+  linux_regsets_changed ();
 
   pid = pid_of (get_thread_lwp (current_inferior));
 #ifdef __x86_64__
@@ -1235,16 +1236,34 @@ amd64_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   i += push_opcode (&buf[i], "48 89 44 24 08"); /* mov %rax,0x8(%rsp) */
   append_insns (&buildaddr, i, buf);
 
-  /* spin-lock.  */
+  /* Pick this thread's collect lock, COLLECT_LOCK_INDEX of its thread
+     area, and keep its address in the remaining stack slot.  */
   i = 0;
+  i += push_opcode (&buf[i], "48 c1 e8 0c");	/* shr $0xc,%rax */
+  i += push_opcode (&buf[i], "83 e0");		/* and $<mask>,%eax */
+  buf[i++] = COLLECT_LOCKS - 1;
+  i += push_opcode (&buf[i], "48 c1 e0");	/* shl $<bits>,%rax */
+  buf[i++] = COLLECT_LOCK_STRIDE_BITS;
   i += push_opcode (&buf[i], "48 be");		/* movl <lockaddr>,%rsi */
   memcpy (&buf[i], (void *) &lockaddr, 8);
   i += 8;
+  i += push_opcode (&buf[i], "48 01 c6");	/* add %rax,%rsi */
+  i += push_opcode (&buf[i], "48 89 74 24 10"); /* mov %rsi,0x10(%rsp) */
+  append_insns (&buildaddr, i, buf);
+
+  /* spin-lock.  While the lock is taken, wait for it to look free
+     before retrying, so that the waiting threads don't keep pulling
+     the lock's cache line away from each other.  */
+  i = 0;
   i += push_opcode (&buf[i], "48 89 e1");       /* mov %rsp,%rcx */
   i += push_opcode (&buf[i], "31 c0");		/* xor %eax,%eax */
   i += push_opcode (&buf[i], "f0 48 0f b1 0e"); /* lock cmpxchg %rcx,(%rsi) */
   i += push_opcode (&buf[i], "48 85 c0");	/* test %rax,%rax */
-  i += push_opcode (&buf[i], "75 f4");		/* jne <again> */
+  i += push_opcode (&buf[i], "74 0a");		/* je <locked> */
+  i += push_opcode (&buf[i], "f3 90");		/* pause */
+  i += push_opcode (&buf[i], "48 83 3e 00");	/* cmpq $0x0,(%rsi) */
+  i += push_opcode (&buf[i], "75 f8");		/* jne <pause> */
+  i += push_opcode (&buf[i], "eb ea");		/* jmp <again> */
   append_insns (&buildaddr, i, buf);
 
   /* Set up the gdb_collect call.  */
@@ -1252,6 +1271,7 @@ amd64_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
      register block.  */
 
   i = 0;
+  i += push_opcode (&buf[i], "48 89 f2");	/* mov %rsi,%rdx */
   i += push_opcode (&buf[i], "48 89 e6");	/* mov %rsp,%rsi */
   i += push_opcode (&buf[i], "48 83 c6 18");	/* add $0x18,%rsi */
 
@@ -1273,9 +1293,8 @@ amd64_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   /* Clear the spin-lock.  */
   i = 0;
   i += push_opcode (&buf[i], "31 c0");		/* xor %eax,%eax */
-  i += push_opcode (&buf[i], "48 a3");		/* mov %rax, lockaddr */
-  memcpy (buf + i, &lockaddr, 8);
-  i += 8;
+  i += push_opcode (&buf[i], "48 8b 74 24 10"); /* mov 0x10(%rsp),%rsi */
+  i += push_opcode (&buf[i], "48 89 06");	/* mov %rax,(%rsi) */
   append_insns (&buildaddr, i, buf);
 
   /* Remove stack that had been used for the collect_t object.  */
@@ -1380,9 +1399,10 @@ i386_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   buf[i++] = 0x0e; /* push %cs */
   append_insns (&buildaddr, i, buf);
 
-  /* Stack space for the collecting_t object.  */
+  /* Stack space for the collecting_t object, and the address of the
+     collect lock.  */
   i = 0;
-  i += push_opcode (&buf[i], "83 ec 08");	/* sub    $0x8,%esp */
+  i += push_opcode (&buf[i], "83 ec 0c");	/* sub    $0xc,%esp */
 
   /* Build the object.  */
   i += push_opcode (&buf[i], "b8");		/* mov    <tpoint>,%eax */
@@ -1394,35 +1414,52 @@ i386_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   i += push_opcode (&buf[i], "89 44 24 04");	   /* mov %eax,0x4(%esp) */
   append_insns (&buildaddr, i, buf);
 
-  /* spin-lock.  Note this is using cmpxchg, which leaves i386 behind.
-     If we cared for it, this could be using xchg alternatively.  */
-
+  /* Pick this thread's collect lock, COLLECT_LOCK_INDEX of its thread
+     area.  */
   i = 0;
-  i += push_opcode (&buf[i], "31 c0");		/* xor %eax,%eax */
-  i += push_opcode (&buf[i], "f0 0f b1 25");    /* lock cmpxchg
-						   %esp,<lockaddr> */
+  i += push_opcode (&buf[i], "c1 e8 0c");	/* shr $0xc,%eax */
+  i += push_opcode (&buf[i], "83 e0");		/* and $<mask>,%eax */
+  buf[i++] = COLLECT_LOCKS - 1;
+  i += push_opcode (&buf[i], "c1 e0");		/* shl $<bits>,%eax */
+  buf[i++] = COLLECT_LOCK_STRIDE_BITS;
+  i += push_opcode (&buf[i], "05");		/* add $<lockaddr>,%eax */
   memcpy (&buf[i], (void *) &lockaddr, 4);
   i += 4;
-  i += push_opcode (&buf[i], "85 c0");		/* test %eax,%eax */
-  i += push_opcode (&buf[i], "75 f2");		/* jne <again> */
+  i += push_opcode (&buf[i], "89 44 24 08");	/* mov %eax,0x8(%esp) */
+  i += push_opcode (&buf[i], "89 c2");		/* mov %eax,%edx */
   append_insns (&buildaddr, i, buf);
 
+  /* spin-lock.  Note this is using cmpxchg, which leaves i386 behind.
+     If we cared for it, this could be using xchg alternatively.  While
+     the lock is taken, wait for it to look free before retrying, so
+     that the waiting threads don't keep pulling the lock's cache line
+     away from each other.  */
 
-  /* Set up arguments to the gdb_collect call.  */
   i = 0;
-  i += push_opcode (&buf[i], "89 e0");		/* mov %esp,%eax */
-  i += push_opcode (&buf[i], "83 c0 08");	/* add $0x08,%eax */
-  i += push_opcode (&buf[i], "89 44 24 fc");	/* mov %eax,-0x4(%esp) */
+  i += push_opcode (&buf[i], "31 c0");		/* xor %eax,%eax */
+  i += push_opcode (&buf[i], "f0 0f b1 22");    /* lock cmpxchg %esp,(%edx) */
+  i += push_opcode (&buf[i], "85 c0");		/* test %eax,%eax */
+  i += push_opcode (&buf[i], "74 09");		/* je <locked> */
+  i += push_opcode (&buf[i], "f3 90");		/* pause */
+  i += push_opcode (&buf[i], "83 3a 00");	/* cmpl $0x0,(%edx) */
+  i += push_opcode (&buf[i], "75 f9");		/* jne <pause> */
+  i += push_opcode (&buf[i], "eb ed");		/* jmp <again> */
   append_insns (&buildaddr, i, buf);
 
+
+  /* Set up arguments to the gdb_collect call.  */
   i = 0;
-  i += push_opcode (&buf[i], "83 ec 08");	/* sub $0x8,%esp */
+  i += push_opcode (&buf[i], "83 ec 0c");	/* sub $0xc,%esp */
   append_insns (&buildaddr, i, buf);
 
   i = 0;
   i += push_opcode (&buf[i], "c7 04 24");       /* movl <addr>,(%esp) */
   memcpy (&buf[i], (void *) &tpoint, 4);
   i += 4;
+  i += push_opcode (&buf[i], "8d 44 24 18");	/* lea 0x18(%esp),%eax */
+  i += push_opcode (&buf[i], "89 44 24 04");	/* mov %eax,0x4(%esp) */
+  i += push_opcode (&buf[i], "8b 44 24 14");	/* mov 0x14(%esp),%eax */
+  i += push_opcode (&buf[i], "89 44 24 08");	/* mov %eax,0x8(%esp) */
   append_insns (&buildaddr, i, buf);
 
   buf[0] = 0xe8; /* call <reladdr> */
@@ -1430,9 +1467,9 @@ i386_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   memcpy (buf + 1, &offset, 4);
   append_insns (&buildaddr, 5, buf);
   /* Clean up after the call.  */
-  buf[0] = 0x83; /* add $0x8,%esp */
+  buf[0] = 0x83; /* add $0xc,%esp */
   buf[1] = 0xc4;
-  buf[2] = 0x08;
+  buf[2] = 0x0c;
   append_insns (&buildaddr, 3, buf);
 
 
@@ -1440,15 +1477,14 @@ i386_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
      broken archs.  */
   i = 0;
   i += push_opcode (&buf[i], "31 c0");		/* xor %eax,%eax */
-  i += push_opcode (&buf[i], "a3");		/* mov %eax, lockaddr */
-  memcpy (buf + i, &lockaddr, 4);
-  i += 4;
+  i += push_opcode (&buf[i], "8b 54 24 08");	/* mov 0x8(%esp),%edx */
+  i += push_opcode (&buf[i], "89 02");		/* mov %eax,(%edx) */
   append_insns (&buildaddr, i, buf);
 
 
   /* Remove stack that had been used for the collect_t object.  */
   i = 0;
-  i += push_opcode (&buf[i], "83 c4 08");	/* add $0x08,%esp */
+  i += push_opcode (&buf[i], "83 c4 0c");	/* add $0x0c,%esp */
   append_insns (&buildaddr, i, buf);
 
   i = 0;
@@ -85,6 +85,17 @@ enum bkpt_type
     other_breakpoint,
   };
 
+/* A breakpoint condition GDB asked us to evaluate, as agent
+   expression bytecode.  */
+struct point_cond_list
+{
+  /* The condition.  */
+  struct agent_expr *cond;
+
+  /* The next condition of the same breakpoint.  */
+  struct point_cond_list *next;
+};
+
 /* A high level (in gdbserver's perspective) breakpoint.  */
 struct breakpoint
 {
@@ -97,6 +108,11 @@ struct breakpoint
      non-NULL.  */
   struct raw_breakpoint *raw;
 
+  /* For GDB breakpoints, the conditions GDB wants evaluated on our
+     side.  The breakpoint is reported if any of them is true, or if
+     there are none.  */
+  struct point_cond_list *cond_list;
+
   /* Function to call when we hit this breakpoint.  If it returns 1,
      the breakpoint shall be deleted; 0 or if this callback is NULL,
      it will be left inserted.  */
@@ -571,6 +587,22 @@ delete_raw_breakpoint (struct process_info *proc, struct raw_breakpoint *todel)
   return ENOENT;
 }
 
+/* Free the condition list of BP.  */
+
+static void
+free_breakpoint_conditions (struct breakpoint *bp)
+{
+  struct point_cond_list *cond, *next;
+
+  for (cond = bp->cond_list; cond != NULL; cond = next)
+    {
+      next = cond->next;
+      free_agent_expr (cond->cond);
+      free (cond);
+    }
+  bp->cond_list = NULL;
+}
+
 static int
 release_breakpoint (struct process_info *proc, struct breakpoint *bp)
 {
@@ -587,6 +619,7 @@ release_breakpoint (struct process_info *proc, struct breakpoint *bp)
   else
     bp->raw->refcount = newrefcount;
 
+  free_breakpoint_conditions (bp);
   free (bp);
 
   return 0;
@@ -645,6 +678,8 @@ find_gdb_breakpoint_at (CORE_ADDR where)
   return NULL;
 }
 
+static int validate_inserted_breakpoint (struct raw_breakpoint *bp);
+
 int
 set_gdb_breakpoint_at (CORE_ADDR where)
 {
@@ -665,6 +700,15 @@ set_gdb_breakpoint_at (CORE_ADDR where)
   bp = find_gdb_breakpoint_at (where);
   if (bp != NULL)
     {
+      /* GDB also inserts a breakpoint again to change its conditions.
+	 If it is still planted, or only lifted for a step over, keep
+	 it: lifting it here would let a running thread go past it
+	 unnoticed.  */
+      if (bp->raw->inserted
+	  ? validate_inserted_breakpoint (bp->raw)
+	  : !bp->raw->shlib_disabled)
+	return 0;
+
       delete_gdb_breakpoint_at (where);
 
       /* Might as well validate all other breakpoints.  */
@@ -707,6 +751,68 @@ gdb_breakpoint_here (CORE_ADDR where)
   return (bp != NULL);
 }
 
+void
+clear_gdb_breakpoint_conditions (CORE_ADDR addr)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+
+  if (bp != NULL)
+    free_breakpoint_conditions (bp);
+}
+
+int
+add_breakpoint_condition (CORE_ADDR addr, char **condition)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+  struct point_cond_list *new_cond, **link;
+  struct agent_expr *cond;
+
+  cond = parse_agent_expr (condition);
+  if (bp == NULL)
+    {
+      free_agent_expr (cond);
+      return 0;
+    }
+
+  new_cond = xmalloc (sizeof (*new_cond));
+  new_cond->cond = cond;
+  new_cond->next = NULL;
+
+  /* Keep the conditions in the order GDB sent them.  */
+  for (link = &bp->cond_list; *link != NULL; link = &(*link)->next)
+    ;
+  *link = new_cond;
+
+  return 1;
+}
+
+int
+gdb_condition_true_at_breakpoint (CORE_ADDR where)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (where);
+  struct point_cond_list *cond;
+  struct regcache *regcache;
+
+  /* An unconditional breakpoint always stops.  */
+  if (bp == NULL || bp->cond_list == NULL)
+    return 1;
+
+  regcache = get_thread_regcache (current_inferior, 1);
+
+  for (cond = bp->cond_list; cond != NULL; cond = cond->next)
+    {
+      ULONGEST value = 0;
+
+      /* If we can't evaluate a condition, let GDB have a go at it
+	 instead of silently ignoring the breakpoint.  */
+      if (gdb_eval_agent_expr (regcache, cond->cond, &value) != 0
+	  || value != 0)
+	return 1;
+    }
+
+  return 0;
+}
+
 void
 set_reinsert_breakpoint (CORE_ADDR stop_at)
 {
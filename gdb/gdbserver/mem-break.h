@@ -43,6 +43,24 @@ int breakpoint_inserted_here (CORE_ADDR addr);
 
 int gdb_breakpoint_here (CORE_ADDR where);
 
+/* Drop the conditions of the GDB breakpoint at ADDR, making it
+   unconditional.  */
+
+void clear_gdb_breakpoint_conditions (CORE_ADDR addr);
+
+/* Parse the agent expression at *CONDITION (in the "X<len>,<bytes>"
+   form of a Z packet), advancing *CONDITION past it, and add it to
+   the conditions of the GDB breakpoint at ADDR.  Returns 1 on
+   success, 0 if there is no GDB breakpoint at ADDR.  */
+
+int add_breakpoint_condition (CORE_ADDR addr, char **condition);
+
+/* Returns TRUE if the GDB breakpoint at WHERE should be reported to
+   GDB: it has no conditions, or one of them is true for the current
+   inferior.  */
+
+int gdb_condition_true_at_breakpoint (CORE_ADDR where);
+
 /* Create a new breakpoint at WHERE, and call HANDLER when
    it is hit.  HANDLER should return 1 if the breakpoint
    should be deleted, 0 otherwise.  */
@@ -32,6 +32,53 @@ const char **gdbserver_expedite_regs;
 
 #ifndef IN_PROCESS_AGENT
 
+/* Non-zero while registers are being fetched into a register cache
+   whose registers are not all REG_UNKNOWN.  Registers that are
+   already REG_VALID are then left alone when the target supplies
+   them, so that values written to the cache before the rest of its
+   registers were fetched are not lost.  */
+static int fetching_unknown_registers;
+
+/* Fetch register REGNO of REGCACHE, or all of its registers if REGNO
+   is -1, from the thread REGCACHE belongs to, if they are still
+   REG_UNKNOWN.  The registers the target could not fetch are marked
+   unavailable.  */
+
+static void
+fetch_unknown_registers (struct regcache *regcache, int regno)
+{
+  struct thread_info *saved_inferior;
+  int saved_fetching;
+  int i;
+
+  if (regcache->register_status == NULL)
+    return;
+
+  if (regno == -1)
+    {
+      for (i = 0; i < num_registers; i++)
+	if (regcache->register_status[i] == REG_UNKNOWN)
+	  break;
+      if (i == num_registers)
+	return;
+    }
+  else if (regcache->register_status[regno] != REG_UNKNOWN)
+    return;
+
+  saved_inferior = current_inferior;
+  saved_fetching = fetching_unknown_registers;
+  current_inferior = regcache->thread;
+  fetching_unknown_registers = 1;
+  fetch_inferior_registers (regcache, regno);
+  fetching_unknown_registers = saved_fetching;
+  current_inferior = saved_inferior;
+
+  for (i = 0; i < num_registers; i++)
+    if ((regno == -1 || i == regno)
+	&& regcache->register_status[i] == REG_UNKNOWN)
+      regcache->register_status[i] = REG_UNAVAILABLE;
+}
+
 struct regcache *
 get_thread_regcache (struct thread_info *thread, int fetch)
 {
@@ -44,11 +91,20 @@ get_thread_regcache (struct thread_info *thread, int fetch)
 
   if (fetch && regcache->registers_valid == 0)
     {
-      struct thread_info *saved_inferior = current_inferior;
+      if (target_supports_lazy_registers ())
+	{
+	  /* Leave fetching the registers until they are needed.  */
+	  memset (regcache->register_status, REG_UNKNOWN, num_registers);
+	  regcache->thread = thread;
+	}
+      else
+	{
+	  struct thread_info *saved_inferior = current_inferior;
 
-      current_inferior = thread;
-      fetch_inferior_registers (regcache, -1);
-      current_inferior = saved_inferior;
+	  current_inferior = thread;
+	  fetch_inferior_registers (regcache, -1);
+	  current_inferior = saved_inferior;
+	}
       regcache->registers_valid = 1;
     }
 
@@ -99,6 +155,7 @@ init_register_cache (struct regcache *regcache, unsigned char *regbuf)
       regcache->registers = xcalloc (1, register_bytes);
       regcache->registers_owned = 1;
       regcache->register_status = xcalloc (1, num_registers);
+      regcache->thread = NULL;
       gdb_assert (REG_UNAVAILABLE == 0);
     }
   else
@@ -112,6 +169,7 @@ init_register_cache (struct regcache *regcache, unsigned char *regbuf)
       regcache->registers_owned = 0;
 #ifndef IN_PROCESS_AGENT
       regcache->register_status = NULL;
+      regcache->thread = NULL;
 #endif
     }
 
@@ -151,6 +209,9 @@ free_register_cache (struct regcache *regcache)
 void
 regcache_cpy (struct regcache *dst, struct regcache *src)
 {
+#ifndef IN_PROCESS_AGENT
+  fetch_unknown_registers (src, -1);
+#endif
   memcpy (dst->registers, src->registers, register_bytes);
 #ifndef IN_PROCESS_AGENT
   if (dst->register_status != NULL && src->register_status != NULL)
@@ -213,27 +274,39 @@ register_cache_size (void)
   return register_bytes;
 }
 
+int
+register_count (void)
+{
+  return num_registers;
+}
+
 #ifndef IN_PROCESS_AGENT
 
+void
+register_to_string (struct regcache *regcache, int n, char *buf)
+{
+  fetch_unknown_registers (regcache, n);
+
+  if (regcache->register_status[n] == REG_VALID)
+    convert_int_to_ascii (regcache->registers + (reg_defs[n].offset / 8),
+			  buf, register_size (n));
+  else
+    memset (buf, 'x', register_size (n) * 2);
+  buf[register_size (n) * 2] = '\0';
+}
+
 void
 registers_to_string (struct regcache *regcache, char *buf)
 {
-  unsigned char *registers = regcache->registers;
   int i;
 
+  /* Fetch everything in one go, rather than register by register.  */
+  fetch_unknown_registers (regcache, -1);
+
   for (i = 0; i < num_registers; i++)
     {
-      if (regcache->register_status[i] == REG_VALID)
-	{
-	  convert_int_to_ascii (registers, buf, register_size (i));
-	  buf += register_size (i) * 2;
-	}
-      else
-	{
-	  memset (buf, 'x', register_size (i) * 2);
-	  buf += register_size (i) * 2;
-	}
-      registers += register_size (i);
+      register_to_string (regcache, i, buf);
+      buf += register_size (i) * 2;
     }
   *buf = '\0';
 }
@@ -244,6 +317,10 @@ registers_from_string (struct regcache *regcache, char *buf)
   int len = strlen (buf);
   unsigned char *registers = regcache->registers;
 
+  /* Make sure no register is fetched from the thread over the new
+     contents later.  */
+  fetch_unknown_registers (regcache, -1);
+
   if (len != register_bytes * 2)
     {
       warning ("Wrong sized register packet (expected %d bytes, got %d)",
@@ -254,6 +331,15 @@ registers_from_string (struct regcache *regcache, char *buf)
   convert_ascii_to_int (buf, registers, len / 2);
 }
 
+void
+register_from_string (struct regcache *regcache, int n, char *buf)
+{
+  unsigned char *value = alloca (register_size (n));
+
+  convert_ascii_to_int (buf, value, register_size (n));
+  supply_register (regcache, n, value);
+}
+
 struct reg *
 find_register_by_name (const char *name)
 {
@@ -295,9 +381,29 @@ register_size (int n)
 static unsigned char *
 register_data (struct regcache *regcache, int n, int fetch)
 {
+#ifndef IN_PROCESS_AGENT
+  if (fetch)
+    fetch_unknown_registers (regcache, n);
+#endif
   return regcache->registers + (reg_defs[n].offset / 8);
 }
 
+#ifndef IN_PROCESS_AGENT
+
+/* Return non-zero if the target is supplying register N of REGCACHE
+   while fetching other registers that were still unknown, and N is
+   already valid, so it must be left alone.  */
+
+static int
+register_already_known (struct regcache *regcache, int n)
+{
+  return (fetching_unknown_registers
+	  && regcache->register_status != NULL
+	  && regcache->register_status[n] == REG_VALID);
+}
+
+#endif
+
 /* Supply register N, whose contents are stored in BUF, to REGCACHE.
    If BUF is NULL, the register's value is recorded as
    unavailable.  */
@@ -305,6 +411,11 @@ register_data (struct regcache *regcache, int n, int fetch)
 void
 supply_register (struct regcache *regcache, int n, const void *buf)
 {
+#ifndef IN_PROCESS_AGENT
+  if (register_already_known (regcache, n))
+    return;
+#endif
+
   if (buf)
     {
       memcpy (register_data (regcache, n, 0), buf, register_size (n));
@@ -328,6 +439,11 @@ supply_register (struct regcache *regcache, int n, const void *buf)
 void
 supply_register_zeroed (struct regcache *regcache, int n)
 {
+#ifndef IN_PROCESS_AGENT
+  if (register_already_known (regcache, n))
+    return;
+#endif
+
   memset (register_data (regcache, n, 0), 0, register_size (n));
 #ifndef IN_PROCESS_AGENT
   if (regcache->register_status != NULL)
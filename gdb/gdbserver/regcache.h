@@ -29,6 +29,12 @@ struct thread_info;
 /* We know the register's value (and we have it cached).  */
 #define REG_VALID 1
 
+/* The register hasn't been fetched from the thread yet.  Register
+   caches of targets that support it are filled in lazily: a register
+   is only fetched, along with whatever else the target reads in the
+   same go, when it is first needed.  */
+#define REG_UNKNOWN 2
+
 /* The data for the register cache.  Note that we have one per
    inferior; this is primarily for simplicity, as the performance
    benefit is minimal.  */
@@ -44,8 +50,12 @@ struct regcache
   int registers_owned;
   unsigned char *registers;
 #ifndef IN_PROCESS_AGENT
-  /* One of REG_UNAVAILBLE or REG_VALID.  */
+  /* One of REG_UNAVAILBLE, REG_VALID or REG_UNKNOWN.  */
   unsigned char *register_status;
+
+  /* The thread whose registers are fetched into this cache when
+     some register is REG_UNKNOWN.  */
+  struct thread_info *thread;
 #endif
 };
 
@@ -74,10 +84,19 @@ void regcache_invalidate (void);
 
 void registers_to_string (struct regcache *regcache, char *buf);
 
+/* Likewise, for register N only.  */
+
+void register_to_string (struct regcache *regcache, int n, char *buf);
+
 /* Convert a string to register values and fill our register cache.  */
 
 void registers_from_string (struct regcache *regcache, char *buf);
 
+/* Likewise, for register N only.  The other registers are left
+   alone, even if they haven't been fetched yet.  */
+
+void register_from_string (struct regcache *regcache, int n, char *buf);
+
 CORE_ADDR regcache_read_pc (struct regcache *regcache);
 
 void regcache_write_pc (struct regcache *regcache, CORE_ADDR pc);
@@ -90,6 +109,10 @@ int register_size (int n);
 
 int register_cache_size (void);
 
+/* Return the number of registers in the register cache.  */
+
+int register_count (void);
+
 int find_regno (const char *name);
 
 /* The following two variables are set by auto-generated
@@ -19,6 +19,7 @@
 #include "server.h"
 #include "terminal.h"
 #include "target.h"
+#include "mem-search.h"
 #include <stdio.h>
 #include <string.h>
 #if HAVE_SYS_IOCTL_H
@@ -1490,6 +1491,77 @@ decode_search_memory_packet (const char *buf, int packet_len,
   return 0;
 }
 
+/* Decode the parameters of a qSearch:memory-multi packet into SEARCH,
+   whose patterns are allocated.  Return -1 if the packet is
+   malformed.  */
+
+int
+decode_search_memory_multi_packet (char *buf, struct mem_search *search,
+				   CORE_ADDR *start_addrp,
+				   ULONGEST *search_space_lenp)
+{
+  char *p = buf;
+  ULONGEST val;
+  int patterns_alloc = 0;
+  int nibble;
+
+  p = unpack_varlen_hex (p, &val);
+  if (*p++ != ';')
+    return -1;
+  *start_addrp = val;
+  p = unpack_varlen_hex (p, search_space_lenp);
+  if (*p++ != ';')
+    return -1;
+  p = unpack_varlen_hex (p, &search->max_count);
+  if (*p++ != ';')
+    return -1;
+  p = unpack_varlen_hex (p, &search->align);
+  if (*p++ != ';')
+    return -1;
+
+  while (1)
+    {
+      struct mem_search_pattern *pattern;
+      int n, m;
+
+      for (n = 0; ishex (p[n], &nibble); n++)
+	;
+      if (n == 0 || n % 2 != 0)
+	return -1;
+
+      if (search->num_patterns == patterns_alloc)
+	{
+	  patterns_alloc = patterns_alloc ? patterns_alloc * 2 : 4;
+	  search->patterns = xrealloc (search->patterns,
+				       (patterns_alloc
+					* sizeof (struct mem_search_pattern)));
+	}
+      pattern = &search->patterns[search->num_patterns++];
+      pattern->len = n / 2;
+      pattern->bytes = xmalloc (pattern->len);
+      pattern->mask = NULL;
+      unhexify ((char *) pattern->bytes, p, pattern->len);
+      p += n;
+
+      if (*p == '/')
+	{
+	  p++;
+	  for (m = 0; ishex (p[m], &nibble); m++)
+	    ;
+	  if (m != n)
+	    return -1;
+	  pattern->mask = xmalloc (pattern->len);
+	  unhexify ((char *) pattern->mask, p, pattern->len);
+	  p += m;
+	}
+
+      if (*p == '\0')
+	return 0;
+      if (*p++ != ';')
+	return -1;
+    }
+}
+
 static void
 free_sym_cache (struct sym_cache *sym)
 {
@@ -1522,7 +1594,7 @@ clear_symbol_cache (struct sym_cache **symcache_p)
 int
 look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
 {
-  char own_buf[266], *p, *q;
+  char own_buf[PBUFSIZ + 1], *p, *q;
   int len;
   struct sym_cache *sym;
   struct process_info *proc;
@@ -1558,20 +1630,32 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
      main loop.  For now, this is an adequate approximation; allow
      GDB to read from memory while it figures out the address of the
      symbol.  */
-  while (own_buf[0] == 'm')
+  while (own_buf[0] == 'm' || strncmp (own_buf, "vReadMemZ:", 10) == 0)
     {
       CORE_ADDR mem_addr;
       unsigned char *mem_buf;
       unsigned int mem_len;
+      int new_len;
 
-      decode_m_packet (&own_buf[1], &mem_addr, &mem_len);
-      mem_buf = xmalloc (mem_len);
-      if (read_inferior_memory (mem_addr, mem_buf, mem_len) == 0)
-	convert_int_to_ascii (mem_buf, own_buf, mem_len);
+      if (own_buf[0] == 'm')
+	{
+	  decode_m_packet (&own_buf[1], &mem_addr, &mem_len);
+	  mem_buf = xmalloc (mem_len);
+	  if (read_inferior_memory (mem_addr, mem_buf, mem_len) == 0)
+	    convert_int_to_ascii (mem_buf, own_buf, mem_len);
+	  else
+	    write_enn (own_buf);
+	  free (mem_buf);
+	  new_len = strlen (own_buf);
+	}
       else
-	write_enn (own_buf);
-      free (mem_buf);
-      if (putpkt (own_buf) < 0)
+	{
+	  new_len = -1;
+	  handle_v_read_mem_z (own_buf, &new_len);
+	  if (new_len == -1)
+	    new_len = strlen (own_buf);
+	}
+      if (putpkt_binary (own_buf, new_len) < 0)
 	return -1;
       len = getpkt (own_buf);
       if (len < 0)
@@ -1620,7 +1704,7 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
 int
 relocate_instruction (CORE_ADDR *to, CORE_ADDR oldloc)
 {
-  char own_buf[266];
+  char own_buf[PBUFSIZ + 1];
   int len;
   ULONGEST written = 0;
 
@@ -1640,13 +1724,17 @@ relocate_instruction (CORE_ADDR *to, CORE_ADDR oldloc)
      wait for the qRelocInsn "response".  That requires re-entering
      the main loop.  For now, this is an adequate approximation; allow
      GDB to access memory.  */
-  while (own_buf[0] == 'm' || own_buf[0] == 'M' || own_buf[0] == 'X')
+  while (own_buf[0] == 'm' || own_buf[0] == 'M' || own_buf[0] == 'X'
+	 || strncmp (own_buf, "vReadMemZ:", 10) == 0)
     {
       CORE_ADDR mem_addr;
       unsigned char *mem_buf = NULL;
       unsigned int mem_len;
+      int new_len = -1;
 
-      if (own_buf[0] == 'm')
+      if (own_buf[0] == 'v')
+	handle_v_read_mem_z (own_buf, &new_len);
+      else if (own_buf[0] == 'm')
 	{
 	  decode_m_packet (&own_buf[1], &mem_addr, &mem_len);
 	  mem_buf = xmalloc (mem_len);
@@ -1673,7 +1761,9 @@ relocate_instruction (CORE_ADDR *to, CORE_ADDR oldloc)
 	    write_enn (own_buf);
 	}
       free (mem_buf);
-      if (putpkt (own_buf) < 0)
+      if (new_len == -1)
+	new_len = strlen (own_buf);
+      if (putpkt_binary (own_buf, new_len) < 0)
 	return -1;
       len = getpkt (own_buf);
       if (len < 0)
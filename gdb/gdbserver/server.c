@@ -18,6 +18,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include "server.h"
+#include "lz-block.h"
+#include "mem-search.h"
 
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -592,7 +594,7 @@ monitor_show_help (void)
    another block (of the same traceframe) or from the read-only
    regions.  */
 
-static int
+int
 gdb_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
 {
   int res;
@@ -648,85 +650,24 @@ gdb_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
     }
 }
 
-/* Subroutine of handle_search_memory to simplify it.  */
+/* Memory reader for searches.  */
 
 static int
-handle_search_memory_1 (CORE_ADDR start_addr, CORE_ADDR search_space_len,
-			gdb_byte *pattern, unsigned pattern_len,
-			gdb_byte *search_buf,
-			unsigned chunk_size, unsigned search_buf_size,
-			CORE_ADDR *found_addrp)
+search_memory_read (CORE_ADDR addr, gdb_byte *buf, ULONGEST len, void *data)
 {
-  /* Prime the search buffer.  */
-
-  if (gdb_read_memory (start_addr, search_buf, search_buf_size)
-      != search_buf_size)
-    {
-      warning ("Unable to access target memory at 0x%lx, halting search.",
-	       (long) start_addr);
-      return -1;
-    }
-
-  /* Perform the search.
-
-     The loop is kept simple by allocating [N + pattern-length - 1] bytes.
-     When we've scanned N bytes we copy the trailing bytes to the start and
-     read in another N bytes.  */
-
-  while (search_space_len >= pattern_len)
-    {
-      gdb_byte *found_ptr;
-      unsigned nr_search_bytes = (search_space_len < search_buf_size
-				  ? search_space_len
-				  : search_buf_size);
-
-      found_ptr = memmem (search_buf, nr_search_bytes, pattern, pattern_len);
-
-      if (found_ptr != NULL)
-	{
-	  CORE_ADDR found_addr = start_addr + (found_ptr - search_buf);
-	  *found_addrp = found_addr;
-	  return 1;
-	}
-
-      /* Not found in this chunk, skip to next chunk.  */
-
-      /* Don't let search_space_len wrap here, it's unsigned.  */
-      if (search_space_len >= chunk_size)
-	search_space_len -= chunk_size;
-      else
-	search_space_len = 0;
-
-      if (search_space_len >= pattern_len)
-	{
-	  unsigned keep_len = search_buf_size - chunk_size;
-	  CORE_ADDR read_addr = start_addr + chunk_size + keep_len;
-	  int nr_to_read;
-
-	  /* Copy the trailing part of the previous iteration to the front
-	     of the buffer for the next iteration.  */
-	  memcpy (search_buf, search_buf + chunk_size, keep_len);
-
-	  nr_to_read = (search_space_len - keep_len < chunk_size
-			? search_space_len - keep_len
-			: chunk_size);
-
-	  if (gdb_read_memory (read_addr, search_buf + keep_len,
-			       nr_to_read) != search_buf_size)
-	    {
-	      warning ("Unable to access target memory "
-		       "at 0x%lx, halting search.",
-		       (long) read_addr);
-	      return -1;
-	    }
+  return gdb_read_memory (addr, buf, len) != len;
+}
 
-	  start_addr += chunk_size;
-	}
-    }
+/* Match callback for qSearch:memory searches.  DATA points to where
+   to record the address of the match.  */
 
-  /* Not found.  */
+static int
+search_memory_found (CORE_ADDR addr, int pattern, void *data)
+{
+  CORE_ADDR *found_addrp = data;
 
-  return 0;
+  *found_addrp = addr;
+  return 1;
 }
 
 /* Handle qSearch:memory packets.  */
@@ -738,12 +679,6 @@ handle_search_memory (char *own_buf, int packet_len)
   CORE_ADDR search_space_len;
   gdb_byte *pattern;
   unsigned int pattern_len;
-  /* NOTE: also defined in find.c testcase.  */
-#define SEARCH_CHUNK_SIZE 16000
-  const unsigned chunk_size = SEARCH_CHUNK_SIZE;
-  /* Buffer to hold memory contents for searching.  */
-  gdb_byte *search_buf;
-  unsigned search_buf_size;
   int found;
   CORE_ADDR found_addr;
   int cmd_name_len = sizeof ("qSearch:memory:") - 1;
@@ -766,25 +701,32 @@ handle_search_memory (char *own_buf, int packet_len)
       return;
     }
 
-  search_buf_size = chunk_size + pattern_len - 1;
-
-  /* No point in trying to allocate a buffer larger than the search space.  */
-  if (search_space_len < search_buf_size)
-    search_buf_size = search_space_len;
-
-  search_buf = malloc (search_buf_size);
-  if (search_buf == NULL)
+  if (pattern_len == 0)
     {
-      free (pattern);
-      error ("Unable to allocate memory to perform the search");
-      strcpy (own_buf, "E00");
-      return;
+      found = 1;
+      found_addr = start_addr;
     }
+  else
+    {
+      struct mem_search_pattern search_pattern;
+      struct mem_search search;
+      CORE_ADDR failed_addr;
+
+      search_pattern.bytes = pattern;
+      search_pattern.mask = NULL;
+      search_pattern.len = pattern_len;
+      memset (&search, 0, sizeof (search));
+      search.patterns = &search_pattern;
+      search.num_patterns = 1;
+      mem_search_prepare (&search);
 
-  found = handle_search_memory_1 (start_addr, search_space_len,
-				  pattern, pattern_len,
-				  search_buf, chunk_size, search_buf_size,
-				  &found_addr);
+      found = mem_search_memory (&search, start_addr, search_space_len,
+				 search_memory_read, search_memory_found,
+				 &found_addr, &failed_addr);
+      if (found < 0)
+	warning ("Unable to access target memory at 0x%lx, halting search.",
+		 (long) failed_addr);
+    }
 
   if (found > 0)
     sprintf (own_buf, "1,%lx", (long) found_addr);
@@ -793,10 +735,91 @@ handle_search_memory (char *own_buf, int packet_len)
   else
     strcpy (own_buf, "E00");
 
-  free (search_buf);
   free (pattern);
 }
 
+/* A reply to a qSearch:memory-multi packet, as its matches are
+   found.  */
+
+struct search_memory_multi_reply
+{
+  /* Where the next match goes, and the end of the room for them.  */
+  char *p;
+  char *end;
+
+  /* Non-zero if a match did not fit.  */
+  int full;
+};
+
+/* Match callback for qSearch:memory-multi searches.  DATA is the
+   search_memory_multi_reply.  */
+
+static int
+search_memory_multi_found (CORE_ADDR addr, int pattern, void *data)
+{
+  struct search_memory_multi_reply *reply = data;
+  char entry[64];
+  int len;
+
+  len = sprintf (entry, ";%s,%x", paddress (addr), pattern);
+  if (reply->end - reply->p < len)
+    {
+      reply->full = 1;
+      return 1;
+    }
+
+  memcpy (reply->p, entry, len);
+  reply->p += len;
+  return 0;
+}
+
+/* Handle qSearch:memory-multi packets.  */
+
+static void
+handle_search_memory_multi (char *own_buf)
+{
+  int cmd_name_len = sizeof ("qSearch:memory-multi:") - 1;
+  struct mem_search search;
+  struct search_memory_multi_reply reply;
+  CORE_ADDR start_addr;
+  ULONGEST search_space_len;
+  CORE_ADDR failed_addr;
+  char *matches;
+  int result;
+  int len;
+
+  memset (&search, 0, sizeof (search));
+  if (decode_search_memory_multi_packet (own_buf + cmd_name_len, &search,
+					 &start_addr, &search_space_len) < 0)
+    {
+      mem_search_free (&search);
+      strcpy (own_buf, "E00");
+      return;
+    }
+  mem_search_prepare (&search);
+
+  /* The packet has been decoded; the matches are gathered in OWN_BUF,
+     after room for the status and an address.  */
+  matches = own_buf + 32;
+  reply.p = matches;
+  reply.end = own_buf + PBUFSIZ - 1;
+  reply.full = 0;
+
+  result = mem_search_memory (&search, start_addr, search_space_len,
+			      search_memory_read, search_memory_multi_found,
+			      &reply, &failed_addr);
+  mem_search_free (&search);
+  *reply.p = '\0';
+
+  if (result < 0)
+    len = sprintf (own_buf, "x%s", paddress (failed_addr));
+  else if (reply.full)
+    len = sprintf (own_buf, "m");
+  else
+    len = sprintf (own_buf, "l");
+  memmove (own_buf + len, matches, reply.p - matches + 1);
+}
+
 #define require_running(BUF)			\
   if (!target_running ())			\
     {						\
@@ -1005,8 +1028,7 @@ handle_qxfer_libraries_svr4 (const char *annex,
   if (writebuf != NULL)
     return -2;
 
-  if (annex[0] != '\0' || !target_running ()
-      || the_target->qxfer_libraries_svr4 == NULL)
+  if (!target_running () || the_target->qxfer_libraries_svr4 == NULL)
     return -1;
 
   return the_target->qxfer_libraries_svr4 (annex, readbuf, writebuf, offset, len);
@@ -1558,7 +1580,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       sprintf (own_buf, "PacketSize=%x;QPassSignals+", PBUFSIZ - 1);
 
       if (the_target->qxfer_libraries_svr4 != NULL)
-	strcat (own_buf, ";qXfer:libraries-svr4:read+");
+	strcat (own_buf, ";qXfer:libraries-svr4:read+"
+		";incremental-libraries-svr4-read+");
       else
 	{
 	  /* We do not have any hook to indicate whether the non-SVR4 target
@@ -1587,6 +1610,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (transport_is_reliable)
 	strcat (own_buf, ";QStartNoAckMode+");
 
+      strcat (own_buf, ";vReadMemZ+");
+
       if (the_target->qxfer_osdata != NULL)
 	strcat (own_buf, ";qXfer:osdata:read+");
 
@@ -1601,6 +1626,9 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 
       strcat (own_buf, ";qXfer:threads:read+");
 
+      if (target_supports_conditional_breakpoints ())
+	strcat (own_buf, ";ConditionalBreakpoints+");
+
       if (target_supports_tracepoints ())
 	{
 	  strcat (own_buf, ";ConditionalTracepoints+");
@@ -1747,6 +1775,14 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (strncmp ("qSearch:memory-multi:", own_buf,
+	       sizeof ("qSearch:memory-multi:") - 1) == 0)
+    {
+      require_running (own_buf);
+      handle_search_memory_multi (own_buf);
+      return;
+    }
+
   if (strcmp (own_buf, "qAttached") == 0
       || strncmp (own_buf, "qAttached:", sizeof ("qAttached:") - 1) == 0)
     {
@@ -2114,6 +2150,81 @@ handle_v_stopped (char *own_buf)
   send_next_stop_reply (own_buf);
 }
 
+/* The largest block of memory a single vReadMemZ packet reads.  */
+#define READ_MEM_Z_MAX_LEN 0x10000
+
+/* Handle a vReadMemZ:ADDR,LENGTH request: read the memory, compress
+   it with lz_block_compress and reply with 'Z' followed by the
+   escaped compressed data.  If the compressed data does not fit in
+   a packet, compress a shorter block; GDB asks for the rest in a
+   following request.  If compression does not make the data any
+   smaller, reply with 'b' followed by as much of the escaped raw
+   data as fits instead.  */
+
+void
+handle_v_read_mem_z (char *own_buf, int *new_packet_len)
+{
+  CORE_ADDR mem_addr;
+  unsigned int len;
+  unsigned char *raw, *packed;
+  int res, out_len;
+
+  require_running (own_buf);
+  decode_m_packet (own_buf + strlen ("vReadMemZ:"), &mem_addr, &len);
+  if (len > READ_MEM_Z_MAX_LEN)
+    len = READ_MEM_Z_MAX_LEN;
+
+  raw = xmalloc (len);
+  res = gdb_read_memory (mem_addr, raw, len);
+  if (res <= 0)
+    {
+      free (raw);
+      write_enn (own_buf);
+      return;
+    }
+
+  packed = xmalloc (PBUFSIZ);
+  while (1)
+    {
+      int packed_len = lz_block_compress (raw, res, packed, PBUFSIZ);
+
+      /* Compression does not make this data any smaller; send it
+	 as is.  */
+      if (packed_len >= res)
+	break;
+
+      if (packed_len >= 0)
+	{
+	  int escaped_len
+	    = remote_escape_output (packed, packed_len,
+				    (unsigned char *) own_buf + 1, &out_len,
+				    PBUFSIZ - 2);
+
+	  if (out_len == packed_len)
+	    {
+	      own_buf[0] = 'Z';
+	      *new_packet_len = escaped_len + 1;
+	      free (packed);
+	      free (raw);
+	      return;
+	    }
+	}
+
+      /* The compressed data does not fit in a packet.  Only retry with
+	 less data while that still beats a raw reply.  */
+      if (res / 2 < PBUFSIZ - 2)
+	break;
+      res /= 2;
+    }
+
+  own_buf[0] = 'b';
+  *new_packet_len = remote_escape_output (raw, res,
+					  (unsigned char *) own_buf + 1,
+					  &out_len, PBUFSIZ - 2) + 1;
+  free (packed);
+  free (raw);
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -2180,6 +2291,12 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (strncmp (own_buf, "vReadMemZ:", 10) == 0)
+    {
+      handle_v_read_mem_z (own_buf, new_packet_len);
+      return;
+    }
+
   /* Otherwise we didn't know what packet it was.  Say we didn't
      understand it.  */
   own_buf[0] = 0;
@@ -2791,6 +2908,38 @@ main (int argc, char *argv[])
     }
 }
 
+/* Process the options GDB appended to a Z packet for the breakpoint
+   at POINT_ADDR, starting at *PACKET.  The options are a list of
+   ";X<len>,<bytes>" conditions, in agent expression bytecode.  */
+
+static void
+process_point_options (CORE_ADDR point_addr, char **packet)
+{
+  char *dataptr = *packet;
+
+  while (*dataptr == ';')
+    {
+      dataptr++;
+      switch (*dataptr)
+	{
+	case 'X':
+	  if (!add_breakpoint_condition (point_addr, &dataptr))
+	    return;
+	  break;
+	default:
+	  /* Skip options we don't know about.  */
+	  if (debug_threads)
+	    fprintf (stderr, "Unknown breakpoint option '%c', ignoring.\n",
+		     *dataptr);
+	  while (*dataptr != '\0' && *dataptr != ';')
+	    dataptr++;
+	  break;
+	}
+    }
+
+  *packet = dataptr;
+}
+
 /* Event loop callback that handles a serial event.  The first byte in
    the serial buffer gets us here.  We expect characters to arrive at
    a brisk pace, so we read the rest of the packet with a blocking
@@ -3022,6 +3171,34 @@ process_serial_event (void)
 	  registers_to_string (regcache, own_buf);
 	}
       break;
+    case 'p':
+      require_running (own_buf);
+      {
+	int regno = strtol (&own_buf[1], NULL, 16);
+
+	if (regno < 0 || regno >= register_count ())
+	  write_enn (own_buf);
+	else if (current_traceframe >= 0)
+	  {
+	    struct regcache *regcache = new_register_cache ();
+
+	    if (fetch_traceframe_registers (current_traceframe,
+					    regcache, regno) == 0)
+	      register_to_string (regcache, regno, own_buf);
+	    else
+	      write_enn (own_buf);
+	    free_register_cache (regcache);
+	  }
+	else
+	  {
+	    struct regcache *regcache;
+
+	    set_desired_inferior (1);
+	    regcache = get_thread_regcache (current_inferior, 1);
+	    register_to_string (regcache, regno, own_buf);
+	  }
+      }
+      break;
     case 'G':
       require_running (own_buf);
       if (current_traceframe >= 0)
@@ -3036,6 +3213,30 @@ process_serial_event (void)
 	  write_ok (own_buf);
 	}
       break;
+    case 'P':
+      require_running (own_buf);
+      {
+	char *value;
+	int regno = strtol (&own_buf[1], &value, 16);
+
+	if (current_traceframe >= 0
+	    || *value != '='
+	    || regno < 0 || regno >= register_count ()
+	    || strlen (value + 1) != register_size (regno) * 2)
+	  write_enn (own_buf);
+	else
+	  {
+	    struct regcache *regcache;
+
+	    /* Only the register's own regset is fetched, when it is
+	       written back.  */
+	    set_desired_inferior (1);
+	    regcache = get_thread_regcache (current_inferior, 1);
+	    register_from_string (regcache, regno, value + 1);
+	    write_ok (own_buf);
+	  }
+      }
+      break;
     case 'm':
       require_running (own_buf);
       decode_m_packet (&own_buf[1], &mem_addr, &len);
@@ -3113,7 +3314,18 @@ process_serial_event (void)
 	  case '4': /* access watchpoint */
 	    require_running (own_buf);
 	    if (insert && the_target->insert_point != NULL)
-	      res = (*the_target->insert_point) (type, addr, len);
+	      {
+		res = (*the_target->insert_point) (type, addr, len);
+
+		/* A software breakpoint may come with conditions for us
+		   to evaluate.  Inserting a breakpoint again replaces
+		   whatever conditions it had.  */
+		if (res == 0 && type == '0')
+		  {
+		    clear_gdb_breakpoint_conditions (addr);
+		    process_point_options (addr, &dataptr);
+		  }
+	      }
 	    else if (!insert && the_target->remove_point != NULL)
 	      res = (*the_target->remove_point) (type, addr, len);
 	    break;
@@ -123,11 +123,22 @@ struct inferior_list
 {
   struct inferior_list_entry *head;
   struct inferior_list_entry *tail;
+
+  /* Hash table of the entries, indexed by ID, so that
+     find_inferior_id does not have to walk the list.  Each bucket is
+     chained through the entries' HASH_NEXT field, most recently added
+     first.  Allocated on first use.  */
+  struct inferior_list_entry **buckets;
+  int num_buckets;
+  int count;
 };
 struct inferior_list_entry
 {
   ptid_t id;
   struct inferior_list_entry *next;
+
+  /* Next entry in the same hash bucket of the containing list.  */
+  struct inferior_list_entry *hash_next;
 };
 
 struct thread_info;
@@ -327,6 +338,9 @@ extern int handle_serial_event (int err, gdb_client_data client_data);
 extern int handle_target_event (int err, gdb_client_data client_data);
 
 extern void push_event (ptid_t ptid, struct target_waitstatus *status);
+extern void handle_v_read_mem_z (char *own_buf, int *new_packet_len);
+extern int gdb_read_memory (CORE_ADDR memaddr, unsigned char *myaddr,
+			    int len);
 
 /* Functions from hostio.c.  */
 extern int handle_vFile (char *, int, int *);
@@ -381,6 +395,10 @@ int decode_search_memory_packet (const char *buf, int packet_len,
 				 CORE_ADDR *search_space_lenp,
 				 gdb_byte *pattern,
 				 unsigned int *pattern_lenp);
+struct mem_search;
+int decode_search_memory_multi_packet (char *buf, struct mem_search *search,
+				       CORE_ADDR *start_addrp,
+				       ULONGEST *search_space_lenp);
 
 int unhexify (char *bin, const char *hex, int count);
 int hexify (char *hex, const char *bin, int count);
@@ -487,7 +505,22 @@ struct fast_tpoint_collect_status
 int fast_tracepoint_collecting (CORE_ADDR thread_area,
 				CORE_ADDR stop_pc,
 				struct fast_tpoint_collect_status *status);
-void force_unlock_trace_buffer (void);
+void force_unlock_trace_buffer (CORE_ADDR thread_area);
+
+/* The in-process agent has this many fast tracepoint collect locks,
+   each guarding its own segment of the agent's trace buffer, so that
+   threads taking different locks collect in parallel.  The locks are
+   COLLECT_LOCK_STRIDE bytes apart, starting at the agent's
+   `collecting' array, so that each has a cache line to itself.  A
+   jump pad takes lock number (THREAD_AREA >> 12) % COLLECT_LOCKS,
+   where THREAD_AREA is the same thread area it records in the lock;
+   thread control blocks are at least a page apart.  COLLECT_LOCKS
+   must be a power of two.  */
+#define COLLECT_LOCKS 16
+#define COLLECT_LOCK_STRIDE_BITS 6
+#define COLLECT_LOCK_STRIDE (1 << COLLECT_LOCK_STRIDE_BITS)
+#define COLLECT_LOCK_INDEX(THREAD_AREA) \
+  (((THREAD_AREA) >> 12) & (COLLECT_LOCKS - 1))
 
 int handle_tracepoint_bkpts (struct thread_info *tinfo, CORE_ADDR stop_pc);
 
@@ -503,6 +536,13 @@ void set_trampoline_buffer_space (CORE_ADDR begin, CORE_ADDR end,
 #else
 void stop_tracing (void);
 
+struct agent_expr;
+struct agent_expr *parse_agent_expr (char **actparm);
+void free_agent_expr (struct agent_expr *aexpr);
+int gdb_eval_agent_expr (struct regcache *regcache,
+			 struct agent_expr *aexpr,
+			 ULONGEST *rslt);
+
 int claim_trampoline_space (ULONGEST used, CORE_ADDR *trampoline);
 int have_fast_tracepoint_trampoline_buffer (char *msgbuf);
 #endif
@@ -390,10 +390,24 @@ struct target_ops
      for use as a fast tracepoint.  */
   int (*get_min_fast_tracepoint_insn_len) (void);
 
-  /* Read solib info on SVR4 platforms.  */
+  /* Read solib info on SVR4 platforms.  ANNEX is empty, or
+     "prev=ADDR" to request only the changes since the list ending
+     with the link map entry at ADDR was reported.  */
   int (*qxfer_libraries_svr4) (const char *annex, unsigned char *readbuf,
 			       unsigned const char *writebuf,
 			       CORE_ADDR offset, int len);
+
+  /* Returns true if the target evaluates the breakpoint conditions
+     GDB sends with Z0 packets, and only reports breakpoint hits whose
+     condition is true.  */
+  int (*supports_conditional_breakpoints) (void);
+
+  /* Returns true if the fetch_registers and store_registers methods
+     cope with register caches whose registers haven't all been
+     fetched yet (REG_UNKNOWN).  The registers of a thread are then
+     only fetched when first needed, and store_registers with REGNO
+     -1 should leave the unknown ones alone.  */
+  int (*supports_lazy_registers) (void);
 };
 
 extern struct target_ops *the_target;
@@ -510,6 +524,14 @@ void set_target_ops (struct target_ops *);
 #define target_emit_ops() \
   (the_target->emit_ops ? (*the_target->emit_ops) () : NULL)
 
+#define target_supports_conditional_breakpoints() \
+  (the_target->supports_conditional_breakpoints ? \
+   (*the_target->supports_conditional_breakpoints) () : 0)
+
+#define target_supports_lazy_registers() \
+  (the_target->supports_lazy_registers ? \
+   (*the_target->supports_lazy_registers) () : 0)
+
 #define target_supports_disable_randomization() \
   (the_target->supports_disable_randomization ? \
    (*the_target->supports_disable_randomization) () : 0)
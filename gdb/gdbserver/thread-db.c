@@ -41,6 +41,7 @@ static int thread_db_use_events;
 #include <stdint.h>
 #include <limits.h>
 #include <ctype.h>
+#include <sys/time.h>
 
 struct thread_db
 {
@@ -93,6 +94,23 @@ struct thread_db
 				     psaddr_t map_address,
 				     size_t offset, psaddr_t *address);
   const char ** (*td_symbol_list_p) (void);
+
+  /* Extensions of Android's libthread_db, which keeps its own list of
+     threads up to date from the clone and exit events we report to
+     it, instead of reading /proc on every td_ta_thr_iter call.  NULL
+     if the library doesn't have them.  */
+  td_err_e (*td_ta_thr_track_p) (td_thragent_t *ta);
+  td_err_e (*td_ta_thr_created_p) (td_thragent_t *ta, lwpid_t lwpid);
+  td_err_e (*td_ta_thr_exited_p) (td_thragent_t *ta, lwpid_t lwpid);
+
+  /* Non-zero if we report clone and exit events to the library.  */
+  int tracking;
+
+  /* Statistics of td_ta_thr_iter calls, for "monitor show
+     thread-db-stats".  */
+  unsigned long iter_calls;
+  unsigned long iter_threads;
+  unsigned long iter_usecs;
 };
 
 static char *libthread_db_search_path;
@@ -406,6 +424,50 @@ find_new_threads_callback (const td_thrhandle_t *th_p, void *data)
   return 0;
 }
 
+/* Return the current time, in microseconds.  */
+
+static LONGEST
+thread_db_timestamp (void)
+{
+  struct timeval tv;
+
+  if (gettimeofday (&tv, NULL) != 0)
+    return 0;
+  return (LONGEST) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* Callback for thread_db_thr_iter.  */
+
+static int
+count_threads_callback (const td_thrhandle_t *th_p, void *data)
+{
+  struct thread_db *thread_db = current_process ()->private->thread_db;
+
+  thread_db->iter_threads++;
+  return find_new_threads_callback (th_p, data);
+}
+
+/* Call td_ta_thr_iter to find new threads, counting the threads and
+   the time it takes.  */
+
+static td_err_e
+thread_db_thr_iter (struct thread_db *thread_db, int *new_thread_count)
+{
+  LONGEST start = thread_db_timestamp ();
+  td_err_e err;
+
+  err = thread_db->td_ta_thr_iter_p (thread_db->thread_agent,
+				     count_threads_callback,
+				     new_thread_count,
+				     TD_THR_ANY_STATE,
+				     TD_THR_LOWEST_PRIORITY,
+				     TD_SIGNO_MASK, TD_THR_ANY_USER_FLAGS);
+
+  thread_db->iter_calls++;
+  thread_db->iter_usecs += thread_db_timestamp () - start;
+  return err;
+}
+
 static void
 thread_db_find_new_threads (void)
 {
@@ -429,12 +491,7 @@ thread_db_find_new_threads (void)
       int new_thread_count = 0;
 
       /* Iterate over all user-space threads to discover new threads.  */
-      err = thread_db->td_ta_thr_iter_p (thread_db->thread_agent,
-					 find_new_threads_callback,
-					 &new_thread_count,
-					 TD_THR_ANY_STATE,
-					 TD_THR_LOWEST_PRIORITY,
-					 TD_SIGNO_MASK, TD_THR_ANY_USER_FLAGS);
+      err = thread_db_thr_iter (thread_db, &new_thread_count);
       if (debug_threads)
 	fprintf (stderr, "Found %d threads in iteration %d.\n",
 		 new_thread_count, iteration);
@@ -637,6 +694,9 @@ try_thread_db_load_1 (void *handle)
   CHK (0, tdb->td_ta_set_event_p = dlsym (handle, "td_ta_set_event"));
   CHK (0, tdb->td_ta_event_getmsg_p = dlsym (handle, "td_ta_event_getmsg"));
   CHK (0, tdb->td_thr_tls_get_addr_p = dlsym (handle, "td_thr_tls_get_addr"));
+  CHK (0, tdb->td_ta_thr_track_p = dlsym (handle, "td_ta_thr_track"));
+  CHK (0, tdb->td_ta_thr_created_p = dlsym (handle, "td_ta_thr_created"));
+  CHK (0, tdb->td_ta_thr_exited_p = dlsym (handle, "td_ta_thr_exited"));
 
 #undef CHK
 
@@ -829,6 +889,17 @@ thread_db_init (int use_events)
 	  thread_db_mourn (proc);
 	  return 0;
 	}
+
+      /* If we're tracing clones, we see every thread come and go, and
+	 can keep the library's list of threads up to date.  */
+      if (!use_events
+	  && proc->private->thread_db->td_ta_thr_track_p != NULL
+	  && proc->private->thread_db->td_ta_thr_created_p != NULL
+	  && proc->private->thread_db->td_ta_thr_exited_p != NULL
+	  && (proc->private->thread_db->td_ta_thr_track_p
+	      (proc->private->thread_db->thread_agent)) == TD_OK)
+	proc->private->thread_db->tracking = 1;
+
       thread_db_find_new_threads ();
       thread_db_look_up_symbols ();
       return 1;
@@ -950,8 +1021,75 @@ thread_db_mourn (struct process_info *proc)
     }
 }
 
-/* Handle "set libthread-db-search-path" monitor command and return 1.
-   For any other command, return 0.  */
+/* Tell the thread library of PTID's process that thread PTID was
+   created.  */
+
+void
+thread_db_notice_clone (ptid_t ptid)
+{
+  struct process_info *proc = find_process_pid (ptid_get_pid (ptid));
+  struct thread_db *thread_db;
+
+  if (proc == NULL || proc->private->thread_db == NULL)
+    return;
+
+  thread_db = proc->private->thread_db;
+  if (thread_db->tracking)
+    thread_db->td_ta_thr_created_p (thread_db->thread_agent,
+				    ptid_get_lwp (ptid));
+}
+
+/* Tell the thread library of PTID's process that thread PTID
+   exited.  */
+
+void
+thread_db_notice_exit (ptid_t ptid)
+{
+  struct process_info *proc = find_process_pid (ptid_get_pid (ptid));
+  struct thread_db *thread_db;
+
+  if (proc == NULL || proc->private->thread_db == NULL)
+    return;
+
+  thread_db = proc->private->thread_db;
+  if (thread_db->tracking)
+    thread_db->td_ta_thr_exited_p (thread_db->thread_agent,
+				   ptid_get_lwp (ptid));
+}
+
+/* Print the td_ta_thr_iter statistics of the current process.  */
+
+static void
+thread_db_show_stats (void)
+{
+  struct thread_db *thread_db;
+  char buf[200];
+
+  if (current_inferior == NULL
+      || current_process ()->private->thread_db == NULL)
+    {
+      monitor_output ("libthread_db is not loaded.\n");
+      return;
+    }
+
+  thread_db = current_process ()->private->thread_db;
+  sprintf (buf, "td_ta_thr_iter: %lu calls, %lu threads, %lu us",
+	   thread_db->iter_calls, thread_db->iter_threads,
+	   thread_db->iter_usecs);
+  monitor_output (buf);
+  if (thread_db->iter_calls != 0)
+    {
+      sprintf (buf, " (%lu us per call)",
+	       thread_db->iter_usecs / thread_db->iter_calls);
+      monitor_output (buf);
+    }
+  monitor_output (thread_db->tracking
+		  ? "\nThread list kept up to date from clone events.\n"
+		  : "\nThread list read by libthread_db on every call.\n");
+}
+
+/* Handle "set libthread-db-search-path" and "show thread-db-stats"
+   monitor commands and return 1.  For any other command, return 0.  */
 
 int
 thread_db_handle_monitor_command (char *mon)
@@ -982,6 +1120,12 @@ thread_db_handle_monitor_command (char *mon)
       return 1;
     }
 
+  if (strcmp (mon, "show thread-db-stats") == 0)
+    {
+      thread_db_show_stats ();
+      return 1;
+    }
+
   /* Tell server.c to perform default processing.  */
   return 0;
 }
@@ -80,10 +80,12 @@ trace_vdebug (const char *fmt, ...)
 #  define ATTR_USED __attribute__((used))
 #  define ATTR_NOINLINE __attribute__((noinline))
 #  define ATTR_CONSTRUCTOR __attribute__ ((constructor))
+#  define ATTR_ALIGNED(N) __attribute__ ((aligned (N)))
 #else
 #  define ATTR_USED
 #  define ATTR_NOINLINE
 #  define ATTR_CONSTRUCTOR
+#  define ATTR_ALIGNED(N)
 #endif
 
 /* Make sure the functions the IPA needs to export (symbols GDBserver
@@ -124,12 +126,7 @@ trace_vdebug (const char *fmt, ...)
 # define error_tracepoint gdb_agent_error_tracepoint
 # define tracepoints gdb_agent_tracepoints
 # define tracing gdb_agent_tracing
-# define trace_buffer_ctrl gdb_agent_trace_buffer_ctrl
-# define trace_buffer_ctrl_curr gdb_agent_trace_buffer_ctrl_curr
-# define trace_buffer_lo gdb_agent_trace_buffer_lo
-# define trace_buffer_hi gdb_agent_trace_buffer_hi
-# define traceframe_read_count gdb_agent_traceframe_read_count
-# define traceframe_write_count gdb_agent_traceframe_write_count
+# define trace_buffer_segments gdb_agent_trace_buffer_segments
 # define traceframes_created gdb_agent_traceframes_created
 # define trace_state_variables gdb_agent_trace_state_variables
 # define get_raw_reg gdb_agent_get_raw_reg
@@ -165,12 +162,7 @@ struct ipa_sym_addresses
   CORE_ADDR addr_error_tracepoint;
   CORE_ADDR addr_tracepoints;
   CORE_ADDR addr_tracing;
-  CORE_ADDR addr_trace_buffer_ctrl;
-  CORE_ADDR addr_trace_buffer_ctrl_curr;
-  CORE_ADDR addr_trace_buffer_lo;
-  CORE_ADDR addr_trace_buffer_hi;
-  CORE_ADDR addr_traceframe_read_count;
-  CORE_ADDR addr_traceframe_write_count;
+  CORE_ADDR addr_trace_buffer_segments;
   CORE_ADDR addr_traceframes_created;
   CORE_ADDR addr_trace_state_variables;
   CORE_ADDR addr_get_raw_reg;
@@ -212,12 +204,7 @@ static struct
   IPA_SYM(error_tracepoint),
   IPA_SYM(tracepoints),
   IPA_SYM(tracing),
-  IPA_SYM(trace_buffer_ctrl),
-  IPA_SYM(trace_buffer_ctrl_curr),
-  IPA_SYM(trace_buffer_lo),
-  IPA_SYM(trace_buffer_hi),
-  IPA_SYM(traceframe_read_count),
-  IPA_SYM(traceframe_write_count),
+  IPA_SYM(trace_buffer_segments),
   IPA_SYM(traceframes_created),
   IPA_SYM(trace_state_variables),
   IPA_SYM(get_raw_reg),
@@ -754,7 +741,7 @@ enum eval_result_type
     expr_eval_invalid_goto
   };
 
-static enum eval_result_type expr_eval_result = expr_eval_no_error;
+IP_AGENT_EXPORT enum eval_result_type expr_eval_result = expr_eval_no_error;
 
 #ifndef IN_PROCESS_AGENT
 
@@ -774,7 +761,7 @@ static const char *eval_result_names[] =
 
 /* The tracepoint in which the error occurred.  */
 
-static struct tracepoint *error_tracepoint;
+IP_AGENT_EXPORT struct tracepoint *error_tracepoint;
 
 struct trace_state_variable
 {
@@ -883,16 +870,7 @@ int current_traceframe = -1;
 static int circular_trace_buffer;
 #endif
 
-/* Pointer to the block of memory that traceframes all go into.  */
-
-static unsigned char *trace_buffer_lo;
-
-/* Pointer to the end of the trace buffer, more precisely to the byte
-   after the end of the buffer.  */
-
-static unsigned char *trace_buffer_hi;
-
-/* Control structure holding the read/write/etc. pointers into the
+/* Control structure holding the read/write/etc. pointers into a
    trace buffer.  We need more than one of these to implement a
    transaction-like mechanism to garantees that both GDBserver and the
    in-process agent can try to change the trace buffer
@@ -901,8 +879,8 @@ static unsigned char *trace_buffer_hi;
 struct trace_buffer_control
 {
   /* Pointer to the first trace frame in the buffer.  In the
-     non-circular case, this is equal to trace_buffer_lo, otherwise it
-     moves around in the buffer.  */
+     non-circular case, this is equal to the buffer's low end,
+     otherwise it moves around in the buffer.  */
   unsigned char *start;
 
   /* Pointer to the free part of the trace buffer.  Note that we clear
@@ -911,15 +889,14 @@ struct trace_buffer_control
   unsigned char *free;
 
   /* Pointer to the byte after the end of the free part.  Note that
-     this may be smaller than trace_buffer_free in the circular case,
-     and means that the free part is in two pieces.  Initially it is
-     equal to trace_buffer_hi, then is generally equivalent to
-     trace_buffer_start.  */
+     this may be smaller than FREE in the circular case, and means
+     that the free part is in two pieces.  Initially it is equal to
+     the buffer's high end, then is generally equivalent to START.  */
   unsigned char *end_free;
 
-  /* Pointer to the wraparound.  If not equal to trace_buffer_hi, then
-     this is the point at which the trace data breaks, and resumes at
-     trace_buffer_lo.  */
+  /* Pointer to the wraparound.  If not equal to the buffer's high
+     end, then this is the point at which the trace data breaks, and
+     resumes at the low end.  */
   unsigned char *wrap;
 };
 
@@ -962,6 +939,10 @@ struct ipa_trace_buffer_control
    structure meanwhile, that will fail, and the IPA restarts the
    allocation process.
 
+   The IPA's trace buffer is split in segments (see struct
+   trace_buffer below), each with its own token and control
+   structures; all of the above applies to each segment separately.
+
    Listing the step in further detail, we have:
 
   In-process agent (producer):
@@ -971,7 +952,8 @@ struct ipa_trace_buffer_control
   - reads current token, extracts current trace buffer control index,
     and starts tentatively updating the rightmost one (0->1, 1->2,
     2->0).  Note that only one inferior thread is executing this code
-    at any given time, due to an outer lock in the jump pads.
+    on a given segment at any given time, due to the segment's collect
+    lock in the jump pads.
 
   - updates counters, and tries to commit the token.
 
@@ -990,17 +972,17 @@ struct ipa_trace_buffer_control
   - updates the token unconditionally, using the current buffer
     control index, since it knows that the IP agent always writes to
     the rightmost, and due to the breakpoint, at most one IP thread
-    can try to update the trace buffer concurrently to GDBserver, so
-    there will be no danger of trace buffer control index wrap making
-    the IPA write to the same index as GDBserver.
+    can try to update the segment concurrently to GDBserver, so there
+    will be no danger of trace buffer control index wrap making the
+    IPA write to the same index as GDBserver.
 
   - flushes the IP agent's trace buffer completely, and updates the
     current trace buffer control structure.  GDBserver *always* wins.
 
   - removes the `about_to_request_buffer_space' breakpoint.
 
-The token is stored in the `trace_buffer_ctrl_curr' variable.
-Internally, it's bits are defined as:
+The token is stored in the segment's `ctrl_curr' field.  Internally,
+it's bits are defined as:
 
  |-------------+-----+-------------+--------+-------------+--------------|
  | Bit offsets |  31 |   30 - 20   |   19   |    18-8     |     7-0      |
@@ -1014,59 +996,114 @@ Internally, it's bits are defined as:
  TBCI - Trace Buffer Control Index
 
 
-An IPA update of `trace_buffer_ctrl_curr' does:
+An IPA update of `ctrl_curr' does:
 
     - read CC from the current token, save as PC.
     - updates pointers
     - atomically tries to write PC+1,CC
 
-A GDBserver update of `trace_buffer_ctrl_curr' does:
+A GDBserver update of `ctrl_curr' does:
 
     - reads PC and CC from the current token.
     - updates pointers
     - writes GSB,PC,CC
 */
 
-/* These are the bits of `trace_buffer_ctrl_curr' that are reserved
-   for the counters described below.  The cleared bits are used to
-   hold the index of the items of the `trace_buffer_ctrl' array that
-   is "current".  */
+/* These are the bits of `ctrl_curr' that are reserved for the
+   counters described below.  The cleared bits are used to hold the
+   index of the items of the `ctrl' array that is "current".  */
 #define GDBSERVER_FLUSH_COUNT_MASK        0xfffffff0
 
-/* `trace_buffer_ctrl_curr' contains two counters.  The `previous'
-   counter, and the `current' counter.  */
+/* `ctrl_curr' contains two counters.  The `previous' counter, and the
+   `current' counter.  */
 
 #define GDBSERVER_FLUSH_COUNT_MASK_PREV   0x7ff00000
 #define GDBSERVER_FLUSH_COUNT_MASK_CURR   0x0007ff00
 
-/* When GDBserver update the IP agent's `trace_buffer_ctrl_curr', it
-   always stamps this bit as set.  */
+/* When GDBserver update the IP agent's `ctrl_curr', it always stamps
+   this bit as set.  */
 #define GDBSERVER_UPDATED_FLUSH_COUNT_BIT 0x80000000
 
 #ifdef IN_PROCESS_AGENT
-IP_AGENT_EXPORT struct trace_buffer_control trace_buffer_ctrl[3];
-IP_AGENT_EXPORT unsigned int trace_buffer_ctrl_curr;
+# define TRACE_BUFFER_CTRLS 3
+#else
+/* The GDBserver side agent only needs one instance of the control
+   structure, as it doesn't need to sync with itself.  Define it as
+   array anyway so that the rest of the code base doesn't need to care
+   for the difference.  */
+# define TRACE_BUFFER_CTRLS 1
+#endif
+
+/* A trace buffer.  GDBserver has one.  The in-process agent has
+   TRACE_BUFFER_SEGMENTS of them, the segments of its trace buffer: a
+   thread hitting a fast tracepoint only adds traceframes to the
+   segment whose collect lock it holds (see `collecting'), so threads
+   holding different locks can collect at the same time, while each
+   segment still has at most one producer.  The last segment is for
+   static tracepoints, which don't go through the jump pads.  Each
+   segment is aligned to a cache line of its own, so that collecting
+   threads don't fight over the line holding another segment's
+   counters.  */
+
+#define TRACE_BUFFER_SEGMENTS (COLLECT_LOCKS + 1)
+
+struct trace_buffer
+{
+  /* Pointer to the block of memory that traceframes all go into.  */
+  unsigned char *lo;
+
+  /* Pointer to the end of the trace buffer, more precisely to the
+     byte after the end of the buffer.  */
+  unsigned char *hi;
+
+  /* The control structures, and the token that says which of them is
+     current.  GDBserver's own buffer only uses the first control
+     structure, and no token.  */
+  struct trace_buffer_control ctrl[TRACE_BUFFER_CTRLS];
+  unsigned int ctrl_curr;
+
+  /* The difference between these counters represents the total
+     number of complete traceframes present in the trace buffer.  The
+     IP agent writes to the write count, GDBserver writes to read
+     count.  */
+  unsigned int write_count;
+  unsigned int read_count;
+} ATTR_ALIGNED (COLLECT_LOCK_STRIDE);
+
+#ifdef IN_PROCESS_AGENT
+
+IP_AGENT_EXPORT struct trace_buffer trace_buffer_segments[TRACE_BUFFER_SEGMENTS];
 
-# define TRACE_BUFFER_CTRL_CURR \
-  (trace_buffer_ctrl_curr & ~GDBSERVER_FLUSH_COUNT_MASK)
+# define TRACE_BUFFER_CTRL_CURR(TB) \
+  ((TB)->ctrl_curr & ~GDBSERVER_FLUSH_COUNT_MASK)
 
 #else
 
-/* The GDBserver side agent only needs one instance of this object, as
-   it doesn't need to sync with itself.  Define it as array anyway so
-   that the rest of the code base doesn't need to care for the
-   difference.  */
-struct trace_buffer_control trace_buffer_ctrl[1];
-# define TRACE_BUFFER_CTRL_CURR 0
-#endif
+/* Same as above, to be used by GDBserver when reading the in-process
+   agent's trace buffer segments.  */
+
+struct ipa_trace_buffer
+{
+  uintptr_t lo;
+  uintptr_t hi;
+  struct ipa_trace_buffer_control ctrl[3];
+  unsigned int ctrl_curr;
+  unsigned int write_count;
+  unsigned int read_count;
+} ATTR_ALIGNED (COLLECT_LOCK_STRIDE);
+
+static struct trace_buffer trace_buffer;
+
+# define TRACE_BUFFER_CTRL_CURR(TB) 0
 
-/* These are convenience macros used to access the current trace
-   buffer control in effect.  */
-#define trace_buffer_start (trace_buffer_ctrl[TRACE_BUFFER_CTRL_CURR].start)
-#define trace_buffer_free (trace_buffer_ctrl[TRACE_BUFFER_CTRL_CURR].free)
-#define trace_buffer_end_free \
-  (trace_buffer_ctrl[TRACE_BUFFER_CTRL_CURR].end_free)
-#define trace_buffer_wrap (trace_buffer_ctrl[TRACE_BUFFER_CTRL_CURR].wrap)
+/* These are convenience macros used to access GDBserver's trace
+   buffer.  */
+#define trace_buffer_lo (trace_buffer.lo)
+#define trace_buffer_hi (trace_buffer.hi)
+#define trace_buffer_start (trace_buffer.ctrl[0].start)
+#define trace_buffer_free (trace_buffer.ctrl[0].free)
+#define trace_buffer_end_free (trace_buffer.ctrl[0].end_free)
+#define trace_buffer_wrap (trace_buffer.ctrl[0].wrap)
 
 
 /* Macro that returns a pointer to the first traceframe in the buffer.  */
@@ -1086,17 +1123,13 @@ struct trace_buffer_control trace_buffer_ctrl[1];
 			     ? (trace_buffer_wrap - trace_buffer_lo)	\
 			     : 0)))
 
-/* The difference between these counters represents the total number
-   of complete traceframes present in the trace buffer.  The IP agent
-   writes to the write count, GDBserver writes to read count.  */
-
-IP_AGENT_EXPORT unsigned int traceframe_write_count;
-IP_AGENT_EXPORT unsigned int traceframe_read_count;
-
-/* Convenience macro.  */
+/* The total number of complete traceframes present in the trace
+   buffer.  */
 
 #define traceframe_count \
-  ((unsigned int) (traceframe_write_count - traceframe_read_count))
+  ((unsigned int) (trace_buffer.write_count - trace_buffer.read_count))
+
+#endif
 
 /* The count of all traceframes created in the current run, including
    ones that were discarded to make room.  */
@@ -1177,6 +1210,11 @@ char *tracing_stop_note;
 struct tracepoint_hit_ctx
 {
   enum tracepoint_type type;
+
+#ifdef IN_PROCESS_AGENT
+  /* The trace buffer segment to collect into.  */
+  struct trace_buffer *tb;
+#endif
 };
 
 #ifdef IN_PROCESS_AGENT
@@ -1238,7 +1276,6 @@ struct trap_tracepoint_ctx
 #endif
 
 #ifndef IN_PROCESS_AGENT
-static struct agent_expr *parse_agent_expr (char **actparm);
 static char *unparse_agent_expr (struct agent_expr *aexpr);
 #endif
 static enum eval_result_type eval_agent_expr (struct tracepoint_hit_ctx *ctx,
@@ -1334,16 +1371,17 @@ record_tracepoint_error (struct tracepoint *tpoint, const char *which,
 /* Trace buffer management.  */
 
 static void
-clear_trace_buffer (void)
+clear_trace_buffer (struct trace_buffer *tb)
 {
-  trace_buffer_start = trace_buffer_lo;
-  trace_buffer_free = trace_buffer_lo;
-  trace_buffer_end_free = trace_buffer_hi;
-  trace_buffer_wrap = trace_buffer_hi;
+  tb->ctrl[0].start = tb->lo;
+  tb->ctrl[0].free = tb->lo;
+  tb->ctrl[0].end_free = tb->hi;
+  tb->ctrl[0].wrap = tb->hi;
+  tb->ctrl_curr = 0;
   /* A traceframe with zeroed fields marks the end of trace data.  */
-  ((struct traceframe *) trace_buffer_free)->tpnum = 0;
-  ((struct traceframe *) trace_buffer_free)->data_size = 0;
-  traceframe_read_count = traceframe_write_count = 0;
+  ((struct traceframe *) tb->lo)->tpnum = 0;
+  ((struct traceframe *) tb->lo)->data_size = 0;
+  tb->read_count = tb->write_count = 0;
   traceframes_created = 0;
 }
 
@@ -1352,47 +1390,46 @@ clear_trace_buffer (void)
 static void
 clear_inferior_trace_buffer (void)
 {
-  CORE_ADDR ipa_trace_buffer_lo;
-  CORE_ADDR ipa_trace_buffer_hi;
+  struct ipa_trace_buffer segments[TRACE_BUFFER_SEGMENTS];
   struct traceframe ipa_traceframe = { 0 };
-  struct ipa_trace_buffer_control ipa_trace_buffer_ctrl;
-
-  read_inferior_data_pointer (ipa_sym_addrs.addr_trace_buffer_lo,
-			      &ipa_trace_buffer_lo);
-  read_inferior_data_pointer (ipa_sym_addrs.addr_trace_buffer_hi,
-			      &ipa_trace_buffer_hi);
+  int i;
 
-  ipa_trace_buffer_ctrl.start = ipa_trace_buffer_lo;
-  ipa_trace_buffer_ctrl.free = ipa_trace_buffer_lo;
-  ipa_trace_buffer_ctrl.end_free = ipa_trace_buffer_hi;
-  ipa_trace_buffer_ctrl.wrap = ipa_trace_buffer_hi;
+  read_inferior_memory (ipa_sym_addrs.addr_trace_buffer_segments,
+			(unsigned char *) segments, sizeof (segments));
 
-  /* A traceframe with zeroed fields marks the end of trace data.  */
-  write_inferior_memory (ipa_sym_addrs.addr_trace_buffer_ctrl,
-			 (unsigned char *) &ipa_trace_buffer_ctrl,
-			 sizeof (ipa_trace_buffer_ctrl));
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    {
+      struct ipa_trace_buffer *seg = &segments[i];
 
-  write_inferior_uinteger (ipa_sym_addrs.addr_trace_buffer_ctrl_curr, 0);
+      seg->ctrl[0].start = seg->lo;
+      seg->ctrl[0].free = seg->lo;
+      seg->ctrl[0].end_free = seg->hi;
+      seg->ctrl[0].wrap = seg->hi;
+      seg->ctrl_curr = 0;
+      seg->write_count = 0;
+      seg->read_count = 0;
 
-  /* A traceframe with zeroed fields marks the end of trace data.  */
-  write_inferior_memory (ipa_trace_buffer_lo,
-			 (unsigned char *) &ipa_traceframe,
-			 sizeof (ipa_traceframe));
+      /* A traceframe with zeroed fields marks the end of trace
+	 data.  */
+      write_inferior_memory (seg->lo,
+			     (unsigned char *) &ipa_traceframe,
+			     sizeof (ipa_traceframe));
+    }
 
-  write_inferior_uinteger (ipa_sym_addrs.addr_traceframe_write_count, 0);
-  write_inferior_uinteger (ipa_sym_addrs.addr_traceframe_read_count, 0);
+  write_inferior_memory (ipa_sym_addrs.addr_trace_buffer_segments,
+			 (unsigned char *) segments, sizeof (segments));
   write_inferior_integer (ipa_sym_addrs.addr_traceframes_created, 0);
 }
 
 #endif
 
 static void
-init_trace_buffer (unsigned char *buf, int bufsize)
+init_trace_buffer (struct trace_buffer *tb, unsigned char *buf, int bufsize)
 {
-  trace_buffer_lo = buf;
-  trace_buffer_hi = trace_buffer_lo + bufsize;
+  tb->lo = buf;
+  tb->hi = tb->lo + bufsize;
 
-  clear_trace_buffer ();
+  clear_trace_buffer (tb);
 }
 
 #ifdef IN_PROCESS_AGENT
@@ -1407,11 +1444,11 @@ about_to_request_buffer_space (void)
 
 #endif
 
-/* Carve out a piece of the trace buffer, returning NULL in case of
+/* Carve out a piece of trace buffer TB, returning NULL in case of
    failure.  */
 
 static void *
-trace_buffer_alloc (size_t amt)
+trace_buffer_alloc (struct trace_buffer *tb, size_t amt)
 {
   unsigned char *rslt;
   struct trace_buffer_control *tbctrl;
@@ -1438,7 +1475,7 @@ trace_buffer_alloc (size_t amt)
 
   /* Read the current token and extract the index to try to write to,
      storing it in CURR.  */
-  prev = trace_buffer_ctrl_curr;
+  prev = tb->ctrl_curr;
   prev_filtered = prev & ~GDBSERVER_FLUSH_COUNT_MASK;
   curr = prev_filtered + 1;
   if (curr > 2)
@@ -1449,26 +1486,26 @@ trace_buffer_alloc (size_t amt)
   /* Start out with a copy of the current state.  GDBserver may be
      midway writing to the PREV_FILTERED TBC, but, that's OK, we won't
      be able to commit anyway if that happens.  */
-  trace_buffer_ctrl[curr]
-    = trace_buffer_ctrl[prev_filtered];
+  tb->ctrl[curr]
+    = tb->ctrl[prev_filtered];
   trace_debug ("trying curr=%u", curr);
 #else
   /* The GDBserver's agent doesn't need all that syncing, and always
      updates TCB 0 (there's only one, mind you).  */
   curr = 0;
 #endif
-  tbctrl = &trace_buffer_ctrl[curr];
+  tbctrl = &tb->ctrl[curr];
 
   /* Offsets are easier to grok for debugging than raw addresses,
      especially for the small trace buffer sizes that are useful for
      testing.  */
   trace_debug ("Trace buffer [%d] start=%d free=%d endfree=%d wrap=%d hi=%d",
 	       curr,
-	       (int) (tbctrl->start - trace_buffer_lo),
-	       (int) (tbctrl->free - trace_buffer_lo),
-	       (int) (tbctrl->end_free - trace_buffer_lo),
-	       (int) (tbctrl->wrap - trace_buffer_lo),
-	       (int) (trace_buffer_hi - trace_buffer_lo));
+	       (int) (tbctrl->start - tb->lo),
+	       (int) (tbctrl->free - tb->lo),
+	       (int) (tbctrl->end_free - tb->lo),
+	       (int) (tbctrl->wrap - tb->lo),
+	       (int) (tb->hi - tb->lo));
 
   /* The algorithm here is to keep trying to get a contiguous block of
      the requested size, possibly discarding older traceframes to free
@@ -1481,7 +1518,7 @@ trace_buffer_alloc (size_t amt)
       /* First, if we have two free parts, try the upper one first.  */
       if (tbctrl->end_free < tbctrl->free)
 	{
-	  if (tbctrl->free + amt <= trace_buffer_hi)
+	  if (tbctrl->free + amt <= tb->hi)
 	    /* We have enough in the upper part.  */
 	    break;
 	  else
@@ -1492,7 +1529,7 @@ trace_buffer_alloc (size_t amt)
 		 discarded.  */
 	      trace_debug ("Upper part too small, setting wraparound");
 	      tbctrl->wrap = tbctrl->free;
-	      tbctrl->free = trace_buffer_lo;
+	      tbctrl->free = tb->lo;
 	    }
 	}
 
@@ -1544,7 +1581,7 @@ trace_buffer_alloc (size_t amt)
 	 circular mode if we only have fast tracepoints.  If we do
 	 that, then this bit becomes racy with GDBserver, which also
 	 writes to this counter.  */
-      --traceframe_write_count;
+      --tb->write_count;
 
       new_start = (unsigned char *) NEXT_TRACEFRAME (oldest);
       /* If we freed the traceframe that wrapped around, go back
@@ -1552,7 +1589,7 @@ trace_buffer_alloc (size_t amt)
       if (new_start < tbctrl->start)
 	{
 	  trace_debug ("Discarding past the wraparound");
-	  tbctrl->wrap = trace_buffer_hi;
+	  tbctrl->wrap = tb->hi;
 	}
       tbctrl->start = new_start;
       tbctrl->end_free = tbctrl->start;
@@ -1561,11 +1598,11 @@ trace_buffer_alloc (size_t amt)
 		   "Trace buffer [%d], start=%d free=%d "
 		   "endfree=%d wrap=%d hi=%d",
 		   curr,
-		   (int) (tbctrl->start - trace_buffer_lo),
-		   (int) (tbctrl->free - trace_buffer_lo),
-		   (int) (tbctrl->end_free - trace_buffer_lo),
-		   (int) (tbctrl->wrap - trace_buffer_lo),
-		   (int) (trace_buffer_hi - trace_buffer_lo));
+		   (int) (tbctrl->start - tb->lo),
+		   (int) (tbctrl->free - tb->lo),
+		   (int) (tbctrl->end_free - tb->lo),
+		   (int) (tbctrl->wrap - tb->lo),
+		   (int) (tb->hi - tb->lo));
 
       /* Now go back around the loop.  The discard might have resulted
 	 in either one or two pieces of free space, so we want to try
@@ -1595,7 +1632,7 @@ trace_buffer_alloc (size_t amt)
 	    | curr);
 
   /* Try to commit it.  */
-  readout = cmpxchg (&trace_buffer_ctrl_curr, prev, commit);
+  readout = cmpxchg (&tb->ctrl_curr, prev, commit);
   if (readout != prev)
     {
       trace_debug ("GDBserver has touched the trace buffer, restarting."
@@ -1620,7 +1657,7 @@ trace_buffer_alloc (size_t amt)
 
     memory_barrier ();
 
-    refetch = trace_buffer_ctrl_curr;
+    refetch = tb->ctrl_curr;
 
     if (refetch == commit
 	|| ((refetch & GDBSERVER_FLUSH_COUNT_MASK_PREV) >> 12) == commit_count)
@@ -1656,11 +1693,11 @@ trace_buffer_alloc (size_t amt)
       trace_debug ("Trace buffer [%d] start=%d free=%d "
 		   "endfree=%d wrap=%d hi=%d",
 		   curr,
-		   (int) (tbctrl->start - trace_buffer_lo),
-		   (int) (tbctrl->free - trace_buffer_lo),
-		   (int) (tbctrl->end_free - trace_buffer_lo),
-		   (int) (tbctrl->wrap - trace_buffer_lo),
-		   (int) (trace_buffer_hi - trace_buffer_lo));
+		   (int) (tbctrl->start - tb->lo),
+		   (int) (tbctrl->free - tb->lo),
+		   (int) (tbctrl->end_free - tb->lo),
+		   (int) (tbctrl->wrap - tb->lo),
+		   (int) (tb->hi - tb->lo));
     }
 
   return rslt;
@@ -2060,14 +2097,47 @@ set_trace_state_variable_getter (int num, LONGEST (*getter) (void))
   tsv->getter = getter;
 }
 
-/* Add a raw traceframe for the given tracepoint.  */
+#ifdef IN_PROCESS_AGENT
+
+/* Return the trace buffer segment TFRAME lives in.  */
+
+static struct trace_buffer *
+traceframe_trace_buffer (struct traceframe *tframe)
+{
+  unsigned char *tf = (unsigned char *) tframe;
+  int i;
+
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    if (trace_buffer_segments[i].lo <= tf && tf < trace_buffer_segments[i].hi)
+      return &trace_buffer_segments[i];
+
+  fatal ("traceframe %p is not in the trace buffer", tframe);
+}
+
+#else
+
+# define traceframe_trace_buffer(TFRAME) (&trace_buffer)
+
+#endif
+
+/* Add a raw traceframe for the given tracepoint to trace buffer TB.
+
+   In the in-process agent, the traceframe's data starts with the
+   value of `traceframes_created' when the traceframe was added, which
+   GDBserver uses to upload the traceframes of all the trace buffer
+   segments in the order they were collected.  */
 
 static struct traceframe *
-add_traceframe (struct tracepoint *tpoint)
+add_traceframe (struct trace_buffer *tb, struct tracepoint *tpoint)
 {
   struct traceframe *tframe;
 
-  tframe = trace_buffer_alloc (sizeof (struct traceframe));
+#ifdef IN_PROCESS_AGENT
+  tframe = trace_buffer_alloc (tb, (sizeof (struct traceframe)
+				    + sizeof (unsigned int)));
+#else
+  tframe = trace_buffer_alloc (tb, sizeof (struct traceframe));
+#endif
 
   if (tframe == NULL)
     return NULL;
@@ -2075,6 +2145,15 @@ add_traceframe (struct tracepoint *tpoint)
   tframe->tpnum = tpoint->number;
   tframe->data_size = 0;
 
+#ifdef IN_PROCESS_AGENT
+  {
+    unsigned int seq = __sync_fetch_and_add (&traceframes_created, 1);
+
+    memcpy (tframe->data, &seq, sizeof (seq));
+    tframe->data_size = sizeof (seq);
+  }
+#endif
+
   return tframe;
 }
 
@@ -2088,7 +2167,7 @@ add_traceframe_block (struct traceframe *tframe, int amt)
   if (!tframe)
     return NULL;
 
-  block = trace_buffer_alloc (amt);
+  block = trace_buffer_alloc (traceframe_trace_buffer (tframe), amt);
 
   if (!block)
     return NULL;
@@ -2103,8 +2182,11 @@ add_traceframe_block (struct traceframe *tframe, int amt)
 static void
 finish_traceframe (struct traceframe *tframe)
 {
-  ++traceframe_write_count;
+  ++traceframe_trace_buffer (tframe)->write_count;
+#ifndef IN_PROCESS_AGENT
+  /* The in-process agent counted it when it was added.  */
   ++traceframes_created;
+#endif
 }
 
 #ifndef IN_PROCESS_AGENT
@@ -2256,7 +2338,7 @@ cmd_qtinit (char *packet)
 	}
     }
 
-  clear_trace_buffer ();
+  clear_trace_buffer (&trace_buffer);
   clear_inferior_trace_buffer ();
 
   write_ok (packet);
@@ -4324,8 +4406,14 @@ collect_data_at_tracepoint (struct tracepoint_hit_ctx *ctx, CORE_ADDR stop_pc,
   struct traceframe *tframe;
   int acti;
 
-  /* Only count it as a hit when we actually collect data.  */
+  /* Only count it as a hit when we actually collect data.  Threads
+     collecting into different trace buffer segments can get here at
+     the same time in the in-process agent.  */
+#ifdef IN_PROCESS_AGENT
+  __sync_add_and_fetch (&tpoint->hit_count, 1);
+#else
   tpoint->hit_count++;
+#endif
 
   /* If we've exceeded a defined pass count, record the event for
      later, and finish the collection for this hit.  This test is only
@@ -4340,7 +4428,11 @@ collect_data_at_tracepoint (struct tracepoint_hit_ctx *ctx, CORE_ADDR stop_pc,
   trace_debug ("Making new traceframe for tracepoint %d at 0x%s, hit %ld",
 	       tpoint->number, paddress (tpoint->address), tpoint->hit_count);
 
-  tframe = add_traceframe (tpoint);
+#ifdef IN_PROCESS_AGENT
+  tframe = add_traceframe (ctx->tb, tpoint);
+#else
+  tframe = add_traceframe (&trace_buffer, tpoint);
+#endif
 
   if (tframe)
     {
@@ -4379,7 +4471,7 @@ collect_data_at_step (struct tracepoint_hit_ctx *ctx,
 	       current_step, tpoint->step_count,
 	       tpoint->hit_count);
 
-  tframe = add_traceframe (tpoint);
+  tframe = add_traceframe (&trace_buffer, tpoint);
 
   if (tframe)
     {
@@ -4609,7 +4701,7 @@ condition_true_at_tracepoint (struct tracepoint_hit_ctx *ctx,
 /* The packet form of an agent expression consists of an 'X', number
    of bytes in expression, a comma, and then the bytes.  */
 
-static struct agent_expr *
+struct agent_expr *
 parse_agent_expr (char **actparm)
 {
   char *act = *actparm;
@@ -4641,6 +4733,46 @@ unparse_agent_expr (struct agent_expr *aexpr)
   return rslt;
 }
 
+/* Release an agent expression returned by parse_agent_expr.  */
+
+void
+free_agent_expr (struct agent_expr *aexpr)
+{
+  if (aexpr != NULL)
+    {
+      free (aexpr->bytes);
+      free (aexpr);
+    }
+}
+
+/* Evaluate AEXPR against the registers in REGCACHE and the memory of
+   the current inferior, outside of any traceframe, storing the value
+   in *RSLT.  This is how breakpoint conditions GDB sends down with Z
+   packets are evaluated.  Returns 0 on success, -1 if the expression
+   could not be evaluated.  */
+
+int
+gdb_eval_agent_expr (struct regcache *regcache,
+		     struct agent_expr *aexpr,
+		     ULONGEST *rslt)
+{
+  struct trap_tracepoint_ctx ctx;
+  enum eval_result_type err;
+
+  ctx.base.type = trap_tracepoint;
+  ctx.regcache = regcache;
+
+  err = eval_agent_expr (&ctx.base, NULL, aexpr, rslt);
+  if (err != expr_eval_no_error)
+    {
+      trace_debug ("breakpoint condition failed to evaluate: %s",
+		   eval_result_names[err]);
+      return -1;
+    }
+
+  return 0;
+}
+
 #endif
 
 /* A wrapper for gdb_agent_op_names that does some bounds-checking.  */
@@ -5662,12 +5794,40 @@ typedef struct collecting_t
   uintptr_t thread_area;
 } collecting_t;
 
+/* A fast tracepoint collect lock.  Points to a collecting_t object
+   built on the stack by the jump pad, if presently locked; NULL if it
+   isn't locked.  Padded so that each lock sits in a cache line of its
+   own.  */
+
+typedef struct collect_lock
+{
+  collecting_t *collecting;
+  char pad[COLLECT_LOCK_STRIDE - sizeof (collecting_t *)];
+} collect_lock_t;
+
 #ifndef IN_PROCESS_AGENT
 
+/* Release the collect lock the thread identified by THREAD_AREA
+   holds, if any.  */
+
 void
-force_unlock_trace_buffer (void)
+force_unlock_trace_buffer (CORE_ADDR thread_area)
 {
-  write_inferior_data_pointer (ipa_sym_addrs.addr_collecting, 0);
+  CORE_ADDR lock = (ipa_sym_addrs.addr_collecting
+		    + COLLECT_LOCK_INDEX (thread_area) * sizeof (collect_lock_t));
+  CORE_ADDR ipa_collecting;
+  collecting_t ipa_collecting_obj;
+
+  /* Other threads may share the lock.  */
+  if (read_inferior_data_pointer (lock, &ipa_collecting) != 0
+      || ipa_collecting == 0
+      || read_inferior_memory (ipa_collecting,
+			       (unsigned char *) &ipa_collecting_obj,
+			       sizeof (ipa_collecting_obj)) != 0
+      || ipa_collecting_obj.thread_area != thread_area)
+    return;
+
+  write_inferior_data_pointer (lock, 0);
 }
 
 /* Check if the thread identified by THREAD_AREA which is stopped at
@@ -5790,11 +5950,13 @@ fast_tracepoint_collecting (CORE_ADDR thread_area,
     {
       collecting_t ipa_collecting_obj;
 
-      /* If `collecting' is set/locked, then the THREAD_AREA thread
-	 may or not be the one holding the lock.  We have to read the
-	 lock to find out.  */
+      /* If the THREAD_AREA thread's collect lock is set/locked, then
+	 the THREAD_AREA thread may or not be the one holding the lock.
+	 We have to read the lock to find out.  */
 
-      if (read_inferior_data_pointer (ipa_sym_addrs.addr_collecting,
+      if (read_inferior_data_pointer (ipa_sym_addrs.addr_collecting
+				      + (COLLECT_LOCK_INDEX (thread_area)
+					 * sizeof (collect_lock_t)),
 				      &ipa_collecting))
 	{
 	  trace_debug ("fast_tracepoint_collecting:"
@@ -5875,19 +6037,21 @@ fast_tracepoint_collecting, returning continue-until-break at %s",
 
 #ifdef IN_PROCESS_AGENT
 
-/* The global fast tracepoint collect lock.  Points to a collecting_t
-   object built on the stack by the jump pad, if presently locked;
-   NULL if it isn't locked.  Note that this lock *must* be set while
-   executing any *function other than the jump pad.  See
-   fast_tracepoint_collecting.  */
-static collecting_t * ATTR_USED collecting;
+/* The fast tracepoint collect locks.  The jump pad takes lock
+   COLLECT_LOCK_INDEX of the thread's thread area, and collects into
+   the trace buffer segment of the same index.  Note that a lock
+   *must* be set while executing any *function other than the jump
+   pad.  See fast_tracepoint_collecting.  */
+static collect_lock_t ATTR_USED collecting[COLLECT_LOCKS]
+  ATTR_ALIGNED (COLLECT_LOCK_STRIDE);
 
 /* This routine, called from the jump pad (in asm) is designed to be
    called from the jump pads of fast tracepoints, thus it is on the
-   critical path.  */
+   critical path.  LOCK is the collect lock the jump pad holds.  */
 
 IP_AGENT_EXPORT void ATTR_USED
-gdb_collect (struct tracepoint *tpoint, unsigned char *regs)
+gdb_collect (struct tracepoint *tpoint, unsigned char *regs,
+	     collect_lock_t *lock)
 {
   struct fast_tracepoint_ctx ctx;
 
@@ -5896,6 +6060,7 @@ gdb_collect (struct tracepoint *tpoint, unsigned char *regs)
     return;
 
   ctx.base.type = fast_tracepoint;
+  ctx.base.tb = &trace_buffer_segments[lock - collecting];
   ctx.regs = regs;
   ctx.regcache_initted = 0;
   /* Wrap the regblock in a register cache (in the stack, we don't
@@ -7022,176 +7187,214 @@ download_trace_state_variables (void)
     }
 }
 
+/* Read the header of the IPA traceframe at TF into IPA_TFRAME, and its
+   sequence number into SEQ.  COUNT is the number of traceframes the
+   IPA claims are left in the trace buffer segment.  */
+
+static void
+read_ipa_traceframe (CORE_ADDR tf, struct traceframe *ipa_tframe,
+		     unsigned int *seq, unsigned int count)
+{
+  if (read_inferior_memory (tf, (unsigned char *) ipa_tframe,
+			    offsetof (struct traceframe, data)))
+    error ("Uploading: couldn't read traceframe at %s\n", paddress (tf));
+
+  if (ipa_tframe->tpnum == 0)
+    fatal ("Uploading: No (more) fast traceframes, but "
+	   "ipa_traceframe_count == %u??\n", count);
+
+  if (read_inferior_memory (tf + offsetof (struct traceframe, data),
+			    (unsigned char *) seq, sizeof (*seq)))
+    error ("Uploading: couldn't read traceframe at %s\n", paddress (tf));
+}
+
 /* Upload complete trace frames out of the IP Agent's trace buffer
    into GDBserver's trace buffer.  This always uploads either all or
-   no trace frames.  This is the counter part of
+   no trace frames of each trace buffer segment, in the order they
+   were collected.  This is the counter part of
    `trace_alloc_trace_buffer'.  See its description of the atomic
    synching mechanism.  */
 
 static void
 upload_fast_traceframes (void)
 {
-  unsigned int ipa_traceframe_read_count, ipa_traceframe_write_count;
-  unsigned int ipa_traceframe_read_count_racy, ipa_traceframe_write_count_racy;
-  CORE_ADDR tf;
-  struct ipa_trace_buffer_control ipa_trace_buffer_ctrl;
-  unsigned int curr_tbctrl_idx;
-  unsigned int ipa_trace_buffer_ctrl_curr;
-  unsigned int ipa_trace_buffer_ctrl_curr_old;
-  CORE_ADDR ipa_trace_buffer_ctrl_addr;
+  struct ipa_trace_buffer segments[TRACE_BUFFER_SEGMENTS];
+  /* For each segment, the current TBC, the index of it, and the
+     number of traceframes left to upload.  */
+  struct ipa_trace_buffer_control ctrl[TRACE_BUFFER_SEGMENTS];
+  unsigned int curr_tbctrl_idx[TRACE_BUFFER_SEGMENTS];
+  unsigned int left[TRACE_BUFFER_SEGMENTS];
+  int uploading[TRACE_BUFFER_SEGMENTS];
+  /* For each segment with traceframes left, the address of the oldest
+     one, its header, and its sequence number.  */
+  CORE_ADDR tf[TRACE_BUFFER_SEGMENTS];
+  struct traceframe ipa_tframe[TRACE_BUFFER_SEGMENTS];
+  unsigned int seq[TRACE_BUFFER_SEGMENTS];
+  int pending = 0;
+  int i;
   struct breakpoint *about_to_request_buffer_space_bkpt;
-  CORE_ADDR ipa_trace_buffer_lo;
-  CORE_ADDR ipa_trace_buffer_hi;
 
-  if (read_inferior_uinteger (ipa_sym_addrs.addr_traceframe_read_count,
-			      &ipa_traceframe_read_count_racy))
+  if (read_inferior_memory (ipa_sym_addrs.addr_trace_buffer_segments,
+			    (unsigned char *) segments, sizeof (segments)))
     {
       /* This will happen in most targets if the current thread is
 	 running.  */
       return;
     }
 
-  if (read_inferior_uinteger (ipa_sym_addrs.addr_traceframe_write_count,
-			      &ipa_traceframe_write_count_racy))
-    return;
-
-  trace_debug ("ipa_traceframe_count (racy area): %d (w=%d, r=%d)",
-	       ipa_traceframe_write_count_racy
-	       - ipa_traceframe_read_count_racy,
-	       ipa_traceframe_write_count_racy,
-	       ipa_traceframe_read_count_racy);
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    {
+      left[i] = segments[i].write_count - segments[i].read_count;
+      uploading[i] = (left[i] != 0);
+      if (uploading[i])
+	{
+	  trace_debug ("ipa_traceframe_count [%d] (racy area): %d "
+		       "(w=%d, r=%d)",
+		       i, left[i],
+		       segments[i].write_count, segments[i].read_count);
+	  pending = 1;
+	}
+    }
 
-  if (ipa_traceframe_write_count_racy == ipa_traceframe_read_count_racy)
+  if (!pending)
     return;
 
   about_to_request_buffer_space_bkpt
     = set_breakpoint_at (ipa_sym_addrs.addr_about_to_request_buffer_space,
 			 NULL);
 
-  if (read_inferior_uinteger (ipa_sym_addrs.addr_trace_buffer_ctrl_curr,
-			      &ipa_trace_buffer_ctrl_curr))
-    return;
+  /* Update the token of each segment we found traceframes in, with
+     new counters, and the GDBserver stamp bit.  Alway reuse the
+     current TBC index.  Segments the IPA only starts writing to after
+     the racy read above are left for the next time around.  */
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    {
+      CORE_ADDR ctrl_curr_addr;
+      unsigned int ctrl_curr, ctrl_curr_old;
+      unsigned int prev, counter;
 
-  ipa_trace_buffer_ctrl_curr_old = ipa_trace_buffer_ctrl_curr;
+      if (!uploading[i])
+	continue;
 
-  curr_tbctrl_idx = ipa_trace_buffer_ctrl_curr & ~GDBSERVER_FLUSH_COUNT_MASK;
+      ctrl_curr_addr = (ipa_sym_addrs.addr_trace_buffer_segments
+			+ i * sizeof (struct ipa_trace_buffer)
+			+ offsetof (struct ipa_trace_buffer, ctrl_curr));
 
-  {
-    unsigned int prev, counter;
+      if (read_inferior_uinteger (ctrl_curr_addr, &ctrl_curr))
+	return;
 
-    /* Update the token, with new counters, and the GDBserver stamp
-       bit.  Alway reuse the current TBC index.  */
-    prev = ipa_trace_buffer_ctrl_curr & GDBSERVER_FLUSH_COUNT_MASK_CURR;
-    counter = (prev + 0x100) & GDBSERVER_FLUSH_COUNT_MASK_CURR;
+      ctrl_curr_old = ctrl_curr;
 
-    ipa_trace_buffer_ctrl_curr = (GDBSERVER_UPDATED_FLUSH_COUNT_BIT
-				  | (prev << 12)
-				  | counter
-				  | curr_tbctrl_idx);
-  }
+      curr_tbctrl_idx[i] = ctrl_curr & ~GDBSERVER_FLUSH_COUNT_MASK;
 
-  if (write_inferior_uinteger (ipa_sym_addrs.addr_trace_buffer_ctrl_curr,
-			       ipa_trace_buffer_ctrl_curr))
-    return;
+      prev = ctrl_curr & GDBSERVER_FLUSH_COUNT_MASK_CURR;
+      counter = (prev + 0x100) & GDBSERVER_FLUSH_COUNT_MASK_CURR;
+
+      ctrl_curr = (GDBSERVER_UPDATED_FLUSH_COUNT_BIT
+		   | (prev << 12)
+		   | counter
+		   | curr_tbctrl_idx[i]);
 
-  trace_debug ("Lib: Committed %08x -> %08x",
-	       ipa_trace_buffer_ctrl_curr_old,
-	       ipa_trace_buffer_ctrl_curr);
+      if (write_inferior_uinteger (ctrl_curr_addr, ctrl_curr))
+	return;
+
+      trace_debug ("Lib: Committed [%d] %08x -> %08x",
+		   i, ctrl_curr_old, ctrl_curr);
+    }
 
-  /* Re-read these, now that we've installed the
+  /* Re-read the segments, now that we've installed the
      `about_to_request_buffer_space' breakpoint/lock.  A thread could
-     have finished a traceframe between the last read of these
-     counters and setting the breakpoint above.  If we start
-     uploading, we never want to leave this function with
-     traceframe_read_count != 0, otherwise, GDBserver could end up
+     have finished a traceframe between the last read of the counters
+     and setting the breakpoint above.  If we start uploading a
+     segment, we never want to leave this function with its
+     read_count != write_count, otherwise, GDBserver could end up
      incrementing the counter tokens more than once (due to event loop
      nesting), which would break the IP agent's "effective" detection
      (see trace_alloc_trace_buffer).  */
-  if (read_inferior_uinteger (ipa_sym_addrs.addr_traceframe_read_count,
-			      &ipa_traceframe_read_count))
-    return;
-  if (read_inferior_uinteger (ipa_sym_addrs.addr_traceframe_write_count,
-			      &ipa_traceframe_write_count))
+  if (read_inferior_memory (ipa_sym_addrs.addr_trace_buffer_segments,
+			    (unsigned char *) segments, sizeof (segments)))
     return;
 
-  if (debug_threads)
-    {
-      trace_debug ("ipa_traceframe_count (blocked area): %d (w=%d, r=%d)",
-		   ipa_traceframe_write_count - ipa_traceframe_read_count,
-		   ipa_traceframe_write_count, ipa_traceframe_read_count);
-
-      if (ipa_traceframe_write_count != ipa_traceframe_write_count_racy
-	  || ipa_traceframe_read_count != ipa_traceframe_read_count_racy)
-	trace_debug ("note that ipa_traceframe_count's parts changed");
-    }
+  /* Note that the IPA's buffer is always circular.  */
 
-  /* Get the address of the current TBC object (the IP agent has an
-     array of 3 such objects).  The index is stored in the TBC
-     token.  */
-  ipa_trace_buffer_ctrl_addr = ipa_sym_addrs.addr_trace_buffer_ctrl;
-  ipa_trace_buffer_ctrl_addr
-    += sizeof (struct ipa_trace_buffer_control) * curr_tbctrl_idx;
+#define IPA_NEXT_TRACEFRAME_1(TF, TFOBJ)		\
+  ((TF) + sizeof (struct traceframe) + (TFOBJ)->data_size)
 
-  if (read_inferior_memory (ipa_trace_buffer_ctrl_addr,
-			    (unsigned char *) &ipa_trace_buffer_ctrl,
-			    sizeof (struct ipa_trace_buffer_control)))
-    return;
+#define IPA_NEXT_TRACEFRAME(TF, TFOBJ, SEG, CTRL)			\
+  (IPA_NEXT_TRACEFRAME_1 (TF, TFOBJ)					\
+   - ((IPA_NEXT_TRACEFRAME_1 (TF, TFOBJ) >= (CTRL)->wrap)		\
+      ? ((CTRL)->wrap - (SEG)->lo)					\
+      : 0))
 
-  if (read_inferior_data_pointer (ipa_sym_addrs.addr_trace_buffer_lo,
-				  &ipa_trace_buffer_lo))
-    return;
-  if (read_inferior_data_pointer (ipa_sym_addrs.addr_trace_buffer_hi,
-				  &ipa_trace_buffer_hi))
-    return;
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    {
+      struct ipa_trace_buffer *seg = &segments[i];
 
-  /* Offsets are easier to grok for debugging than raw addresses,
-     especially for the small trace buffer sizes that are useful for
-     testing.  */
-  trace_debug ("Lib: Trace buffer [%d] start=%d free=%d "
-	       "endfree=%d wrap=%d hi=%d",
-	       curr_tbctrl_idx,
-	       (int) (ipa_trace_buffer_ctrl.start - ipa_trace_buffer_lo),
-	       (int) (ipa_trace_buffer_ctrl.free - ipa_trace_buffer_lo),
-	       (int) (ipa_trace_buffer_ctrl.end_free - ipa_trace_buffer_lo),
-	       (int) (ipa_trace_buffer_ctrl.wrap - ipa_trace_buffer_lo),
-	       (int) (ipa_trace_buffer_hi - ipa_trace_buffer_lo));
+      if (!uploading[i])
+	continue;
 
-  /* Note that the IPA's buffer is always circular.  */
+      left[i] = seg->write_count - seg->read_count;
 
-#define IPA_FIRST_TRACEFRAME() (ipa_trace_buffer_ctrl.start)
+      if (debug_threads)
+	{
+	  trace_debug ("ipa_traceframe_count [%d] (blocked area): %d "
+		       "(w=%d, r=%d)",
+		       i, left[i], seg->write_count, seg->read_count);
+	}
 
-#define IPA_NEXT_TRACEFRAME_1(TF, TFOBJ)		\
-  ((TF) + sizeof (struct traceframe) + (TFOBJ)->data_size)
+      /* Get the current TBC object of the segment (the IP agent has
+	 an array of 3 such objects).  The index is stored in the TBC
+	 token.  */
+      ctrl[i] = seg->ctrl[curr_tbctrl_idx[i]];
 
-#define IPA_NEXT_TRACEFRAME(TF, TFOBJ)					\
-  (IPA_NEXT_TRACEFRAME_1 (TF, TFOBJ)					\
-   - ((IPA_NEXT_TRACEFRAME_1 (TF, TFOBJ) >= ipa_trace_buffer_ctrl.wrap) \
-      ? (ipa_trace_buffer_ctrl.wrap - ipa_trace_buffer_lo)		\
-      : 0))
+      /* Offsets are easier to grok for debugging than raw addresses,
+	 especially for the small trace buffer sizes that are useful
+	 for testing.  */
+      trace_debug ("Lib: Trace buffer [%d][%d] start=%d free=%d "
+		   "endfree=%d wrap=%d hi=%d",
+		   i, curr_tbctrl_idx[i],
+		   (int) (ctrl[i].start - seg->lo),
+		   (int) (ctrl[i].free - seg->lo),
+		   (int) (ctrl[i].end_free - seg->lo),
+		   (int) (ctrl[i].wrap - seg->lo),
+		   (int) (seg->hi - seg->lo));
 
-  tf = IPA_FIRST_TRACEFRAME ();
+      tf[i] = ctrl[i].start;
+      if (left[i] != 0)
+	read_ipa_traceframe (tf[i], &ipa_tframe[i], &seq[i], left[i]);
+    }
 
-  while (ipa_traceframe_write_count - ipa_traceframe_read_count)
+  /* Merge the segments' traceframes into GDBserver's trace buffer,
+     oldest first.  */
+  while (1)
     {
+      struct ipa_trace_buffer *seg;
       struct tracepoint *tpoint;
       struct traceframe *tframe;
       unsigned char *block;
-      struct traceframe ipa_tframe;
+      unsigned int data_size;
 
-      if (read_inferior_memory (tf, (unsigned char *) &ipa_tframe,
-				offsetof (struct traceframe, data)))
-	error ("Uploading: couldn't read traceframe at %s\n", paddress (tf));
+      /* Find the segment holding the oldest traceframe left.  The
+	 sequence numbers may wrap around.  */
+      i = -1;
+      for (pending = 0; pending < TRACE_BUFFER_SEGMENTS; pending++)
+	if (left[pending] != 0
+	    && (i == -1 || (int) (seq[pending] - seq[i]) < 0))
+	  i = pending;
+
+      if (i == -1)
+	break;
 
-      if (ipa_tframe.tpnum == 0)
-	fatal ("Uploading: No (more) fast traceframes, but "
-	       "ipa_traceframe_count == %u??\n",
-	       ipa_traceframe_write_count - ipa_traceframe_read_count);
+      seg = &segments[i];
 
       /* Note that this will be incorrect for multi-location
 	 tracepoints...  */
-      tpoint = find_next_tracepoint_by_number (NULL, ipa_tframe.tpnum);
+      tpoint = find_next_tracepoint_by_number (NULL, ipa_tframe[i].tpnum);
 
-      tframe = add_traceframe (tpoint);
+      /* Leave the sequence number out.  */
+      data_size = ipa_tframe[i].data_size - sizeof (seq[i]);
+
+      tframe = add_traceframe (&trace_buffer, tpoint);
       if (tframe == NULL)
 	{
 	  trace_buffer_is_full = 1;
@@ -7201,73 +7404,87 @@ upload_fast_traceframes (void)
 	{
 	  /* Copy the whole set of blocks in one go for now.  FIXME:
 	     split this in smaller blocks.  */
-	  block = add_traceframe_block (tframe, ipa_tframe.data_size);
+	  block = add_traceframe_block (tframe, data_size);
 	  if (block != NULL)
 	    {
-	      if (read_inferior_memory (tf
-					+ offsetof (struct traceframe, data),
-					block, ipa_tframe.data_size))
+	      CORE_ADDR data = (tf[i] + offsetof (struct traceframe, data)
+				+ sizeof (seq[i]));
+
+	      if (read_inferior_memory (data, block, data_size))
 		error ("Uploading: Couldn't read traceframe data at %s\n",
-		       paddress (tf + offsetof (struct traceframe, data)));
+		       paddress (data));
 	    }
 
 	  trace_debug ("Uploading: traceframe didn't fit");
 	  finish_traceframe (tframe);
 	}
 
-      tf = IPA_NEXT_TRACEFRAME (tf, &ipa_tframe);
+      tf[i] = IPA_NEXT_TRACEFRAME (tf[i], &ipa_tframe[i], seg, &ctrl[i]);
 
       /* If we freed the traceframe that wrapped around, go back
 	 to the non-wrap case.  */
-      if (tf < ipa_trace_buffer_ctrl.start)
+      if (tf[i] < ctrl[i].start)
 	{
 	  trace_debug ("Lib: Discarding past the wraparound");
-	  ipa_trace_buffer_ctrl.wrap = ipa_trace_buffer_hi;
+	  ctrl[i].wrap = seg->hi;
 	}
-      ipa_trace_buffer_ctrl.start = tf;
-      ipa_trace_buffer_ctrl.end_free = ipa_trace_buffer_ctrl.start;
-      ++ipa_traceframe_read_count;
+      ctrl[i].start = tf[i];
+      ctrl[i].end_free = ctrl[i].start;
+      ++seg->read_count;
 
-      if (ipa_trace_buffer_ctrl.start == ipa_trace_buffer_ctrl.free
-	  && ipa_trace_buffer_ctrl.start == ipa_trace_buffer_ctrl.end_free)
+      if (ctrl[i].start == ctrl[i].free
+	  && ctrl[i].start == ctrl[i].end_free)
 	{
 	  trace_debug ("Lib: buffer is fully empty.  "
-		       "Trace buffer [%d] start=%d free=%d endfree=%d",
-		       curr_tbctrl_idx,
-		       (int) (ipa_trace_buffer_ctrl.start
-			      - ipa_trace_buffer_lo),
-		       (int) (ipa_trace_buffer_ctrl.free
-			      - ipa_trace_buffer_lo),
-		       (int) (ipa_trace_buffer_ctrl.end_free
-			      - ipa_trace_buffer_lo));
-
-	  ipa_trace_buffer_ctrl.start = ipa_trace_buffer_lo;
-	  ipa_trace_buffer_ctrl.free = ipa_trace_buffer_lo;
-	  ipa_trace_buffer_ctrl.end_free = ipa_trace_buffer_hi;
-	  ipa_trace_buffer_ctrl.wrap = ipa_trace_buffer_hi;
+		       "Trace buffer [%d][%d] start=%d free=%d endfree=%d",
+		       i, curr_tbctrl_idx[i],
+		       (int) (ctrl[i].start - seg->lo),
+		       (int) (ctrl[i].free - seg->lo),
+		       (int) (ctrl[i].end_free - seg->lo));
+
+	  ctrl[i].start = seg->lo;
+	  ctrl[i].free = seg->lo;
+	  ctrl[i].end_free = seg->hi;
+	  ctrl[i].wrap = seg->hi;
 	}
 
       trace_debug ("Uploaded a traceframe\n"
-		   "Lib: Trace buffer [%d] start=%d free=%d "
+		   "Lib: Trace buffer [%d][%d] start=%d free=%d "
 		   "endfree=%d wrap=%d hi=%d",
-		   curr_tbctrl_idx,
-		   (int) (ipa_trace_buffer_ctrl.start - ipa_trace_buffer_lo),
-		   (int) (ipa_trace_buffer_ctrl.free - ipa_trace_buffer_lo),
-		   (int) (ipa_trace_buffer_ctrl.end_free
-			  - ipa_trace_buffer_lo),
-		   (int) (ipa_trace_buffer_ctrl.wrap - ipa_trace_buffer_lo),
-		   (int) (ipa_trace_buffer_hi - ipa_trace_buffer_lo));
-    }
-
-  if (write_inferior_memory (ipa_trace_buffer_ctrl_addr,
-			     (unsigned char *) &ipa_trace_buffer_ctrl,
-			     sizeof (struct ipa_trace_buffer_control)))
-    return;
+		   i, curr_tbctrl_idx[i],
+		   (int) (ctrl[i].start - seg->lo),
+		   (int) (ctrl[i].free - seg->lo),
+		   (int) (ctrl[i].end_free - seg->lo),
+		   (int) (ctrl[i].wrap - seg->lo),
+		   (int) (seg->hi - seg->lo));
+
+      if (--left[i] != 0)
+	read_ipa_traceframe (tf[i], &ipa_tframe[i], &seq[i], left[i]);
+    }
+
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    {
+      CORE_ADDR seg_addr = (ipa_sym_addrs.addr_trace_buffer_segments
+			    + i * sizeof (struct ipa_trace_buffer));
+
+      if (!uploading[i])
+	continue;
+
+      if (write_inferior_memory (seg_addr
+				 + offsetof (struct ipa_trace_buffer, ctrl)
+				 + (sizeof (struct ipa_trace_buffer_control)
+				    * curr_tbctrl_idx[i]),
+				 (unsigned char *) &ctrl[i],
+				 sizeof (struct ipa_trace_buffer_control)))
+	return;
 
-  write_inferior_integer (ipa_sym_addrs.addr_traceframe_read_count,
-			  ipa_traceframe_read_count);
+      write_inferior_uinteger (seg_addr
+			       + offsetof (struct ipa_trace_buffer,
+					   read_count),
+			       segments[i].read_count);
+    }
 
-  trace_debug ("Done uploading traceframes [%d]\n", curr_tbctrl_idx);
+  trace_debug ("Done uploading traceframes\n");
 
   pause_all (1);
   cancel_breakpoints ();
@@ -7385,6 +7602,9 @@ ust_marker_to_static_tracepoint (const struct marker *mdata)
   return NULL;
 }
 
+/* Set while a thread is collecting static tracepoint data.  */
+static int static_tracepoint_collecting;
+
 /* The probe function we install on lttng/ust markers.  Whenever a
    probed ust marker is hit, this function is called.  This is similar
    to gdb_collect, only for static tracepoints, instead of fast
@@ -7406,6 +7626,7 @@ gdb_probe (const struct marker *mdata, void *probe_private,
     }
 
   ctx.base.type = static_tracepoint;
+  ctx.base.tb = &trace_buffer_segments[TRACE_BUFFER_SEGMENTS - 1];
   ctx.regcache_initted = 0;
   ctx.regs = regs;
   ctx.fmt = fmt;
@@ -7443,6 +7664,11 @@ gdb_probe (const struct marker *mdata, void *probe_private,
 	       mdata->location, mdata->channel,
 	       mdata->name, mdata->format);
 
+  /* Static tracepoints share a trace buffer segment; only one thread
+     may add traceframes to it at a time.  */
+  while (cmpxchg (&static_tracepoint_collecting, 0, 1) != 0)
+    ;
+
   /* Test the condition if present, and collect if true.  */
   if (tpoint->cond == NULL
       || condition_true_at_tracepoint ((struct tracepoint_hit_ctx *) &ctx,
@@ -7464,6 +7690,8 @@ gdb_probe (const struct marker *mdata, void *probe_private,
       if (expr_eval_result != expr_eval_no_error)
 	stop_tracing ();
     }
+
+  __sync_lock_release (&static_tracepoint_collecting);
 }
 
 /* Called if the gdb static tracepoint requested collecting "$_sdata",
@@ -8223,10 +8451,21 @@ get_timestamp (void)
 void
 initialize_tracepoint (void)
 {
+#ifdef IN_PROCESS_AGENT
+  /* There currently no way to change the buffer size.  Only the
+     segments threads actually collect into are ever touched.  */
+  const int sizeOfSegment = 1024 * 1024;
+  int i;
+
+  for (i = 0; i < TRACE_BUFFER_SEGMENTS; i++)
+    init_trace_buffer (&trace_buffer_segments[i],
+		       xmalloc (sizeOfSegment), sizeOfSegment);
+#else
   /* There currently no way to change the buffer size.  */
   const int sizeOfBuffer = 5 * 1024 * 1024;
   unsigned char *buf = xmalloc (sizeOfBuffer);
-  init_trace_buffer (buf, sizeOfBuffer);
+  init_trace_buffer (&trace_buffer, buf, sizeOfBuffer);
+#endif
 
   /* Wire trace state variable 1 to be the timestamp.  This will be
      uploaded to GDB upon connection and become one of its trace state
@@ -129,6 +129,15 @@ struct thread_suspend_state
 struct thread_info
 {
   struct thread_info *next;
+
+  /* The previous thread in the thread list, so that a thread can be
+     unlinked without walking the list.  */
+  struct thread_info *prev;
+
+  /* The next thread in the thread list with the same ptid, used by
+     thread.c's ptid index.  */
+  struct thread_info *next_same_ptid;
+
   ptid_t ptid;			/* "Actual process id";
 				    In fact, this may be overloaded with 
 				    kernel thread id, etc.  */
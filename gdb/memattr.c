@@ -570,6 +570,7 @@ mem_enable_command (char *args, int from_tty)
   require_user_regions (from_tty);
 
   target_dcache_invalidate ();
+  target_code_cache_invalidate ();
 
   if (args == NULL || *args == '\0')
     { /* Enable all mem regions.  */
@@ -617,6 +618,7 @@ mem_disable_command (char *args, int from_tty)
   require_user_regions (from_tty);
 
   target_dcache_invalidate ();
+  target_code_cache_invalidate ();
 
   if (args == NULL || *args == '\0')
     {
@@ -672,6 +674,7 @@ mem_delete_command (char *args, int from_tty)
   require_user_regions (from_tty);
 
   target_dcache_invalidate ();
+  target_code_cache_invalidate ();
 
   if (args == NULL || *args == '\0')
     {
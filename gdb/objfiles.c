@@ -646,6 +646,8 @@ free_objfile (struct objfile *objfile)
   bcache_xfree (objfile->filename_cache);
   if (objfile->demangled_names_hash)
     htab_delete (objfile->demangled_names_hash);
+  if (objfile->file_symbol_names)
+    htab_delete (objfile->file_symbol_names);
   obstack_free (&objfile->objfile_obstack, 0);
 
   /* Rebuild section map next time we need it.  */
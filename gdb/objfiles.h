@@ -28,6 +28,7 @@ struct bcache;
 struct htab;
 struct symtab;
 struct objfile_data;
+struct psymtab_name_index;
 
 /* This structure maintains information on a per-objfile basis about the
    "entry point" of the objfile, and the scope within which the entry point
@@ -212,6 +213,12 @@ struct objfile
 
     struct addrmap *psymtabs_addrmap;
 
+    /* Map the names of the partial symbols of PSYMTABS to the entries
+       of PSYMTABS that have symbols by that name.  Built when first
+       needed, and discarded whenever PSYMTABS changes.  */
+
+    struct psymtab_name_index *psymtab_name_index;
+
     /* List of freed partial symtabs, available for re-use.  */
 
     struct partial_symtab *free_psymtabs;
@@ -257,6 +264,12 @@ struct objfile
        if the name doesn't demangle.  */
     struct htab *demangled_names_hash;
 
+    /* Hash table of the base names of the source files named by the
+       ELF file symbols of an OBJF_LAZY_DEBUG objfile, or NULL.  Used
+       to tell whether a source file lookup has to read its deferred
+       partial symbols.  */
+    struct htab *file_symbol_names;
+
     /* Vectors of all partial symbols read in from file.  The actual data
        is stored in the objfile_obstack.  */
 
@@ -433,6 +446,13 @@ struct objfile
 
 #define OBJF_MAINLINE (1 << 5)
 
+/* Set if the partial symbols of this objfile should only be read once
+   a lookup is known to concern it, judging by its minimal symbols or
+   section addresses.  Used for shared libraries when "set
+   solib-lazy-debug-info" is on.  */
+
+#define OBJF_LAZY_DEBUG (1 << 6)
+
 /* The object file that contains the runtime common minimal symbols
    for SunOS4.  Note that this objfile has no associated BFD.  */
 
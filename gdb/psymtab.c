@@ -71,6 +71,8 @@ static struct partial_symbol *fixup_psymbol_section (struct partial_symbol
 
 static struct symtab *psymtab_to_symtab (struct partial_symtab *pst);
 
+static char *psymtab_search_name (const char *name);
+
 /* Ensure that the partial symbols for OBJFILE have been loaded.  This
    function always returns its argument, as a convenience.  */
 
@@ -125,6 +127,115 @@ require_partial_symbols (struct objfile *objfile, int verbose)
   ALL_OBJFILES (objfile)	 \
     ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, p)
 
+/* Return non-zero if OBJFILE was loaded with OBJF_LAZY_DEBUG and its
+   partial symbols have not been read yet.  */
+
+static int
+psymtabs_deferred_p (struct objfile *objfile)
+{
+  return ((objfile->flags & OBJF_LAZY_DEBUG) != 0
+	  && (objfile->flags & OBJF_PSYMTABS_READ) == 0);
+}
+
+/* Return non-zero if a lookup of NAME in DOMAIN has to read the
+   partial symbols of OBJFILE.  Functions and variables have minimal
+   symbols, so a deferred objfile only needs reading for a VAR_DOMAIN
+   lookup when it, or the objfile it holds the separate debug info of,
+   has a minimal symbol called NAME.  Typedefs and enumerators, which
+   are in VAR_DOMAIN too, are found by lookup_symbol reading the
+   deferred objfiles whose debug info may define them when nothing
+   else matches; see read_deferred_partial_symbols.  Lookups in other
+   domains always read.  */
+
+static int
+psymtabs_may_define_name (struct objfile *objfile, const char *name,
+			  domain_enum domain)
+{
+  struct objfile *parent = objfile->separate_debug_objfile_backlink;
+
+  if (!psymtabs_deferred_p (objfile) || domain != VAR_DOMAIN)
+    return 1;
+
+  return (lookup_minimal_symbol (name, NULL, objfile) != NULL
+	  || (parent != NULL
+	      && lookup_minimal_symbol (name, NULL, parent) != NULL));
+}
+
+/* See psymtab.h.  */
+
+int
+read_deferred_partial_symbols (const char *name)
+{
+  struct objfile *objfile;
+  int read = 0;
+
+  /* Objfiles without a sym_read_psymbols method have no debug info
+     that can be read lazily, and an objfile whose pubnames don't list
+     NAME can't define it.  */
+  ALL_OBJFILES (objfile)
+    if (psymtabs_deferred_p (objfile)
+	&& objfile->sf->sym_read_psymbols != NULL
+	&& dwarf2_may_define_name (objfile, name))
+      {
+	require_partial_symbols (objfile, 1);
+	read = 1;
+      }
+
+  return read;
+}
+
+/* Return non-zero if a lookup of source file NAME has to read the
+   partial symbols of OBJFILE.  A deferred objfile only needs reading
+   when one of its ELF file symbols has the same base name.  */
+
+static int
+psymtabs_may_have_file (struct objfile *objfile, const char *name)
+{
+  struct objfile *parent = objfile->separate_debug_objfile_backlink;
+
+  if (!psymtabs_deferred_p (objfile))
+    return 1;
+
+  return ((objfile->file_symbol_names != NULL
+	   && htab_find (objfile->file_symbol_names, lbasename (name)) != NULL)
+	  || (parent != NULL
+	      && parent->file_symbol_names != NULL
+	      && htab_find (parent->file_symbol_names,
+			    lbasename (name)) != NULL));
+}
+
+/* Return non-zero if a lookup of PC in SECTION has to read the partial
+   symbols of OBJFILE.  A deferred objfile only needs reading when PC
+   lies within one of its sections, or one of those of the objfile it
+   holds the separate debug info of.  */
+
+static int
+psymtabs_may_cover_pc (struct objfile *objfile, CORE_ADDR pc,
+		       struct obj_section *section)
+{
+  struct obj_section *osect;
+
+  if (!psymtabs_deferred_p (objfile))
+    return 1;
+
+  /* The sections of an objfile holding separate debug info belong to
+     the objfile it holds the debug info of.  */
+  if (section != NULL)
+    return (section->objfile == objfile
+	    || section->objfile == objfile->separate_debug_objfile_backlink);
+
+  ALL_OBJFILE_OSECTIONS (objfile, osect)
+    if (pc >= obj_section_addr (osect) && pc < obj_section_endaddr (osect))
+      return 1;
+
+  if (objfile->separate_debug_objfile_backlink != NULL)
+    ALL_OBJFILE_OSECTIONS (objfile->separate_debug_objfile_backlink, osect)
+      if (pc >= obj_section_addr (osect) && pc < obj_section_endaddr (osect))
+	return 1;
+
+  return 0;
+}
+
 /* Helper function for partial_map_symtabs_matching_filename that
    expands the symtabs and calls the iterator.  */
 
@@ -165,6 +276,9 @@ partial_map_symtabs_matching_filename (struct objfile *objfile,
   struct partial_symtab *pst;
   const char *name_basename = lbasename (name);
 
+  if (!psymtabs_may_have_file (objfile, name))
+    return 0;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, pst)
   {
     if (FILENAME_CMP (name, pst->filename) == 0)
@@ -316,6 +430,9 @@ find_pc_sect_psymtab (struct objfile *objfile, CORE_ADDR pc,
 {
   struct partial_symtab *pst;
 
+  if (!psymtabs_may_cover_pc (objfile, pc, section))
+    return NULL;
+
   /* Try just the PSYMTABS_ADDRMAP mapping first as it has better granularity
      than the later used TEXTLOW/TEXTHIGH one.  */
 
@@ -499,39 +616,201 @@ fixup_psymbol_section (struct partial_symbol *psym, struct objfile *objfile)
   return psym;
 }
 
+/* The index from the names of the partial symbols of an objfile to
+   its psymtabs, so that looking up a name does not have to search
+   every psymtab.  The names are hashed with msymbol_hash_iw, so all
+   the names strcmp_iw considers equal to some name are in the same
+   bucket.  */
+
+struct psymtab_name_node
+{
+  struct partial_symtab *pst;
+  struct psymtab_name_node *next;
+};
+
+struct psymtab_name_entry
+{
+  /* The first partial symbol seen with this SYMBOL_SEARCH_NAME, and
+     the hash of that name.  */
+  struct partial_symbol *psym;
+  unsigned int hash;
+
+  /* The next entry in the same bucket.  */
+  struct psymtab_name_entry *next;
+
+  /* The psymtabs that have global or static symbols by this name, in
+     the order of the objfile's psymtab list.  */
+  struct psymtab_name_node *psymtabs;
+};
+
+struct psymtab_name_index
+{
+  unsigned int nbuckets;
+  struct psymtab_name_entry **buckets;
+};
+
+/* Add the COUNT partial symbols of PST starting at PSYM to INDEX,
+   allocating on OBSTACK.  */
+
+static void
+add_psymbols_to_name_index (struct psymtab_name_index *index,
+			    struct partial_symtab *pst,
+			    struct partial_symbol **psym, int count,
+			    struct obstack *obstack)
+{
+  for (; count > 0; psym++, count--)
+    {
+      const char *name = SYMBOL_SEARCH_NAME (*psym);
+      unsigned int hash = msymbol_hash_iw (name);
+      struct psymtab_name_entry **bucket;
+      struct psymtab_name_entry *entry;
+
+      bucket = &index->buckets[hash % index->nbuckets];
+      for (entry = *bucket; entry != NULL; entry = entry->next)
+	if (entry->hash == hash
+	    && strcmp (SYMBOL_SEARCH_NAME (entry->psym), name) == 0)
+	  break;
+
+      if (entry == NULL)
+	{
+	  entry = OBSTACK_ZALLOC (obstack, struct psymtab_name_entry);
+	  entry->psym = *psym;
+	  entry->hash = hash;
+	  entry->next = *bucket;
+	  *bucket = entry;
+	}
+
+      if (entry->psymtabs == NULL || entry->psymtabs->pst != pst)
+	{
+	  struct psymtab_name_node *node;
+
+	  node = OBSTACK_ZALLOC (obstack, struct psymtab_name_node);
+	  node->pst = pst;
+	  node->next = entry->psymtabs;
+	  entry->psymtabs = node;
+	}
+    }
+}
+
+/* Return the name index of OBJFILE, reading its partial symbols and
+   building the index first if needed.  */
+
+static struct psymtab_name_index *
+psymtab_name_index (struct objfile *objfile)
+{
+  struct psymtab_name_index *index;
+  struct partial_symtab *pst;
+  struct partial_symtab **psymtabs;
+  int n_psymtabs, n_psyms, i;
+
+  require_partial_symbols (objfile, 1);
+  if (objfile->psymtab_name_index != NULL)
+    return objfile->psymtab_name_index;
+
+  n_psymtabs = 0;
+  for (pst = objfile->psymtabs; pst != NULL; pst = pst->next)
+    n_psymtabs++;
+  psymtabs = xmalloc (n_psymtabs * sizeof (*psymtabs));
+  n_psymtabs = 0;
+  for (pst = objfile->psymtabs; pst != NULL; pst = pst->next)
+    psymtabs[n_psymtabs++] = pst;
+
+  n_psyms = ((objfile->global_psymbols.next - objfile->global_psymbols.list)
+	     + (objfile->static_psymbols.next
+		- objfile->static_psymbols.list));
+
+  index = OBSTACK_ZALLOC (&objfile->objfile_obstack,
+			  struct psymtab_name_index);
+  index->nbuckets = n_psyms / 2 + 1;
+  index->buckets = OBSTACK_CALLOC (&objfile->objfile_obstack,
+				   index->nbuckets,
+				   struct psymtab_name_entry *);
+
+  /* Each psymtab is prepended to the lists of its names, so go
+     backward to keep the lists in the order of the psymtab list.  */
+  for (i = n_psymtabs - 1; i >= 0; i--)
+    {
+      pst = psymtabs[i];
+      add_psymbols_to_name_index (index, pst,
+				  objfile->global_psymbols.list
+				  + pst->globals_offset,
+				  pst->n_global_syms,
+				  &objfile->objfile_obstack);
+      add_psymbols_to_name_index (index, pst,
+				  objfile->static_psymbols.list
+				  + pst->statics_offset,
+				  pst->n_static_syms,
+				  &objfile->objfile_obstack);
+    }
+  xfree (psymtabs);
+
+  objfile->psymtab_name_index = index;
+  return index;
+}
+
 static struct symtab *
 lookup_symbol_aux_psymtabs (struct objfile *objfile,
 			    int block_index, const char *name,
 			    const domain_enum domain)
 {
-  struct partial_symtab *ps;
+  struct psymtab_name_index *index;
+  struct psymtab_name_entry *entry;
   const int psymtab_index = (block_index == GLOBAL_BLOCK ? 1 : 0);
+  char *search_name;
+  struct cleanup *cleanup;
+  unsigned int hash;
 
-  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
-  {
-    if (!ps->readin && lookup_partial_symbol (ps, name, psymtab_index, domain))
-      {
-	struct symbol *sym = NULL;
-	struct symtab *stab = PSYMTAB_TO_SYMTAB (ps);
+  if (!psymtabs_may_define_name (objfile, name, domain))
+    return NULL;
 
-	/* Some caution must be observed with overloaded functions
-	   and methods, since the psymtab will not contain any overload
-	   information (but NAME might contain it).  */
-	if (stab->primary)
-	  {
-	    struct blockvector *bv = BLOCKVECTOR (stab);
-	    struct block *block = BLOCKVECTOR_BLOCK (bv, block_index);
+  index = psymtab_name_index (objfile);
+  search_name = psymtab_search_name (name);
+  cleanup = make_cleanup (xfree, search_name);
+  hash = msymbol_hash_iw (search_name);
 
-	    sym = lookup_block_symbol (block, name, domain);
-	  }
+  for (entry = index->buckets[hash % index->nbuckets];
+       entry != NULL;
+       entry = entry->next)
+    {
+      struct psymtab_name_node *node;
+
+      if (entry->hash != hash
+	  || strcmp_iw (SYMBOL_SEARCH_NAME (entry->psym), search_name) != 0)
+	continue;
 
-	if (sym && strcmp_iw (SYMBOL_SEARCH_NAME (sym), name) == 0)
-	  return stab;
+      for (node = entry->psymtabs; node != NULL; node = node->next)
+	{
+	  struct partial_symtab *ps = node->pst;
 
-	/* Keep looking through other psymtabs.  */
-      }
-  }
+	  if (!ps->readin
+	      && lookup_partial_symbol (ps, name, psymtab_index, domain))
+	    {
+	      struct symbol *sym = NULL;
+	      struct symtab *stab = PSYMTAB_TO_SYMTAB (ps);
 
+	      /* Some caution must be observed with overloaded functions
+		 and methods, since the psymtab will not contain any
+		 overload information (but NAME might contain it).  */
+	      if (stab->primary)
+		{
+		  struct blockvector *bv = BLOCKVECTOR (stab);
+		  struct block *block = BLOCKVECTOR_BLOCK (bv, block_index);
+
+		  sym = lookup_block_symbol (block, name, domain);
+		}
+
+	      if (sym && strcmp_iw (SYMBOL_SEARCH_NAME (sym), name) == 0)
+		{
+		  do_cleanups (cleanup);
+		  return stab;
+		}
+
+	      /* Keep looking through other psymtabs.  */
+	    }
+	}
+    }
+
+  do_cleanups (cleanup);
   return NULL;
 }
 
@@ -792,7 +1071,9 @@ relocate_psymtabs (struct objfile *objfile,
   struct partial_symbol **psym;
   struct partial_symtab *p;
 
-  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, p)
+  /* Do not force deferred partial symbols to be read here; when they
+     are read later, they will use the new offsets.  */
+  for (p = objfile->psymtabs; p != NULL; p = p->next)
     {
       p->textlow += ANOFFSET (delta, SECT_OFF_TEXT (objfile));
       p->texthigh += ANOFFSET (delta, SECT_OFF_TEXT (objfile));
@@ -824,6 +1105,9 @@ find_last_source_symtab_from_partial (struct objfile *ofp)
   struct partial_symtab *ps;
   struct partial_symtab *cs_pst = 0;
 
+  if (psymtabs_deferred_p (ofp))
+    return NULL;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (ofp, ps)
     {
       const char *name = ps->filename;
@@ -853,6 +1137,10 @@ forget_cached_source_info_partial (struct objfile *objfile)
 {
   struct partial_symtab *pst;
 
+  /* Nothing can be cached for partial symbols that were never read.  */
+  if (psymtabs_deferred_p (objfile))
+    return;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, pst)
     {
       if (pst->fullname != NULL)
@@ -1074,6 +1362,9 @@ read_symtabs_for_function (struct objfile *objfile, const char *func_name)
 {
   struct partial_symtab *ps;
 
+  if (!psymtabs_may_define_name (objfile, func_name, VAR_DOMAIN))
+    return;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
   {
     if (ps->readin)
@@ -1103,6 +1394,9 @@ read_psymtabs_with_filename (struct objfile *objfile, const char *filename)
 {
   struct partial_symtab *p;
 
+  if (!psymtabs_may_have_file (objfile, filename))
+    return;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, p)
     {
       if (filename_cmp (filename, p->filename) == 0)
@@ -1175,6 +1469,9 @@ find_symbol_file_from_partial (struct objfile *objfile, const char *name)
 {
   struct partial_symtab *pst;
 
+  if (!psymtabs_may_define_name (objfile, name, VAR_DOMAIN))
+    return NULL;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, pst)
     {
       if (lookup_partial_symbol (pst, name, 1, VAR_DOMAIN))
@@ -1226,6 +1523,9 @@ map_matching_symbols_psymtab (const char *name, domain_enum namespace,
   const int block_kind = global ? GLOBAL_BLOCK : STATIC_BLOCK;
   struct partial_symtab *ps;
 
+  if (!psymtabs_may_define_name (objfile, name, namespace))
+    return;
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
     {
       QUIT;
@@ -1258,6 +1558,76 @@ expand_symtabs_matching_via_partial
 {
   struct partial_symtab *ps;
 
+  /* A deferred objfile is read only if one of its minimal symbols
+     matches.  File names are not known before reading, so a search
+     restricted to some files has to read it.  */
+  if (psymtabs_deferred_p (objfile) && file_matcher == NULL)
+    {
+      struct minimal_symbol *msymbol;
+      int found = 0;
+
+      ALL_OBJFILE_MSYMBOLS (objfile, msymbol)
+	{
+	  QUIT;
+	  if ((*name_matcher) (current_language,
+			       SYMBOL_NATURAL_NAME (msymbol), data))
+	    {
+	      found = 1;
+	      break;
+	    }
+	}
+      if (!found)
+	return;
+    }
+
+  /* Completion matches every name, whatever the psymtab; go through
+     each distinct name once rather than once per psymtab.  */
+  if (file_matcher == NULL && kind == ALL_DOMAIN)
+    {
+      struct psymtab_name_index *index = psymtab_name_index (objfile);
+      struct cleanup *cleanup;
+      htab_t matching;
+      unsigned int i;
+
+      matching = htab_create_alloc (127, htab_hash_pointer, htab_eq_pointer,
+				    NULL, xcalloc, xfree);
+      cleanup = make_cleanup_htab_delete (matching);
+
+      for (i = 0; i < index->nbuckets; i++)
+	{
+	  struct psymtab_name_entry *entry;
+
+	  for (entry = index->buckets[i]; entry != NULL; entry = entry->next)
+	    {
+	      struct psymtab_name_node *node;
+
+	      QUIT;
+
+	      for (node = entry->psymtabs; node != NULL; node = node->next)
+		if (!node->pst->readin
+		    && htab_find (matching, node->pst) == NULL)
+		  break;
+	      if (node == NULL
+		  || !(*name_matcher) (current_language,
+				       SYMBOL_NATURAL_NAME (entry->psym),
+				       data))
+		continue;
+
+	      for (; node != NULL; node = node->next)
+		if (!node->pst->readin)
+		  *htab_find_slot (matching, node->pst, INSERT) = node->pst;
+	    }
+	}
+
+      /* Read the matching psymtabs in the same order as below.  */
+      ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
+	if (!ps->readin && htab_find (matching, ps) != NULL)
+	  PSYMTAB_TO_SYMTAB (ps);
+
+      do_cleanups (cleanup);
+      return;
+    }
+
   ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
     {
       struct partial_symbol **psym;
@@ -1673,6 +2043,7 @@ allocate_psymtab (const char *filename, struct objfile *objfile)
   psymtab->objfile = objfile;
   psymtab->next = objfile->psymtabs;
   objfile->psymtabs = psymtab;
+  objfile->psymtab_name_index = NULL;
 
   return (psymtab);
 }
@@ -1695,6 +2066,7 @@ discard_psymtab (struct partial_symtab *pst)
   while ((*prev_pst) != pst)
     prev_pst = &((*prev_pst)->next);
   (*prev_pst) = pst->next;
+  pst->objfile->psymtab_name_index = NULL;
 
   /* Next, put it on a free list for recycling.  */
 
@@ -49,4 +49,10 @@ extern const struct quick_symbol_functions dwarf2_gdb_index_functions;
 extern struct objfile *require_partial_symbols (struct objfile *objfile,
 						int verbose);
 
+/* Read the partial symbols of the objfiles whose debug info is read
+   lazily, hasn't been read yet, and may define NAME.  Return non-zero
+   if there were any.  */
+
+extern int read_deferred_partial_symbols (const char *name);
+
 #endif /* PSYMTAB_H */
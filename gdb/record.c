@@ -55,100 +55,119 @@
    instruction's side effects by duplicating the changes that it would
    have made on memory and registers.  */
 
-#define DEFAULT_RECORD_INSN_MAX_NUM	200000
+#define DEFAULT_RECORD_INSN_MAX_NUM	1000000
 
 #define RECORD_IS_REPLAY \
-     (record_list->next || execution_direction == EXEC_REVERSE)
+     (record_cur != record_insn_count || execution_direction == EXEC_REVERSE)
+
+#define RECORD_FILE_MAGIC	netorder32(0x20121016)
+
+/* These are the core structures of the process record functionality.
+
+   The execution log records, for each instruction, the changes the
+   instruction makes to registers and memory.  For each register and
+   each piece of memory, it holds the value that is not currently in
+   the inferior: the value from before the instruction while the
+   instruction's effects are applied, the value from after it while
+   they are not.  Executing an instruction, forward or backward, swaps
+   the logged values with the inferior's.
+
+   The changes of an instruction are encoded as a sequence of entries,
+   each starting with an opcode byte, and ending with an end entry:
+
+     RECORD_OP_REG: a register.  Bits 2-7 of the opcode hold the
+       register number plus one, or zero, in which case a ULEB128
+       register number follows.  Then the register's raw contents;
+       their size is in record_reg_size.
+
+     RECORD_OP_MEM: a piece of memory.  Bits 4-7 of the opcode hold its
+       length, or zero, in which case a ULEB128 length follows.  Then
+       the address: an SLEB128 offset from the address of the previous
+       memory entry of the instruction if RECORD_MEM_DELTA is set, a
+       ULEB128 address otherwise.  Then the memory contents.
+       RECORD_MEM_NOT_ACCESSIBLE is set once the memory can no longer
+       be accessed.
+
+     RECORD_OP_END: the end of the instruction.
+
+     RECORD_OP_END_SIGNAL: likewise, followed by the signal, as two
+       bytes in big-endian order, that was delivered to the inferior
+       when it resumed after the instruction.
+
+   The instructions are numbered consecutively.  Their changes are
+   laid out back to back in chunks of RECORD_CHUNK_SIZE bytes, and
+   never span two chunks; an instruction whose changes don't fit in
+   a chunk gets a chunk of its own.  Each chunk has an index of where
+   each of its instructions starts, so that the log can be walked
+   backward as cheaply as forward.  */
+
+enum record_op
+{
+  RECORD_OP_END = 0,
+  RECORD_OP_END_SIGNAL,
+  RECORD_OP_REG,
+  RECORD_OP_MEM
+};
 
-#define RECORD_FILE_MAGIC	netorder32(0x20091016)
+#define RECORD_OP_MASK			0x03
+#define RECORD_REG_SHIFT		2
+#define RECORD_MEM_NOT_ACCESSIBLE	0x04
+#define RECORD_MEM_DELTA		0x08
+#define RECORD_MEM_LEN_SHIFT		4
 
-/* These are the core structs of the process record functionality.
+#define RECORD_CHUNK_SIZE	65536
 
-   A record_entry is a record of the value change of a register
-   ("record_reg") or a part of memory ("record_mem").  And each
-   instruction must have a struct record_entry ("record_end") that
-   indicates that this is the last struct record_entry of this
-   instruction.
+struct record_chunk
+{
+  struct record_chunk *prev;
+  struct record_chunk *next;
 
-   Each struct record_entry is linked to "record_list" by "prev" and
-   "next" pointers.  */
+  /* The number of the instruction whose changes start at INDEX[0].  */
+  ULONGEST base_insn;
 
-struct record_mem_entry
-{
-  CORE_ADDR addr;
-  int len;
-  /* Set this flag if target memory for this entry
-     can no longer be accessed.  */
-  int mem_entry_not_accessible;
-  union
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[sizeof (gdb_byte *)];
-  } u;
-};
+  /* The instructions at INDEX[FIRST] to INDEX[NUM_INSNS - 1] are in
+     the log; the ones before FIRST have been released.  */
+  unsigned int first;
+  unsigned int num_insns;
 
-struct record_reg_entry
-{
-  unsigned short num;
-  unsigned short len;
-  union 
-  {
-    gdb_byte *ptr;
-    gdb_byte buf[2 * sizeof (gdb_byte *)];
-  } u;
-};
+  /* The offsets in DATA where the changes of each instruction start.
+     The size of DATA keeps them below 65536, except in a chunk that
+     holds a single instruction.  */
+  unsigned short *index;
+  unsigned int index_alloc;
 
-struct record_end_entry
-{
-  enum target_signal sigval;
-  ULONGEST insn_num;
-};
+  /* Non-zero if some instruction in the chunk ends with a
+     RECORD_OP_END_SIGNAL entry.  */
+  int signals;
 
-enum record_type
-{
-  record_end = 0,
-  record_reg,
-  record_mem
+  /* The changes, SIZE bytes of them, in a buffer of ALLOC bytes.  */
+  unsigned int size;
+  unsigned int alloc;
+  gdb_byte data[1];
 };
 
-/* This is the data structure that makes up the execution log.
+/* An entry of the execution log, decoded by record_decode_entry.  */
 
-   The execution log consists of a single linked list of entries
-   of type "struct record_entry".  It is doubly linked so that it
-   can be traversed in either direction.
+struct record_entry
+{
+  enum record_op type;
 
-   The start of the list is anchored by a struct called
-   "record_first".  The pointer "record_list" either points to the
-   last entry that was added to the list (in record mode), or to the
-   next entry in the list that will be executed (in replay mode).
+  /* The opcode byte in the log.  */
+  gdb_byte *op;
 
-   Each list element (struct record_entry), in addition to next and
-   prev pointers, consists of a union of three entry types: mem, reg,
-   and end.  A field called "type" determines which entry type is
-   represented by a given list element.
+  /* The register number, for RECORD_OP_REG.  */
+  int regnum;
 
-   Each instruction that is added to the execution log is represented
-   by a variable number of list elements ('entries').  The instruction
-   will have one "reg" entry for each register that is changed by 
-   executing the instruction (including the PC in every case).  It 
-   will also have one "mem" entry for each memory change.  Finally,
-   each instruction will have an "end" entry that separates it from
-   the changes associated with the next instruction.  */
+  /* The address, for RECORD_OP_MEM.  */
+  CORE_ADDR addr;
 
-struct record_entry
-{
-  struct record_entry *prev;
-  struct record_entry *next;
-  enum record_type type;
-  union
-  {
-    /* reg */
-    struct record_reg_entry reg;
-    /* mem */
-    struct record_mem_entry mem;
-    /* end */
-    struct record_end_entry end;
-  } u;
+  /* The logged contents of the register or memory, and their
+     length.  */
+  gdb_byte *val;
+  int len;
+
+  /* The signal, for RECORD_OP_END_SIGNAL.  */
+  enum target_signal sigval;
 };
 
 /* This is the debug switch for process record.  */
@@ -171,35 +190,54 @@ static struct target_section *record_core_start;
 static struct target_section *record_core_end;
 static struct record_core_buf_entry *record_core_buf_list = NULL;
 
-/* The following variables are used for managing the linked list that
-   represents the execution log.
-
-   record_first is the anchor that holds down the beginning of the list.
-
-   record_list serves two functions:
-     1) In record mode, it anchors the end of the list.
-     2) In replay mode, it traverses the list and points to
-        the next instruction that must be emulated.
-
-   record_arch_list_head and record_arch_list_tail are used to manage
-   a separate list, which is used to build up the change elements of
-   the currently executing instruction during record mode.  When this
-   instruction has been completely annotated in the "arch list", it 
-   will be appended to the main execution log.  */
-
-static struct record_entry record_first;
-static struct record_entry *record_list = &record_first;
-static struct record_entry *record_arch_list_head = NULL;
-static struct record_entry *record_arch_list_tail = NULL;
-
-/* 1 ask user. 0 auto delete the last struct record_entry.  */
+/* The following variables are used for managing the execution log.
+
+   record_chunks_head and record_chunks_tail are the oldest and the
+   newest chunk of the log.  record_chunk_hint is the chunk where an
+   instruction was last looked up; the log is mostly walked one
+   instruction at a time, so the next lookup likely hits it.
+
+   record_cur is the number of the last instruction whose effects are
+   applied to the inferior:
+     1) In record mode, it is the last instruction of the log.
+     2) In replay mode, the next instruction to emulate going forward
+        is the one after it, going backward it is record_cur itself.
+   It is one less than the number of the first instruction of the log
+   when the inferior is at the start of the log.
+
+   record_arch_buf holds the changes of the instruction being
+   recorded, encoded as in a chunk.  When the instruction has been
+   completely annotated, it is appended to the execution log.  */
+
+static struct record_chunk *record_chunks_head = NULL;
+static struct record_chunk *record_chunks_tail = NULL;
+static struct record_chunk *record_chunk_hint = NULL;
+static ULONGEST record_cur = 0;
+
+static gdb_byte *record_arch_buf = NULL;
+static unsigned int record_arch_size = 0;
+static unsigned int record_arch_alloc = 0;
+
+/* The address of the last memory entry in record_arch_buf, if
+   record_arch_mem_p.  */
+static CORE_ADDR record_arch_mem_addr;
+static int record_arch_mem_p = 0;
+
+/* The size of each register number in the log, or zero if no change
+   of that register has been logged.  The log is decoded with these
+   sizes, whatever the current architecture is.  */
+static unsigned short *record_reg_size = NULL;
+static int record_reg_size_count = 0;
+
+/* 1 ask user. 0 auto delete the oldest instruction in the log.  */
 static int record_stop_at_limit = 1;
 /* Maximum allowed number of insns in execution log.  */
 static unsigned int record_insn_max_num = DEFAULT_RECORD_INSN_MAX_NUM;
 /* Actual count of insns presently in execution log.  */
 static int record_insn_num = 0;
 /* Count of insns logged so far (may be larger
-   than count of insns presently in execution log).  */
+   than count of insns presently in execution log).  This is also the
+   number of the last instruction of the log.  */
 static ULONGEST record_insn_count;
 
 /* The target_ops of process record.  */
@@ -235,153 +273,400 @@ static int (*record_beneath_to_stopped_data_address) (struct target_ops *,
 						      CORE_ADDR *);
 static void (*record_beneath_to_async) (void (*) (enum inferior_event_type, void *), void *);
 
-/* Alloc and free functions for record_reg, record_mem, and record_end 
-   entries.  */
+/* Functions to encode and decode the execution log.  */
 
-/* Alloc a record_reg record entry.  */
+/* Reserve LEN more bytes at the end of record_arch_buf, and return a
+   pointer to them.  */
 
-static inline struct record_entry *
-record_reg_alloc (struct regcache *regcache, int regnum)
+static gdb_byte *
+record_arch_grow (unsigned int len)
 {
-  struct record_entry *rec;
-  struct gdbarch *gdbarch = get_regcache_arch (regcache);
+  gdb_byte *p;
 
-  rec = (struct record_entry *) xcalloc (1, sizeof (struct record_entry));
-  rec->type = record_reg;
-  rec->u.reg.num = regnum;
-  rec->u.reg.len = register_size (gdbarch, regnum);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    rec->u.reg.u.ptr = (gdb_byte *) xmalloc (rec->u.reg.len);
+  if (record_arch_size + len > record_arch_alloc)
+    {
+      record_arch_alloc = 2 * record_arch_alloc;
+      if (record_arch_alloc < record_arch_size + len)
+	record_arch_alloc = record_arch_size + len;
+      record_arch_buf = xrealloc (record_arch_buf, record_arch_alloc);
+    }
 
-  return rec;
+  p = record_arch_buf + record_arch_size;
+  record_arch_size += len;
+  return p;
 }
 
-/* Free a record_reg record entry.  */
+/* Discard the changes in record_arch_buf.  */
 
-static inline void
-record_reg_release (struct record_entry *rec)
+static void
+record_arch_reset (void)
 {
-  gdb_assert (rec->type == record_reg);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    xfree (rec->u.reg.u.ptr);
-  xfree (rec);
+  record_arch_size = 0;
+  record_arch_mem_p = 0;
 }
 
-/* Alloc a record_mem record entry.  */
+/* Append the ULEB128 encoding of VAL to record_arch_buf.  */
 
-static inline struct record_entry *
-record_mem_alloc (CORE_ADDR addr, int len)
+static void
+record_arch_put_uleb (ULONGEST val)
 {
-  struct record_entry *rec;
+  gdb_byte buf[10];
+  int len = 0;
 
-  rec = (struct record_entry *) xcalloc (1, sizeof (struct record_entry));
-  rec->type = record_mem;
-  rec->u.mem.addr = addr;
-  rec->u.mem.len = len;
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    rec->u.mem.u.ptr = (gdb_byte *) xmalloc (len);
+  do
+    {
+      buf[len] = val & 0x7f;
+      val >>= 7;
+      if (val != 0)
+	buf[len] |= 0x80;
+      len++;
+    }
+  while (val != 0);
 
-  return rec;
+  memcpy (record_arch_grow (len), buf, len);
 }
 
-/* Free a record_mem record entry.  */
+/* Append the SLEB128 encoding of VAL to record_arch_buf.  */
 
-static inline void
-record_mem_release (struct record_entry *rec)
+static void
+record_arch_put_sleb (LONGEST val)
 {
-  gdb_assert (rec->type == record_mem);
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    xfree (rec->u.mem.u.ptr);
-  xfree (rec);
+  gdb_byte buf[10];
+  int len = 0;
+  int more;
+
+  do
+    {
+      buf[len] = val & 0x7f;
+      val >>= 7;
+      more = !((val == 0 && (buf[len] & 0x40) == 0)
+	       || (val == -1 && (buf[len] & 0x40) != 0));
+      if (more)
+	buf[len] |= 0x80;
+      len++;
+    }
+  while (more);
+
+  memcpy (record_arch_grow (len), buf, len);
 }
 
-/* Alloc a record_end record entry.  */
+/* Read a ULEB128 number from P into *VAL.  Return a pointer past
+   it.  */
 
-static inline struct record_entry *
-record_end_alloc (void)
+static gdb_byte *
+record_get_uleb (gdb_byte *p, ULONGEST *val)
 {
-  struct record_entry *rec;
+  ULONGEST result = 0;
+  int shift = 0;
+  gdb_byte byte;
 
-  rec = (struct record_entry *) xcalloc (1, sizeof (struct record_entry));
-  rec->type = record_end;
+  do
+    {
+      byte = *p++;
+      result |= (ULONGEST) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
 
-  return rec;
+  *val = result;
+  return p;
 }
 
-/* Free a record_end record entry.  */
+/* Read an SLEB128 number from P into *VAL.  Return a pointer past
+   it.  */
 
-static inline void
-record_end_release (struct record_entry *rec)
+static gdb_byte *
+record_get_sleb (gdb_byte *p, LONGEST *val)
 {
-  xfree (rec);
+  ULONGEST result = 0;
+  int shift = 0;
+  gdb_byte byte;
+
+  do
+    {
+      byte = *p++;
+      result |= (ULONGEST) (byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while (byte & 0x80);
+
+  if (shift < 8 * sizeof (result) && (byte & 0x40) != 0)
+    result |= -((ULONGEST) 1 << shift);
+
+  *val = result;
+  return p;
 }
 
-/* Free one record entry, any type.
-   Return entry->type, in case caller wants to know.  */
+/* Note that register REGNUM is LEN bytes long.  Return -1 if the log
+   already has changes of REGNUM with a different size.  */
 
-static inline enum record_type
-record_entry_release (struct record_entry *rec)
+static int
+record_note_reg_size (int regnum, int len)
 {
-  enum record_type type = rec->type;
+  if (regnum >= record_reg_size_count)
+    {
+      int count = record_reg_size_count ? 2 * record_reg_size_count : 64;
+
+      while (count <= regnum)
+	count *= 2;
+      record_reg_size = xrealloc (record_reg_size,
+				  count * sizeof (*record_reg_size));
+      memset (record_reg_size + record_reg_size_count, 0,
+	      (count - record_reg_size_count) * sizeof (*record_reg_size));
+      record_reg_size_count = count;
+    }
+
+  if (record_reg_size[regnum] == 0)
+    record_reg_size[regnum] = len;
+  else if (record_reg_size[regnum] != len)
+    return -1;
 
-  switch (type) {
-  case record_reg:
-    record_reg_release (rec);
-    break;
-  case record_mem:
-    record_mem_release (rec);
-    break;
-  case record_end:
-    record_end_release (rec);
-    break;
-  }
-  return type;
+  return 0;
 }
 
-/* Free all record entries in list pointed to by REC.  */
+/* Decode the log entry at P into ENTRY, and return a pointer to the
+   entry that follows it.  *MEM_ADDR is the address of the previous
+   memory entry of the same instruction; it is updated if ENTRY is a
+   memory entry.  */
 
-static void
-record_list_release (struct record_entry *rec)
+static gdb_byte *
+record_decode_entry (gdb_byte *p, struct record_entry *entry,
+		     CORE_ADDR *mem_addr)
 {
-  if (!rec)
-    return;
+  ULONGEST uval;
+  LONGEST sval;
 
-  while (rec->next)
-    rec = rec->next;
+  entry->op = p;
+  entry->type = *p & RECORD_OP_MASK;
+  p++;
 
-  while (rec->prev)
+  switch (entry->type)
     {
-      rec = rec->prev;
-      record_entry_release (rec->next);
+    case RECORD_OP_END:
+      entry->sigval = TARGET_SIGNAL_0;
+      break;
+
+    case RECORD_OP_END_SIGNAL:
+      entry->sigval = (p[0] << 8) | p[1];
+      p += 2;
+      break;
+
+    case RECORD_OP_REG:
+      uval = *entry->op >> RECORD_REG_SHIFT;
+      if (uval == 0)
+	p = record_get_uleb (p, &uval);
+      else
+	uval--;
+      entry->regnum = uval;
+      gdb_assert (entry->regnum < record_reg_size_count);
+      entry->len = record_reg_size[entry->regnum];
+      entry->val = p;
+      p += entry->len;
+      break;
+
+    case RECORD_OP_MEM:
+      uval = *entry->op >> RECORD_MEM_LEN_SHIFT;
+      if (uval == 0)
+	p = record_get_uleb (p, &uval);
+      entry->len = uval;
+      if (*entry->op & RECORD_MEM_DELTA)
+	{
+	  p = record_get_sleb (p, &sval);
+	  *mem_addr += sval;
+	}
+      else
+	{
+	  p = record_get_uleb (p, &uval);
+	  *mem_addr = uval;
+	}
+      entry->addr = *mem_addr;
+      entry->val = p;
+      p += entry->len;
+      break;
     }
 
-  if (rec == &record_first)
+  return p;
+}
+
+/* Return the number of the first instruction of the log.  */
+
+static ULONGEST
+record_first_insn (void)
+{
+  return record_insn_count - record_insn_num + 1;
+}
+
+/* Find the changes of instruction INSN, which must be in the log.
+   Set *START and *END to their bounds and return the chunk holding
+   them.  */
+
+static struct record_chunk *
+record_find_insn (ULONGEST insn, gdb_byte **start, gdb_byte **end)
+{
+  struct record_chunk *chunk = record_chunk_hint;
+  unsigned int i;
+
+  gdb_assert (insn >= record_first_insn () && insn <= record_insn_count);
+
+  if (chunk == NULL)
+    chunk = record_chunks_tail;
+  while (insn < chunk->base_insn + chunk->first)
+    chunk = chunk->prev;
+  while (insn >= chunk->base_insn + chunk->num_insns)
+    chunk = chunk->next;
+  record_chunk_hint = chunk;
+
+  i = insn - chunk->base_insn;
+  *start = chunk->data + chunk->index[i];
+  if (i + 1 < chunk->num_insns)
+    *end = chunk->data + chunk->index[i + 1];
+  else
+    *end = chunk->data + chunk->size;
+
+  return chunk;
+}
+
+/* Return the end entry of instruction INSN.  */
+
+static gdb_byte *
+record_insn_end (ULONGEST insn)
+{
+  struct record_entry entry;
+  CORE_ADDR mem_addr = 0;
+  gdb_byte *p, *end;
+
+  record_find_insn (insn, &p, &end);
+  do
+    p = record_decode_entry (p, &entry, &mem_addr);
+  while (entry.type == RECORD_OP_REG || entry.type == RECORD_OP_MEM);
+
+  return entry.op;
+}
+
+/* Return the signal recorded at the end of instruction INSN, or
+   TARGET_SIGNAL_0 if INSN is not in the log.  */
+
+static enum target_signal
+record_insn_signal (ULONGEST insn)
+{
+  struct record_chunk *chunk;
+  struct record_entry entry;
+  CORE_ADDR mem_addr = 0;
+  gdb_byte *p, *end;
+
+  if (record_insn_num == 0 || insn < record_first_insn ())
+    return TARGET_SIGNAL_0;
+
+  chunk = record_find_insn (insn, &p, &end);
+  if (!chunk->signals)
+    return TARGET_SIGNAL_0;
+
+  record_decode_entry (record_insn_end (insn), &entry, &mem_addr);
+  return entry.sigval;
+}
+
+/* Record SIGNAL at the end of the last instruction of the log.  */
+
+static void
+record_set_last_signal (enum target_signal signal)
+{
+  struct record_chunk *chunk = record_chunks_tail;
+  gdb_byte *p = record_insn_end (record_insn_count);
+
+  if (*p == RECORD_OP_END)
     {
-      record_insn_num = 0;
-      record_first.next = NULL;
+      if (signal == TARGET_SIGNAL_0)
+	return;
+
+      /* record_log_append leaves room for the signal.  */
+      gdb_assert (p + 1 == chunk->data + chunk->size);
+      gdb_assert (chunk->size + 2 <= chunk->alloc);
+      *p = RECORD_OP_END_SIGNAL;
+      chunk->size += 2;
     }
-  else
-    record_entry_release (rec);
+
+  p[1] = (signal >> 8) & 0xff;
+  p[2] = signal & 0xff;
+  chunk->signals = 1;
 }
 
-/* Free all record entries forward of the given list position.  */
+/* Unlink CHUNK from the log and free it.  */
 
 static void
-record_list_release_following (struct record_entry *rec)
+record_chunk_free (struct record_chunk *chunk)
+{
+  if (chunk->prev)
+    chunk->prev->next = chunk->next;
+  else
+    record_chunks_head = chunk->next;
+  if (chunk->next)
+    chunk->next->prev = chunk->prev;
+  else
+    record_chunks_tail = chunk->prev;
+
+  if (record_chunk_hint == chunk)
+    record_chunk_hint = NULL;
+
+  xfree (chunk->index);
+  xfree (chunk);
+}
+
+/* Allocate a chunk with room for at least SIZE bytes of changes, and
+   append it to the log.  The first instruction added to it will be
+   instruction BASE_INSN.  */
+
+static struct record_chunk *
+record_chunk_new (unsigned int size, ULONGEST base_insn)
 {
-  struct record_entry *tmp = rec->next;
+  struct record_chunk *chunk;
+
+  if (size < RECORD_CHUNK_SIZE)
+    size = RECORD_CHUNK_SIZE;
+
+  chunk = xmalloc (offsetof (struct record_chunk, data) + size);
+  memset (chunk, 0, offsetof (struct record_chunk, data));
+  chunk->base_insn = base_insn;
+  chunk->alloc = size;
+
+  chunk->prev = record_chunks_tail;
+  if (record_chunks_tail)
+    record_chunks_tail->next = chunk;
+  else
+    record_chunks_head = chunk;
+  record_chunks_tail = chunk;
+
+  return chunk;
+}
 
-  rec->next = NULL;
-  while (tmp)
+/* Add an instruction whose changes start at offset OFFSET to the index
+   of CHUNK.  */
+
+static void
+record_chunk_add_insn (struct record_chunk *chunk, unsigned int offset)
+{
+  if (chunk->num_insns == chunk->index_alloc)
     {
-      rec = tmp->next;
-      if (record_entry_release (tmp) == record_end)
-	{
-	  record_insn_num--;
-	  record_insn_count--;
-	}
-      tmp = rec;
+      chunk->index_alloc = chunk->index_alloc ? 2 * chunk->index_alloc : 256;
+      chunk->index = xrealloc (chunk->index,
+			       chunk->index_alloc * sizeof (*chunk->index));
     }
+  chunk->index[chunk->num_insns++] = offset;
+}
+
+/* Free the whole execution log.  */
+
+static void
+record_log_release (void)
+{
+  while (record_chunks_head)
+    record_chunk_free (record_chunks_head);
+
+  record_insn_num = 0;
+  record_cur = record_insn_count;
+
+  xfree (record_reg_size);
+  record_reg_size = NULL;
+  record_reg_size_count = 0;
 }
 
 /* Delete the first instruction from the beginning of the log, to make
@@ -392,74 +677,66 @@ record_list_release_following (struct record_entry *rec)
 static void
 record_list_release_first (void)
 {
-  struct record_entry *tmp;
+  struct record_chunk *chunk = record_chunks_head;
 
-  if (!record_first.next)
+  if (chunk == NULL)
     return;
 
-  /* Loop until a record_end.  */
-  while (1)
-    {
-      /* Cut record_first.next out of the linked list.  */
-      tmp = record_first.next;
-      record_first.next = tmp->next;
-      tmp->next->prev = &record_first;
+  chunk->first++;
+  if (chunk->first == chunk->num_insns)
+    record_chunk_free (chunk);
+}
 
-      /* tmp is now isolated, and can be deleted.  */
-      if (record_entry_release (tmp) == record_end)
-	break;	/* End loop at first record_end.  */
+/* Free all instructions after the current position of the log.  */
 
-      if (!record_first.next)
+static void
+record_list_release_following (void)
+{
+  while (record_insn_count > record_cur)
+    {
+      struct record_chunk *chunk = record_chunks_tail;
+      unsigned int n = chunk->num_insns - chunk->first;
+
+      if (record_insn_count - record_cur >= n)
+	record_chunk_free (chunk);
+      else
 	{
-	  gdb_assert (record_insn_num == 1);
-	  break;	/* End loop when list is empty.  */
+	  n = record_insn_count - record_cur;
+	  chunk->num_insns -= n;
+	  chunk->size = chunk->index[chunk->num_insns];
 	}
+
+      record_insn_num -= n;
+      record_insn_count -= n;
     }
 }
 
-/* Add a struct record_entry to record_arch_list.  */
+/* Append the instruction in record_arch_buf to the end of the log,
+   and make it the current instruction.  Release the oldest instruction
+   if the log is full.  */
 
 static void
-record_arch_list_add (struct record_entry *rec)
+record_log_append (void)
 {
-  if (record_debug > 1)
-    fprintf_unfiltered (gdb_stdlog,
-			"Process record: record_arch_list_add %s.\n",
-			host_address_to_string (rec));
+  struct record_chunk *chunk = record_chunks_tail;
+  unsigned int len = record_arch_size;
 
-  if (record_arch_list_tail)
-    {
-      record_arch_list_tail->next = rec;
-      rec->prev = record_arch_list_tail;
-      record_arch_list_tail = rec;
-    }
-  else
-    {
-      record_arch_list_head = rec;
-      record_arch_list_tail = rec;
-    }
-}
+  /* Keep room for record_set_last_signal.  */
+  if (chunk == NULL || chunk->size + len + 2 > chunk->alloc)
+    chunk = record_chunk_new (len + 2, record_insn_count + 1);
+
+  record_chunk_add_insn (chunk, chunk->size);
+  memcpy (chunk->data + chunk->size, record_arch_buf, len);
+  chunk->size += len;
+  record_arch_reset ();
 
-/* Return the value storage location of a record entry.  */
-static inline gdb_byte *
-record_get_loc (struct record_entry *rec)
-{
-  switch (rec->type) {
-  case record_mem:
-    if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-      return rec->u.mem.u.ptr;
-    else
-      return rec->u.mem.u.buf;
-  case record_reg:
-    if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-      return rec->u.reg.u.ptr;
-    else
-      return rec->u.reg.u.buf;
-  case record_end:
-  default:
-    gdb_assert_not_reached ("unexpected record_entry type");
-    return NULL;
-  }
+  record_insn_count++;
+  record_cur = record_insn_count;
+
+  if (record_insn_num == record_insn_max_num && record_insn_max_num)
+    record_list_release_first ();
+  else
+    record_insn_num++;
 }
 
 /* Record the value of a register NUM to record_arch_list.  */
@@ -467,7 +744,7 @@ record_get_loc (struct record_entry *rec)
 int
 record_arch_list_add_reg (struct regcache *regcache, int regnum)
 {
-  struct record_entry *rec;
+  int len = register_size (get_regcache_arch (regcache), regnum);
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
@@ -475,11 +752,18 @@ record_arch_list_add_reg (struct regcache *regcache, int regnum)
 			"record list.\n",
 			regnum);
 
-  rec = record_reg_alloc (regcache, regnum);
+  if (record_note_reg_size (regnum, len))
+    return -1;
 
-  regcache_raw_read (regcache, regnum, record_get_loc (rec));
+  if (regnum + 1 < (1 << (8 - RECORD_REG_SHIFT)))
+    *record_arch_grow (1) = RECORD_OP_REG | ((regnum + 1) << RECORD_REG_SHIFT);
+  else
+    {
+      *record_arch_grow (1) = RECORD_OP_REG;
+      record_arch_put_uleb (regnum);
+    }
 
-  record_arch_list_add (rec);
+  regcache_raw_read (regcache, regnum, record_arch_grow (len));
 
   return 0;
 }
@@ -490,7 +774,8 @@ record_arch_list_add_reg (struct regcache *regcache, int regnum)
 int
 record_arch_list_add_mem (CORE_ADDR addr, int len)
 {
-  struct record_entry *rec;
+  unsigned int old_size = record_arch_size;
+  gdb_byte op = RECORD_OP_MEM;
 
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
@@ -501,40 +786,46 @@ record_arch_list_add_mem (CORE_ADDR addr, int len)
   if (!addr)	/* FIXME: Why?  Some arch must permit it...  */
     return 0;
 
-  rec = record_mem_alloc (addr, len);
+  if (record_arch_mem_p)
+    op |= RECORD_MEM_DELTA;
+  if (len > 0 && len < (1 << (8 - RECORD_MEM_LEN_SHIFT)))
+    op |= len << RECORD_MEM_LEN_SHIFT;
 
-  if (target_read_memory (addr, record_get_loc (rec), len))
+  *record_arch_grow (1) = op;
+  if ((op >> RECORD_MEM_LEN_SHIFT) == 0)
+    record_arch_put_uleb (len);
+  if (record_arch_mem_p)
+    record_arch_put_sleb ((LONGEST) (addr - record_arch_mem_addr));
+  else
+    record_arch_put_uleb (addr);
+
+  if (target_read_memory (addr, record_arch_grow (len), len))
     {
       if (record_debug)
 	fprintf_unfiltered (gdb_stdlog,
 			    "Process record: error reading memory at "
 			    "addr = %s len = %d.\n",
 			    paddress (target_gdbarch, addr), len);
-      record_mem_release (rec);
+      record_arch_size = old_size;
       return -1;
     }
 
-  record_arch_list_add (rec);
+  record_arch_mem_addr = addr;
+  record_arch_mem_p = 1;
 
   return 0;
 }
 
-/* Add a record_end type struct record_entry to record_arch_list.  */
+/* Add the end of the instruction to record_arch_list.  */
 
 int
 record_arch_list_add_end (void)
 {
-  struct record_entry *rec;
-
   if (record_debug > 1)
     fprintf_unfiltered (gdb_stdlog,
 			"Process record: add end to arch list.\n");
 
-  rec = record_end_alloc ();
-  rec->u.end.sigval = TARGET_SIGNAL_0;
-  rec->u.end.insn_num = ++record_insn_count;
-
-  record_arch_list_add (rec);
+  *record_arch_grow (1) = RECORD_OP_END;
 
   return 0;
 }
@@ -571,14 +862,14 @@ record_check_insn_num (int set_terminal)
 static void
 record_arch_list_cleanups (void *ignore)
 {
-  record_list_release (record_arch_list_tail);
+  record_arch_reset ();
 }
 
 /* Before inferior step (when GDB record the running message, inferior
    only can step), GDB will call this function to record the values to
-   record_list.  This function will call gdbarch_process_record to
-   record the running message of inferior and set them to
-   record_arch_list, and add it to record_list.  */
+   the execution log.  This function will call gdbarch_process_record
+   to record the running message of inferior in record_arch_buf, and
+   append it to the log.  */
 
 static int
 record_message (struct regcache *regcache, enum target_signal signal)
@@ -587,8 +878,7 @@ record_message (struct regcache *regcache, enum target_signal signal)
   struct gdbarch *gdbarch = get_regcache_arch (regcache);
   struct cleanup *old_cleanups = make_cleanup (record_arch_list_cleanups, 0);
 
-  record_arch_list_head = NULL;
-  record_arch_list_tail = NULL;
+  record_arch_reset ();
 
   /* Check record_insn_num.  */
   record_check_insn_num (1);
@@ -615,11 +905,8 @@ record_message (struct regcache *regcache, enum target_signal signal)
      But we should still deliver the signal to gdb during the replay,
      if we delivered it during the recording.  Therefore we should
      record the signal during record_wait, not record_resume.  */
-  if (record_list != &record_first)    /* FIXME better way to check */
-    {
-      gdb_assert (record_list->type == record_end);
-      record_list->u.end.sigval = signal;
-    }
+  if (record_insn_num > 0)
+    record_set_last_signal (signal);
 
   if (signal == TARGET_SIGNAL_0
       || !gdbarch_process_record_signal_p (gdbarch))
@@ -638,14 +925,7 @@ record_message (struct regcache *regcache, enum target_signal signal)
 
   discard_cleanups (old_cleanups);
 
-  record_list->next = record_arch_list_head;
-  record_arch_list_head->prev = record_list;
-  record_list = record_arch_list_tail;
-
-  if (record_insn_num == record_insn_max_num && record_insn_max_num)
-    record_list_release_first ();
-  else
-    record_insn_num++;
+  record_log_append ();
 
   return 1;
 }
@@ -695,17 +975,16 @@ record_gdb_operation_disable_set (void)
 /* Flag set to TRUE for target_stopped_by_watchpoint.  */
 static int record_hw_watchpoint = 0;
 
-/* Execute one instruction from the record log.  Each instruction in
-   the log will be represented by an arbitrary sequence of register
-   entries and memory entries, followed by an 'end' entry.  */
+/* Swap the register or the memory of log entry ENTRY with the
+   inferior's.  */
 
 static inline void
-record_exec_insn (struct regcache *regcache, struct gdbarch *gdbarch,
-		  struct record_entry *entry)
+record_exec_entry (struct regcache *regcache, struct gdbarch *gdbarch,
+		   struct record_entry *entry)
 {
   switch (entry->type)
     {
-    case record_reg: /* reg */
+    case RECORD_OP_REG: /* reg */
       {
         gdb_byte reg[MAX_REGISTER_SIZE];
 
@@ -713,56 +992,54 @@ record_exec_insn (struct regcache *regcache, struct gdbarch *gdbarch,
           fprintf_unfiltered (gdb_stdlog,
                               "Process record: record_reg %s to "
                               "inferior num = %d.\n",
-                              host_address_to_string (entry),
-                              entry->u.reg.num);
+                              host_address_to_string (entry->op),
+                              entry->regnum);
 
-        regcache_cooked_read (regcache, entry->u.reg.num, reg);
-        regcache_cooked_write (regcache, entry->u.reg.num, 
-			       record_get_loc (entry));
-        memcpy (record_get_loc (entry), reg, entry->u.reg.len);
+        regcache_cooked_read (regcache, entry->regnum, reg);
+        regcache_cooked_write (regcache, entry->regnum, entry->val);
+        memcpy (entry->val, reg, entry->len);
       }
       break;
 
-    case record_mem: /* mem */
+    case RECORD_OP_MEM: /* mem */
       {
 	/* Nothing to do if the entry is flagged not_accessible.  */
-        if (!entry->u.mem.mem_entry_not_accessible)
+        if (!(*entry->op & RECORD_MEM_NOT_ACCESSIBLE))
           {
-            gdb_byte *mem = alloca (entry->u.mem.len);
+            gdb_byte *mem = alloca (entry->len);
 
             if (record_debug > 1)
               fprintf_unfiltered (gdb_stdlog,
                                   "Process record: record_mem %s to "
                                   "inferior addr = %s len = %d.\n",
-                                  host_address_to_string (entry),
-                                  paddress (gdbarch, entry->u.mem.addr),
-                                  entry->u.mem.len);
+                                  host_address_to_string (entry->op),
+                                  paddress (gdbarch, entry->addr),
+                                  entry->len);
 
-            if (target_read_memory (entry->u.mem.addr, mem, entry->u.mem.len))
+            if (target_read_memory (entry->addr, mem, entry->len))
               {
-                entry->u.mem.mem_entry_not_accessible = 1;
+                *entry->op |= RECORD_MEM_NOT_ACCESSIBLE;
                 if (record_debug)
                   warning (_("Process record: error reading memory at "
 			     "addr = %s len = %d."),
-                           paddress (gdbarch, entry->u.mem.addr),
-                           entry->u.mem.len);
+                           paddress (gdbarch, entry->addr),
+                           entry->len);
               }
             else
               {
-                if (target_write_memory (entry->u.mem.addr, 
-					 record_get_loc (entry),
-					 entry->u.mem.len))
+                if (target_write_memory (entry->addr, entry->val,
+					 entry->len))
                   {
-                    entry->u.mem.mem_entry_not_accessible = 1;
+                    *entry->op |= RECORD_MEM_NOT_ACCESSIBLE;
                     if (record_debug)
                       warning (_("Process record: error writing memory at "
 				 "addr = %s len = %d."),
-                               paddress (gdbarch, entry->u.mem.addr),
-                               entry->u.mem.len);
+                               paddress (gdbarch, entry->addr),
+                               entry->len);
                   }
                 else
 		  {
-		    memcpy (record_get_loc (entry), mem, entry->u.mem.len);
+		    memcpy (entry->val, mem, entry->len);
 
 		    /* We've changed memory --- check if a hardware
 		       watchpoint should trap.  Note that this
@@ -774,7 +1051,7 @@ record_exec_insn (struct regcache *regcache, struct gdbarch *gdbarch,
 		       traps.  */
 		    if (hardware_watchpoint_inserted_in_range
 			(get_regcache_aspace (regcache),
-			 entry->u.mem.addr, entry->u.mem.len))
+			 entry->addr, entry->len))
 		      record_hw_watchpoint = 1;
 		  }
               }
@@ -784,6 +1061,52 @@ record_exec_insn (struct regcache *regcache, struct gdbarch *gdbarch,
     }
 }
 
+/* Execute instruction INSN of the log, forward if FORWARD is non-zero
+   and backward otherwise.  Its register and memory entries are
+   swapped with the inferior's in the order they were recorded going
+   forward, and in the opposite order going backward.  */
+
+static void
+record_exec_insn (struct regcache *regcache, struct gdbarch *gdbarch,
+		  ULONGEST insn, int forward)
+{
+  struct record_entry entry, *entries;
+  CORE_ADDR mem_addr = 0;
+  gdb_byte *p, *end;
+  int i, n;
+
+  if (record_debug > 1)
+    fprintf_unfiltered (gdb_stdlog,
+			"Process record: %s insn %s.\n",
+			forward ? "execute" : "reverse execute",
+			pulongest (insn));
+
+  /* Count the entries, so that they can be walked in either
+     direction.  */
+  record_find_insn (insn, &p, &end);
+  for (n = 0; ; n++)
+    {
+      p = record_decode_entry (p, &entry, &mem_addr);
+      if (entry.type != RECORD_OP_REG && entry.type != RECORD_OP_MEM)
+	break;
+    }
+  if (n == 0)
+    return;
+
+  entries = alloca (n * sizeof (*entries));
+  record_find_insn (insn, &p, &end);
+  mem_addr = 0;
+  for (i = 0; i < n; i++)
+    p = record_decode_entry (p, &entries[i], &mem_addr);
+
+  if (forward)
+    for (i = 0; i < n; i++)
+      record_exec_entry (regcache, gdbarch, &entries[i]);
+  else
+    for (i = n - 1; i >= 0; i--)
+      record_exec_entry (regcache, gdbarch, &entries[i]);
+}
+
 static struct target_ops *tmp_to_resume_ops;
 static void (*tmp_to_resume) (struct target_ops *, ptid_t, int,
 			      enum target_signal);
@@ -964,10 +1287,8 @@ record_open (char *name, int from_tty)
     error (_("Could not find 'to_xfer_partial' method on the target stack."));
 
   /* Reset */
-  record_insn_num = 0;
   record_insn_count = 0;
-  record_list = &record_first;
-  record_list->next = NULL;
+  record_log_release ();
 
   /* Set the tmp beneath pointers to beneath pointers.  */
   record_beneath_to_resume_ops = tmp_to_resume_ops;
@@ -1005,7 +1326,12 @@ record_close (int quitting)
   if (record_debug)
     fprintf_unfiltered (gdb_stdlog, "Process record: record_close\n");
 
-  record_list_release (record_list);
+  record_log_release ();
+
+  xfree (record_arch_buf);
+  record_arch_buf = NULL;
+  record_arch_alloc = 0;
+  record_arch_reset ();
 
   /* Release record_core_regbuf.  */
   if (record_core_regbuf)
@@ -1132,18 +1458,6 @@ record_sig_handler (int signo)
   record_get_sig = 1;
 }
 
-static void
-record_wait_cleanups (void *ignore)
-{
-  if (execution_direction == EXEC_REVERSE)
-    {
-      if (record_list->next)
-	record_list = record_list->next;
-    }
-  else
-    record_list = record_list->prev;
-}
-
 /* "to_wait" target method for process record target.
 
    In record mode, the target is always run in singlestep mode
@@ -1304,8 +1618,6 @@ record_wait_1 (struct target_ops *ops,
       struct gdbarch *gdbarch = get_regcache_arch (regcache);
       struct address_space *aspace = get_regcache_aspace (regcache);
       int continue_flag = 1;
-      int first_record_end = 1;
-      struct cleanup *old_cleanups = make_cleanup (record_wait_cleanups, 0);
       CORE_ADDR tmp_pc;
 
       record_hw_watchpoint = 0;
@@ -1339,124 +1651,91 @@ record_wait_1 (struct target_ops *ops,
          Then set it to terminal_ours to make GDB get the signal.  */
       target_terminal_ours ();
 
-      /* In EXEC_FORWARD mode, record_list points to the tail of prev
-         instruction.  */
-      if (execution_direction == EXEC_FORWARD && record_list->next)
-	record_list = record_list->next;
-
-      /* Loop over the record_list, looking for the next place to
+      /* Loop over the execution log, looking for the next place to
 	 stop.  */
       do
 	{
 	  /* Check for beginning and end of log.  */
 	  if (execution_direction == EXEC_REVERSE
-	      && record_list == &record_first)
+	      && record_cur == record_first_insn () - 1)
 	    {
 	      /* Hit beginning of record log in reverse.  */
 	      status->kind = TARGET_WAITKIND_NO_HISTORY;
 	      break;
 	    }
-	  if (execution_direction != EXEC_REVERSE && !record_list->next)
+	  if (execution_direction != EXEC_REVERSE
+	      && record_cur == record_insn_count)
 	    {
 	      /* Hit end of record log going forward.  */
 	      status->kind = TARGET_WAITKIND_NO_HISTORY;
 	      break;
 	    }
 
-          record_exec_insn (regcache, gdbarch, record_list);
+	  /* Reaching the beginning or the end of the log is only
+	     reported on the next attempt to go past it, so that a step
+	     or a breakpoint there is reported as such.  */
+	  if (execution_direction == EXEC_REVERSE)
+	    {
+	      record_exec_insn (regcache, gdbarch, record_cur, 0);
+	      record_cur--;
+	    }
+	  else
+	    {
+	      record_exec_insn (regcache, gdbarch, record_cur + 1, 1);
+	      record_cur++;
+	    }
 
-	  if (record_list->type == record_end)
+	  /* step */
+	  if (record_resume_step)
 	    {
 	      if (record_debug > 1)
 		fprintf_unfiltered (gdb_stdlog,
-				    "Process record: record_end %s to "
-				    "inferior.\n",
-				    host_address_to_string (record_list));
-
-	      if (first_record_end && execution_direction == EXEC_REVERSE)
-		{
-		  /* When reverse excute, the first record_end is the part of
-		     current instruction.  */
-		  first_record_end = 0;
-		}
-	      else
-		{
-		  /* In EXEC_REVERSE mode, this is the record_end of prev
-		     instruction.
-		     In EXEC_FORWARD mode, this is the record_end of current
-		     instruction.  */
-		  /* step */
-		  if (record_resume_step)
-		    {
-		      if (record_debug > 1)
-			fprintf_unfiltered (gdb_stdlog,
-					    "Process record: step.\n");
-		      continue_flag = 0;
-		    }
-
-		  /* check breakpoint */
-		  tmp_pc = regcache_read_pc (regcache);
-		  if (breakpoint_inserted_here_p (aspace, tmp_pc))
-		    {
-		      int decr_pc_after_break
-			= gdbarch_decr_pc_after_break (gdbarch);
+				    "Process record: step.\n");
+	      continue_flag = 0;
+	    }
 
-		      if (record_debug)
-			fprintf_unfiltered (gdb_stdlog,
-					    "Process record: break "
-					    "at %s.\n",
-					    paddress (gdbarch, tmp_pc));
-		      if (decr_pc_after_break
-			  && execution_direction == EXEC_FORWARD
-			  && !record_resume_step
-			  && software_breakpoint_inserted_here_p (aspace,
-								  tmp_pc))
-			regcache_write_pc (regcache,
-					   tmp_pc + decr_pc_after_break);
-		      continue_flag = 0;
-		    }
+	  /* check breakpoint */
+	  tmp_pc = regcache_read_pc (regcache);
+	  if (breakpoint_inserted_here_p (aspace, tmp_pc))
+	    {
+	      int decr_pc_after_break = gdbarch_decr_pc_after_break (gdbarch);
 
-		  if (record_hw_watchpoint)
-		    {
-		      if (record_debug)
-			fprintf_unfiltered (gdb_stdlog,
-					    "Process record: hit hw "
-					    "watchpoint.\n");
-		      continue_flag = 0;
-		    }
-		  /* Check target signal */
-		  if (record_list->u.end.sigval != TARGET_SIGNAL_0)
-		    /* FIXME: better way to check */
-		    continue_flag = 0;
-		}
+	      if (record_debug)
+		fprintf_unfiltered (gdb_stdlog,
+				    "Process record: break at %s.\n",
+				    paddress (gdbarch, tmp_pc));
+	      if (decr_pc_after_break
+		  && execution_direction == EXEC_FORWARD
+		  && !record_resume_step
+		  && software_breakpoint_inserted_here_p (aspace, tmp_pc))
+		regcache_write_pc (regcache,
+				   tmp_pc + decr_pc_after_break);
+	      continue_flag = 0;
 	    }
 
-	  if (continue_flag)
+	  if (record_hw_watchpoint)
 	    {
-	      if (execution_direction == EXEC_REVERSE)
-		{
-		  if (record_list->prev)
-		    record_list = record_list->prev;
-		}
-	      else
-		{
-		  if (record_list->next)
-		    record_list = record_list->next;
-		}
+	      if (record_debug)
+		fprintf_unfiltered (gdb_stdlog,
+				    "Process record: hit hw watchpoint.\n");
+	      continue_flag = 0;
 	    }
+
+	  /* Check target signal.  Going backward, this is the signal
+	     delivered after the instruction before the one just
+	     undone.  */
+	  if (record_insn_signal (record_cur) != TARGET_SIGNAL_0)
+	    continue_flag = 0;
 	}
       while (continue_flag);
 
 replay_out:
       if (record_get_sig)
 	status->value.sig = TARGET_SIGNAL_INT;
-      else if (record_list->u.end.sigval != TARGET_SIGNAL_0)
-	/* FIXME: better way to check */
-	status->value.sig = record_list->u.end.sigval;
+      else if (record_insn_signal (record_cur) != TARGET_SIGNAL_0)
+	status->value.sig = record_insn_signal (record_cur);
       else
 	status->value.sig = TARGET_SIGNAL_TRAP;
-
-      discard_cleanups (old_cleanups);
     }
 
   signal (SIGINT, handle_sigint);
@@ -1558,8 +1837,7 @@ record_registers_change (struct regcache *regcache, int regnum)
   /* Check record_insn_num.  */
   record_check_insn_num (0);
 
-  record_arch_list_head = NULL;
-  record_arch_list_tail = NULL;
+  record_arch_reset ();
 
   if (regnum < 0)
     {
@@ -1569,7 +1847,7 @@ record_registers_change (struct regcache *regcache, int regnum)
 	{
 	  if (record_arch_list_add_reg (regcache, i))
 	    {
-	      record_list_release (record_arch_list_tail);
+	      record_arch_reset ();
 	      error (_("Process record: failed to record execution log."));
 	    }
 	}
@@ -1578,23 +1856,16 @@ record_registers_change (struct regcache *regcache, int regnum)
     {
       if (record_arch_list_add_reg (regcache, regnum))
 	{
-	  record_list_release (record_arch_list_tail);
+	  record_arch_reset ();
 	  error (_("Process record: failed to record execution log."));
 	}
     }
   if (record_arch_list_add_end ())
     {
-      record_list_release (record_arch_list_tail);
+      record_arch_reset ();
       error (_("Process record: failed to record execution log."));
     }
-  record_list->next = record_arch_list_head;
-  record_arch_list_head->prev = record_list;
-  record_list = record_arch_list_tail;
-
-  if (record_insn_num == record_insn_max_num && record_insn_max_num)
-    record_list_release_first ();
-  else
-    record_insn_num++;
+  record_log_append ();
 }
 
 /* "to_store_registers" method for process record target.  */
@@ -1644,7 +1915,7 @@ record_store_registers (struct target_ops *ops, struct regcache *regcache,
 	    }
 
 	  /* Destroy the record from here forward.  */
-	  record_list_release_following (record_list);
+	  record_list_release_following ();
 	}
 
       record_registers_change (regcache, regno);
@@ -1676,18 +1947,17 @@ record_xfer_partial (struct target_ops *ops, enum target_object object,
 	    error (_("Process record canceled the operation."));
 
 	  /* Destroy the record from here forward.  */
-	  record_list_release_following (record_list);
+	  record_list_release_following ();
 	}
 
       /* Check record_insn_num */
       record_check_insn_num (0);
 
       /* Record registers change to list as an instruction.  */
-      record_arch_list_head = NULL;
-      record_arch_list_tail = NULL;
+      record_arch_reset ();
       if (record_arch_list_add_mem (offset, len))
 	{
-	  record_list_release (record_arch_list_tail);
+	  record_arch_reset ();
 	  if (record_debug)
 	    fprintf_unfiltered (gdb_stdlog,
 				"Process record: failed to record "
@@ -1696,21 +1966,14 @@ record_xfer_partial (struct target_ops *ops, enum target_object object,
 	}
       if (record_arch_list_add_end ())
 	{
-	  record_list_release (record_arch_list_tail);
+	  record_arch_reset ();
 	  if (record_debug)
 	    fprintf_unfiltered (gdb_stdlog,
 				"Process record: failed to record "
 				"execution log.");
 	  return -1;
 	}
-      record_list->next = record_arch_list_head;
-      record_arch_list_head->prev = record_list;
-      record_list = record_arch_list_tail;
-
-      if (record_insn_num == record_insn_max_num && record_insn_max_num)
-	record_list_release_first ();
-      else
-	record_insn_num++;
+      record_log_append ();
     }
 
   return record_beneath_to_xfer_partial (record_beneath_to_xfer_partial_ops,
@@ -1773,9 +2036,9 @@ record_get_bookmark (char *args, int from_tty)
 {
   gdb_byte *ret = NULL;
 
-  /* Return stringified form of instruction count.  */
-  if (record_list && record_list->type == record_end)
-    ret = xstrdup (pulongest (record_list->u.end.insn_num));
+  /* Return stringified form of the number of the current
+     instruction, as "record goto" takes it.  */
+  ret = xstrdup (pulongest (record_cur + 1));
 
   if (record_debug)
     {
@@ -2138,7 +2401,7 @@ cmd_record_delete (char *args, int from_tty)
 	  if (!from_tty || query (_("Delete the log from this point forward "
 		                    "and begin to record the running message "
 		                    "at current PC?")))
-	    record_list_release_following (record_list);
+	    record_list_release_following ();
 	}
       else
 	  printf_unfiltered (_("Already at end of record list.\n"));
@@ -2176,6 +2439,9 @@ set_record_insn_max_num (char *args, int from_tty, struct cmd_list_element *c)
 	  record_list_release_first ();
 	  record_insn_num--;
 	}
+
+      if (record_cur < record_first_insn () - 1)
+	record_cur = record_first_insn () - 1;
     }
 }
 
@@ -2201,8 +2467,6 @@ show_record_command (char *args, int from_tty)
 static void
 info_record_command (char *args, int from_tty)
 {
-  struct record_entry *p;
-
   if (current_target.to_stratum == record_stratum)
     {
       if (RECORD_IS_REPLAY)
@@ -2210,23 +2474,18 @@ info_record_command (char *args, int from_tty)
       else
 	printf_filtered (_("Record mode:\n"));
 
-      /* Find entry for first actual instruction in the log.  */
-      for (p = record_first.next;
-	   p != NULL && p->type != record_end;
-	   p = p->next)
-	;
-
       /* Do we have a log at all?  */
-      if (p != NULL && p->type == record_end)
+      if (record_insn_num > 0)
 	{
 	  /* Display instruction number for first instruction in the log.  */
 	  printf_filtered (_("Lowest recorded instruction number is %s.\n"),
-			   pulongest (p->u.end.insn_num));
+			   pulongest (record_first_insn ()));
 
-	  /* If in replay mode, display where we are in the log.  */
+	  /* If in replay mode, display where we are in the log: the
+	     instruction about to be replayed going forward.  */
 	  if (RECORD_IS_REPLAY)
 	    printf_filtered (_("Current instruction number is %s.\n"),
-			     pulongest (record_list->u.end.insn_num));
+			     pulongest (record_cur + 1));
 
 	  /* Display instruction number for last instruction in the log.  */
 	  printf_filtered (_("Highest recorded instruction number is %s.\n"), 
@@ -2291,6 +2550,26 @@ info_record_command (char *args, int from_tty)
        8 bytes: memory address (network byte order).
        n bytes: memory value (n == memory length).
 
+   Version 3
+     4 bytes: magic number netorder32(0x20121016).
+       NOTE: be sure to change whenever this file format changes!
+     4 bytes: number N of register numbers (network byte order).
+     N times 2 bytes: size of register 0 to N - 1 in the log, or zero
+                      if the log has no change of it (network byte order).
+     8 bytes: number of the first instruction (network byte order).
+
+   Chunks:
+     4 bytes: number of instructions n (network byte order).
+     4 bytes: size s of the changes (network byte order).
+     4 bytes: flags; bit 0 is set if some instruction of the chunk ends
+              with RECORD_OP_END_SIGNAL (network byte order).
+     n times 2 bytes: offset of the changes of each instruction
+                      (network byte order).
+     s bytes: the changes, encoded as in struct record_chunk.
+
+   The core file holds the state before the first instruction, and
+   the logged values are the ones after each instruction.
+
 */
 
 /* bfdcore_read -- read bytes from a core file section.  */
@@ -2338,17 +2617,25 @@ netorder16 (uint16_t input)
   return ret;
 }
 
+/* Cleanup for record_restore: discard a partially restored log.  */
+
+static void
+record_restore_cleanups (void *ignore)
+{
+  record_log_release ();
+}
+
 /* Restore the execution log from a core_bfd file.  */
 static void
 record_restore (void)
 {
-  uint32_t magic;
+  uint32_t magic, nregs, i;
+  uint64_t first;
   struct cleanup *old_cleanups;
-  struct record_entry *rec;
   asection *osec;
   uint32_t osec_size;
   int bfd_offset = 0;
-  struct regcache *regcache;
+  struct gdbarch *gdbarch;
 
   /* We restore the execution log from the open core bfd,
      if there is one.  */
@@ -2356,7 +2643,7 @@ record_restore (void)
     return;
 
   /* "record_restore" can only be called when record list is empty.  */
-  gdb_assert (record_first.next == NULL);
+  gdb_assert (record_chunks_head == NULL);
  
   if (record_debug)
     fprintf_unfiltered (gdb_stdlog, "Restoring recording from core file.\n");
@@ -2383,119 +2670,84 @@ record_restore (void)
 			"RECORD_FILE_MAGIC (0x%s)\n",
 			phex_nz (netorder32 (magic), 4));
 
-  /* Restore the entries in recfd into record_arch_list_head and
-     record_arch_list_tail.  */
-  record_arch_list_head = NULL;
-  record_arch_list_tail = NULL;
-  record_insn_num = 0;
-  old_cleanups = make_cleanup (record_arch_list_cleanups, 0);
-  regcache = get_current_regcache ();
+  old_cleanups = make_cleanup (record_restore_cleanups, 0);
+  gdbarch = get_regcache_arch (get_current_regcache ());
+
+  /* Get the register sizes, and check them against the current
+     architecture.  */
+  bfdcore_read (core_bfd, osec, &nregs, sizeof (nregs), &bfd_offset);
+  nregs = netorder32 (nregs);
+  for (i = 0; i < nregs; i++)
+    {
+      uint16_t size;
+
+      bfdcore_read (core_bfd, osec, &size, sizeof (size), &bfd_offset);
+      size = netorder16 (size);
+      if (size != 0
+	  && (i >= gdbarch_num_regs (gdbarch)
+	      || size != register_size (gdbarch, i)
+	      || record_note_reg_size (i, size)))
+	error (_("Register size mis-match in core file %s."),
+	       bfd_get_filename (core_bfd));
+    }
+
+  /* Get the number of the first instruction.  */
+  bfdcore_read (core_bfd, osec, &first, sizeof (first), &bfd_offset);
+  first = netorder64 (first);
+  record_insn_count = first - 1;
 
   while (1)
     {
-      uint8_t rectype;
-      uint32_t regnum, len, signal, count;
-      uint64_t addr;
+      struct record_chunk *chunk;
+      uint32_t n, size, flags;
 
       /* We are finished when offset reaches osec_size.  */
       if (bfd_offset >= osec_size)
 	break;
-      bfdcore_read (core_bfd, osec, &rectype, sizeof (rectype), &bfd_offset);
-
-      switch (rectype)
-        {
-        case record_reg: /* reg */
-          /* Get register number to regnum.  */
-          bfdcore_read (core_bfd, osec, &regnum,
-			sizeof (regnum), &bfd_offset);
-	  regnum = netorder32 (regnum);
-
-          rec = record_reg_alloc (regcache, regnum);
-
-          /* Get val.  */
-          bfdcore_read (core_bfd, osec, record_get_loc (rec),
-			rec->u.reg.len, &bfd_offset);
 
-	  if (record_debug)
-	    fprintf_unfiltered (gdb_stdlog,
-				"  Reading register %d (1 "
-				"plus %lu plus %d bytes)\n",
-				rec->u.reg.num,
-				(unsigned long) sizeof (regnum),
-				rec->u.reg.len);
-          break;
-
-        case record_mem: /* mem */
-          /* Get len.  */
-          bfdcore_read (core_bfd, osec, &len, 
-			sizeof (len), &bfd_offset);
-	  len = netorder32 (len);
-
-          /* Get addr.  */
-          bfdcore_read (core_bfd, osec, &addr,
-			sizeof (addr), &bfd_offset);
-	  addr = netorder64 (addr);
-
-          rec = record_mem_alloc (addr, len);
-
-          /* Get val.  */
-          bfdcore_read (core_bfd, osec, record_get_loc (rec),
-			rec->u.mem.len, &bfd_offset);
+      bfdcore_read (core_bfd, osec, &n, sizeof (n), &bfd_offset);
+      n = netorder32 (n);
+      bfdcore_read (core_bfd, osec, &size, sizeof (size), &bfd_offset);
+      size = netorder32 (size);
+      bfdcore_read (core_bfd, osec, &flags, sizeof (flags), &bfd_offset);
+      flags = netorder32 (flags);
+      if (n == 0 || size > osec_size - bfd_offset)
+	error (_("Bad chunk in core file %s."),
+	       bfd_get_filename (core_bfd));
 
-	  if (record_debug)
-	    fprintf_unfiltered (gdb_stdlog,
-				"  Reading memory %s (1 plus "
-				"%lu plus %lu plus %d bytes)\n",
-				paddress (get_current_arch (),
-					  rec->u.mem.addr),
-				(unsigned long) sizeof (addr),
-				(unsigned long) sizeof (len),
-				rec->u.mem.len);
-          break;
-
-        case record_end: /* end */
-          rec = record_end_alloc ();
-          record_insn_num ++;
-
-	  /* Get signal value.  */
-	  bfdcore_read (core_bfd, osec, &signal, 
-			sizeof (signal), &bfd_offset);
-	  signal = netorder32 (signal);
-	  rec->u.end.sigval = signal;
-
-	  /* Get insn count.  */
-	  bfdcore_read (core_bfd, osec, &count, 
-			sizeof (count), &bfd_offset);
-	  count = netorder32 (count);
-	  rec->u.end.insn_num = count;
-	  record_insn_count = count + 1;
-	  if (record_debug)
-	    fprintf_unfiltered (gdb_stdlog,
-				"  Reading record_end (1 + "
-				"%lu + %lu bytes), offset == %s\n",
-				(unsigned long) sizeof (signal),
-				(unsigned long) sizeof (count),
-				paddress (get_current_arch (),
-					  bfd_offset));
-          break;
-
-        default:
-          error (_("Bad entry type in core file %s."),
-		 bfd_get_filename (core_bfd));
-          break;
-        }
+      if (record_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "  Reading chunk of %u insns "
+			    "(12 plus %u plus %u bytes)\n",
+			    (unsigned) n, (unsigned) (2 * n),
+			    (unsigned) size);
+
+      chunk = record_chunk_new (size + 2, record_insn_count + 1);
+      chunk->signals = (flags & 1) != 0;
+      for (i = 0; i < n; i++)
+	{
+	  uint16_t offset;
+
+	  bfdcore_read (core_bfd, osec, &offset, sizeof (offset),
+			&bfd_offset);
+	  offset = netorder16 (offset);
+	  if (offset >= size
+	      || (i > 0 && offset <= chunk->index[i - 1]))
+	    error (_("Bad chunk in core file %s."),
+		   bfd_get_filename (core_bfd));
+	  record_chunk_add_insn (chunk, offset);
+	}
+      bfdcore_read (core_bfd, osec, chunk->data, size, &bfd_offset);
+      chunk->size = size;
 
-      /* Add rec to record arch list.  */
-      record_arch_list_add (rec);
+      record_insn_num += n;
+      record_insn_count += n;
     }
 
   discard_cleanups (old_cleanups);
 
-  /* Add record_arch_list_head to the end of record list.  */
-  record_first.next = record_arch_list_head;
-  record_arch_list_head->prev = &record_first;
-  record_arch_list_tail->next = NULL;
-  record_list = &record_first;
+  /* The log starts at the state saved in the core file.  */
+  record_cur = record_first_insn () - 1;
 
   /* Update record_insn_max_num.  */
   if (record_insn_num > record_insn_max_num)
@@ -2548,6 +2800,34 @@ record_save_cleanups (void *data)
   xfree (pathname);
 }
 
+/* record_goto_insn -- rewind the record log (forward or backward) so
+   that instruction TARGET_INSN is the last one whose effects are
+   applied, changing the program state correspondingly.  */
+
+static void
+record_goto_insn (ULONGEST target_insn)
+{
+  struct cleanup *set_cleanups = record_gdb_operation_disable_set ();
+  struct regcache *regcache = get_current_regcache ();
+  struct gdbarch *gdbarch = get_regcache_arch (regcache);
+
+  /* Assume everything is valid: we will hit the instruction,
+     and we will not hit the end of the recording.  */
+
+  while (record_cur < target_insn)
+    {
+      record_exec_insn (regcache, gdbarch, record_cur + 1, 1);
+      record_cur++;
+    }
+  while (record_cur > target_insn)
+    {
+      record_exec_insn (regcache, gdbarch, record_cur, 0);
+      record_cur--;
+    }
+
+  do_cleanups (set_cleanups);
+}
+
 /* Save the execution log to a file.  We use a modified elf corefile
    format, with an extra section for our data.  */
 
@@ -2555,16 +2835,16 @@ static void
 cmd_record_save (char *args, int from_tty)
 {
   char *recfilename, recfilename_buffer[40];
-  struct record_entry *cur_record_list;
-  uint32_t magic;
-  struct regcache *regcache;
-  struct gdbarch *gdbarch;
+  ULONGEST cur_insn;
+  struct record_chunk *chunk;
+  uint32_t magic, nregs;
+  uint64_t first;
   struct cleanup *old_cleanups;
-  struct cleanup *set_cleanups;
   bfd *obfd;
   int save_size = 0;
   asection *osec = NULL;
   int bfd_offset = 0;
+  int i;
 
   if (strcmp (current_target.to_shortname, "record") != 0)
     error (_("This command can only be used with target 'record'.\n"
@@ -2589,45 +2869,20 @@ cmd_record_save (char *args, int from_tty)
   obfd = create_gcore_bfd (recfilename);
   old_cleanups = make_cleanup (record_save_cleanups, obfd);
 
-  /* Save the current record entry to "cur_record_list".  */
-  cur_record_list = record_list;
-
-  /* Get the values of regcache and gdbarch.  */
-  regcache = get_current_regcache ();
-  gdbarch = get_regcache_arch (regcache);
-
-  /* Disable the GDB operation record.  */
-  set_cleanups = record_gdb_operation_disable_set ();
+  /* Save the current instruction to "cur_insn".  */
+  cur_insn = record_cur;
 
-  /* Reverse execute to the begin of record list.  */
-  while (1)
-    {
-      /* Check for beginning and end of log.  */
-      if (record_list == &record_first)
-        break;
-
-      record_exec_insn (regcache, gdbarch, record_list);
-
-      if (record_list->prev)
-        record_list = record_list->prev;
-    }
+  /* Reverse execute to the begin of record list.  The core file holds
+     the state before the first instruction of the log, and the log
+     holds the changes of each instruction as they are there.  */
+  record_goto_insn (record_first_insn () - 1);
 
   /* Compute the size needed for the extra bfd section.  */
   save_size = 4;	/* magic cookie */
-  for (record_list = record_first.next; record_list;
-       record_list = record_list->next)
-    switch (record_list->type)
-      {
-      case record_end:
-	save_size += 1 + 4 + 4;
-	break;
-      case record_reg:
-	save_size += 1 + 4 + record_list->u.reg.len;
-	break;
-      case record_mem:
-	save_size += 1 + 4 + 8 + record_list->u.mem.len;
-	break;
-      }
+  save_size += 4 + 2 * record_reg_size_count + 8;
+  for (chunk = record_chunks_head; chunk; chunk = chunk->next)
+    save_size += (4 + 4 + 4 + 2 * (chunk->num_insns - chunk->first)
+		  + chunk->size - chunk->index[chunk->first]);
 
   /* Make the new bfd section.  */
   osec = bfd_make_section_anyway_with_flags (obfd, "precord",
@@ -2655,110 +2910,56 @@ cmd_record_save (char *args, int from_tty)
 		      phex_nz (magic, 4));
   bfdcore_write (obfd, osec, &magic, sizeof (magic), &bfd_offset);
 
-  /* Save the entries to recfd and forward execute to the end of
-     record list.  */
-  record_list = &record_first;
-  while (1)
+  /* Write the register sizes.  */
+  nregs = netorder32 (record_reg_size_count);
+  bfdcore_write (obfd, osec, &nregs, sizeof (nregs), &bfd_offset);
+  for (i = 0; i < record_reg_size_count; i++)
     {
-      /* Save entry.  */
-      if (record_list != &record_first)
-        {
-	  uint8_t type;
-	  uint32_t regnum, len, signal, count;
-          uint64_t addr;
-
-	  type = record_list->type;
-          bfdcore_write (obfd, osec, &type, sizeof (type), &bfd_offset);
+      uint16_t size = netorder16 (record_reg_size[i]);
 
-          switch (record_list->type)
-            {
-            case record_reg: /* reg */
-	      if (record_debug)
-		fprintf_unfiltered (gdb_stdlog,
-				    "  Writing register %d (1 "
-				    "plus %lu plus %d bytes)\n",
-				    record_list->u.reg.num,
-				    (unsigned long) sizeof (regnum),
-				    record_list->u.reg.len);
-
-              /* Write regnum.  */
-              regnum = netorder32 (record_list->u.reg.num);
-              bfdcore_write (obfd, osec, &regnum,
-			     sizeof (regnum), &bfd_offset);
-
-              /* Write regval.  */
-              bfdcore_write (obfd, osec, record_get_loc (record_list),
-			     record_list->u.reg.len, &bfd_offset);
-              break;
-
-            case record_mem: /* mem */
-	      if (record_debug)
-		fprintf_unfiltered (gdb_stdlog,
-				    "  Writing memory %s (1 plus "
-				    "%lu plus %lu plus %d bytes)\n",
-				    paddress (gdbarch,
-					      record_list->u.mem.addr),
-				    (unsigned long) sizeof (addr),
-				    (unsigned long) sizeof (len),
-				    record_list->u.mem.len);
-
-	      /* Write memlen.  */
-	      len = netorder32 (record_list->u.mem.len);
-	      bfdcore_write (obfd, osec, &len, sizeof (len), &bfd_offset);
-
-	      /* Write memaddr.  */
-	      addr = netorder64 (record_list->u.mem.addr);
-	      bfdcore_write (obfd, osec, &addr, 
-			     sizeof (addr), &bfd_offset);
-
-	      /* Write memval.  */
-	      bfdcore_write (obfd, osec, record_get_loc (record_list),
-			     record_list->u.mem.len, &bfd_offset);
-              break;
-
-              case record_end:
-		if (record_debug)
-		  fprintf_unfiltered (gdb_stdlog,
-				      "  Writing record_end (1 + "
-				      "%lu + %lu bytes)\n", 
-				      (unsigned long) sizeof (signal),
-				      (unsigned long) sizeof (count));
-		/* Write signal value.  */
-		signal = netorder32 (record_list->u.end.sigval);
-		bfdcore_write (obfd, osec, &signal,
-			       sizeof (signal), &bfd_offset);
-
-		/* Write insn count.  */
-		count = netorder32 (record_list->u.end.insn_num);
-		bfdcore_write (obfd, osec, &count,
-			       sizeof (count), &bfd_offset);
-                break;
-            }
-        }
-
-      /* Execute entry.  */
-      record_exec_insn (regcache, gdbarch, record_list);
-
-      if (record_list->next)
-        record_list = record_list->next;
-      else
-        break;
+      bfdcore_write (obfd, osec, &size, sizeof (size), &bfd_offset);
     }
 
-  /* Reverse execute to cur_record_list.  */
-  while (1)
+  /* Write the number of the first instruction.  */
+  first = netorder64 (record_first_insn ());
+  bfdcore_write (obfd, osec, &first, sizeof (first), &bfd_offset);
+
+  /* Write the chunks, without their released instructions.  */
+  for (chunk = record_chunks_head; chunk; chunk = chunk->next)
     {
-      /* Check for beginning and end of log.  */
-      if (record_list == cur_record_list)
-        break;
+      unsigned int start = chunk->index[chunk->first];
+      uint32_t n, size, flags;
+      unsigned int j;
 
-      record_exec_insn (regcache, gdbarch, record_list);
+      if (record_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "  Writing chunk of %u insns "
+			    "(12 plus %u plus %u bytes)\n",
+			    chunk->num_insns - chunk->first,
+			    2 * (chunk->num_insns - chunk->first),
+			    chunk->size - start);
+
+      n = netorder32 (chunk->num_insns - chunk->first);
+      bfdcore_write (obfd, osec, &n, sizeof (n), &bfd_offset);
+      size = netorder32 (chunk->size - start);
+      bfdcore_write (obfd, osec, &size, sizeof (size), &bfd_offset);
+      flags = netorder32 (chunk->signals ? 1 : 0);
+      bfdcore_write (obfd, osec, &flags, sizeof (flags), &bfd_offset);
+
+      for (j = chunk->first; j < chunk->num_insns; j++)
+	{
+	  uint16_t offset = netorder16 (chunk->index[j] - start);
 
-      if (record_list->prev)
-        record_list = record_list->prev;
+	  bfdcore_write (obfd, osec, &offset, sizeof (offset), &bfd_offset);
+	}
+
+      bfdcore_write (obfd, osec, chunk->data + start, chunk->size - start,
+		     &bfd_offset);
     }
 
-  do_cleanups (set_cleanups);
+  /* Forward execute to cur_insn.  */
+  record_goto_insn (cur_insn);
+
   bfd_close (obfd);
   discard_cleanups (old_cleanups);
 
@@ -2767,35 +2968,6 @@ cmd_record_save (char *args, int from_tty)
 		   recfilename);
 }
 
-/* record_goto_insn -- rewind the record log (forward or backward,
-   depending on DIR) to the given entry, changing the program state
-   correspondingly.  */
-
-static void
-record_goto_insn (struct record_entry *entry,
-		  enum exec_direction_kind dir)
-{
-  struct cleanup *set_cleanups = record_gdb_operation_disable_set ();
-  struct regcache *regcache = get_current_regcache ();
-  struct gdbarch *gdbarch = get_regcache_arch (regcache);
-
-  /* Assume everything is valid: we will hit the entry,
-     and we will not hit the end of the recording.  */
-
-  if (dir == EXEC_FORWARD)
-    record_list = record_list->next;
-
-  do
-    {
-      record_exec_insn (regcache, gdbarch, record_list);
-      if (dir == EXEC_REVERSE)
-	record_list = record_list->prev;
-      else
-	record_list = record_list->next;
-    } while (record_list != entry);
-  do_cleanups (set_cleanups);
-}
-
 /* "record goto" command.  Argument is an instruction number,
    as given by "info record".
 
@@ -2804,58 +2976,47 @@ record_goto_insn (struct record_entry *entry,
 static void
 cmd_record_goto (char *arg, int from_tty)
 {
-  struct record_entry *p = NULL;
   ULONGEST target_insn = 0;
 
   if (arg == NULL || *arg == '\0')
     error (_("Command requires an argument (insn number to go to)."));
 
+  /* TARGET_INSN is the number of the instruction to go to, about to
+     be replayed as "info record" shows it; the state there is the one
+     after the instruction before it.  */
   if (strncmp (arg, "start", strlen ("start")) == 0
       || strncmp (arg, "begin", strlen ("begin")) == 0)
     {
-      /* Special case.  Find first insn.  */
-      for (p = &record_first; p != NULL; p = p->next)
-	if (p->type == record_end)
-	  break;
-      if (p)
-	target_insn = p->u.end.insn_num;
+      /* Special case.  The state before the first insn.  */
+      target_insn = record_first_insn ();
     }
   else if (strncmp (arg, "end", strlen ("end")) == 0)
     {
-      /* Special case.  Find last insn.  */
-      for (p = record_list; p->next != NULL; p = p->next)
-	;
-      for (; p!= NULL; p = p->prev)
-	if (p->type == record_end)
-	  break;
-      if (p)
-	target_insn = p->u.end.insn_num;
+      /* Special case.  The state after the last insn.  */
+      target_insn = record_insn_count + 1;
     }
   else
     {
-      /* General case.  Find designated insn.  */
+      /* General case.  Designated insn.  */
       target_insn = parse_and_eval_long (arg);
-
-      for (p = &record_first; p != NULL; p = p->next)
-	if (p->type == record_end && p->u.end.insn_num == target_insn)
-	  break;
     }
 
-  if (p == NULL)
+  if (target_insn < record_first_insn ()
+      || target_insn > record_insn_count + 1)
     error (_("Target insn '%s' not found."), arg);
-  else if (p == record_list)
+  else if (target_insn - 1 == record_cur)
     error (_("Already at insn '%s'."), arg);
-  else if (p->u.end.insn_num > record_list->u.end.insn_num)
+  else if (target_insn - 1 > record_cur)
     {
       printf_filtered (_("Go forward to insn number %s\n"),
 		       pulongest (target_insn));
-      record_goto_insn (p, EXEC_FORWARD);
+      record_goto_insn (target_insn - 1);
     }
   else
     {
       printf_filtered (_("Go backward to insn number %s\n"),
 		       pulongest (target_insn));
-      record_goto_insn (p, EXEC_REVERSE);
+      record_goto_insn (target_insn - 1);
     }
   registers_changed ();
   reinit_frame_cache ();
@@ -2867,11 +3028,6 @@ _initialize_record (void)
 {
   struct cmd_list_element *c;
 
-  /* Init record_first.  */
-  record_first.prev = NULL;
-  record_first.next = NULL;
-  record_first.type = record_end;
-
   init_record_ops ();
   add_target (&record_ops);
   init_record_core_ops ();
@@ -2944,13 +3100,14 @@ delete the oldest recorded instruction to make room for each new one."),
 			    _("Set record/replay buffer limit."),
 			    _("Show record/replay buffer limit."), _("\
 Set the maximum number of instructions to be stored in the\n\
-record/replay buffer.  Zero means unlimited.  Default is 200000."),
+record/replay buffer.  Zero means unlimited.  Default is 1000000."),
 			    set_record_insn_max_num,
 			    NULL, &set_record_cmdlist, &show_record_cmdlist);
 
   add_cmd ("goto", class_obscure, cmd_record_goto, _("\
-Restore the program to its state at instruction number N.\n\
-Argument is instruction number, as shown by 'info record'."),
+Restore the program to its state before instruction number N.\n\
+Argument is instruction number, as shown by 'info record', or\n\
+\"begin\" or \"end\" for the start or the end of the log."),
 	   &record_cmdlist);
 
   add_setshow_boolean_cmd ("memory-query", no_class,
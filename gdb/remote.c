@@ -41,6 +41,7 @@
 #include "solib.h"
 #include "cli/cli-decode.h"
 #include "cli/cli-setshow.h"
+#include "cli/cli-utils.h"
 #include "target-descriptions.h"
 
 #include <ctype.h>
@@ -65,6 +66,8 @@
 #include "tracepoint.h"
 #include "ax.h"
 #include "ax-gdb.h"
+#include "lz-block.h"
+#include "gcore.h"
 
 /* Temp hacks for tracepoint encoding migration.  */
 static char *target_buf;
@@ -1242,6 +1245,7 @@ enum {
   PACKET_vFile_pwrite,
   PACKET_vFile_close,
   PACKET_vFile_unlink,
+  PACKET_vFile_pwritemem,
   PACKET_qXfer_auxv,
   PACKET_qXfer_features,
   PACKET_qXfer_libraries,
@@ -1258,6 +1262,7 @@ enum {
   PACKET_qSupported,
   PACKET_QPassSignals,
   PACKET_qSearch_memory,
+  PACKET_qSearch_memory_multi,
   PACKET_vAttach,
   PACKET_vRun,
   PACKET_QStartNoAckMode,
@@ -1275,6 +1280,9 @@ enum {
   PACKET_QAllow,
   PACKET_qXfer_fdpic,
   PACKET_QDisableRandomization,
+  PACKET_vReadMemZ,
+  PACKET_ConditionalBreakpoints,
+  PACKET_incremental_libraries_svr4_read,
   PACKET_MAX
 };
 
@@ -3811,6 +3819,12 @@ static struct protocol_feature remote_protocol_features[] = {
     PACKET_qXfer_fdpic },
   { "QDisableRandomization", PACKET_DISABLE, remote_supported_packet,
     PACKET_QDisableRandomization },
+  { "vReadMemZ", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vReadMemZ },
+  { "ConditionalBreakpoints", PACKET_DISABLE, remote_supported_packet,
+    PACKET_ConditionalBreakpoints },
+  { "incremental-libraries-svr4-read", PACKET_DISABLE,
+    remote_supported_packet, PACKET_incremental_libraries_svr4_read },
   { "tracenz", PACKET_DISABLE,
     remote_string_tracing_feature, -1 },
 };
@@ -6512,32 +6526,20 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
 				 memaddr, myaddr, len, packet_format[0], 1);
 }
 
-/* Read memory data directly from the remote machine.
-   This does not use the data cache; the data cache uses this.
-   MEMADDR is the address in the remote memory space.
-   MYADDR is the address of the buffer in our space.
-   LEN is the number of bytes.
+/* Maximum number of memory read packets remote_read_bytes keeps in
+   flight at once when reading a block larger than one packet.  0 or
+   1 disables pipelining.  */
 
-   Returns number of bytes transferred, or 0 for error.  */
+static unsigned int remote_memory_read_window = 1;
 
-static int
-remote_read_bytes (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+/* Send an "m" packet requesting LEN bytes at MEMADDR, without
+   waiting for the reply.  */
+
+static void
+remote_send_read_bytes_request (CORE_ADDR memaddr, int len)
 {
   struct remote_state *rs = get_remote_state ();
-  int max_buf_size;		/* Max size of packet output buffer.  */
   char *p;
-  int todo;
-  int i;
-
-  if (len <= 0)
-    return 0;
-
-  max_buf_size = get_memory_read_packet_size ();
-  /* The packet buffer will be large enough for the payload;
-     get_memory_packet_size ensures this.  */
-
-  /* Number if bytes that will fit.  */
-  todo = min (len, max_buf_size / 2);
 
   /* Construct "m"<memaddr>","<len>".  */
   memaddr = remote_address_masked (memaddr);
@@ -6545,9 +6547,21 @@ remote_read_bytes (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
   *p++ = 'm';
   p += hexnumstr (p, (ULONGEST) memaddr);
   *p++ = ',';
-  p += hexnumstr (p, (ULONGEST) todo);
+  p += hexnumstr (p, (ULONGEST) len);
   *p = '\0';
   putpkt (rs->buf);
+}
+
+/* Wait for the reply to an "m" packet requesting LEN bytes, and
+   store the data in MYADDR.  If MYADDR is NULL, the reply is
+   discarded.  Returns the number of bytes transferred, or 0 for
+   error (setting errno).  */
+
+static int
+remote_get_read_bytes_reply (gdb_byte *myaddr, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+
   getpkt (&rs->buf, &rs->buf_size, 0);
   if (rs->buf[0] == 'E'
       && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
@@ -6561,14 +6575,206 @@ remote_read_bytes (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
       errno = EIO;
       return 0;
     }
+
+  if (myaddr == NULL)
+    return 0;
+
   /* Reply describes memory byte by byte, each byte encoded as two hex
      characters.  */
+  return hex2bin (rs->buf, myaddr, len);
+}
+
+/* Read LEN bytes at MEMADDR into MYADDR, splitting the read into
+   packets of at most CHUNK bytes and keeping up to
+   remote_memory_read_window of them outstanding, so that the
+   transfer is not bound by the link's round-trip latency.  Replies
+   come back in request order.  After a short or failed reply, no new
+   requests are sent, and the replies to those already in flight are
+   drained and discarded.  Returns the number of contiguous bytes
+   transferred from MEMADDR, or 0 for error.  */
+
+static int
+remote_read_bytes_pipelined (CORE_ADDR memaddr, gdb_byte *myaddr, int len,
+			     int chunk)
+{
+  int npackets = (len + chunk - 1) / chunk;
+  int window = min (npackets, remote_memory_read_window);
+  int sent = 0;
+  int received = 0;
+  int xfered = 0;
+  int done = 0;
+
+  if (remote_debug)
+    fprintf_unfiltered (gdb_stdlog,
+			"remote_read_bytes: %d packets, window %d\n",
+			npackets, window);
+
+  for (; sent < window; sent++)
+    remote_send_read_bytes_request (memaddr + sent * chunk,
+				    min (chunk, len - sent * chunk));
+
+  for (; received < sent; received++)
+    {
+      int offset = received * chunk;
+      int todo = min (chunk, len - offset);
+      int n;
+
+      n = remote_get_read_bytes_reply (done ? NULL : myaddr + offset, todo);
+      if (done)
+	continue;
+
+      xfered += n;
+      if (n < todo)
+	{
+	  done = 1;
+	  continue;
+	}
+
+      if (sent < npackets)
+	{
+	  remote_send_read_bytes_request (memaddr + sent * chunk,
+					  min (chunk, len - sent * chunk));
+	  sent++;
+	}
+    }
+
+  return xfered;
+}
+
+/* The largest block of memory requested with a single vReadMemZ
+   packet.  The stub may return less.  */
+#define REMOTE_READ_MEM_Z_MAX_LEN 0x10000
+
+/* Read up to LEN bytes at MEMADDR into MYADDR using the vReadMemZ
+   packet, whose reply carries the memory either compressed with
+   lz_block_compress or, when that would not make it any smaller, as
+   raw binary data.  Returns the number of bytes transferred, 0 for
+   error (setting errno), or -1 if the stub turns out not to support
+   the packet, in which case it is disabled.  */
+
+static int
+remote_read_bytes_compressed (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct packet_config *packet = &remote_protocol_packets[PACKET_vReadMemZ];
+  struct cleanup *old_chain;
+  gdb_byte *packed;
+  int todo, reply_len, packed_len, unpacked_len;
+  char *p;
+
+  todo = min (len, REMOTE_READ_MEM_Z_MAX_LEN);
+
+  /* Construct "vReadMemZ:"<memaddr>","<len>".  */
+  memaddr = remote_address_masked (memaddr);
   p = rs->buf;
-  i = hex2bin (p, myaddr, todo);
+  p += xsnprintf (p, get_remote_packet_size (), "vReadMemZ:");
+  p += hexnumstr (p, (ULONGEST) memaddr);
+  *p++ = ',';
+  p += hexnumstr (p, (ULONGEST) todo);
+  *p = '\0';
+  putpkt (rs->buf);
+  reply_len = getpkt_sane (&rs->buf, &rs->buf_size, 0);
+  if (reply_len < 0)
+    {
+      errno = EIO;
+      return 0;
+    }
+
+  /* A stub that claimed support but does not recognize the packet
+     after all; stop using it, and let the caller read with "m"
+     packets instead.  */
+  if (packet_check_result (rs->buf) == PACKET_UNKNOWN)
+    {
+      if (remote_debug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "Packet %s (%s) is NOT supported\n",
+			    packet->name, packet->title);
+      packet->support = PACKET_DISABLE;
+      return -1;
+    }
+
+  if (packet_ok (rs->buf, packet) == PACKET_ERROR)
+    {
+      errno = EIO;
+      return 0;
+    }
+
+  if (rs->buf[0] == 'b')
+    return remote_unescape_input ((gdb_byte *) rs->buf + 1, reply_len - 1,
+				  myaddr, todo);
+
+  if (rs->buf[0] != 'Z')
+    error (_("Unexpected vReadMemZ reply: %s"), rs->buf);
+
+  packed = xmalloc (reply_len);
+  old_chain = make_cleanup (xfree, packed);
+  packed_len = remote_unescape_input ((gdb_byte *) rs->buf + 1,
+				      reply_len - 1, packed, reply_len);
+  unpacked_len = lz_block_decompress (packed, packed_len, myaddr, todo);
+  do_cleanups (old_chain);
+
+  if (unpacked_len <= 0)
+    error (_("Malformed vReadMemZ reply."));
+
+  return unpacked_len;
+}
+
+/* Read memory data directly from the remote machine.
+   This does not use the data cache; the data cache uses this.
+   MEMADDR is the address in the remote memory space.
+   MYADDR is the address of the buffer in our space.
+   LEN is the number of bytes.
+
+   Returns number of bytes transferred, or 0 for error.  */
+
+static int
+remote_read_bytes (CORE_ADDR memaddr, gdb_byte *myaddr, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int max_buf_size;		/* Max size of packet output buffer.  */
+  int todo;
+  int pipeline;
+  int round_trip_len;
+
+  if (len <= 0)
+    return 0;
+
+  max_buf_size = get_memory_read_packet_size ();
+  /* The packet buffer will be large enough for the payload;
+     get_memory_packet_size ensures this.  */
+
+  /* Number if bytes that will fit.  */
+  todo = min (len, max_buf_size / 2);
+
+  /* Only pipeline in no-ack mode.  Otherwise, the stub would read the
+     next request while waiting for the acknowledgement of its
+     reply.  */
+  pipeline = rs->noack_mode && remote_memory_read_window > 1;
+
+  /* Compressing only pays off for blocks that "m" packets cannot
+     move in a single round trip; anything smaller, including a
+     pipelined read that fits in one window, is read with "m"
+     packets.  */
+  round_trip_len = max_buf_size / 2;
+  if (pipeline)
+    round_trip_len *= remote_memory_read_window;
+  if (len > round_trip_len
+      && remote_protocol_packets[PACKET_vReadMemZ].support != PACKET_DISABLE)
+    {
+      int res = remote_read_bytes_compressed (memaddr, myaddr, len);
+
+      if (res >= 0)
+	return res;
+    }
+
+  if (todo < len && pipeline)
+    return remote_read_bytes_pipelined (memaddr, myaddr, len, todo);
+
+  remote_send_read_bytes_request (memaddr, todo);
   /* Return what we have.  Let higher layers handle partial reads.  */
-  return i;
+  return remote_get_read_bytes_reply (myaddr, todo);
 }
-
+
 
 /* Remote notification handler.  */
 
@@ -7694,6 +7900,58 @@ extended_remote_create_inferior (struct target_ops *ops,
    support, we ask the remote target to do the work; on targets
    which don't, we insert a traditional memory breakpoint.  */
 
+/* Return true if the remote stub evaluates breakpoint conditions
+   sent along with Z0 packets.  */
+
+static int
+remote_supports_cond_breakpoints (void)
+{
+  /* The conditions travel in Z0 packets.  */
+  return (remote_protocol_packets[PACKET_ConditionalBreakpoints].support
+	  == PACKET_ENABLE
+	  && remote_protocol_packets[PACKET_Z0].support != PACKET_DISABLE);
+}
+
+/* Return true if the remote stub answers qXfer:libraries-svr4:read
+   requests with a "prev=" annex with only the changes to the list.  */
+
+static int
+remote_incremental_libraries_svr4_read (void)
+{
+  return (remote_protocol_packets[PACKET_incremental_libraries_svr4_read].support
+	  == PACKET_ENABLE);
+}
+
+/* Append the conditions of BP_TGT to the Z packet being built at
+   BUF, as ";X<len>,<bytes>" agent expressions.  BUF_END is the end
+   of the packet buffer.  If the conditions don't all fit, send none,
+   and let GDB evaluate them on every hit.  */
+
+static void
+remote_add_target_side_condition (struct bp_target_info *bp_tgt,
+				  char *buf, char *buf_end)
+{
+  struct agent_expr *aexpr;
+  char *p = buf;
+  int ix;
+
+  for (ix = 0;
+       VEC_iterate (agent_expr_p, bp_tgt->conditions, ix, aexpr);
+       ix++)
+    {
+      /* ";X", the length, a comma, and the bytes in hex.  */
+      if (p + 2 + 8 + 1 + 2 * aexpr->len + 1 > buf_end)
+	{
+	  *buf = '\0';
+	  return;
+	}
+
+      p += sprintf (p, ";X%x,", aexpr->len);
+      bin2hex (aexpr->buf, p, aexpr->len);
+      p += 2 * aexpr->len;
+    }
+}
+
 static int
 remote_insert_breakpoint (struct gdbarch *gdbarch,
 			  struct bp_target_info *bp_tgt)
@@ -7720,7 +7978,11 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       *(p++) = ',';
       addr = (ULONGEST) remote_address_masked (addr);
       p += hexnumstr (p, addr);
-      sprintf (p, ",%d", bpsize);
+      p += sprintf (p, ",%d", bpsize);
+
+      if (remote_supports_cond_breakpoints ())
+	remote_add_target_side_condition (bp_tgt, p,
+					  rs->buf + get_remote_packet_size ());
 
       putpkt (rs->buf);
       getpkt (&rs->buf, &rs->buf_size, 0);
@@ -8543,6 +8805,141 @@ remote_search_memory (struct target_ops* ops,
   return found;
 }
 
+/* Search memory with qSearch:memory-multi packets.  A reply holds
+   as many matches as fit in it; when it is full, the search resumes
+   at the address of its last match, and the matches at that address
+   that were already reported are skipped.  */
+
+static int
+remote_search_memory_multi (struct target_ops *ops,
+			    const struct mem_search *search,
+			    CORE_ADDR start_addr, ULONGEST search_space_len,
+			    mem_search_found_ftype *found, void *data)
+{
+  int addr_size = gdbarch_addr_bit (target_gdbarch) / 8;
+  struct remote_state *rs = get_remote_state ();
+  struct packet_config *packet =
+    &remote_protocol_packets[PACKET_qSearch_memory_multi];
+  ULONGEST count = 0;
+  CORE_ADDR last_addr = 0;
+  ULONGEST last_pattern = 0;
+  int have_last = 0;
+
+  while (1)
+    {
+      char *p = rs->buf;
+      char *endp = rs->buf + get_remote_packet_size ();
+      ULONGEST max_count = 0;
+      ULONGEST failed_addr = 0;
+      int new_matches = 0;
+      char status;
+      int i;
+
+      if (packet->support == PACKET_DISABLE)
+	break;
+
+      /* Ask for enough matches to make up for the ones that will be
+	 skipped.  */
+      if (search->max_count != 0)
+	{
+	  max_count = search->max_count - count;
+	  if (have_last && max_count + search->num_patterns > max_count)
+	    max_count += search->num_patterns;
+	}
+
+      p += xsnprintf (p, endp - p, "qSearch:memory-multi:%s;%s;%s;%s",
+		      phex_nz (start_addr, addr_size),
+		      phex_nz (search_space_len, sizeof (search_space_len)),
+		      phex_nz (max_count, sizeof (max_count)),
+		      phex_nz (search->align, sizeof (search->align)));
+      for (i = 0; i < search->num_patterns; i++)
+	{
+	  const struct mem_search_pattern *pattern = &search->patterns[i];
+
+	  if (endp - p <= 2 + 4 * pattern->len)
+	    break;
+	  *p++ = ';';
+	  p += 2 * bin2hex (pattern->bytes, p, pattern->len);
+	  if (pattern->mask != NULL)
+	    {
+	      *p++ = '/';
+	      p += 2 * bin2hex (pattern->mask, p, pattern->len);
+	    }
+	}
+
+      /* Search here if the patterns don't fit in a packet.  */
+      if (i < search->num_patterns)
+	break;
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      if (packet_ok (rs->buf, packet) != PACKET_OK)
+	{
+	  if (packet->support == PACKET_DISABLE)
+	    break;
+	  return -1;
+	}
+
+      p = rs->buf;
+      status = *p++;
+      if (status == 'x')
+	p = unpack_varlen_hex (p, &failed_addr);
+      else if (status != 'l' && status != 'm')
+	error (_("Unknown qSearch:memory-multi reply: %s"), rs->buf);
+
+      while (*p == ';')
+	{
+	  ULONGEST addr, pattern;
+
+	  p = unpack_varlen_hex (p + 1, &addr);
+	  if (*p != ',')
+	    error (_("Unknown qSearch:memory-multi reply: %s"), rs->buf);
+	  p = unpack_varlen_hex (p + 1, &pattern);
+	  if (pattern >= search->num_patterns)
+	    error (_("Unknown qSearch:memory-multi reply: %s"), rs->buf);
+
+	  if (have_last && addr == last_addr && pattern <= last_pattern)
+	    continue;
+	  have_last = 1;
+	  last_addr = addr;
+	  last_pattern = pattern;
+	  new_matches++;
+
+	  if (found (addr, pattern, data))
+	    return 1;
+	  count++;
+	  if (search->max_count != 0 && count >= search->max_count)
+	    return 1;
+	}
+      if (*p != '\0')
+	error (_("Unknown qSearch:memory-multi reply: %s"), rs->buf);
+
+      if (status == 'l')
+	return 0;
+      if (status == 'x')
+	{
+	  warning (_("Unable to access target memory at %s, halting search."),
+		   hex_string (failed_addr));
+	  return -1;
+	}
+
+      if (new_matches == 0)
+	error (_("Remote memory search made no progress."));
+      search_space_len -= last_addr - start_addr;
+      start_addr = last_addr;
+    }
+
+  /* Target doesn't provide special support, fall back to its single
+     pattern searches, or to searching here.  */
+  if (mem_search_simple_p (search)
+      && remote_protocol_packets[PACKET_qSearch_memory].support
+	 != PACKET_DISABLE)
+    return repeat_search_memory (ops, search, start_addr, search_space_len,
+				 found, data);
+  return simple_search_memory_multi (ops, search, start_addr,
+				     search_space_len, found, data);
+}
+
 static void
 remote_rcmd (char *command,
 	     struct ui_file *outbuf)
@@ -9353,6 +9750,36 @@ remote_hostio_unlink (const char *filename, int *remote_errno)
 				     remote_errno, NULL, NULL);
 }
 
+/* Have the remote target write LEN bytes of its memory at ADDR to FD,
+   starting at OFFSET.  Return the number of bytes written, which is
+   less than LEN if some of the memory could not be read, or -1 if an
+   error occurs (and set *REMOTE_ERRNO).  */
+
+static int
+remote_hostio_pwritemem (int fd, ULONGEST offset, CORE_ADDR addr, int len,
+			 int *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *p = rs->buf;
+  int left = get_remote_packet_size () - 1;
+
+  remote_buffer_add_string (&p, &left, "vFile:pwritemem:");
+
+  remote_buffer_add_int (&p, &left, fd);
+  remote_buffer_add_string (&p, &left, ",");
+
+  remote_buffer_add_int (&p, &left, offset);
+  remote_buffer_add_string (&p, &left, ",");
+
+  remote_buffer_add_int (&p, &left, remote_address_masked (addr));
+  remote_buffer_add_string (&p, &left, ",");
+
+  remote_buffer_add_int (&p, &left, len);
+
+  return remote_hostio_send_command (p - rs->buf, PACKET_vFile_pwritemem,
+				     remote_errno, NULL, NULL);
+}
+
 static int
 remote_fileio_errno_to_host (int errnum)
 {
@@ -9425,12 +9852,32 @@ remote_hostio_close_cleanup (void *opaque)
 }
 
 
+/* The state behind a BFD opened with remote_bfd_open.  BFD tends to
+   issue many small reads, mostly close to each other; each of them
+   would cost a vFile:pread round trip.  Small reads are therefore
+   served from a block of REMOTE_BFD_READAHEAD bytes fetched at once.  */
+
+#define REMOTE_BFD_READAHEAD (64 * 1024)
+
+struct remote_bfd_stream
+{
+  /* The remote file descriptor.  */
+  int fd;
+
+  /* The read-ahead block, or NULL if nothing was read yet.  */
+  gdb_byte *cache;
+
+  /* The file offset of CACHE, and the number of valid bytes in it.  */
+  file_ptr cache_offset;
+  file_ptr cache_len;
+};
+
 static void *
 remote_bfd_iovec_open (struct bfd *abfd, void *open_closure)
 {
   const char *filename = bfd_get_filename (abfd);
   int fd, remote_errno;
-  int *stream;
+  struct remote_bfd_stream *stream;
 
   gdb_assert (remote_filename_p (filename));
 
@@ -9442,18 +9889,20 @@ remote_bfd_iovec_open (struct bfd *abfd, void *open_closure)
       return NULL;
     }
 
-  stream = xmalloc (sizeof (int));
-  *stream = fd;
+  stream = XZALLOC (struct remote_bfd_stream);
+  stream->fd = fd;
   return stream;
 }
 
 static int
 remote_bfd_iovec_close (struct bfd *abfd, void *stream)
 {
-  int fd = *(int *)stream;
+  struct remote_bfd_stream *rstream = stream;
+  int fd = rstream->fd;
   int remote_errno;
 
-  xfree (stream);
+  xfree (rstream->cache);
+  xfree (rstream);
 
   /* Ignore errors on close; these may happen if the remote
      connection was already torn down.  */
@@ -9462,18 +9911,21 @@ remote_bfd_iovec_close (struct bfd *abfd, void *stream)
   return 1;
 }
 
+/* Read NBYTES bytes at OFFSET of remote file FD into BUF, looping
+   over as many vFile:pread requests as needed.  Return the number of
+   bytes read, which is short only at end-of-file, or -1 on error.  */
+
 static file_ptr
-remote_bfd_iovec_pread (struct bfd *abfd, void *stream, void *buf,
-			file_ptr nbytes, file_ptr offset)
+remote_bfd_read_fully (int fd, gdb_byte *buf, file_ptr nbytes,
+		       file_ptr offset)
 {
-  int fd = *(int *)stream;
   int remote_errno;
   file_ptr pos, bytes;
 
   pos = 0;
   while (nbytes > pos)
     {
-      bytes = remote_hostio_pread (fd, (char *)buf + pos, nbytes - pos,
+      bytes = remote_hostio_pread (fd, buf + pos, nbytes - pos,
 				   offset + pos, &remote_errno);
       if (bytes == 0)
         /* Success, but no bytes, means end-of-file.  */
@@ -9491,6 +9943,42 @@ remote_bfd_iovec_pread (struct bfd *abfd, void *stream, void *buf,
   return pos;
 }
 
+static file_ptr
+remote_bfd_iovec_pread (struct bfd *abfd, void *stream, void *buf,
+			file_ptr nbytes, file_ptr offset)
+{
+  struct remote_bfd_stream *rstream = stream;
+  file_ptr bytes;
+
+  /* Large reads, typically whole sections, go straight to the
+     target.  */
+  if (nbytes >= REMOTE_BFD_READAHEAD)
+    return remote_bfd_read_fully (rstream->fd, buf, nbytes, offset);
+
+  if (rstream->cache == NULL
+      || offset < rstream->cache_offset
+      || offset + nbytes > rstream->cache_offset + rstream->cache_len)
+    {
+      if (rstream->cache == NULL)
+	rstream->cache = xmalloc (REMOTE_BFD_READAHEAD);
+
+      /* Invalidate first, in case the read fails.  */
+      rstream->cache_len = 0;
+      bytes = remote_bfd_read_fully (rstream->fd, rstream->cache,
+				     REMOTE_BFD_READAHEAD, offset);
+      if (bytes == -1)
+	return -1;
+      rstream->cache_offset = offset;
+      rstream->cache_len = bytes;
+    }
+
+  bytes = rstream->cache_offset + rstream->cache_len - offset;
+  if (bytes > nbytes)
+    bytes = nbytes;
+  memcpy (buf, rstream->cache + (offset - rstream->cache_offset), bytes);
+  return bytes;
+}
+
 static int
 remote_bfd_iovec_stat (struct bfd *abfd, void *stream, struct stat *sb)
 {
@@ -9676,6 +10164,349 @@ remote_file_delete (const char *remote_file, int from_tty)
     printf_filtered (_("Successfully deleted file \"%s\".\n"), remote_file);
 }
 
+/* Read all of the remote file REMOTE_FILE.  Return its contents in a
+   NUL-terminated malloc buffer, or NULL if it could not be opened (and
+   set *REMOTE_ERRNO).  */
+
+static char *
+remote_hostio_read_file (const char *remote_file, int *remote_errno)
+{
+  struct cleanup *back_to, *close_cleanup;
+  int fd, bytes, size, len;
+  char *buffer;
+
+  fd = remote_hostio_open (remote_file, FILEIO_O_RDONLY, 0, remote_errno);
+  if (fd == -1)
+    return NULL;
+  close_cleanup = make_cleanup (remote_hostio_close_cleanup, &fd);
+
+  size = 4096;
+  buffer = xmalloc (size);
+  back_to = make_cleanup (free_current_contents, &buffer);
+
+  len = 0;
+  while (1)
+    {
+      if (size - len < 1024)
+	{
+	  size *= 2;
+	  buffer = xrealloc (buffer, size);
+	}
+
+      bytes = remote_hostio_pread (fd, (gdb_byte *) buffer + len,
+				   size - len - 1, len, remote_errno);
+      if (bytes == 0)
+	/* Success, but no bytes, means end-of-file.  */
+	break;
+      if (bytes == -1)
+	remote_hostio_error (*remote_errno);
+
+      len += bytes;
+    }
+  buffer[len] = '\0';
+
+  discard_cleanups (back_to);
+  do_cleanups (close_cleanup);
+  return buffer;
+}
+
+/* Fills the "to_find_memory_regions" target vector.  Lists the memory
+   regions of the inferior for a corefile from its /proc/PID/maps file
+   on the remote system; if there is no such file, leave it to the
+   targets beneath, which make do with the objfiles.  */
+
+static int
+remote_find_memory_regions (find_memory_region_ftype func, void *obfd)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct cleanup *back_to;
+  struct target_ops *t;
+  char mapsfilename[40];
+  char *maps = NULL, *line, *next, *p;
+  int remote_errno;
+  long id = 0;
+
+  /* Without the multi-process extensions, the PID is made up.  But
+     remote GNU/Linux targets number threads by their LWP, and the
+     /proc/LWP/maps file of any thread is that of the whole process.  */
+  if (ptid_get_tid (inferior_ptid) != 0)
+    id = ptid_get_tid (inferior_ptid);
+  else if (remote_multi_process_p (rs))
+    id = ptid_get_pid (inferior_ptid);
+
+  if (id != 0)
+    {
+      xsnprintf (mapsfilename, sizeof (mapsfilename), "/proc/%ld/maps", id);
+      maps = remote_hostio_read_file (mapsfilename, &remote_errno);
+    }
+
+  if (maps == NULL)
+    {
+      for (t = current_target.beneath; t != NULL; t = t->beneath)
+	if (t->to_stratum < process_stratum
+	    && t->to_find_memory_regions != NULL)
+	  return t->to_find_memory_regions (func, obfd);
+
+      return -1;
+    }
+  back_to = make_cleanup (xfree, maps);
+
+  if (info_verbose)
+    fprintf_filtered (gdb_stdout,
+		      "Reading memory regions from %s\n", mapsfilename);
+
+  for (line = maps; *line != '\0'; line = next)
+    {
+      ULONGEST addr, endaddr;
+      int read, write, exec;
+
+      next = strchr (line, '\n');
+      if (next != NULL)
+	*next++ = '\0';
+      else
+	next = line + strlen (line);
+
+      /* Each line starts with "ADDR-ENDADDR PERMISSIONS".  */
+      addr = strtoulst (line, (const char **) &p, 16);
+      if (*p != '-')
+	continue;
+      endaddr = strtoulst (p + 1, (const char **) &p, 16);
+      p = skip_spaces (p);
+      if (strlen (p) < 3)
+	continue;
+
+      read = p[0] == 'r';
+      write = p[1] == 'w';
+      exec = p[2] == 'x';
+
+      if (info_verbose)
+	fprintf_filtered (gdb_stdout,
+			  "Save segment, %s bytes at %s (%c%c%c)\n",
+			  pulongest (endaddr - addr),
+			  paddress (target_gdbarch, addr),
+			  read ? 'r' : ' ', write ? 'w' : ' ',
+			  exec ? 'x' : ' ');
+
+      func (addr, endaddr - addr, read, write, exec, obfd);
+    }
+
+  do_cleanups (back_to);
+  return 0;
+}
+
+/* The largest amount of memory to have the remote target copy into a
+   core file at once.  Each copy is a single request, which must be
+   answered within the remote timeout.  */
+#define REMOTE_GCORE_COPY_BYTES (4 * 1024 * 1024)
+
+/* A memory section of the core file being written by
+   remote_file_gcore, whose contents the remote target copies from its
+   own memory.  */
+
+typedef struct remote_gcore_section
+{
+  CORE_ADDR vma;
+  file_ptr filepos;
+  bfd_size_type size;
+} remote_gcore_section_s;
+
+DEF_VEC_O(remote_gcore_section_s);
+
+static void
+remote_gcore_add_section (bfd *obfd, asection *osec, void *data)
+{
+  VEC (remote_gcore_section_s) **sections = data;
+  struct remote_gcore_section sec;
+
+  if (!gcore_memory_section_p (obfd, osec))
+    return;
+
+  sec.vma = bfd_section_vma (obfd, osec);
+  sec.filepos = osec->filepos;
+  sec.size = bfd_section_size (obfd, osec);
+  VEC_safe_push (remote_gcore_section_s, *sections, &sec);
+}
+
+static int
+remote_gcore_section_cmp (const void *a, const void *b)
+{
+  const struct remote_gcore_section *sa = a;
+  const struct remote_gcore_section *sb = b;
+
+  if (sa->filepos < sb->filepos)
+    return -1;
+  return sa->filepos > sb->filepos;
+}
+
+static void
+remote_gcore_unlink_cleanup (void *filename)
+{
+  unlink (filename);
+}
+
+static void
+remote_gcore_free_sections_cleanup (void *data)
+{
+  VEC (remote_gcore_section_s) **sections = data;
+
+  VEC_free (remote_gcore_section_s, *sections);
+}
+
+/* Write the core file in the remote file FD from OFFSET to END with
+   the contents of FILE, using BUFFER of IO_SIZE bytes.  */
+
+static void
+remote_gcore_put_range (int fd, FILE *file, gdb_byte *buffer, int io_size,
+			file_ptr offset, file_ptr end)
+{
+  int retcode, remote_errno, bytes;
+
+  while (offset < end)
+    {
+      bytes = min (end - offset, io_size);
+      if (fseek (file, offset, SEEK_SET) != 0
+	  || fread (buffer, 1, bytes, file) != bytes)
+	error (_("Error reading the core file headers."));
+
+      retcode = remote_hostio_pwrite (fd, buffer, bytes,
+				      offset, &remote_errno);
+      if (retcode < 0)
+	remote_hostio_error (remote_errno);
+      else if (retcode == 0)
+	error (_("Remote write of %d bytes returned 0!"), bytes);
+
+      offset += retcode;
+    }
+}
+
+/* Have the remote target copy the contents of SEC from its memory into
+   the remote file FD.  */
+
+static void
+remote_gcore_copy_section (int fd, struct remote_gcore_section *sec)
+{
+  bfd_size_type done = 0;
+  int retcode, remote_errno, size;
+
+  while (done < sec->size)
+    {
+      size = min (sec->size - done, REMOTE_GCORE_COPY_BYTES);
+
+      retcode = remote_hostio_pwritemem (fd, sec->filepos + done,
+					 sec->vma + done, size,
+					 &remote_errno);
+      if (retcode < 0)
+	{
+	  if (remote_errno == FILEIO_ENOSYS)
+	    error (_("The remote target cannot write core files."));
+	  remote_hostio_error (remote_errno);
+	}
+
+      done += retcode;
+      if (retcode < size)
+	{
+	  warning (_("Memory read failed for corefile "
+		     "section, %s bytes at %s."),
+		   plongest (sec->size - done),
+		   paddress (target_gdbarch, sec->vma + done));
+	  break;
+	}
+    }
+}
+
+/* Save a core file of the inferior as REMOTE_FILE on the remote
+   target.  The headers and notes are composed here, as for "gcore",
+   and written with vFile:pwrite; the remote target copies the contents
+   of the memory sections itself, so that they do not cross the
+   link.  */
+
+void
+remote_file_gcore (const char *remote_file, int from_tty)
+{
+  struct cleanup *back_to, *bfd_cleanup, *close_cleanup;
+  VEC (remote_gcore_section_s) *sections = NULL;
+  struct remote_gcore_section *sec;
+  char *tmpname;
+  bfd *obfd;
+  FILE *file;
+  gdb_byte *buffer;
+  struct stat st;
+  file_ptr offset;
+  int fd, remote_errno, io_size, ix;
+
+  if (!remote_desc)
+    error (_("command can only be used with remote target"));
+
+  /* No use generating a corefile without a target process.  */
+  if (!target_has_execution)
+    noprocess ();
+
+  /* Compose the core file locally, without the memory contents.  */
+  tmpname = make_temp_file (".core");
+  back_to = make_cleanup (xfree, tmpname);
+  make_cleanup (remote_gcore_unlink_cleanup, tmpname);
+
+  obfd = create_gcore_bfd (tmpname);
+  bfd_cleanup = make_cleanup_bfd_close (obfd);
+
+  write_gcore_file_headers (obfd);
+
+  /* Writing the notes laid out the file.  */
+  if (!obfd->output_has_begun)
+    error (_("The target cannot make core file notes."));
+
+  make_cleanup (remote_gcore_free_sections_cleanup, &sections);
+  bfd_map_over_sections (obfd, remote_gcore_add_section, &sections);
+  qsort (VEC_address (remote_gcore_section_s, sections),
+	 VEC_length (remote_gcore_section_s, sections),
+	 sizeof (struct remote_gcore_section), remote_gcore_section_cmp);
+
+  discard_cleanups (bfd_cleanup);
+  if (!bfd_close (obfd))
+    error (_("Failed to write core file headers (%s)."),
+	   bfd_errmsg (bfd_get_error ()));
+
+  file = fopen (tmpname, "rb");
+  if (file == NULL)
+    perror_with_name (tmpname);
+  make_cleanup_fclose (file);
+  if (fstat (fileno (file), &st) != 0)
+    perror_with_name (tmpname);
+
+  fd = remote_hostio_open (remote_file, (FILEIO_O_WRONLY | FILEIO_O_CREAT
+					 | FILEIO_O_TRUNC),
+			   0600, &remote_errno);
+  if (fd == -1)
+    remote_hostio_error (remote_errno);
+
+  io_size = get_remote_packet_size ();
+  buffer = xmalloc (io_size);
+  make_cleanup (xfree, buffer);
+
+  close_cleanup = make_cleanup (remote_hostio_close_cleanup, &fd);
+
+  /* Send the parts of the file between the memory sections, and have
+     the remote target fill in the memory sections.  */
+  offset = 0;
+  for (ix = 0;
+       VEC_iterate (remote_gcore_section_s, sections, ix, sec);
+       ix++)
+    {
+      remote_gcore_put_range (fd, file, buffer, io_size,
+			      offset, sec->filepos);
+      remote_gcore_copy_section (fd, sec);
+      offset = sec->filepos + sec->size;
+    }
+  remote_gcore_put_range (fd, file, buffer, io_size, offset, st.st_size);
+
+  discard_cleanups (close_cleanup);
+  if (remote_hostio_close (fd, &remote_errno))
+    remote_hostio_error (remote_errno);
+
+  fprintf_filtered (gdb_stdout, "Saved corefile %s\n", remote_file);
+  do_cleanups (back_to);
+}
+
 static void
 remote_put_command (char *args, int from_tty)
 {
@@ -9733,6 +10564,31 @@ remote_delete_command (char *args, int from_tty)
   do_cleanups (back_to);
 }
 
+static void
+remote_gcore_command (char *args, int from_tty)
+{
+  struct cleanup *back_to;
+  char **argv;
+  char corefilename[40];
+
+  if (args == NULL)
+    {
+      /* Default corefile name is "core.PID", as for "gcore".  */
+      sprintf (corefilename, "core.%d", PIDGET (inferior_ptid));
+      remote_file_gcore (corefilename, from_tty);
+      return;
+    }
+
+  argv = gdb_buildargv (args);
+  back_to = make_cleanup_freeargv (argv);
+  if (argv[0] == NULL || argv[1] != NULL)
+    error (_("Invalid parameters to remote gcore"));
+
+  remote_file_gcore (argv[0], from_tty);
+
+  do_cleanups (back_to);
+}
+
 static void
 remote_command (char *args, int from_tty)
 {
@@ -10666,6 +11522,9 @@ Specify the serial device it is connected to\n\
   remote_ops.to_flash_done = remote_flash_done;
   remote_ops.to_read_description = remote_read_description;
   remote_ops.to_search_memory = remote_search_memory;
+  remote_ops.to_search_memory_multi = remote_search_memory_multi;
+  remote_ops.to_find_memory_regions = remote_find_memory_regions;
+  remote_ops.to_make_corefile_notes = gcore_make_regset_notes;
   remote_ops.to_can_async_p = remote_can_async_p;
   remote_ops.to_is_async_p = remote_is_async_p;
   remote_ops.to_async = remote_async;
@@ -10677,6 +11536,10 @@ Specify the serial device it is connected to\n\
     = remote_supports_disable_randomization;
   remote_ops.to_supports_enable_disable_tracepoint = remote_supports_enable_disable_tracepoint;
   remote_ops.to_supports_string_tracing = remote_supports_string_tracing;
+  remote_ops.to_supports_evaluation_of_breakpoint_conditions
+    = remote_supports_cond_breakpoints;
+  remote_ops.to_incremental_libraries_svr4_read
+    = remote_incremental_libraries_svr4_read;
   remote_ops.to_trace_init = remote_trace_init;
   remote_ops.to_download_tracepoint = remote_download_tracepoint;
   remote_ops.to_can_download_tracepoint = remote_can_download_tracepoint;
@@ -11032,6 +11895,19 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("memory-read-window-size", no_class,
+			     &remote_memory_read_window, _("\
+Set the maximum number of memory-read packets in flight at once."), _("\
+Show the maximum number of memory-read packets in flight at once."), _("\
+When reading a block of memory larger than one packet, GDB sends up to\n\
+this many requests before waiting for the first reply.  This hides the\n\
+latency of slow links.  A value of 0 or 1 disables pipelining.\n\
+Pipelining is only used when the remote protocol is in no-ack mode."),
+			     NULL, NULL, /* FIXME: i18n: The maximum
+					    number of memory-read packets
+					    in flight is %s.  */
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -11158,6 +12034,9 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_qSearch_memory],
 			 "qSearch:memory", "search-memory", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qSearch_memory_multi],
+			 "qSearch:memory-multi", "search-memory-multi", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_vFile_open],
 			 "vFile:open", "hostio-open", 0);
 
@@ -11173,6 +12052,9 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_vFile_unlink],
 			 "vFile:unlink", "hostio-unlink", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_vFile_pwritemem],
+			 "vFile:pwritemem", "hostio-pwritemem", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_vAttach],
 			 "vAttach", "attach", 0);
 
@@ -11215,6 +12097,17 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_QDisableRandomization],
 			 "QDisableRandomization", "disable-randomization", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_vReadMemZ],
+			 "vReadMemZ", "read-memory-compressed", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_ConditionalBreakpoints],
+			 "ConditionalBreakpoints",
+			 "conditional-breakpoints", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_incremental_libraries_svr4_read],
+			 "incremental-libraries-svr4-read",
+			 "library-info-svr4-incremental", 0);
+
   /* Keep the old ``set remote Z-packet ...'' working.  Each individual
      Z sub-packet has its own set and show commands, but users may
      have sets to this variable in their .gdbinit files (or in their
@@ -11249,6 +12142,12 @@ Transfer files to and from the remote target system."),
 	   _("Delete a remote file."),
 	   &remote_cmdlist);
 
+  add_cmd ("gcore", class_files, remote_gcore_command, _("\
+Save a core file of the debugged process on the remote system.\n\
+Argument is optional filename.  Default filename is 'core.<process_id>'.\n\
+The remote target copies the process memory into the file itself."),
+	   &remote_cmdlist);
+
   remote_exec_file = xstrdup ("");
   add_setshow_string_noescape_cmd ("exec-file", class_files,
 				   &remote_exec_file, _("\
@@ -325,8 +325,31 @@ struct svr4_info
   CORE_ADDR interp_text_sect_high;
   CORE_ADDR interp_plt_sect_low;
   CORE_ADDR interp_plt_sect_high;
+
+  /* The library list last received via TARGET_OBJECT_LIBRARIES_SVR4,
+     including the main executable's entry, if XFER_LIBRARIES_P.
+     Incremental updates from the target are applied to it.  */
+  struct so_list *xfer_libraries;
+  int xfer_libraries_p;
+
+  /* The generation number the target gave that list, or 0 if it gave
+     none.  */
+  ULONGEST xfer_libraries_generation;
 };
 
+static void svr4_free_library_list (void *p_list);
+
+/* Discard the library list cached in INFO.  */
+
+static void
+svr4_invalidate_xfer_libraries (struct svr4_info *info)
+{
+  svr4_free_library_list (&info->xfer_libraries);
+  info->xfer_libraries = NULL;
+  info->xfer_libraries_p = 0;
+  info->xfer_libraries_generation = 0;
+}
+
 /* Per-program-space data key.  */
 static const struct program_space_data *solib_svr4_pspace_data;
 
@@ -336,6 +359,8 @@ svr4_pspace_data_cleanup (struct program_space *pspace, void *arg)
   struct svr4_info *info;
 
   info = program_space_data (pspace, solib_svr4_pspace_data);
+  if (info != NULL)
+    svr4_invalidate_xfer_libraries (info);
   xfree (info);
 }
 
@@ -978,6 +1003,15 @@ struct svr4_library_list
   /* Inferior address of struct r_debug used for the debugger interface.  It is
      NULL if not known.  */
   CORE_ADDR debug_base;
+
+  /* Set if the document only describes the changes to the previously
+     received list: the entries whose struct link_map addresses are in
+     REMOVED are gone, and HEAD are to be appended.  */
+  int incremental;
+  VEC (CORE_ADDR) *removed;
+
+  /* The generation number of the document, or 0 if it has none.  */
+  ULONGEST generation;
 };
 
 /* Implementation for target_so_ops.free_so.  */
@@ -1000,6 +1034,7 @@ svr4_free_library_list (void *p_list)
       struct so_list *next = list->next;
 
       svr4_free_so (list);
+      xfree (list);
       list = next;
     }
 }
@@ -1055,6 +1090,10 @@ svr4_library_list_start_list (struct gdb_xml_parser *parser,
   const char *version = xml_find_attribute (attributes, "version")->value;
   struct gdb_xml_value *debug_base =
     xml_find_attribute (attributes, "debug-base");
+  struct gdb_xml_value *incremental =
+    xml_find_attribute (attributes, "incremental");
+  struct gdb_xml_value *generation =
+    xml_find_attribute (attributes, "generation");
 
   if (strcmp (version, "1.0") != 0)
     gdb_xml_error (parser,
@@ -1063,6 +1102,25 @@ svr4_library_list_start_list (struct gdb_xml_parser *parser,
 
   if (debug_base)
     list->debug_base = *(ULONGEST *) debug_base->value;
+
+  if (incremental)
+    list->incremental = strcmp (incremental->value, "yes") == 0;
+
+  if (generation)
+    list->generation = *(ULONGEST *) generation->value;
+}
+
+/* Handle the start of a <removed> element.  */
+
+static void
+library_list_start_removed (struct gdb_xml_parser *parser,
+			    const struct gdb_xml_element *element,
+			    void *user_data, VEC(gdb_xml_value_s) *attributes)
+{
+  struct svr4_library_list *list = user_data;
+  ULONGEST *lmp = xml_find_attribute (attributes, "lm")->value;
+
+  VEC_safe_push (CORE_ADDR, list->removed, *lmp);
 }
 
 /* The allowed elements and attributes for an XML library list.
@@ -1077,8 +1135,19 @@ static const struct gdb_xml_attribute svr4_library_attributes[] =
   { NULL, GDB_XML_AF_NONE, NULL, NULL }
 };
 
+static const struct gdb_xml_attribute svr4_removed_attributes[] =
+{
+  { "lm", GDB_XML_AF_NONE, gdb_xml_parse_attr_ulongest, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 static const struct gdb_xml_element svr4_library_list_children[] =
 {
+  {
+    "removed", svr4_removed_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    library_list_start_removed, NULL
+  },
   {
     "library", svr4_library_attributes, NULL,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
@@ -1091,6 +1160,8 @@ static const struct gdb_xml_attribute svr4_library_list_attributes[] =
 {
   { "version", GDB_XML_AF_NONE, NULL, NULL },
   { "debug-base", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "incremental", GDB_XML_AF_OPTIONAL, NULL, NULL },
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
   { NULL, GDB_XML_AF_NONE, NULL, NULL }
 };
 
@@ -1111,10 +1182,11 @@ static int
 svr4_parse_libraries (const char *document, struct svr4_library_list *list,
 		      int ignore_first)
 {
-  struct cleanup *back_to = make_cleanup (svr4_free_library_list,
-					  &list->head);
+  struct cleanup *back_to;
 
   memset (list, 0, sizeof (*list));
+  back_to = make_cleanup (svr4_free_library_list, &list->head);
+  make_cleanup (VEC_cleanup (CORE_ADDR), &list->removed);
   list->tailp = &list->head;
   list->ignore_first = ignore_first;
   if (gdb_xml_parse_quick (_("target library list"), "library-list.dtd",
@@ -1129,32 +1201,159 @@ svr4_parse_libraries (const char *document, struct svr4_library_list *list,
   return 0;
 }
 
+/* Return a copy of the library list LIST.  */
+
+static struct so_list *
+svr4_copy_library_list (struct so_list *list)
+{
+  struct so_list *dst = NULL;
+  struct so_list **link = &dst;
+
+  for (; list != NULL; list = list->next)
+    {
+      struct so_list *new_elem;
+
+      new_elem = xmalloc (sizeof (struct so_list));
+      memcpy (new_elem, list, sizeof (struct so_list));
+      new_elem->lm_info = xmalloc (sizeof (struct lm_info));
+      memcpy (new_elem->lm_info, list->lm_info, sizeof (struct lm_info));
+      new_elem->next = NULL;
+
+      *link = new_elem;
+      link = &new_elem->next;
+    }
+
+  return dst;
+}
+
+/* Apply the incremental library list UPDATE to the list cached in
+   INFO: drop the entries UPDATE lists as removed, then append the
+   entries of UPDATE, whose ownership is transferred.  */
+
+static void
+svr4_apply_library_list_update (struct svr4_info *info,
+				struct svr4_library_list *update)
+{
+  struct so_list **link = &info->xfer_libraries;
+
+  while (*link != NULL)
+    {
+      struct so_list *so = *link;
+      CORE_ADDR lm;
+      int ix;
+
+      for (ix = 0; VEC_iterate (CORE_ADDR, update->removed, ix, lm); ix++)
+	if (lm == so->lm_info->lm_addr)
+	  break;
+
+      if (ix < VEC_length (CORE_ADDR, update->removed))
+	{
+	  *link = so->next;
+	  svr4_free_so (so);
+	  xfree (so);
+	}
+      else
+	link = &so->next;
+    }
+
+  *link = update->head;
+  update->head = NULL;
+}
+
 /* Attempt to get so_list from target via qXfer:libraries:read packet.
 
    Return 0 if packet not supported, *SO_LIST_RETURN is not modified in such
    case.  Return 1 if *SO_LIST_RETURN contains the library list, it may be
-   empty, caller is responsible for freeing all its entries.  */
+   empty, caller is responsible for freeing all its entries.
+
+   The full list last received is kept in the svr4_info.  If the target
+   supports it, only the changes since that list are requested, by
+   naming its last entry and its generation number in the annex, so
+   that loading one more library does not transfer and parse the whole
+   list again.  */
 
 static int
 svr4_current_sos_via_xfer_libraries (struct svr4_library_list *list,
 				     int ignore_first)
 {
+  struct svr4_info *info = get_svr4_info ();
   char *svr4_library_document;
+  char *annex = NULL;
+  struct svr4_library_list update;
+  struct so_list *so;
   int result;
   struct cleanup *back_to;
 
+  if (info->xfer_libraries_p && info->xfer_libraries != NULL
+      && info->xfer_libraries_generation != 0
+      && target_incremental_libraries_svr4_read ())
+    {
+      for (so = info->xfer_libraries; so->next != NULL; so = so->next)
+	;
+      annex = xstrprintf ("prev=%s,gen=%s",
+			  phex_nz (so->lm_info->lm_addr,
+				   sizeof (so->lm_info->lm_addr)),
+			  phex_nz (info->xfer_libraries_generation,
+				   sizeof (info->xfer_libraries_generation)));
+    }
+  back_to = make_cleanup (xfree, annex);
+
   /* Fetch the list of shared libraries.  */
   svr4_library_document = target_read_stralloc (&current_target,
 						TARGET_OBJECT_LIBRARIES_SVR4,
-						NULL);
+						annex);
   if (svr4_library_document == NULL)
-    return 0;
+    {
+      svr4_invalidate_xfer_libraries (info);
+      do_cleanups (back_to);
+      return 0;
+    }
 
-  back_to = make_cleanup (xfree, svr4_library_document);
-  result = svr4_parse_libraries (svr4_library_document, list, ignore_first);
-  do_cleanups (back_to);
+  make_cleanup (xfree, svr4_library_document);
+  result = svr4_parse_libraries (svr4_library_document, &update, 0);
+  if (!result)
+    {
+      svr4_invalidate_xfer_libraries (info);
+      do_cleanups (back_to);
+      return 0;
+    }
 
-  return result;
+  make_cleanup (svr4_free_library_list, &update.head);
+  make_cleanup (VEC_cleanup (CORE_ADDR), &update.removed);
+
+  if (update.incremental)
+    {
+      if (annex == NULL)
+	{
+	  /* Nothing to apply the changes to.  */
+	  warning (_("Unexpected incremental SVR4 library list"));
+	  svr4_invalidate_xfer_libraries (info);
+	  do_cleanups (back_to);
+	  return 0;
+	}
+      svr4_apply_library_list_update (info, &update);
+    }
+  else
+    {
+      svr4_invalidate_xfer_libraries (info);
+      info->xfer_libraries = update.head;
+      update.head = NULL;
+    }
+  info->xfer_libraries_p = 1;
+  info->xfer_libraries_generation = update.generation;
+
+  memset (list, 0, sizeof (*list));
+  list->debug_base = update.debug_base;
+  so = info->xfer_libraries;
+  if (ignore_first && so != NULL)
+    {
+      list->main_lm = so->lm_info->lm_addr;
+      so = so->next;
+    }
+  list->head = svr4_copy_library_list (so);
+
+  do_cleanups (back_to);
+  return 1;
 }
 
 #else
@@ -2310,6 +2509,7 @@ svr4_clear_solib (void)
   info->debug_loader_offset = 0;
   xfree (info->debug_loader_name);
   info->debug_loader_name = NULL;
+  svr4_invalidate_xfer_libraries (info);
 }
 
 /* Clear any bits of ADDR that wouldn't fit in a target-format
@@ -105,6 +105,19 @@ show_solib_search_path (struct ui_file *file, int from_tty,
 		    value);
 }
 
+/* If non-zero, only the minimal symbols of shared libraries are read
+   when they are loaded; their debug information is read the first time
+   a lookup needs it.  */
+static int solib_lazy_debug_info = 0;
+static void
+show_solib_lazy_debug_info (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Deferred reading of shared library debug "
+			    "information is %s.\n"),
+		    value);
+}
+
 /* Same as HAVE_DOS_BASED_FILE_SYSTEM, but useable as an rvalue.  */
 #if (HAVE_DOS_BASED_FILE_SYSTEM)
 #  define DOS_BASED_FILE_SYSTEM 1
@@ -595,6 +608,8 @@ solib_read_symbols (struct so_list *so, int flags)
       TRY_CATCH (e, RETURN_MASK_ERROR)
 	{
 	  struct section_addr_info *sap;
+	  int add_flags = flags;
+	  int objfile_flags = OBJF_SHARED;
 
 	  /* Have we already loaded this shared object?  */
 	  ALL_OBJFILES (so->objfile)
@@ -608,9 +623,14 @@ solib_read_symbols (struct so_list *so, int flags)
 
 	  sap = build_section_addr_info_from_section_table (so->sections,
 							    so->sections_end);
+	  if (solib_lazy_debug_info)
+	    {
+	      add_flags |= SYMFILE_NO_READ;
+	      objfile_flags |= OBJF_LAZY_DEBUG;
+	    }
 	  so->objfile = symbol_file_add_from_bfd (so->abfd,
-						  flags, sap, OBJF_SHARED,
-						  NULL);
+						  add_flags, sap,
+						  objfile_flags, NULL);
 	  so->objfile->addr_low = so->addr_low;
 	  free_section_addr_info (sap);
 	}
@@ -1474,6 +1494,19 @@ inferior.  Otherwise, symbols must be loaded manually, using \
 			   show_auto_solib_add,
 			   &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("solib-lazy-debug-info", class_support,
+			   &solib_lazy_debug_info, _("\
+Set deferred reading of shared library debug information."), _("\
+Show deferred reading of shared library debug information."), _("\
+If \"on\", only the minimal symbols of a shared library are read when it\n\
+is loaded.  Its debug information is read the first time a symbol lookup\n\
+names one of its minimal symbols, or an address inside the library needs\n\
+to be symbolized.  This mostly helps remote targets, where every shared\n\
+library has to be fetched from the target."),
+			   NULL,
+			   show_solib_lazy_debug_info,
+			   &setlist, &showlist);
+
   add_setshow_filename_cmd ("sysroot", class_support,
 			    &gdb_sysroot, _("\
 Set an alternate system root."), _("\
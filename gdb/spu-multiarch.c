@@ -318,6 +318,29 @@ spu_search_memory (struct target_ops* ops,
 					pattern, pattern_len, found_addrp);
 }
 
+/* Override the to_search_memory_multi routine.  */
+static int
+spu_search_memory_multi (struct target_ops *ops,
+			 const struct mem_search *search,
+			 CORE_ADDR start_addr, ULONGEST search_space_len,
+			 mem_search_found_ftype *found, void *data)
+{
+  struct target_ops *ops_beneath = find_target_beneath (ops);
+  while (ops_beneath && !ops_beneath->to_search_memory_multi)
+    ops_beneath = find_target_beneath (ops_beneath);
+
+  /* For SPU local store, always fall back to the simple method.  Likewise
+     if we do not have any target-specific special implementation.  */
+  if (!ops_beneath || SPUADDR_SPU (start_addr) >= 0)
+    return simple_search_memory_multi (ops, search,
+				       start_addr, search_space_len,
+				       found, data);
+
+  return ops_beneath->to_search_memory_multi (ops_beneath, search,
+					      start_addr, search_space_len,
+					      found, data);
+}
+
 
 /* Push and pop the SPU multi-architecture support target.  */
 
@@ -395,6 +418,7 @@ init_spu_ops (void)
   spu_ops.to_store_registers = spu_store_registers;
   spu_ops.to_xfer_partial = spu_xfer_partial;
   spu_ops.to_search_memory = spu_search_memory;
+  spu_ops.to_search_memory_multi = spu_search_memory_multi;
   spu_ops.to_region_ok_for_hw_watchpoint = spu_region_ok_for_hw_watchpoint;
   spu_ops.to_thread_architecture = spu_thread_architecture;
   spu_ops.to_stratum = arch_stratum;
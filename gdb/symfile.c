@@ -1196,7 +1196,7 @@ symbol_file_add_separate (bfd *bfd, int symfile_flags, struct objfile *objfile)
     (bfd, symfile_flags,
      sap, NULL, 0,
      objfile->flags & (OBJF_REORDERED | OBJF_SHARED | OBJF_READNOW
-		       | OBJF_USERLOADED),
+		       | OBJF_USERLOADED | OBJF_LAZY_DEBUG),
      objfile);
 
   do_cleanups (my_cleanup);
@@ -2515,11 +2515,17 @@ reread_symbols (void)
 	      htab_delete (objfile->demangled_names_hash);
 	      objfile->demangled_names_hash = NULL;
 	    }
+	  if (objfile->file_symbol_names != NULL)
+	    {
+	      htab_delete (objfile->file_symbol_names);
+	      objfile->file_symbol_names = NULL;
+	    }
 	  obstack_free (&objfile->objfile_obstack, 0);
 	  objfile->sections = NULL;
 	  objfile->symtabs = NULL;
 	  objfile->psymtabs = NULL;
 	  objfile->psymtabs_addrmap = NULL;
+	  objfile->psymtab_name_index = NULL;
 	  objfile->free_psymtabs = NULL;
 	  objfile->template_symbols = NULL;
 	  objfile->msymbols = NULL;
@@ -603,6 +603,14 @@ struct dwarf2_debug_sections {
 extern int dwarf2_has_info (struct objfile *,
                             const struct dwarf2_debug_sections *);
 
+/* Return non-zero if the DWARF debug info of OBJFILE may define NAME.
+   This only consults the pubnames and pubtypes sections, without
+   reading any partial symbols, and returns non-zero when OBJFILE has
+   none.  */
+
+extern int dwarf2_may_define_name (struct objfile *objfile,
+				   const char *name);
+
 /* Dwarf2 sections that can be accessed by dwarf2_get_section_info.  */
 enum dwarf2_section_enum {
   DWARF2_DEBUG_FRAME,
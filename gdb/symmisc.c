@@ -105,6 +105,8 @@ print_objfile_statistics (void)
   struct objfile *objfile;
   struct symtab *s;
   int i, linetables, blockvectors;
+  int open_files, max_open_files;
+  unsigned long hits, misses;
 
   immediate_quit++;
   ALL_PSPACES (pspace)
@@ -156,6 +158,14 @@ print_objfile_statistics (void)
     printf_filtered (_("  Total memory used for file name cache: %d\n"),
 		     bcache_memory_used (objfile->filename_cache));
   }
+
+  bfd_cache_stats (&open_files, &max_open_files, &hits, &misses);
+  printf_filtered (_("Statistics for the BFD file cache:\n"));
+  printf_filtered (_("  Open files: %d (at most %d)\n"),
+		   open_files, max_open_files);
+  printf_filtered (_("  Lookups that found the file open: %lu\n"), hits);
+  printf_filtered (_("  Lookups that had to reopen the file: %lu\n"),
+		   misses);
   immediate_quit--;
 }
 
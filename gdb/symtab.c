@@ -1267,7 +1267,24 @@ lookup_symbol_aux (const char *name, const struct block *block,
   /* Now search all static file-level symbols.  Not strictly correct,
      but more useful than an error.  */
 
-  return lookup_static_symbol_aux (name, domain);
+  sym = lookup_static_symbol_aux (name, domain);
+  if (sym != NULL)
+    return sym;
+
+  /* Typedefs and enumerators have no minimal symbols, so the lookups
+     above skip the objfiles whose debug info is read lazily, unless
+     some minimal symbol has the same name.  Read the ones whose debug
+     info may define NAME and try again.  */
+  if (domain == VAR_DOMAIN && read_deferred_partial_symbols (name))
+    {
+      sym = langdef->la_lookup_symbol_nonlocal (name, block, domain);
+      if (sym != NULL)
+	return sym;
+
+      sym = lookup_static_symbol_aux (name, domain);
+    }
+
+  return sym;
 }
 
 /* Search all static file-level symbols for NAME from DOMAIN.  Do the symtabs
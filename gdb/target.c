@@ -42,6 +42,7 @@
 #include "exec.h"
 #include "inline-frame.h"
 #include "tracepoint.h"
+#include "observer.h"
 
 static void target_info (char *, int);
 
@@ -254,6 +255,52 @@ target_dcache_invalidate (void)
   dcache_invalidate (target_dcache);
 }
 
+/* Non-zero if reads of read-only code sections go through the code
+   cache.  */
+static int code_cache_enabled_p = 1;
+
+static void
+set_code_cache_enabled_p (char *args, int from_tty,
+			  struct cmd_list_element *c)
+{
+  target_code_cache_invalidate ();
+}
+
+static void
+show_code_cache_enabled_p (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Cache use for code access is %s.\n"), value);
+}
+
+/* Cache of the contents of read-only code sections.  Unlike the
+   dcache, it is kept while the inferior runs.  */
+static DCACHE *target_code_cache;
+
+/* Invalidate the target code cache.  */
+
+void
+target_code_cache_invalidate (void)
+{
+  dcache_invalidate (target_code_cache);
+}
+
+/* Observers that invalidate the code cache when code may have
+   changed: when a process comes or goes, or when the executable or a
+   shared library does.  */
+
+static void
+code_cache_inferior_changed (struct inferior *inf)
+{
+  target_code_cache_invalidate ();
+}
+
+static void
+code_cache_solib_changed (struct so_list *solib)
+{
+  target_code_cache_invalidate ();
+}
+
 /* The user just typed 'target' without the name of a target.  */
 
 static void
@@ -462,6 +509,7 @@ void
 target_load (char *arg, int from_tty)
 {
   target_dcache_invalidate ();
+  target_code_cache_invalidate ();
   (*current_target.to_load) (arg, from_tty);
 }
 
@@ -668,9 +716,12 @@ update_current_target (void)
       /* Do not inherit to_read_description.  */
       INHERIT (to_get_ada_task_ptid, t);
       /* Do not inherit to_search_memory.  */
+      /* Do not inherit to_search_memory_multi.  */
       INHERIT (to_supports_multi_process, t);
       INHERIT (to_supports_enable_disable_tracepoint, t);
       INHERIT (to_supports_string_tracing, t);
+      INHERIT (to_supports_evaluation_of_breakpoint_conditions, t);
+      INHERIT (to_incremental_libraries_svr4_read, t);
       INHERIT (to_trace_init, t);
       INHERIT (to_download_tracepoint, t);
       INHERIT (to_can_download_tracepoint, t);
@@ -846,6 +897,12 @@ update_current_target (void)
   de_fault (to_supports_string_tracing,
 	    (int (*) (void))
 	    return_zero);
+  de_fault (to_supports_evaluation_of_breakpoint_conditions,
+	    (int (*) (void))
+	    return_zero);
+  de_fault (to_incremental_libraries_svr4_read,
+	    (int (*) (void))
+	    return_zero);
   de_fault (to_trace_init,
 	    (void (*) (void))
 	    tcomplain);
@@ -1526,6 +1583,44 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
   else
     inf = NULL;
 
+  /* Read code through the code cache.  Only read-only code sections
+     are cached, as those aren't expected to change while the program
+     runs; GDB's own writes update the cache.  The cache holds the
+     contents of memory without breakpoints, so it isn't used when
+     breakpoint instructions are wanted, nor while single-step
+     breakpoints, whose shadows aren't known to breakpoint_xfer_memory,
+     are inserted.  The code cache reads whole cache lines too, so it
+     isn't used with traceframes either, nor with overlays, whose code
+     changes behind GDB's back.  */
+  if (readbuf != NULL
+      && inf != NULL
+      && code_cache_enabled_p
+      && !show_memory_breakpoints
+      && !single_step_breakpoints_inserted ()
+      && !overlay_debugging
+      && get_traceframe_number () == -1
+      && object != TARGET_OBJECT_STACK_MEMORY)
+    {
+      struct target_section *secp = target_section_by_addr (ops, memaddr);
+
+      if (secp != NULL
+	  && ((bfd_get_section_flags (secp->bfd, secp->the_bfd_section)
+	       & (SEC_CODE | SEC_READONLY)) == (SEC_CODE | SEC_READONLY)))
+	{
+	  int code_len = reg_len;
+
+	  if (code_len > secp->endaddr - memaddr)
+	    code_len = secp->endaddr - memaddr;
+	  res = dcache_read_code (target_code_cache, memaddr, readbuf,
+				  code_len, secp->endaddr);
+	  if (res > 0)
+	    return res;
+
+	  /* If the code couldn't be read through the cache, try reading
+	     just what was asked for.  */
+	}
+    }
+
   if (inf != NULL
       /* The dcache reads whole cache lines; that doesn't play well
 	 with reading from a trace buffer, because reading outside of
@@ -1631,6 +1726,13 @@ memory_xfer_partial (struct target_ops *ops, enum target_object object,
       breakpoint_xfer_memory (NULL, buf, writebuf, memaddr, len);
       res = memory_xfer_partial_1 (ops, object, NULL, buf, memaddr, len);
 
+      /* The code cache holds memory without breakpoints, so update
+	 it with what was asked to be written, not with BUF.  Writes of
+	 raw memory, by which breakpoints are inserted and removed,
+	 don't come here and leave the code cache alone.  */
+      if (res > 0)
+	dcache_update (target_code_cache, memaddr, (void *) writebuf, res);
+
       do_cleanups (old_chain);
     }
 
@@ -2782,110 +2884,108 @@ target_read_description (struct target_ops *target)
   return NULL;
 }
 
-/* The default implementation of to_search_memory.
-   This implements a basic search of memory, reading target memory and
-   performing the search here (as opposed to performing the search in on the
-   target side with, for example, gdbserver).  */
+/* State of a search by simple_search_memory_multi.  */
 
-int
-simple_search_memory (struct target_ops *ops,
-		      CORE_ADDR start_addr, ULONGEST search_space_len,
-		      const gdb_byte *pattern, ULONGEST pattern_len,
-		      CORE_ADDR *found_addrp)
+struct simple_search_state
 {
-  /* NOTE: also defined in find.c testcase.  */
-#define SEARCH_CHUNK_SIZE 16000
-  const unsigned chunk_size = SEARCH_CHUNK_SIZE;
-  /* Buffer to hold memory contents for searching.  */
-  gdb_byte *search_buf;
-  unsigned search_buf_size;
-  struct cleanup *old_cleanups;
-
-  search_buf_size = chunk_size + pattern_len - 1;
+  /* The target to read memory from.  */
+  struct target_ops *ops;
 
-  /* No point in trying to allocate a buffer larger than the search space.  */
-  if (search_space_len < search_buf_size)
-    search_buf_size = search_space_len;
+  /* The match callback of the search, and its data.  */
+  mem_search_found_ftype *found;
+  void *data;
+};
 
-  search_buf = malloc (search_buf_size);
-  if (search_buf == NULL)
-    error (_("Unable to allocate memory to perform the search."));
-  old_cleanups = make_cleanup (free_current_contents, &search_buf);
+/* Memory reader for simple_search_memory_multi.  DATA is the
+   simple_search_state.  */
 
-  /* Prime the search buffer.  */
-
-  if (target_read (ops, TARGET_OBJECT_MEMORY, NULL,
-		   search_buf, start_addr, search_buf_size) != search_buf_size)
-    {
-      warning (_("Unable to access target memory at %s, halting search."),
-	       hex_string (start_addr));
-      do_cleanups (old_cleanups);
-      return -1;
-    }
+static int
+simple_search_read_memory (CORE_ADDR addr, gdb_byte *buf, ULONGEST len,
+			   void *data)
+{
+  struct simple_search_state *state = data;
 
-  /* Perform the search.
+  return target_read (state->ops, TARGET_OBJECT_MEMORY, NULL,
+		      buf, addr, len) != len;
+}
 
-     The loop is kept simple by allocating [N + pattern-length - 1] bytes.
-     When we've scanned N bytes we copy the trailing bytes to the start and
-     read in another N bytes.  */
+/* Match callback for simple_search_memory_multi.  DATA is the
+   simple_search_state.  */
 
-  while (search_space_len >= pattern_len)
-    {
-      gdb_byte *found_ptr;
-      unsigned nr_search_bytes = min (search_space_len, search_buf_size);
+static int
+simple_search_found_multi (CORE_ADDR addr, int pattern, void *data)
+{
+  struct simple_search_state *state = data;
 
-      found_ptr = memmem (search_buf, nr_search_bytes,
-			  pattern, pattern_len);
+  return state->found (addr, pattern, state->data);
+}
 
-      if (found_ptr != NULL)
-	{
-	  CORE_ADDR found_addr = start_addr + (found_ptr - search_buf);
+/* The default implementation of to_search_memory_multi.
+   This implements a basic search of memory, reading target memory and
+   performing the search here (as opposed to performing the search in on the
+   target side with, for example, gdbserver).  */
 
-	  *found_addrp = found_addr;
-	  do_cleanups (old_cleanups);
-	  return 1;
-	}
+int
+simple_search_memory_multi (struct target_ops *ops,
+			    const struct mem_search *search,
+			    CORE_ADDR start_addr, ULONGEST search_space_len,
+			    mem_search_found_ftype *found, void *data)
+{
+  struct simple_search_state state;
+  CORE_ADDR failed_addr;
+  int result;
+
+  state.ops = ops;
+  state.found = found;
+  state.data = data;
+  result = mem_search_memory (search, start_addr, search_space_len,
+			      simple_search_read_memory,
+			      simple_search_found_multi, &state,
+			      &failed_addr);
+  if (result < 0)
+    warning (_("Unable to access target memory at %s, halting search."),
+	     hex_string (failed_addr));
 
-      /* Not found in this chunk, skip to next chunk.  */
+  return result;
+}
 
-      /* Don't let search_space_len wrap here, it's unsigned.  */
-      if (search_space_len >= chunk_size)
-	search_space_len -= chunk_size;
-      else
-	search_space_len = 0;
+/* Match callback for simple_search_memory.  DATA points to where to
+   record the address of the match.  */
 
-      if (search_space_len >= pattern_len)
-	{
-	  unsigned keep_len = search_buf_size - chunk_size;
-	  CORE_ADDR read_addr = start_addr + chunk_size + keep_len;
-	  int nr_to_read;
+static int
+simple_search_found (CORE_ADDR addr, int pattern, void *data)
+{
+  CORE_ADDR *found_addrp = data;
 
-	  /* Copy the trailing part of the previous iteration to the front
-	     of the buffer for the next iteration.  */
-	  gdb_assert (keep_len == pattern_len - 1);
-	  memcpy (search_buf, search_buf + chunk_size, keep_len);
+  *found_addrp = addr;
+  return 1;
+}
 
-	  nr_to_read = min (search_space_len - keep_len, chunk_size);
+/* The default implementation of to_search_memory.  */
 
-	  if (target_read (ops, TARGET_OBJECT_MEMORY, NULL,
-			   search_buf + keep_len, read_addr,
-			   nr_to_read) != nr_to_read)
-	    {
-	      warning (_("Unable to access target "
-			 "memory at %s, halting search."),
-		       hex_string (read_addr));
-	      do_cleanups (old_cleanups);
-	      return -1;
-	    }
+int
+simple_search_memory (struct target_ops *ops,
+		      CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  struct mem_search_pattern search_pattern;
+  struct mem_search search;
 
-	  start_addr += chunk_size;
-	}
-    }
+  if (pattern_len > search_space_len)
+    return 0;
 
-  /* Not found.  */
+  search_pattern.bytes = (gdb_byte *) pattern;
+  search_pattern.mask = NULL;
+  search_pattern.len = pattern_len;
+  memset (&search, 0, sizeof (search));
+  search.patterns = &search_pattern;
+  search.num_patterns = 1;
+  mem_search_prepare (&search);
 
-  do_cleanups (old_cleanups);
-  return 0;
+  return simple_search_memory_multi (ops, &search,
+				     start_addr, search_space_len,
+				     simple_search_found, found_addrp);
 }
 
 /* Search SEARCH_SPACE_LEN bytes beginning at START_ADDR for the
@@ -2935,6 +3035,90 @@ target_search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
   return found;
 }
 
+/* Search for the single pattern of SEARCH with the to_search_memory
+   method of OPS, continuing after each match.  Arguments and result
+   are as for to_search_memory_multi.  */
+
+int
+repeat_search_memory (struct target_ops *ops,
+		      const struct mem_search *search,
+		      CORE_ADDR start_addr, ULONGEST search_space_len,
+		      mem_search_found_ftype *found, void *data)
+{
+  const struct mem_search_pattern *pattern = &search->patterns[0];
+  ULONGEST count = 0;
+
+  while (search_space_len >= pattern->len)
+    {
+      CORE_ADDR found_addr;
+      ULONGEST skip;
+      int result;
+
+      result = ops->to_search_memory (ops, start_addr, search_space_len,
+				      pattern->bytes, pattern->len,
+				      &found_addr);
+      if (result <= 0)
+	return result;
+
+      if (found (found_addr, 0, data))
+	return 1;
+      count++;
+      if (search->max_count != 0 && count >= search->max_count)
+	return 1;
+
+      skip = found_addr - start_addr + 1;
+      if (skip >= search_space_len)
+	break;
+      start_addr += skip;
+      search_space_len -= skip;
+    }
+
+  return 0;
+}
+
+/* Search SEARCH_SPACE_LEN bytes beginning at START_ADDR for the
+   patterns of SEARCH, calling FOUND with DATA for each match.  See
+   to_search_memory_multi for the result.  */
+
+int
+target_search_memory_multi (const struct mem_search *search,
+			    CORE_ADDR start_addr, ULONGEST search_space_len,
+			    mem_search_found_ftype *found, void *data)
+{
+  struct target_ops *t;
+  int result;
+
+  /* Like target_search_memory, scan the target stack ourselves.  A
+     target that can only search for a single pattern is still used
+     for the searches it can do.  */
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog,
+			"target_search_memory_multi (%s, ...)\n",
+			hex_string (start_addr));
+
+  for (t = current_target.beneath; t != NULL; t = t->beneath)
+    if (t->to_search_memory_multi != NULL || t->to_search_memory != NULL)
+      break;
+
+  if (t != NULL && t->to_search_memory_multi != NULL)
+    result = t->to_search_memory_multi (t, search,
+					start_addr, search_space_len,
+					found, data);
+  else if (t != NULL && mem_search_simple_p (search))
+    result = repeat_search_memory (t, search, start_addr, search_space_len,
+				   found, data);
+  else
+    result = simple_search_memory_multi (current_target.beneath, search,
+					 start_addr, search_space_len,
+					 found, data);
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog, "  = %d\n", result);
+
+  return result;
+}
+
 /* Look through the currently pushed targets.  If none of them will
    be able to restart the currently running process, issue an error
    message.  */
@@ -4402,6 +4586,19 @@ By default, caching for stack access is on."),
 			   show_stack_cache_enabled_p,
 			   &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("code-cache", class_support,
+			   &code_cache_enabled_p, _("\
+Set cache use for code access."), _("\
+Show cache use for code access."), _("\
+When on, read the read-only code sections of the program and its shared\n\
+libraries through the code cache, which is kept while the program runs.\n\
+This speeds up disassembly and prologue analysis, especially on remote\n\
+targets.  Turn it off to debug a program that modifies its own code.\n\
+By default, caching for code access is on."),
+			   set_code_cache_enabled_p,
+			   show_code_cache_enabled_p,
+			   &setlist, &showlist);
+
   add_setshow_boolean_cmd ("may-write-registers", class_support,
 			   &may_write_registers_1, _("\
 Set permission to write into registers."), _("\
@@ -4458,4 +4655,11 @@ Otherwise, any attempt to interrupt or stop will be ignored."),
 
 
   target_dcache = dcache_init ();
+  target_code_cache = dcache_init_code ();
+
+  observer_attach_inferior_appeared (code_cache_inferior_changed);
+  observer_attach_inferior_exit (code_cache_inferior_changed);
+  observer_attach_solib_loaded (code_cache_solib_changed);
+  observer_attach_solib_unloaded (code_cache_solib_changed);
+  observer_attach_executable_changed (target_code_cache_invalidate);
 }
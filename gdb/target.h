@@ -62,6 +62,7 @@ struct expression;
 #include "memattr.h"
 #include "vec.h"
 #include "gdb_signals.h"
+#include "mem-search.h"
 
 enum strata
   {
@@ -640,6 +641,21 @@ struct target_ops
 			     const gdb_byte *pattern, ULONGEST pattern_len,
 			     CORE_ADDR *found_addrp);
 
+    /* Search SEARCH_SPACE_LEN bytes beginning at START_ADDR for the
+       patterns of SEARCH, calling FOUND with DATA for each match, in
+       address order, until FOUND returns non-zero or SEARCH->max_count
+       matches have been found.
+
+       The result is 1 if the search was stopped, 0 if the whole space
+       was searched, and -1 if there was an error requiring halting of
+       the search (e.g. memory read error).  */
+    int (*to_search_memory_multi) (struct target_ops *ops,
+				   const struct mem_search *search,
+				   CORE_ADDR start_addr,
+				   ULONGEST search_space_len,
+				   mem_search_found_ftype *found,
+				   void *data);
+
     /* Can target execute in reverse?  */
     int (*to_can_execute_reverse) (void);
 
@@ -662,6 +678,16 @@ struct target_ops
     /* Does this target support the tracenz bytecode for string collection?  */
     int (*to_supports_string_tracing) (void);
 
+    /* Does this target evaluate breakpoint conditions itself, given
+       as agent expressions in bp_target_info, and only report the
+       breakpoint hits whose condition is true?  */
+    int (*to_supports_evaluation_of_breakpoint_conditions) (void);
+
+    /* Does this target answer TARGET_OBJECT_LIBRARIES_SVR4 reads with
+       a "prev=ADDR" annex with only the changes since the list ending
+       with the link map entry at ADDR?  */
+    int (*to_incremental_libraries_svr4_read) (void);
+
     /* Determine current architecture of thread PTID.
 
        The target is supposed to determine the architecture of the code where
@@ -927,9 +953,24 @@ int target_supports_disable_randomization (void);
 #define target_supports_string_tracing() \
   (*current_target.to_supports_string_tracing) ()
 
+/* Returns true if this target can evaluate breakpoint conditions on
+   its side.  */
+
+#define target_supports_evaluation_of_breakpoint_conditions() \
+  (*current_target.to_supports_evaluation_of_breakpoint_conditions) ()
+
+/* Returns true if this target can report incremental changes to the
+   SVR4 library list.  */
+
+#define target_incremental_libraries_svr4_read() \
+  (*current_target.to_incremental_libraries_svr4_read) ()
+
 /* Invalidate all target dcaches.  */
 extern void target_dcache_invalidate (void);
 
+/* Invalidate the code cache.  */
+extern void target_code_cache_invalidate (void);
+
 extern int target_read_string (CORE_ADDR, char **, int, int *);
 
 extern int target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len);
@@ -1489,6 +1530,31 @@ extern int target_search_memory (CORE_ADDR start_addr,
                                  ULONGEST pattern_len,
                                  CORE_ADDR *found_addrp);
 
+/* Utility implementation of searching memory for several patterns.  */
+extern int simple_search_memory_multi (struct target_ops *ops,
+				       const struct mem_search *search,
+				       CORE_ADDR start_addr,
+				       ULONGEST search_space_len,
+				       mem_search_found_ftype *found,
+				       void *data);
+
+/* Utility implementation of searching memory for a single pattern
+   without a mask or alignment, repeating the to_search_memory method
+   of OPS.  */
+extern int repeat_search_memory (struct target_ops *ops,
+				 const struct mem_search *search,
+				 CORE_ADDR start_addr,
+				 ULONGEST search_space_len,
+				 mem_search_found_ftype *found,
+				 void *data);
+
+/* Main entry point for searching memory for several patterns.  */
+extern int target_search_memory_multi (const struct mem_search *search,
+				       CORE_ADDR start_addr,
+				       ULONGEST search_space_len,
+				       mem_search_found_ftype *found,
+				       void *data);
+
 /* Tracepoint-related operations.  */
 
 #define target_trace_init() \
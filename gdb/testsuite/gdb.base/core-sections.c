@@ -0,0 +1,49 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* Three pages of memory, filled with 0x11, 0x22 and 0x33.  The middle
+   page is made read-only, so that the core file has three adjacent
+   sections for them.  */
+unsigned char *pages;
+long page_size;
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  page_size = sysconf (_SC_PAGESIZE);
+  pages = mmap (NULL, 3 * page_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED)
+    return 1;
+
+  memset (pages, 0x11, page_size);
+  memset (pages + page_size, 0x22, page_size);
+  memset (pages + 2 * page_size, 0x33, page_size);
+  mprotect (pages + page_size, page_size, PROT_READ);
+
+  marker ();
+  return 0;
+}
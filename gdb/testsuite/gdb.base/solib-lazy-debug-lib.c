@@ -0,0 +1,33 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Neither the typedef nor the enumerators have minimal symbols.  */
+
+typedef int lzlib_t;
+
+enum lzlib_color { LZLIB_RED, LZLIB_GREEN };
+
+enum lzlib_color lzlib_color = LZLIB_RED;
+
+int
+lzlib_func (int arg)
+{
+  lzlib_t val = arg + 1;
+
+  lzlib_color = LZLIB_GREEN;
+  return val;
+}
@@ -0,0 +1,45 @@
+/* Program for the backtrace performance test.  It recurses DEPTH
+   levels deep.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+void
+bottom (void)
+{
+}
+
+int
+recurse (int depth)
+{
+  int result;
+
+  if (depth == 0)
+    {
+      bottom ();
+      return 0;
+    }
+
+  result = recurse (depth - 1);
+  return result + 1;
+}
+
+int
+main (void)
+{
+  return recurse (DEPTH) != DEPTH;
+}
@@ -0,0 +1,45 @@
+/* Program for the server-memory performance test.  It fills a heap
+   buffer of SIZE bytes for GDB to read.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+
+unsigned char *buffer;
+
+void
+filled (void)
+{
+}
+
+int
+main (void)
+{
+  size_t i;
+
+  buffer = malloc (SIZE);
+  if (buffer == NULL)
+    return 1;
+
+  /* Not too regular, so that compressed transfers are not flattered.  */
+  for (i = 0; i < SIZE; i++)
+    buffer[i] = (i * 2654435761u) >> 13;
+
+  filled ();
+  return 0;
+}
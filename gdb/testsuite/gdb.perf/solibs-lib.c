@@ -0,0 +1,31 @@
+/* Shared library for the solibs performance test.  It is compiled
+   once per library, with LIB defined to the library's number.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define PASTE_1(a, b) a ## b
+#define PASTE(a, b) PASTE_1 (a, b)
+
+int PASTE (lib_global_, LIB);
+
+int
+PASTE (lib_func_, LIB) (int x)
+{
+  PASTE (lib_global_, LIB) += x;
+  return PASTE (lib_global_, LIB);
+}
@@ -0,0 +1,48 @@
+/* Main program for the solibs performance test.  It loads
+   SOLIB_COUNT libraries named SOLIB_PREFIX<N>.so.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void
+all_loaded (void)
+{
+}
+
+int
+main (void)
+{
+  char name[4096];
+  int i;
+
+  for (i = 0; i < SOLIB_COUNT; i++)
+    {
+      snprintf (name, sizeof name, "%s%d.so", SOLIB_PREFIX, i);
+      if (dlopen (name, RTLD_NOW | RTLD_GLOBAL) == NULL)
+	{
+	  fprintf (stderr, "%s\n", dlerror ());
+	  exit (1);
+	}
+    }
+
+  all_loaded ();
+  return 0;
+}
@@ -0,0 +1,43 @@
+/* Program for the stepping performance test.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+volatile int total;
+
+void
+hot (int x)
+{
+  total += x;
+}
+
+void
+done (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    hot (i);
+
+  done ();
+  return 0;
+}
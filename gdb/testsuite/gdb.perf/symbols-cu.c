@@ -0,0 +1,44 @@
+/* Compilation unit for the symbols performance test.  It is compiled
+   once per unit, with CU defined to the unit's number.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define PASTE_1(a, b) a ## b
+#define PASTE(a, b) PASTE_1 (a, b)
+
+struct PASTE (cu_struct_, CU)
+{
+  int a;
+  long b;
+  char c[8];
+};
+
+struct PASTE (cu_struct_, CU) PASTE (cu_global_, CU);
+
+static int PASTE (cu_static_, CU);
+
+int
+PASTE (cu_func_, CU) (int x)
+{
+  struct PASTE (cu_struct_, CU) s;
+
+  s.a = x;
+  PASTE (cu_static_, CU) += s.a;
+  PASTE (cu_global_, CU).b = s.a;
+  return PASTE (cu_static_, CU);
+}
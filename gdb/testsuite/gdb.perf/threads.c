@@ -0,0 +1,65 @@
+/* Program for the threads performance test.  It starts THREAD_COUNT
+   threads, which stay blocked until the program exits.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static pthread_barrier_t barrier;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *
+thread_function (void *arg)
+{
+  pthread_barrier_wait (&barrier);
+
+  /* Block until the program exits.  */
+  pthread_mutex_lock (&mutex);
+  return NULL;
+}
+
+void
+all_started (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_attr_t attr;
+  pthread_t thread;
+  int i;
+
+  pthread_mutex_lock (&mutex);
+  pthread_barrier_init (&barrier, NULL, THREAD_COUNT + 1);
+  pthread_attr_init (&attr);
+  pthread_attr_setstacksize (&attr, 64 * 1024);
+
+  for (i = 0; i < THREAD_COUNT; i++)
+    if (pthread_create (&thread, &attr, thread_function, NULL) != 0)
+      {
+	fprintf (stderr, "cannot create thread %d\n", i);
+	exit (1);
+      }
+
+  pthread_barrier_wait (&barrier);
+  all_started ();
+  return 0;
+}
@@ -0,0 +1,55 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* This program is intended to be started outside of gdb, and then
+   attached to by gdb.  It only starts a thread once GDB sets GO, and
+   gives up after a while.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+volatile int go;
+
+void
+marker (void)
+{
+}
+
+void *
+thread_func (void *arg)
+{
+  marker ();
+  return NULL;
+}
+
+int
+main (void)
+{
+  pthread_t thread;
+  int i;
+
+  for (i = 0; i < 120 && !go; i++)
+    sleep (1);
+
+  if (go)
+    {
+      pthread_create (&thread, NULL, thread_func, NULL);
+      pthread_join (thread, NULL);
+    }
+
+  return 0;
+}
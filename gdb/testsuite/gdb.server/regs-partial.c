@@ -0,0 +1,47 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+unsigned int xmm0_in[4] = { 0x01010101, 0x02020202, 0x03030303, 0x04040404 };
+unsigned int xmm1_in[4] = { 0x11111111, 0x12121212, 0x13131313, 0x14141414 };
+unsigned int xmm0_out[4];
+unsigned int xmm1_out[4];
+
+void
+done (void)
+{
+}
+
+int
+main (void)
+{
+  /* Load known values into RBX, XMM0 and XMM1, stop at STOP_HERE with
+     nothing else touching them, and save the XMM registers after
+     GDB has had its way with them.  */
+  asm volatile ("movq $0x0123456789abcdef, %%rbx\n\t"
+		"movdqu %2, %%xmm0\n\t"
+		"movdqu %3, %%xmm1\n\t"
+		".globl stop_here\n"
+		"stop_here:\n\t"
+		"nop\n\t"
+		"movdqu %%xmm0, %0\n\t"
+		"movdqu %%xmm1, %1"
+		: "=m" (xmm0_out), "=m" (xmm1_out)
+		: "m" (xmm0_in), "m" (xmm1_in)
+		: "rbx", "xmm0", "xmm1");
+  done ();
+  return 0;
+}
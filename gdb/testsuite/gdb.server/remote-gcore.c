@@ -0,0 +1,45 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+
+#define BUFFER_SIZE (256 * 1024)
+
+int value = 0x12345678;
+
+/* A heap buffer, mostly zeros, so that the core file has holes,
+   with a few bytes set at either end.  */
+unsigned char *buffer;
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  buffer = calloc (1, BUFFER_SIZE);
+  if (buffer == NULL)
+    return 1;
+
+  buffer[0] = 0xaa;
+  buffer[BUFFER_SIZE - 1] = 0x55;
+
+  marker ();
+  return 0;
+}
@@ -0,0 +1,54 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+static void
+stop (void)
+{
+}
+
+int
+main (void)
+{
+  void *h1, *h2;
+
+  h1 = dlopen (SHLIB_NAME1, RTLD_NOW);
+  if (h1 == NULL)
+    abort ();
+  stop ();
+
+  h2 = dlopen (SHLIB_NAME2, RTLD_NOW);
+  if (h2 == NULL)
+    abort ();
+  stop ();
+
+  dlclose (h1);
+  stop ();
+
+  h1 = dlopen (SHLIB_NAME1, RTLD_NOW);
+  if (h1 == NULL)
+    abort ();
+  stop ();
+
+  dlclose (h1);
+  dlclose (h2);
+  stop ();
+
+  return 0;
+}
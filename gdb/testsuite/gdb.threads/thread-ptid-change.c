@@ -0,0 +1,69 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <assert.h>
+
+#define NTHREADS 100
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *
+thread_function (void *arg)
+{
+  pthread_mutex_lock (&mutex);
+  pthread_mutex_unlock (&mutex);
+  return arg;
+}
+
+static void
+all_started (void)
+{
+}
+
+static void
+all_joined (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  int i, res;
+
+  pthread_mutex_lock (&mutex);
+
+  for (i = 0; i < NTHREADS; i++)
+    {
+      res = pthread_create (&threads[i], NULL, thread_function, NULL);
+      assert (res == 0);
+    }
+
+  all_started ();
+  pthread_mutex_unlock (&mutex);
+
+  for (i = 0; i < NTHREADS; i++)
+    {
+      res = pthread_join (threads[i], NULL);
+      assert (res == 0);
+    }
+
+  all_joined ();
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2012 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+
+#ifdef SYMBOL_PREFIX
+#define SYMBOL(str)     SYMBOL_PREFIX #str
+#else
+#define SYMBOL(str)     #str
+#endif
+
+#define NUM_THREADS 4
+#define ITERATIONS 50
+
+/* Serializes the threads' calls to marker, so that the tickets are
+   collected in increasing order.  */
+static pthread_mutex_t ticket_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int ticket;
+
+static void
+begin (void)
+{}
+
+/* Called from asm.  */
+static void __attribute__((used))
+func (void)
+{}
+
+static void __attribute__((noinline))
+marker (unsigned int anarg)
+{
+  /* `set_point' is the label at which to set a fast tracepoint.  The
+     insn at the label must be large enough to fit a fast tracepoint
+     jump.  */
+  asm ("    .global " SYMBOL(set_point) "\n"
+       SYMBOL(set_point) ":\n"
+#if (defined __x86_64__ || defined __i386__)
+       "    call " SYMBOL(func) "\n"
+#endif
+       );
+}
+
+static void *
+worker (void *arg)
+{
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      pthread_mutex_lock (&ticket_lock);
+      marker (++ticket);
+      pthread_mutex_unlock (&ticket_lock);
+    }
+
+  return NULL;
+}
+
+static void
+end (void)
+{}
+
+int
+main ()
+{
+  pthread_t threads[NUM_THREADS];
+  int i;
+
+  begin ();
+
+  for (i = 0; i < NUM_THREADS; i++)
+    pthread_create (&threads[i], NULL, worker, NULL);
+
+  for (i = 0; i < NUM_THREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  end ();
+  return 0;
+}
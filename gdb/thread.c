@@ -45,6 +45,7 @@
 #include "gdb_regex.h"
 #include "cli/cli-utils.h"
 #include "continuations.h"
+#include "hashtab.h"
 
 /* Definition of struct thread_info exported to gdbthread.h.  */
 
@@ -57,6 +58,16 @@ void _initialize_thread (void);
 static struct thread_info *thread_list = NULL;
 static int highest_thread_num;
 
+/* Indexes of THREAD_LIST, so that looking up a thread does not need a
+   walk of the whole list.  THREAD_PTID_HTAB maps a ptid to the first
+   thread with that ptid in THREAD_LIST.  There can be more than one,
+   when a thread that can not be deleted yet has exited and the OS has
+   reused its id; the others follow through their next_same_ptid links,
+   in list order.  THREAD_NUM_HTAB maps a GDB thread number to its
+   thread.  */
+static htab_t thread_ptid_htab;
+static htab_t thread_num_htab;
+
 static void thread_command (char *tidstr, int from_tty);
 static void thread_apply_all_command (char *, int);
 static int thread_alive (struct thread_info *);
@@ -136,6 +147,116 @@ free_thread (struct thread_info *tp)
   xfree (tp);
 }
 
+static hashval_t
+hash_ptid (ptid_t ptid)
+{
+  hashval_t hash;
+
+  hash = ptid_get_pid (ptid);
+  hash = hash * 31 + ptid_get_lwp (ptid);
+  hash = hash * 31 + ptid_get_tid (ptid);
+  return hash;
+}
+
+/* Hash function for THREAD_PTID_HTAB entries.  */
+
+static hashval_t
+hash_thread_ptid (const void *p)
+{
+  const struct thread_info *tp = p;
+
+  return hash_ptid (tp->ptid);
+}
+
+/* Equality function for THREAD_PTID_HTAB.  KEY is a pointer to a
+   ptid_t.  */
+
+static int
+eq_thread_ptid (const void *p, const void *key)
+{
+  const struct thread_info *tp = p;
+
+  return ptid_equal (tp->ptid, *(const ptid_t *) key);
+}
+
+/* Hash function for THREAD_NUM_HTAB entries.  */
+
+static hashval_t
+hash_thread_num (const void *p)
+{
+  const struct thread_info *tp = p;
+
+  return tp->num;
+}
+
+/* Equality function for THREAD_NUM_HTAB.  KEY is a pointer to an
+   int.  */
+
+static int
+eq_thread_num (const void *p, const void *key)
+{
+  const struct thread_info *tp = p;
+
+  return tp->num == *(const int *) key;
+}
+
+/* Add TP to THREAD_PTID_HTAB under its current ptid.  New threads
+   are added at the head of THREAD_LIST, so list order is descending
+   thread number, and so is the order of a chain of threads sharing a
+   ptid.  */
+
+static void
+link_thread_ptid (struct thread_info *tp)
+{
+  void **slot;
+  struct thread_info **link;
+
+  slot = htab_find_slot_with_hash (thread_ptid_htab, &tp->ptid,
+				   hash_ptid (tp->ptid), INSERT);
+  for (link = (struct thread_info **) slot;
+       *link != NULL && (*link)->num > tp->num;
+       link = &(*link)->next_same_ptid)
+    ;
+  tp->next_same_ptid = *link;
+  *link = tp;
+}
+
+/* Remove TP from THREAD_PTID_HTAB.  TP->ptid must still be the ptid
+   it was added under.  */
+
+static void
+unlink_thread_ptid (struct thread_info *tp)
+{
+  void **slot;
+  struct thread_info **link;
+
+  slot = htab_find_slot_with_hash (thread_ptid_htab, &tp->ptid,
+				   hash_ptid (tp->ptid), NO_INSERT);
+  gdb_assert (slot != NULL);
+
+  link = (struct thread_info **) slot;
+  if (*link == tp && tp->next_same_ptid == NULL)
+    htab_clear_slot (thread_ptid_htab, slot);
+  else
+    {
+      for (; *link != tp; link = &(*link)->next_same_ptid)
+	gdb_assert (*link != NULL);
+      *link = tp->next_same_ptid;
+    }
+  tp->next_same_ptid = NULL;
+}
+
+/* Change the ptid of thread TP to PTID, keeping THREAD_PTID_HTAB up
+   to date.  */
+
+static void
+set_thread_ptid (struct thread_info *tp, ptid_t ptid)
+{
+  unlink_thread_ptid (tp);
+  tp->ptid = ptid;
+  link_thread_ptid (tp);
+}
+
 void
 init_thread_list (void)
 {
@@ -153,6 +274,8 @@ init_thread_list (void)
     }
 
   thread_list = NULL;
+  htab_empty (thread_ptid_htab);
+  htab_empty (thread_num_htab);
 }
 
 /* Allocate a new thread with target id PTID and add it to the thread
@@ -168,8 +291,14 @@ new_thread (ptid_t ptid)
   tp->ptid = ptid;
   tp->num = ++highest_thread_num;
   tp->next = thread_list;
+  if (thread_list != NULL)
+    thread_list->prev = tp;
   thread_list = tp;
 
+  link_thread_ptid (tp);
+  *htab_find_slot_with_hash (thread_num_htab, &tp->num, tp->num,
+			     INSERT) = tp;
+
   /* Nothing to follow yet.  */
   tp->pending_follow.kind = TARGET_WAITKIND_SPURIOUS;
   tp->state = THREAD_STOPPED;
@@ -208,7 +337,7 @@ add_thread_silent (ptid_t ptid)
 	  delete_thread (ptid);
 
 	  /* Now reset its ptid, and reswitch inferior_ptid to it.  */
-	  tp->ptid = ptid;
+	  set_thread_ptid (tp, ptid);
 	  tp->state = THREAD_STOPPED;
 	  switch_to_thread (ptid);
 
@@ -253,14 +382,9 @@ add_thread (ptid_t ptid)
 static void
 delete_thread_1 (ptid_t ptid, int silent)
 {
-  struct thread_info *tp, *tpprev;
-
-  tpprev = NULL;
-
-  for (tp = thread_list; tp; tpprev = tp, tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      break;
+  struct thread_info *tp;
 
+  tp = find_thread_ptid (ptid);
   if (!tp)
     return;
 
@@ -293,10 +417,15 @@ delete_thread_1 (ptid_t ptid, int silent)
   tp->state = THREAD_EXITED;
   clear_thread_inferior_resources (tp);
 
-  if (tpprev)
-    tpprev->next = tp->next;
+  if (tp->prev != NULL)
+    tp->prev->next = tp->next;
   else
     thread_list = tp->next;
+  if (tp->next != NULL)
+    tp->next->prev = tp->prev;
+
+  htab_remove_elt_with_hash (thread_num_htab, &tp->num, tp->num);
+  unlink_thread_ptid (tp);
 
   free_thread (tp);
 }
@@ -320,26 +449,14 @@ delete_thread_silent (ptid_t ptid)
 struct thread_info *
 find_thread_id (int num)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (tp->num == num)
-      return tp;
-
-  return NULL;
+  return htab_find_with_hash (thread_num_htab, &num, num);
 }
 
 /* Find a thread_info by matching PTID.  */
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return tp;
-
-  return NULL;
+  return htab_find_with_hash (thread_ptid_htab, &ptid, hash_ptid (ptid));
 }
 
 /*
@@ -387,23 +504,16 @@ thread_count (void)
 int
 valid_thread_id (int num)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (tp->num == num)
-      return 1;
-
-  return 0;
+  return find_thread_id (num) != NULL;
 }
 
 int
 pid_to_thread_id (ptid_t ptid)
 {
-  struct thread_info *tp;
+  struct thread_info *tp = find_thread_ptid (ptid);
 
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return tp->num;
+  if (tp)
+    return tp->num;
 
   return 0;
 }
@@ -422,13 +532,7 @@ thread_id_to_pid (int num)
 int
 in_thread_list (ptid_t ptid)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return 1;
-
-  return 0;			/* Never heard of 'im.  */
+  return find_thread_ptid (ptid) != NULL;
 }
 
 /* Finds the first thread of the inferior given by PID.  If PID is -1,
@@ -559,7 +663,7 @@ thread_change_ptid (ptid_t old_ptid, ptid_t new_ptid)
   inf->pid = ptid_get_pid (new_ptid);
 
   tp = find_thread_ptid (old_ptid);
-  tp->ptid = new_ptid;
+  set_thread_ptid (tp, new_ptid);
 
   observer_notify_thread_ptid_changed (old_ptid, new_ptid);
 }
@@ -1447,6 +1551,11 @@ _initialize_thread (void)
 {
   static struct cmd_list_element *thread_apply_list = NULL;
 
+  thread_ptid_htab = htab_create_alloc (64, hash_thread_ptid, eq_thread_ptid,
+					NULL, xcalloc, xfree);
+  thread_num_htab = htab_create_alloc (64, hash_thread_num, eq_thread_num,
+				       NULL, xcalloc, xfree);
+
   add_info ("threads", info_threads_command, 
 	    _("Display currently known threads.\n\
 Usage: info threads [ID]...\n\
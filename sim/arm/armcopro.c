@@ -52,7 +52,7 @@ NoCoPro4W (ARMul_State * state ATTRIBUTE_UNUSED,
 /* The XScale Co-processors.  */
 
 /* Coprocessor 15:  System Control.  */
-static void     write_cp14_reg (unsigned, ARMword);
+static void     write_cp14_reg (ARMul_State *, unsigned, ARMword);
 static ARMword  read_cp14_reg  (unsigned);
 
 /* There are two sets of registers for copro 15.
@@ -260,6 +260,7 @@ write_cp15_reg (ARMul_State * state,
 	      state->bigendSig = value & ARMul_CP15_R1_ENDIAN;
 	      /* Force ARMulator to notice these now.  */
 	      state->Emulate = CHANGEMODE;
+	      ARMul_DecodeCacheFlush (state);
 	    }
 	  break;
 
@@ -295,6 +296,8 @@ write_cp15_reg (ARMul_State * state,
 	case 13: /* Process ID.  */
 	  /* Only BITS (31, 25) are writable.  */
 	  value &= 0xfe000000;
+	  /* This relocates instruction fetches.  */
+	  ARMul_DecodeCacheFlush (state);
 	  break;
 
 	case 14: /* DBR0, DBR1, DBCON, IBCR0, IBCR1 */
@@ -527,6 +530,20 @@ XScale_check_memacc (ARMul_State * state, ARMword * address, int store)
     }
 }
 
+/* Return non-zero if XScale_check_memacc leaves aligned accesses
+   alone: there is no process ID to relocate them by, and debug is
+   disabled so there are no data breakpoints to check.  */
+
+int
+XScale_memacc_trivial (ARMul_State * state)
+{
+  if (!state->is_XScale)
+    return 1;
+
+  return read_cp15_reg (13, 0, 0) == 0
+    && (read_cp14_reg (10) & (1UL << 31)) == 0;
+}
+
 /* Set the XScale FSR and FAR registers.  */
 
 void
@@ -557,7 +574,7 @@ XScale_debug_moe (ARMul_State * state, int moe)
           value &= ~0x1c;
           value |= moe;
 	
-          write_cp14_reg (10, value);
+          write_cp14_reg (state, 10, value);
 	}
       return 1;
     }
@@ -846,7 +863,7 @@ check_cp14_access (ARMul_State * state,
 /* Store a value into one of coprocessor 14's registers.  */
 
 static void
-write_cp14_reg (unsigned reg, ARMword value)
+write_cp14_reg (ARMul_State * state, unsigned reg, ARMword value)
 {
   switch (reg)
     {
@@ -886,6 +903,9 @@ write_cp14_reg (unsigned reg, ARMword value)
       /* Only BITS (31:30), BITS (23:22), BITS (20:16) and BITS (5:0) can
 	 be written.  */
       value &= 0xc0df003f;
+      /* Enabling debug makes instruction fetches check the data
+	 breakpoints.  */
+      ARMul_DecodeCacheFlush (state);
       break;
 
     case 11: /* TBREG */
@@ -924,7 +944,7 @@ XScale_cp14_LDC (ARMul_State * state, unsigned type, ARMword instr, ARMword data
   result = check_cp14_access (state, reg, 0, 0, 0);
 
   if (result == ARMul_DONE && type == ARMul_DATA)
-    write_cp14_reg (reg, data);
+    write_cp14_reg (state, reg, data);
 
   return result;
 }
@@ -978,7 +998,7 @@ XScale_cp14_MCR
   result = check_cp14_access (state, reg, BITS (0, 3), BITS (21, 23), BITS (5, 7));
 
   if (result == ARMul_DONE)
-    write_cp14_reg (reg, value);
+    write_cp14_reg (state, reg, value);
 
   return result;
 }
@@ -999,12 +1019,12 @@ XScale_cp14_read_reg
 static unsigned
 XScale_cp14_write_reg
 (
- ARMul_State * state ATTRIBUTE_UNUSED,
+ ARMul_State * state,
  unsigned      reg,
  ARMword       value
 )
 {
-  write_cp14_reg (reg, value);
+  write_cp14_reg (state, reg, value);
 
   return TRUE;
 }
@@ -1076,6 +1096,10 @@ MMUMCR (ARMul_State * state,
 	  || b != state->bigendSig)
 	/* Force ARMulator to notice these now.  */
 	state->Emulate = CHANGEMODE;
+
+      /* Cached instruction words were fetched in the old byte order.  */
+      if (b != state->bigendSig)
+	ARMul_DecodeCacheFlush (state);
     }
 
   return ARMul_DONE;
@@ -1118,6 +1142,10 @@ MMUWrite (ARMul_State * state, unsigned reg, ARMword value)
 	  || b != state->bigendSig)
 	/* Force ARMulator to notice these now.  */	
 	state->Emulate = CHANGEMODE;
+
+      /* Cached instruction words were fetched in the old byte order.  */
+      if (b != state->bigendSig)
+	ARMul_DecodeCacheFlush (state);
     }
 
   return TRUE;
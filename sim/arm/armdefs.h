@@ -61,6 +61,30 @@ typedef unsigned ARMul_CPReads (ARMul_State * state, unsigned reg,
 typedef unsigned ARMul_CPWrites (ARMul_State * state, unsigned reg,
 				 ARMword value);
 
+/* The decode cache.  The emulator's pipeline fetches instructions
+   through it, and for Thumb code it also remembers the ARM instruction
+   that ARMul_ThumbDecode translated each one into, so that code which
+   is executed repeatedly does not go through the memory interface and
+   the Thumb decoder every time.  It is direct mapped and indexed by
+   address.  The memory interface invalidates the entries fetched from
+   a word whenever that word is written.  */
+
+#define DECODE_CACHE_SIZE 8192	/* entries, must be a power of two */
+#define DECODE_CACHE_INDEX(address) \
+  (((address) >> 1) & (DECODE_CACHE_SIZE - 1))
+/* Thumb instructions are tagged with their address plus one.  ARM
+   instructions are word aligned, so no tag equals DECODE_CACHE_EMPTY.  */
+#define DECODE_CACHE_TAG(address, isize) ((address) | ((isize) == 2))
+#define DECODE_CACHE_EMPTY 2
+
+struct ARMul_DecodeEntry
+{
+  ARMword tag;
+  ARMword instr;		/* the instruction as fetched */
+  ARMword ainstr;		/* Thumb: the equivalent ARM instruction */
+  unsigned thumb_decoded;	/* set if ainstr is valid */
+};
+
 struct ARMul_State
 {
   ARMword Emulate;		/* to start and stop emulation */
@@ -150,6 +174,8 @@ struct ARMul_State
   unsigned is_iWMMXt;		/* Are we emulating an iWMMXt co-processor ?  */
   unsigned is_ep9312;		/* Are we emulating a Cirrus Maverick co-processor ?  */
   unsigned verbose;		/* Print various messages like the banner */
+
+  struct ARMul_DecodeEntry *DecodeCache;	/* NULL if disabled */
 };
 
 #define ResetPin NresetSig
@@ -256,6 +282,11 @@ extern void ARMul_Reset (ARMul_State * state);
 extern ARMword ARMul_DoProg (ARMul_State * state);
 extern ARMword ARMul_DoInstr (ARMul_State * state);
 
+extern void ARMul_DecodeCacheInit (ARMul_State * state);
+extern void ARMul_DecodeCacheFlush (ARMul_State * state);
+extern void ARMul_DecodeCacheInvalidate (ARMul_State * state,
+					 ARMword address);
+
 /***************************************************************************\
 *                Definitons of things for event handling                    *
 \***************************************************************************/
@@ -310,6 +341,7 @@ extern ARMword ARMul_LoadInstrN (ARMul_State * state, ARMword address,
 				 ARMword isize);
 extern ARMword ARMul_ReLoadInstr (ARMul_State * state, ARMword address,
 				  ARMword isize);
+extern int ARMul_InstrCacheable (ARMul_State * state, ARMword address);
 
 extern ARMword ARMul_LoadWordS (ARMul_State * state, ARMword address);
 extern ARMword ARMul_LoadWordN (ARMul_State * state, ARMword address);
@@ -401,6 +433,7 @@ extern void XScale_check_memacc (ARMul_State * state, ARMword * address,
 				 int store);
 extern void XScale_set_fsr_far (ARMul_State * state, ARMword fsr, ARMword far);
 extern int XScale_debug_moe (ARMul_State * state, int moe);
+extern int XScale_memacc_trivial (ARMul_State * state);
 
 /***************************************************************************\
 *               Definitons of things in the host environment                *
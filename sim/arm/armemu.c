@@ -480,6 +480,83 @@ handle_v6_insn (ARMul_State * state, ARMword instr)
    or Thumb instructions are being executed.  */
 ARMword isize;
 
+/* Fetch the ISIZE instruction at ADDRESS into the pipeline, in a SEQ
+   or NONSEQ cycle, going through the decode cache if there is one.  */
+
+static ARMword
+fetch_instr (ARMul_State * state, ARMword address, int cycle)
+{
+  struct ARMul_DecodeEntry *entry;
+  ARMword tag;
+  ARMword instr;
+
+  if (state->DecodeCache == NULL)
+    return (cycle == SEQ
+	    ? ARMul_LoadInstrS (state, address, isize)
+	    : ARMul_LoadInstrN (state, address, isize));
+
+  tag = DECODE_CACHE_TAG (address, isize);
+  entry = &state->DecodeCache[DECODE_CACHE_INDEX (address)];
+  if (entry->tag == tag)
+    {
+      /* Account for the cycle as the memory interface would.  */
+      if (cycle == SEQ)
+	state->NumScycles++;
+      else
+	state->NumNcycles++;
+      return entry->instr;
+    }
+
+  instr = (cycle == SEQ
+	   ? ARMul_LoadInstrS (state, address, isize)
+	   : ARMul_LoadInstrN (state, address, isize));
+
+  if (ARMul_InstrCacheable (state, address))
+    {
+      entry->tag = tag;
+      entry->instr = instr;
+      entry->thumb_decoded = 0;
+    }
+
+  return instr;
+}
+
+#ifdef MODET
+/* Translate the Thumb instruction INSTR at PC, reusing the translation
+   in the decode cache if the fetch of INSTR is still there.  Only
+   translations are kept: the Thumb instructions that ARMul_ThumbDecode
+   executes itself have side effects.  */
+
+static tdstate
+decode_thumb (ARMul_State * state, ARMword pc, ARMword instr, ARMword * ainstr)
+{
+  struct ARMul_DecodeEntry *entry = NULL;
+  tdstate valid;
+
+  if (state->DecodeCache != NULL)
+    {
+      entry = &state->DecodeCache[DECODE_CACHE_INDEX (pc)];
+      if (entry->tag != DECODE_CACHE_TAG (pc, 2) || entry->instr != instr)
+	entry = NULL;
+      else if (entry->thumb_decoded)
+	{
+	  * ainstr = entry->ainstr;
+	  return t_decoded;
+	}
+    }
+
+  valid = ARMul_ThumbDecode (state, pc, instr, ainstr);
+
+  if (entry != NULL && valid == t_decoded)
+    {
+      entry->ainstr = * ainstr;
+      entry->thumb_decoded = 1;
+    }
+
+  return valid;
+}
+#endif
+
 ARMword
 #ifdef MODE32
 ARMul_Emulate32 (ARMul_State * state)
@@ -518,7 +595,7 @@ ARMul_Emulate26 (ARMul_State * state)
 	  pc += isize;
 	  instr = decoded;
 	  decoded = loaded;
-	  loaded = ARMul_LoadInstrS (state, pc + (isize * 2), isize);
+	  loaded = fetch_instr (state, pc + (isize * 2), SEQ);
 	  break;
 
 	case NONSEQ:
@@ -527,7 +604,7 @@ ARMul_Emulate26 (ARMul_State * state)
 	  pc += isize;
 	  instr = decoded;
 	  decoded = loaded;
-	  loaded = ARMul_LoadInstrN (state, pc + (isize * 2), isize);
+	  loaded = fetch_instr (state, pc + (isize * 2), NONSEQ);
 	  NORMALCYCLE;
 	  break;
 
@@ -536,7 +613,7 @@ ARMul_Emulate26 (ARMul_State * state)
 	  pc += isize;
 	  instr = decoded;
 	  decoded = loaded;
-	  loaded = ARMul_LoadInstrS (state, pc + (isize * 2), isize);
+	  loaded = fetch_instr (state, pc + (isize * 2), SEQ);
 	  NORMALCYCLE;
 	  break;
 
@@ -545,7 +622,7 @@ ARMul_Emulate26 (ARMul_State * state)
 	  pc += isize;
 	  instr = decoded;
 	  decoded = loaded;
-	  loaded = ARMul_LoadInstrN (state, pc + (isize * 2), isize);
+	  loaded = fetch_instr (state, pc + (isize * 2), NONSEQ);
 	  NORMALCYCLE;
 	  break;
 
@@ -571,9 +648,9 @@ ARMul_Emulate26 (ARMul_State * state)
 #endif
 	  state->Reg[15] = pc + (isize * 2);
 	  state->Aborted = 0;
-	  instr   = ARMul_LoadInstrN (state, pc, isize);
-	  decoded = ARMul_LoadInstrS (state, pc + (isize), isize);
-	  loaded  = ARMul_LoadInstrS (state, pc + (isize * 2), isize);
+	  instr   = fetch_instr (state, pc, NONSEQ);
+	  decoded = fetch_instr (state, pc + (isize), SEQ);
+	  loaded  = fetch_instr (state, pc + (isize * 2), SEQ);
 	  NORMALCYCLE;
 	  break;
 	}
@@ -654,7 +731,7 @@ ARMul_Emulate26 (ARMul_State * state)
 	  ARMword new;
 
 	  /* Check if in Thumb mode.  */
-	  switch (ARMul_ThumbDecode (state, pc, instr, &new))
+	  switch (decode_thumb (state, pc, instr, &new))
 	    {
 	    case t_undefined:
 	      /* This is a Thumb instruction.  */
@@ -169,6 +169,60 @@ ARMul_SelectProcessor (ARMul_State * state, unsigned properties)
   /* Only initialse the coprocessor support once we
      know what kind of chip we are dealing with.  */
   ARMul_CoProInit (state);
+
+  /* Thumb decoding depends on the architecture.  */
+  ARMul_DecodeCacheFlush (state);
+}
+
+/***************************************************************************\
+*     Set up, empty and invalidate the decode cache (see armdefs.h)         *
+\***************************************************************************/
+
+void
+ARMul_DecodeCacheInit (ARMul_State * state)
+{
+  state->DecodeCache = (struct ARMul_DecodeEntry *)
+    malloc (DECODE_CACHE_SIZE * sizeof (struct ARMul_DecodeEntry));
+
+  if (state->DecodeCache != NULL)
+    ARMul_DecodeCacheFlush (state);
+}
+
+void
+ARMul_DecodeCacheFlush (ARMul_State * state)
+{
+  unsigned i;
+
+  if (state->DecodeCache == NULL)
+    return;
+
+  for (i = 0; i < DECODE_CACHE_SIZE; i++)
+    state->DecodeCache[i].tag = DECODE_CACHE_EMPTY;
+}
+
+/* The word at ADDRESS has been written.  Discard the ARM instruction
+   fetched from it, and the Thumb fetches which included it: the one
+   from ADDRESS itself, and the misaligned ones from the halfwords on
+   either side.  */
+
+void
+ARMul_DecodeCacheInvalidate (ARMul_State * state, ARMword address)
+{
+  struct ARMul_DecodeEntry *entry;
+
+  address &= ~3;
+
+  entry = &state->DecodeCache[DECODE_CACHE_INDEX (address)];
+  if ((entry->tag & ~1) == address)
+    entry->tag = DECODE_CACHE_EMPTY;
+
+  entry = &state->DecodeCache[DECODE_CACHE_INDEX (address + 2)];
+  if (entry->tag == ((address + 2) | 1))
+    entry->tag = DECODE_CACHE_EMPTY;
+
+  entry = &state->DecodeCache[DECODE_CACHE_INDEX (address - 2)];
+  if (entry->tag == ((address - 2) | 1))
+    entry->tag = DECODE_CACHE_EMPTY;
 }
 
 /***************************************************************************\
@@ -124,6 +124,9 @@ PutWord (ARMul_State * state, ARMword address, ARMword data, int check)
     SWI_vector_installed = TRUE;
 
   *(pageptr + offset) = data;
+
+  if (state->DecodeCache != NULL)
+    ARMul_DecodeCacheInvalidate (state, address);
 }
 
 /***************************************************************************\
@@ -210,6 +213,25 @@ ARMul_ReLoadInstr (ARMul_State * state, ARMword address, ARMword isize)
   return GetWord (state, address, TRUE);
 }
 
+/***************************************************************************\
+*     Can the instruction at an address be kept in the decode cache?        *
+\***************************************************************************/
+
+int
+ARMul_InstrCacheable (ARMul_State * state, ARMword address)
+{
+#ifdef ABORTS
+  if (address >= LOWABORT && address < HIGHABORT)
+    return FALSE;
+#endif
+
+  /* Fetching it again must give the same word, with no side effects.  */
+  if (state->is_XScale && ! XScale_memacc_trivial (state))
+    return FALSE;
+
+  return TRUE;
+}
+
 /***************************************************************************\
 *                   Load Instruction, Sequential Cycle                      *
 \***************************************************************************/
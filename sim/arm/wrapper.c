@@ -56,6 +56,9 @@ static int verbosity;
 /* Non-zero to set big endian mode.  */
 static int big_endian;
 
+/* Non-zero to run through the decode cache.  */
+static int decode_cache = 1;
+
 int stop_simulator;
 
 /* Cirrus DSP registers.
@@ -100,6 +103,8 @@ init ()
       ARMul_EmulateInit ();
       state = ARMul_NewState ();
       state->bigendSig = (big_endian ? HIGH : LOW);
+      if (decode_cache)
+	ARMul_DecodeCacheInit (state);
       ARMul_MemoryInit (state, mem_size);
       ARMul_OSInit (state);
       state->verbose = verbosity;
@@ -678,6 +683,7 @@ typedef struct
 } swi_options;
 
 #define SWI_SWITCH	"--swi-support"
+#define DECODE_CACHE_SWITCH	"--no-decode-cache"
 
 static swi_options options[] =
   {
@@ -709,6 +715,18 @@ sim_target_parse_command_line (argc, argv)
       if ((ptr == NULL) || (* ptr != '-'))
 	break;
 
+      if (strcmp (ptr, DECODE_CACHE_SWITCH) == 0)
+	{
+	  decode_cache = 0;
+
+	  /* Remove this option from the argv array.  */
+	  for (arg = i; arg < argc; arg ++)
+	    argv[arg] = argv[arg + 1];
+	  argc --;
+	  i --;
+	  continue;
+	}
+
       if (strncmp (ptr, SWI_SWITCH, sizeof SWI_SWITCH - 1) != 0)
 	continue;
 
@@ -780,6 +798,8 @@ sim_target_display_usage (help)
   fprintf (stream, "%s=<list>  Comma seperated list of SWI protocols to supoport.\n\
                 This list can contain: NONE, DEMON, ANGEL, REDBOOT and/or ALL.\n",
 	   SWI_SWITCH);
+  fprintf (stream, "%s  Execute without the decode cache.\n",
+	   DECODE_CACHE_SWITCH);
 }
 #endif
 
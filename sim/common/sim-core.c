@@ -25,6 +25,7 @@
 
 #include "sim-main.h"
 #include "sim-assert.h"
+#include "sim-options.h"
 
 #if (WITH_HW)
 #include "sim-hw.h"
@@ -41,6 +42,20 @@
 #if EXTERN_SIM_CORE_P
 static MODULE_INIT_FN sim_core_init;
 static MODULE_UNINSTALL_FN sim_core_uninstall;
+static MODULE_INFO_FN sim_core_info;
+
+static DECLARE_OPTION_HANDLER (sim_core_option_handler);
+
+enum {
+  OPTION_SIM_CORE_STATS = OPTION_START,
+};
+
+static const OPTION sim_core_options[] = {
+  { {"sim-core-stats", no_argument, NULL, OPTION_SIM_CORE_STATS},
+      '\0', NULL, "Report the core's address translation cache hit rate",
+      sim_core_option_handler, NULL },
+  { {NULL, no_argument, NULL, 0}, '\0', NULL, NULL, NULL, NULL }
+};
 #endif
 
 #if EXTERN_SIM_CORE_P
@@ -52,6 +67,8 @@ sim_core_install (SIM_DESC sd)
   /* establish the other handlers */
   sim_module_add_uninstall_fn (sd, sim_core_uninstall);
   sim_module_add_init_fn (sd, sim_core_init);
+  sim_module_add_info_fn (sd, sim_core_info);
+  sim_add_option_table (sd, NULL, sim_core_options);
 
   /* establish any initial data structures - none */
   return SIM_RC_OK;
@@ -59,6 +76,25 @@ sim_core_install (SIM_DESC sd)
 #endif
 
 
+/* Discard every processor's TLB entries.  Must be called whenever
+   the mappings they were derived from change.  */
+
+#if EXTERN_SIM_CORE_P
+static void
+sim_core_tlb_flush (SIM_DESC sd)
+{
+  int i;
+  for (i = 0; i < MAX_NR_PROCESSORS; i++)
+    {
+      sim_core_tlb *tlb = &CPU_CORE (STATE_CPU (sd, i))->tlb;
+      /* An all ones page number never matches an address.  */
+      memset (tlb->entry, 0xff, sizeof (tlb->entry));
+      tlb->nr_flushes++;
+    }
+}
+#endif
+
+
 /* Uninstall the "core" subsystem from the simulator.  */
 
 #if EXTERN_SIM_CORE_P
@@ -81,6 +117,7 @@ sim_core_uninstall (SIM_DESC sd)
     }
     core->common.map[map].first = NULL;
   }
+  sim_core_tlb_flush (sd);
 }
 #endif
 
@@ -89,12 +126,75 @@ sim_core_uninstall (SIM_DESC sd)
 static SIM_RC
 sim_core_init (SIM_DESC sd)
 {
-  /* Nothing to do */
+  /* The processors' TLBs start out zeroed, which is not the same as
+     empty.  */
+  sim_core_tlb_flush (sd);
   return SIM_RC_OK;
 }
 #endif
 
 
+#if EXTERN_SIM_CORE_P
+static SIM_RC
+sim_core_option_handler (SIM_DESC sd,
+			 sim_cpu *cpu,
+			 int opt,
+			 char *arg,
+			 int is_command)
+{
+  switch (opt)
+    {
+    case OPTION_SIM_CORE_STATS:
+      STATE_CORE (sd)->tlb_stats_p = 1;
+      return SIM_RC_OK;
+    }
+  return SIM_RC_FAIL;
+}
+#endif
+
+
+/* Print the TLB statistics collected when --sim-core-stats is in
+   effect.  */
+
+#if EXTERN_SIM_CORE_P
+static void
+sim_core_info (SIM_DESC sd, int verbose)
+{
+  char comma_buf[20];
+  int i;
+
+  if (!STATE_CORE (sd)->tlb_stats_p)
+    return;
+
+  sim_io_printf (sd, "Core address translation statistics:\n\n");
+  for (i = 0; i < MAX_NR_PROCESSORS; i++)
+    {
+      sim_core_tlb *tlb = &CPU_CORE (STATE_CPU (sd, i))->tlb;
+      unsigned long nr_accesses = tlb->nr_hits + tlb->nr_misses;
+
+      if (MAX_NR_PROCESSORS > 1)
+	sim_io_printf (sd, "  CPU %d\n", i);
+      sim_io_printf (sd, "  Total accesses: %s\n",
+		     sim_add_commas (comma_buf, sizeof (comma_buf),
+				     nr_accesses));
+      sim_io_printf (sd, "  TLB hits:       %s\n",
+		     sim_add_commas (comma_buf, sizeof (comma_buf),
+				     tlb->nr_hits));
+      sim_io_printf (sd, "  TLB misses:     %s\n",
+		     sim_add_commas (comma_buf, sizeof (comma_buf),
+				     tlb->nr_misses));
+      sim_io_printf (sd, "  TLB flushes:    %s\n",
+		     sim_add_commas (comma_buf, sizeof (comma_buf),
+				     tlb->nr_flushes));
+      if (nr_accesses != 0)
+	sim_io_printf (sd, "  Hit rate:       %.2f%%\n",
+		       100.0 * tlb->nr_hits / nr_accesses);
+      sim_io_printf (sd, "\n");
+    }
+}
+#endif
+
+
 
 #ifndef SIM_CORE_SIGNAL
 #define SIM_CORE_SIGNAL(SD,CPU,CIA,MAP,NR_BYTES,ADDR,TRANSFER,ERROR) \
@@ -399,6 +499,7 @@ sim_core_attach (SIM_DESC sd,
 	CPU_CORE (STATE_CPU (sd, i))->common = STATE_CORE (sd)->common;
       }
   }
+  sim_core_tlb_flush (sd);
 }
 #endif
 
@@ -457,6 +558,7 @@ sim_core_detach (SIM_DESC sd,
 	CPU_CORE (STATE_CPU (sd, i))->common = STATE_CORE (sd)->common;
       }
   }
+  sim_core_tlb_flush (sd);
 }
 #endif
 
@@ -506,6 +608,43 @@ sim_core_translate (sim_core_mapping *mapping,
 }
 
 
+/* Enter the page containing ADDR into CPU_CORE's TLB for MAP, given
+   that sim_core_find_mapping returned MAPPING for ADDR.  The page is
+   only entered when MAPPING would be found for every address in it:
+   the page must be plain memory lying entirely within MAPPING, and no
+   mapping searched before MAPPING may overlap it.  */
+
+STATIC_SIM_CORE\
+(void)
+sim_core_tlb_fill (sim_cpu_core *cpu_core,
+		   unsigned map,
+		   sim_core_mapping *mapping,
+		   address_word addr)
+{
+  address_word lo = addr & ~SIM_CORE_TLB_PAGE_MASK;
+  address_word hi = lo + SIM_CORE_TLB_PAGE_MASK;
+  sim_core_mapping *earlier;
+  sim_core_tlb_entry *entry;
+
+  if (mapping->device != NULL
+      || mapping->mask != (unsigned) 0 - 1
+      || lo < mapping->base
+      || hi > mapping->bound)
+    return;
+  for (earlier = cpu_core->common.map[map].first;
+       earlier != mapping;
+       earlier = earlier->next)
+    {
+      if (earlier->base <= hi && earlier->bound >= lo)
+	return;
+    }
+
+  entry = &cpu_core->tlb.entry[map][SIM_CORE_TLB_INDEX (addr)];
+  entry->page = addr >> SIM_CORE_TLB_PAGE_BITS;
+  entry->buffer = (unsigned8 *) mapping->buffer + (lo - mapping->base);
+}
+
+
 #if EXTERN_SIM_CORE_P
 unsigned
 sim_core_read_buffer (SIM_DESC sd,
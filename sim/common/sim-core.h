@@ -85,15 +85,55 @@ typedef struct _sim_core sim_core;
 struct _sim_core {
   sim_core_common common;
   address_word byte_xor; /* apply xor universally */
+  int tlb_stats_p; /* --sim-core-stats */
 };
 
 
+/* Software TLB.
+
+   The processor oriented read/write functions below are called for
+   every simulated load, store and instruction fetch.  Rather than
+   search the list of mappings each time, each processor remembers,
+   for each access map, the host address of recently used target
+   pages.  Only pages of plain memory that a single mapping translates
+   in full are entered; device (callback) and modulo memory always
+   take the slow path.  All entries are flushed whenever a mapping is
+   attached or detached. */
+
+#ifndef SIM_CORE_TLB_PAGE_BITS
+#define SIM_CORE_TLB_PAGE_BITS 12
+#endif
+
+#ifndef SIM_CORE_TLB_NR_ENTRIES
+#define SIM_CORE_TLB_NR_ENTRIES 256 /* must be a power of two */
+#endif
+
+#define SIM_CORE_TLB_PAGE_SIZE ((address_word) 1 << SIM_CORE_TLB_PAGE_BITS)
+#define SIM_CORE_TLB_PAGE_MASK (SIM_CORE_TLB_PAGE_SIZE - 1)
+#define SIM_CORE_TLB_INDEX(ADDR) \
+  (((ADDR) >> SIM_CORE_TLB_PAGE_BITS) & (SIM_CORE_TLB_NR_ENTRIES - 1))
+
+typedef struct _sim_core_tlb_entry {
+  address_word page; /* ADDR >> SIM_CORE_TLB_PAGE_BITS; all ones when empty */
+  unsigned8 *buffer; /* host address of the start of the page */
+} sim_core_tlb_entry;
+
+typedef struct _sim_core_tlb {
+  sim_core_tlb_entry entry[nr_maps][SIM_CORE_TLB_NR_ENTRIES];
+  /* statistics */
+  unsigned long nr_hits;
+  unsigned long nr_misses;
+  unsigned long nr_flushes;
+} sim_core_tlb;
+
+
 /* Per CPU distributed component of the core.  At present this is
    mostly a clone of the global core data structure. */
 
 typedef struct _sim_cpu_core {
   sim_core_common common;
   address_word xor[WITH_XOR_ENDIAN + 1]; /* +1 to avoid zero-sized array */
+  sim_core_tlb tlb;
 } sim_cpu_core;
 
 
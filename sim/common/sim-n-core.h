@@ -154,6 +154,7 @@ sim_core_read_aligned_N(sim_cpu *cpu,
   sim_core_common *core = &cpu_core->common;
   unsigned_M val;
   sim_core_mapping *mapping;
+  sim_core_tlb_entry *entry;
   address_word addr;
 #if WITH_XOR_ENDIAN != 0
   if (WITH_XOR_ENDIAN)
@@ -161,9 +162,20 @@ sim_core_read_aligned_N(sim_cpu *cpu,
   else
 #endif
     addr = xaddr;
-  mapping = sim_core_find_mapping (core, map, addr, N, read_transfer, 1 /*abort*/, cpu, cia);
   do
     {
+      /* fast path - the page is in the TLB */
+      entry = &cpu_core->tlb.entry[map][SIM_CORE_TLB_INDEX (addr)];
+      if (entry->page == (addr >> SIM_CORE_TLB_PAGE_BITS)
+	  && (addr & SIM_CORE_TLB_PAGE_MASK) <= SIM_CORE_TLB_PAGE_SIZE - N)
+	{
+	  cpu_core->tlb.nr_hits++;
+	  val = T2H_M (*(unsigned_M*) (entry->buffer
+				       + (addr & SIM_CORE_TLB_PAGE_MASK)));
+	  break;
+	}
+      cpu_core->tlb.nr_misses++;
+      mapping = sim_core_find_mapping (core, map, addr, N, read_transfer, 1 /*abort*/, cpu, cia);
 #if (WITH_DEVICES)
       if (WITH_CALLBACK_MEMORY && mapping->device != NULL)
 	{
@@ -185,6 +197,7 @@ sim_core_read_aligned_N(sim_cpu *cpu,
 	}
 #endif
       val = T2H_M (*(unsigned_M*) sim_core_translate (mapping, addr));
+      sim_core_tlb_fill (cpu_core, map, mapping, addr);
     }
   while (0);
   PROFILE_COUNT_CORE (cpu, addr, N, map);
@@ -285,6 +298,7 @@ sim_core_write_aligned_N(sim_cpu *cpu,
   sim_cpu_core *cpu_core = CPU_CORE (cpu);
   sim_core_common *core = &cpu_core->common;
   sim_core_mapping *mapping;
+  sim_core_tlb_entry *entry;
   address_word addr;
 #if WITH_XOR_ENDIAN != 0
   if (WITH_XOR_ENDIAN)
@@ -292,9 +306,20 @@ sim_core_write_aligned_N(sim_cpu *cpu,
   else
 #endif
     addr = xaddr;
-  mapping = sim_core_find_mapping (core, map, addr, N, write_transfer, 1 /*abort*/, cpu, cia);
   do
     {
+      /* fast path - the page is in the TLB */
+      entry = &cpu_core->tlb.entry[map][SIM_CORE_TLB_INDEX (addr)];
+      if (entry->page == (addr >> SIM_CORE_TLB_PAGE_BITS)
+	  && (addr & SIM_CORE_TLB_PAGE_MASK) <= SIM_CORE_TLB_PAGE_SIZE - N)
+	{
+	  cpu_core->tlb.nr_hits++;
+	  *(unsigned_M*) (entry->buffer
+			  + (addr & SIM_CORE_TLB_PAGE_MASK)) = H2T_M (val);
+	  break;
+	}
+      cpu_core->tlb.nr_misses++;
+      mapping = sim_core_find_mapping (core, map, addr, N, write_transfer, 1 /*abort*/, cpu, cia);
 #if (WITH_DEVICES)
       if (WITH_CALLBACK_MEMORY && mapping->device != NULL)
 	{
@@ -314,6 +339,7 @@ sim_core_write_aligned_N(sim_cpu *cpu,
 	}
 #endif
       *(unsigned_M*) sim_core_translate (mapping, addr) = H2T_M (val);
+      sim_core_tlb_fill (cpu_core, map, mapping, addr);
     }
   while (0);
   PROFILE_COUNT_CORE (cpu, addr, N, map);